@@ -4176,12 +4176,15 @@ class ExoPlayerCore(private val activity: Activity) :
       "subLibassLastMs" to assSubtitleView?.lastLibassMs,
       "subLibassMaxMs" to assSubtitleView?.maxLibassMs,
       "subLibassHist" to assSubtitleView?.libassMsHistogram,
+      // Placed atlas pixels per thousand uploaded, last changed frame
+      "subAtlasOccupancy" to assSubtitleView?.lastAtlasOccupancy,
       // ASS render-ahead: hits = served from a pre-rendered frame (GL-only path);
       // minLead ≥ 0 means changed content reached the queue before the video
       // frame's vsync — the frame-perfection signal.
       "subSpecHits" to assSubtitleView?.specHits,
       "subSpecMisses" to assSubtitleView?.specMisses,
       "subSpecSkips" to assSubtitleView?.specSkips,
+      "subSpecHeld" to assSubtitleView?.specHeld,
       "subPrefetches" to assSubtitleView?.prefetchCount,
       "subBlankClears" to assSubtitleView?.blankClearCount,
       "subCoalesced" to assSubtitleView?.coalescedRequestCount,
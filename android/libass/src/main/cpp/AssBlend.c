@@ -0,0 +1,106 @@
+#include "AssBlend.h"
+
+#if defined(__ARM_NEON) || defined(__ARM_NEON__)
+#include <arm_neon.h>
+#define ASS_BLEND_NEON 1
+#elif defined(__SSE2__) || defined(_M_X64)
+#include <emmintrin.h>
+#define ASS_BLEND_SSE2 1
+#endif
+
+void ass_blend_span_scalar(
+    uint8_t* dst, const uint8_t* src, int count, unsigned r, unsigned g, unsigned b, unsigned a) {
+  for (int x = 0; x < count; x++, dst += 4) {
+    const unsigned k = (src[x] * a + 127u) / 255u;
+    if (k == 0) continue;
+    const unsigned inv = 255u - k;
+    dst[0] = (uint8_t)((r * k + dst[0] * inv + 127u) / 255u);
+    dst[1] = (uint8_t)((g * k + dst[1] * inv + 127u) / 255u);
+    dst[2] = (uint8_t)((b * k + dst[2] * inv + 127u) / 255u);
+    dst[3] = (uint8_t)((255u * k + dst[3] * inv + 127u) / 255u);
+  }
+}
+
+// Both kernels divide by 255 as (x + 1 + (x >> 8)) >> 8, which is exact for
+// every x below 65535; the largest value either step divides is
+// 255 * 255 + 127. A zero k leaves dst unchanged under that math too, so the
+// kernels need no per-pixel skip to match the scalar one.
+
+#if ASS_BLEND_NEON
+
+static inline uint16x8_t div255(uint16x8_t x) {
+  return vshrq_n_u16(vaddq_u16(vaddq_u16(x, vdupq_n_u16(1)), vshrq_n_u16(x, 8)), 8);
+}
+
+static inline uint8x8_t blendChannel(uint8x8_t d, uint8x8_t colour, uint8x8_t k, uint8x8_t inv) {
+  return vmovn_u16(div255(vmlal_u8(vmlal_u8(vdupq_n_u16(127), colour, k), d, inv)));
+}
+
+void ass_blend_span(uint8_t* dst, const uint8_t* src, int count, unsigned r, unsigned g, unsigned b, unsigned a) {
+  const uint8x8_t av = vdup_n_u8((uint8_t)a);
+  const uint8x8_t rv = vdup_n_u8((uint8_t)r);
+  const uint8x8_t gv = vdup_n_u8((uint8_t)g);
+  const uint8x8_t bv = vdup_n_u8((uint8_t)b);
+  const uint8x8_t opaque = vdup_n_u8(255);
+  int x = 0;
+  for (; x + 8 <= count; x += 8) {
+    const uint8x8_t s = vld1_u8(src + x);
+    if (vget_lane_u64(vreinterpret_u64_u8(s), 0) == 0) continue;
+    const uint8x8_t k = vmovn_u16(div255(vmlal_u8(vdupq_n_u16(127), s, av)));
+    const uint8x8_t inv = vmvn_u8(k);
+    uint8x8x4_t d = vld4_u8(dst + (size_t)x * 4);
+    d.val[0] = blendChannel(d.val[0], rv, k, inv);
+    d.val[1] = blendChannel(d.val[1], gv, k, inv);
+    d.val[2] = blendChannel(d.val[2], bv, k, inv);
+    d.val[3] = blendChannel(d.val[3], opaque, k, inv);
+    vst4_u8(dst + (size_t)x * 4, d);
+  }
+  ass_blend_span_scalar(dst + (size_t)x * 4, src + x, count - x, r, g, b, a);
+}
+
+#elif ASS_BLEND_SSE2
+
+static inline __m128i div255(__m128i x) {
+  return _mm_srli_epi16(_mm_add_epi16(_mm_add_epi16(x, _mm_set1_epi16(1)), _mm_srli_epi16(x, 8)), 8);
+}
+
+// Two pixels widened to 16-bit lanes, each under its own k (repeated per channel).
+static inline __m128i blendPair(__m128i d, __m128i k, __m128i colour) {
+  const __m128i inv = _mm_sub_epi16(_mm_set1_epi16(255), k);
+  const __m128i sum = _mm_add_epi16(_mm_mullo_epi16(colour, k), _mm_mullo_epi16(d, inv));
+  return div255(_mm_add_epi16(sum, _mm_set1_epi16(127)));
+}
+
+void ass_blend_span(uint8_t* dst, const uint8_t* src, int count, unsigned r, unsigned g, unsigned b, unsigned a) {
+  const __m128i zero = _mm_setzero_si128();
+  const __m128i av = _mm_set1_epi16((short)a);
+  const __m128i colour = _mm_set_epi16(255, (short)b, (short)g, (short)r, 255, (short)b, (short)g, (short)r);
+  int x = 0;
+  for (; x + 8 <= count; x += 8) {
+    const __m128i s = _mm_loadl_epi64((const __m128i*)(src + x));
+    if (_mm_movemask_epi8(_mm_cmpeq_epi8(s, zero)) == 0xFFFF) continue;
+    const __m128i k = div255(_mm_add_epi16(_mm_mullo_epi16(_mm_unpacklo_epi8(s, zero), av), _mm_set1_epi16(127)));
+    const __m128i k03 = _mm_unpacklo_epi16(k, k);
+    const __m128i k47 = _mm_unpackhi_epi16(k, k);
+    uint8_t* p = dst + (size_t)x * 4;
+    const __m128i d03 = _mm_loadu_si128((const __m128i*)p);
+    const __m128i d47 = _mm_loadu_si128((const __m128i*)(p + 16));
+    const __m128i out03 = _mm_packus_epi16(
+        blendPair(_mm_unpacklo_epi8(d03, zero), _mm_unpacklo_epi32(k03, k03), colour),
+        blendPair(_mm_unpackhi_epi8(d03, zero), _mm_unpackhi_epi32(k03, k03), colour));
+    const __m128i out47 = _mm_packus_epi16(
+        blendPair(_mm_unpacklo_epi8(d47, zero), _mm_unpacklo_epi32(k47, k47), colour),
+        blendPair(_mm_unpackhi_epi8(d47, zero), _mm_unpackhi_epi32(k47, k47), colour));
+    _mm_storeu_si128((__m128i*)p, out03);
+    _mm_storeu_si128((__m128i*)(p + 16), out47);
+  }
+  ass_blend_span_scalar(dst + (size_t)x * 4, src + x, count - x, r, g, b, a);
+}
+
+#else
+
+void ass_blend_span(uint8_t* dst, const uint8_t* src, int count, unsigned r, unsigned g, unsigned b, unsigned a) {
+  ass_blend_span_scalar(dst, src, count, r, g, b, a);
+}
+
+#endif
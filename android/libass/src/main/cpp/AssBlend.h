@@ -0,0 +1,26 @@
+// The src-over span blend behind the RGBA composite (AssPack.c). Kept free of
+// JNI/Android includes like AssPack.h, so a desktop harness can check the SIMD
+// kernel against the scalar one bit for bit.
+#ifndef PLEZY_ASS_BLEND_H
+#define PLEZY_ASS_BLEND_H
+
+#include <stdint.h>
+
+// Blends `count` pixels of one libass alpha mask row (`src`) in colour
+// (r, g, b) at opacity `a` (all 0..255, `a` already inverted from libass's
+// transparency) over the premultiplied RGBA pixels at `dst`:
+//
+//   k   = (src * a + 127) / 255
+//   dst = (colour * k + dst * (255 - k) + 127) / 255, alpha with colour 255
+//
+// the painter-order math the GL path applies to atlas quads, rounded once per
+// step. Uses NEON on ARM and SSE2 on x86 when the build targets them, and runs
+// of fully transparent mask pixels are skipped without touching `dst`.
+void ass_blend_span(uint8_t* dst, const uint8_t* src, int count, unsigned r, unsigned g, unsigned b, unsigned a);
+
+// The same blend one pixel at a time: the reference the SIMD kernels must
+// match exactly, and the tail of every span.
+void ass_blend_span_scalar(
+    uint8_t* dst, const uint8_t* src, int count, unsigned r, unsigned g, unsigned b, unsigned a);
+
+#endif  // PLEZY_ASS_BLEND_H
@@ -0,0 +1,181 @@
+#include "AssIndex.h"
+
+#include <stdlib.h>
+#include <string.h>
+
+static int compareEntries(const void* a, const void* b) {
+  const AssIndexEntry* x = (const AssIndexEntry*)a;
+  const AssIndexEntry* y = (const AssIndexEntry*)b;
+  if (x->start != y->start) return x->start < y->start ? -1 : 1;
+  if (x->end != y->end) return x->end < y->end ? -1 : 1;
+  return x->event - y->event;
+}
+
+static int compareLongs(const void* a, const void* b) {
+  const long long x = *(const long long*)a;
+  const long long y = *(const long long*)b;
+  return x < y ? -1 : (x > y ? 1 : 0);
+}
+
+// First position in the sorted `values` whose value is > key (upper bound).
+static int firstLongAfter(const long long* values, int count, long long key) {
+  int lo = 0, hi = count;
+  while (lo < hi) {
+    const int mid = lo + (hi - lo) / 2;
+    if (values[mid] <= key) {
+      lo = mid + 1;
+    } else {
+      hi = mid;
+    }
+  }
+  return lo;
+}
+
+// First position whose start is >= key (lower bound), or > key when `strict`.
+static int firstEntryFrom(const AssIndexEntry* entries, int count, long long key, int strict) {
+  int lo = 0, hi = count;
+  while (lo < hi) {
+    const int mid = lo + (hi - lo) / 2;
+    if (entries[mid].start < key || (strict && entries[mid].start == key)) {
+      lo = mid + 1;
+    } else {
+      hi = mid;
+    }
+  }
+  return lo;
+}
+
+AssEventIndex* ass_index_new(void) { return (AssEventIndex*)calloc(1, sizeof(AssEventIndex)); }
+
+void ass_index_free(AssEventIndex* index) {
+  if (index == NULL) return;
+  free(index->byStart);
+  free(index->ends);
+  free(index);
+}
+
+static void resetIndex(AssEventIndex* index) {
+  index->count = 0;
+  index->maxDuration = 0;
+}
+
+static int reserve(AssEventIndex* index, int count) {
+  if (count <= index->capacity) return 1;
+  int capacity = index->capacity > 0 ? index->capacity : 256;
+  while (capacity < count) capacity *= 2;
+  AssIndexEntry* byStart = (AssIndexEntry*)realloc(index->byStart, (size_t)capacity * sizeof(AssIndexEntry));
+  if (byStart == NULL) return 0;
+  index->byStart = byStart;
+  long long* ends = (long long*)realloc(index->ends, (size_t)capacity * sizeof(long long));
+  if (ends == NULL) return 0;
+  index->ends = ends;
+  index->capacity = capacity;
+  return 1;
+}
+
+// Whether the events already indexed are still the ones at those positions.
+static int stillAppendOnly(const AssEventIndex* index, const ASS_Track* track) {
+  if (index->count == 0) return 1;
+  if (track->n_events < index->count) return 0;
+  const ASS_Event* first = &track->events[0];
+  const ASS_Event* last = &track->events[index->count - 1];
+  return first->Start == index->firstStart && first->Duration == index->firstDuration &&
+         last->Start == index->lastStart && last->Duration == index->lastDuration;
+}
+
+int ass_index_sync(AssEventIndex* index, const ASS_Track* track) {
+  if (index == NULL || track == NULL) return 0;
+  if (!stillAppendOnly(index, track)) resetIndex(index);
+  const int old = index->count;
+  const int added = track->n_events - old;
+  if (added <= 0) return 1;
+  if (!reserve(index, track->n_events)) {
+    resetIndex(index);
+    return 0;
+  }
+
+  // The new events sorted on their own, in the spare room past the indexed ones,
+  // then merged in from the back so nothing moves twice.
+  AssIndexEntry* fresh = index->byStart + old;
+  long long* freshEnds = index->ends + old;
+  for (int i = 0; i < added; i++) {
+    const ASS_Event* event = &track->events[old + i];
+    fresh[i].start = event->Start;
+    fresh[i].end = event->Start + event->Duration;
+    fresh[i].event = old + i;
+    freshEnds[i] = fresh[i].end;
+    if (event->Duration > index->maxDuration) index->maxDuration = event->Duration;
+  }
+  qsort(fresh, (size_t)added, sizeof(AssIndexEntry), compareEntries);
+  qsort(freshEnds, (size_t)added, sizeof(long long), compareLongs);
+
+  if (old > 0) {
+    AssIndexEntry* spare = (AssIndexEntry*)malloc((size_t)added * sizeof(AssIndexEntry));
+    long long* spareEnds = (long long*)malloc((size_t)added * sizeof(long long));
+    if (spare == NULL || spareEnds == NULL) {
+      free(spare);
+      free(spareEnds);
+      resetIndex(index);
+      return 0;
+    }
+    memcpy(spare, fresh, (size_t)added * sizeof(AssIndexEntry));
+    memcpy(spareEnds, freshEnds, (size_t)added * sizeof(long long));
+    int i = old - 1, j = added - 1, k = old + added - 1;
+    while (j >= 0) {
+      if (i >= 0 && compareEntries(&index->byStart[i], &spare[j]) > 0) {
+        index->byStart[k--] = index->byStart[i--];
+      } else {
+        index->byStart[k--] = spare[j--];
+      }
+    }
+    i = old - 1, j = added - 1, k = old + added - 1;
+    while (j >= 0) {
+      if (i >= 0 && index->ends[i] > spareEnds[j]) {
+        index->ends[k--] = index->ends[i--];
+      } else {
+        index->ends[k--] = spareEnds[j--];
+      }
+    }
+    free(spare);
+    free(spareEnds);
+  }
+
+  index->count = track->n_events;
+  const ASS_Event* first = &track->events[0];
+  const ASS_Event* last = &track->events[index->count - 1];
+  index->firstStart = first->Start;
+  index->firstDuration = first->Duration;
+  index->lastStart = last->Start;
+  index->lastDuration = last->Duration;
+  return 1;
+}
+
+long long ass_index_next_start(const AssEventIndex* index, long long afterMs) {
+  if (index == NULL) return -1;
+  const int at = firstEntryFrom(index->byStart, index->count, afterMs, 1);
+  return at < index->count ? index->byStart[at].start : -1;
+}
+
+long long ass_index_next_change(const AssEventIndex* index, long long afterMs) {
+  if (index == NULL) return -1;
+  const long long start = ass_index_next_start(index, afterMs);
+  const int at = firstLongAfter(index->ends, index->count, afterMs);
+  const long long end = at < index->count ? index->ends[at] : -1;
+  if (start < 0) return end;
+  if (end < 0) return start;
+  return start < end ? start : end;
+}
+
+int ass_index_window(const AssEventIndex* index, long long fromMs, long long toMs, AssIndexEntry* out, int max) {
+  if (index == NULL || toMs <= fromMs) return 0;
+  // Nothing that starts before fromMs - maxDuration can still be showing.
+  const int first = firstEntryFrom(index->byStart, index->count, fromMs - index->maxDuration, 0);
+  const int last = firstEntryFrom(index->byStart, index->count, toMs, 0);
+  int found = 0;
+  for (int i = first; i < last; i++) {
+    if (index->byStart[i].end <= fromMs) continue;
+    if (found < max && out != NULL) out[found] = index->byStart[i];
+    found++;
+  }
+  return found;
+}
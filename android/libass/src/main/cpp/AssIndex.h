@@ -0,0 +1,53 @@
+// Event-time index behind the track's next-boundary and window queries (AssKt.c).
+// Kept free of JNI/Android includes like AssPack.h, so a desktop harness can
+// check it against a host libass build.
+#ifndef PLEZY_ASS_INDEX_H
+#define PLEZY_ASS_INDEX_H
+
+#include "ass/ass.h"
+
+typedef struct {
+  long long start;
+  long long end;  // Start + Duration
+  int event;      // index into ASS_Track.events
+} AssIndexEntry;
+
+// Every event's start and end, each sorted, so "the next boundary after t" is a
+// binary search instead of a scan of the whole track: signs-heavy tracks carry
+// 10k+ events and the render pipeline asks on every idle stretch.
+//
+// libass only ever appends to a track's events (ass_process_chunk), so a sync
+// sorts the events added since the last one and merges them in. Anything else -
+// a flush, a prune, a track reloaded with the same count - shows as fewer
+// events or a changed first/last indexed event, and rebuilds from scratch.
+typedef struct {
+  AssIndexEntry* byStart;  // sorted by start, then end
+  long long* ends;         // sorted
+  int count;
+  int capacity;
+  // The longest event, which bounds how far before a window an event that is
+  // still showing in it can start.
+  long long maxDuration;
+  // The first and last indexed events as they were indexed; see above.
+  long long firstStart, firstDuration, lastStart, lastDuration;
+} AssEventIndex;
+
+AssEventIndex* ass_index_new(void);
+void ass_index_free(AssEventIndex* index);
+
+// Brings the index up to date with `track`. Returns 0 on allocation failure,
+// leaving the index empty so the next sync rebuilds.
+int ass_index_sync(AssEventIndex* index, const ASS_Track* track);
+
+// Earliest event start strictly after `afterMs`, or -1.
+long long ass_index_next_start(const AssEventIndex* index, long long afterMs);
+
+// Earliest event start or end strictly after `afterMs`, or -1.
+long long ass_index_next_change(const AssEventIndex* index, long long afterMs);
+
+// The events showing at any point of [fromMs, toMs): start < toMs and end >
+// fromMs. Writes up to `max` of them to `out` in start order and returns how
+// many there are in all, so a caller with too small a buffer can grow it.
+int ass_index_window(const AssEventIndex* index, long long fromMs, long long toMs, AssIndexEntry* out, int max);
+
+#endif  // PLEZY_ASS_INDEX_H
@@ -18,6 +18,7 @@ static inline long long nowMs(void) {
   return (long long)ts.tv_sec * 1000 + ts.tv_nsec / 1000000;
 }
 
+#include "AssIndex.h"
 #include "AssPack.h"
 #include "ass/ass.h"
 
@@ -82,21 +83,42 @@ Java_com_edde746_plezy_libass_AssTrack_nativeAssTrackInit(JNIEnv* env, jclass cl
   return (jlong)track;
 }
 
-// Shared body of readBuffer/readChunk: pins the byte array and feeds libass.
-// chunked != 0 routes to ass_process_chunk (timed dialogue), else ass_process_data.
+// Feeds one span to libass. chunked != 0 routes to ass_process_chunk (timed
+// dialogue), else ass_process_data. Both copy what they keep, so the span only
+// has to live for the call.
+static void feedTrack(ASS_Track* track, char* data, int length, long long start, long long duration, int chunked) {
+  if (chunked) {
+    ass_process_chunk(track, data, length, start, duration);
+  } else {
+    ass_process_data(track, data, length);
+  }
+}
+
+static int spanFits(jlong capacity, jlong offset, jlong length) {
+  return offset >= 0 && length >= 0 && offset <= capacity && length <= capacity - offset;
+}
+
+// Shared body of readBuffer/readChunk. libass only reads the span, so the
+// array is always released with JNI_ABORT and nothing is copied back. A timed
+// dialogue line parses in microseconds and is read inside a critical region,
+// which spares ART copying the array out. A whole script is not: it can carry
+// embedded fonts to decode, and a critical region would hold off the GC for
+// the full parse, so it takes GetByteArrayElements instead.
 static void processTrackBytes(
     JNIEnv* env, jlong track, jbyteArray buffer, jint offset, jint length, jlong start, jlong duration, int chunked) {
-  if (!track) return;
-  jbyte* elements = (*env)->GetByteArrayElements(env, buffer, NULL);
+  if (!track || !buffer) return;
+  if (!spanFits((*env)->GetArrayLength(env, buffer), offset, length)) return;
+  jbyte* elements =
+      chunked ? (*env)->GetPrimitiveArrayCritical(env, buffer, NULL) : (*env)->GetByteArrayElements(env, buffer, NULL);
   if (elements == NULL) {
     return;
   }
+  feedTrack((ASS_Track*)track, (char*)(elements + offset), length, start, duration, chunked);
   if (chunked) {
-    ass_process_chunk((ASS_Track*)track, (char*)(elements + offset), length, start, duration);
+    (*env)->ReleasePrimitiveArrayCritical(env, buffer, elements, JNI_ABORT);
   } else {
-    ass_process_data((ASS_Track*)track, (char*)(elements + offset), length);
+    (*env)->ReleaseByteArrayElements(env, buffer, elements, JNI_ABORT);
   }
-  (*env)->ReleaseByteArrayElements(env, buffer, elements, 0);
 }
 
 JNIEXPORT void JNICALL Java_com_edde746_plezy_libass_AssTrack_nativeAssTrackReadBuffer(
@@ -109,25 +131,88 @@ JNIEXPORT void JNICALL Java_com_edde746_plezy_libass_AssTrack_nativeAssTrackRead
   processTrackBytes(env, track, buffer, offset, length, start, duration, 1);
 }
 
+// Direct ByteBuffer variants: libass reads the buffer's own memory, with no
+// pinning and no copy at all. offset/length are absolute within the buffer.
+static void processTrackDirect(
+    JNIEnv* env, jlong track, jobject buffer, jint offset, jint length, jlong start, jlong duration, int chunked) {
+  if (!track || !buffer) return;
+  char* data = (char*)(*env)->GetDirectBufferAddress(env, buffer);
+  if (data == NULL || !spanFits((*env)->GetDirectBufferCapacity(env, buffer), offset, length)) return;
+  feedTrack((ASS_Track*)track, data + offset, length, start, duration, chunked);
+}
+
+JNIEXPORT void JNICALL Java_com_edde746_plezy_libass_AssTrack_nativeAssTrackReadBufferDirect(
+    JNIEnv* env, jclass clazz, jlong track, jobject buffer, jint offset, jint length) {
+  processTrackDirect(env, track, buffer, offset, length, 0, 0, 0);
+}
+
+JNIEXPORT void JNICALL Java_com_edde746_plezy_libass_AssTrack_nativeAssTrackReadChunkDirect(
+    JNIEnv* env, jclass clazz, jlong track, jlong start, jlong duration, jobject buffer, jint offset, jint length) {
+  processTrackDirect(env, track, buffer, offset, length, start, duration, 1);
+}
+
+// Many timed dialogue chunks in one JNI call. chunks holds count records of
+// ASS_CHUNK_LONGS longs each: start, duration, then the offset and length of
+// the line within the direct buffer. A record whose span falls outside the
+// buffer is skipped rather than ending the batch. Returns how many were fed.
+// Records are copied out a block at a time: libass parses between copies, so
+// the array is never pinned (and the GC never held off) while it does.
+#define ASS_CHUNK_LONGS 4
+#define ASS_CHUNK_BLOCK 64
+
+JNIEXPORT jint JNICALL Java_com_edde746_plezy_libass_AssTrack_nativeAssTrackReadChunks(
+    JNIEnv* env, jclass clazz, jlong track, jobject buffer, jlongArray chunks, jint count) {
+  if (!track || !buffer || !chunks || count <= 0) return 0;
+  char* data = (char*)(*env)->GetDirectBufferAddress(env, buffer);
+  const jlong capacity = (*env)->GetDirectBufferCapacity(env, buffer);
+  if (data == NULL) return 0;
+  if ((jlong)count * ASS_CHUNK_LONGS > (*env)->GetArrayLength(env, chunks)) return 0;
+  jlong records[ASS_CHUNK_BLOCK * ASS_CHUNK_LONGS];
+  int fed = 0;
+  for (int first = 0; first < count; first += ASS_CHUNK_BLOCK) {
+    const int block = count - first < ASS_CHUNK_BLOCK ? count - first : ASS_CHUNK_BLOCK;
+    (*env)->GetLongArrayRegion(env, chunks, first * ASS_CHUNK_LONGS, block * ASS_CHUNK_LONGS, records);
+    for (int i = 0; i < block; i++) {
+      const jlong* r = records + i * ASS_CHUNK_LONGS;
+      if (r[3] > INT_MAX || !spanFits(capacity, r[2], r[3])) continue;
+      feedTrack((ASS_Track*)track, data + r[2], (int)r[3], r[0], r[1], 1);
+      fed++;
+    }
+  }
+  return fed;
+}
+
 JNIEXPORT void JNICALL
 Java_com_edde746_plezy_libass_AssTrack_nativeAssTrackDeinit(JNIEnv* env, jclass clazz, jlong track) {
   if (!track) return;
   ass_free_track((ASS_Track*)track);
 }
 
+// The track's event-time index (AssIndex.h). Owned by the Kotlin AssTrack
+// beside the track handle, and only touched under the same libass lock.
+JNIEXPORT jlong JNICALL Java_com_edde746_plezy_libass_AssTrack_nativeAssTrackIndexInit(JNIEnv* env, jclass clazz) {
+  return (jlong)ass_index_new();
+}
+
+JNIEXPORT void JNICALL
+Java_com_edde746_plezy_libass_AssTrack_nativeAssTrackIndexDeinit(JNIEnv* env, jclass clazz, jlong index) {
+  ass_index_free((AssEventIndex*)index);
+}
+
+// The index caught up with whatever ass_process_chunk appended since the last
+// query, or NULL when either handle is missing or the sync ran out of memory.
+static AssEventIndex* syncedIndex(jlong track, jlong index) {
+  if (!track || !index) return NULL;
+  AssEventIndex* eventIndex = (AssEventIndex*)index;
+  return ass_index_sync(eventIndex, (ASS_Track*)track) ? eventIndex : NULL;
+}
+
 // Earliest event Start strictly after afterMs, or -1. Lets the render pipeline
 // pre-render (cache-warm) the next upcoming event during idle stretches so
 // heavy typesetting doesn't pay its cache-cold rasterization at appearance.
 JNIEXPORT jlong JNICALL Java_com_edde746_plezy_libass_AssTrack_nativeAssTrackNextEventStart(
-    JNIEnv* env, jclass clazz, jlong track, jlong afterMs) {
-  if (!track) return -1;
-  ASS_Track* t = (ASS_Track*)track;
-  long long best = -1;
-  for (int i = 0; i < t->n_events; i++) {
-    const long long start = t->events[i].Start;
-    if (start > afterMs && (best < 0 || start < best)) best = start;
-  }
-  return (jlong)best;
+    JNIEnv* env, jclass clazz, jlong track, jlong index, jlong afterMs) {
+  return (jlong)ass_index_next_start(syncedIndex(track, index), afterMs);
 }
 
 // Earliest visible-content boundary (event Start OR End) strictly after afterMs,
@@ -135,17 +220,39 @@ JNIEXPORT jlong JNICALL Java_com_edde746_plezy_libass_AssTrack_nativeAssTrackNex
 // the render pipeline uses this to ensure nothing on screen is due to change
 // before the event it is about to warm.
 JNIEXPORT jlong JNICALL Java_com_edde746_plezy_libass_AssTrack_nativeAssTrackNextEventChange(
-    JNIEnv* env, jclass clazz, jlong track, jlong afterMs) {
-  if (!track) return -1;
-  ASS_Track* t = (ASS_Track*)track;
-  long long best = -1;
-  for (int i = 0; i < t->n_events; i++) {
-    const long long start = t->events[i].Start;
-    const long long end = start + t->events[i].Duration;
-    if (start > afterMs && (best < 0 || start < best)) best = start;
-    if (end > afterMs && (best < 0 || end < best)) best = end;
+    JNIEnv* env, jclass clazz, jlong track, jlong index, jlong afterMs) {
+  return (jlong)ass_index_next_change(syncedIndex(track, index), afterMs);
+}
+
+// Events showing at any point of [fromMs, toMs), in start order, as (start, end)
+// pairs in `out` - as many as fit. Returns how many there are in all; a count
+// above out.size / 2 means the caller should grow `out` and ask again.
+JNIEXPORT jint JNICALL Java_com_edde746_plezy_libass_AssTrack_nativeAssTrackEventsInWindow(
+    JNIEnv* env, jclass clazz, jlong track, jlong index, jlong fromMs, jlong toMs, jlongArray out) {
+  AssEventIndex* eventIndex = syncedIndex(track, index);
+  if (eventIndex == NULL || out == NULL) return 0;
+  const int max = (int)((*env)->GetArrayLength(env, out) / 2);
+  AssIndexEntry stackEntries[64];
+  AssIndexEntry* entries = stackEntries;
+  const int total = ass_index_window(eventIndex, fromMs, toMs, NULL, 0);
+  const int wanted = total < max ? total : max;
+  if (wanted > 64) {
+    entries = (AssIndexEntry*)malloc((size_t)wanted * sizeof(AssIndexEntry));
+    if (entries == NULL) return 0;
   }
-  return (jlong)best;
+  ass_index_window(eventIndex, fromMs, toMs, entries, wanted);
+  if (wanted > 0) {
+    jlong* pairs = (*env)->GetPrimitiveArrayCritical(env, out, NULL);
+    if (pairs != NULL) {
+      for (int i = 0; i < wanted; i++) {
+        pairs[2 * i] = entries[i].start;
+        pairs[2 * i + 1] = entries[i].end;
+      }
+      (*env)->ReleasePrimitiveArrayCritical(env, out, pairs, 0);
+    }
+  }
+  if (entries != stackEntries) free(entries);
+  return total;
 }
 
 // --- AssRender ---
@@ -244,6 +351,17 @@ Java_com_edde746_plezy_libass_AssRender_nativeAssRenderDeinit(JNIEnv* env, jclas
   }
 }
 
+// The persistent atlas layout (AssPack.h) one AssRender keeps across frames.
+// Owned by the Kotlin AssRender and only touched under the libass lock.
+JNIEXPORT jlong JNICALL Java_com_edde746_plezy_libass_AssRender_nativeAssPackCacheInit(JNIEnv* env, jclass clazz) {
+  return (jlong)ass_pack_cache_new();
+}
+
+JNIEXPORT void JNICALL
+Java_com_edde746_plezy_libass_AssRender_nativeAssPackCacheDeinit(JNIEnv* env, jclass clazz, jlong cache) {
+  ass_pack_cache_free((AssPackCache*)cache);
+}
+
 // Packing/composite policy lives in AssPack.c (pure C, desktop-testable); this
 // file owns the JNI boundary, buffer plumbing and logging.
 
@@ -268,11 +386,13 @@ static int truncationLogCounter = 0;
 //   [7 .. 7+MAX-1]            = pageHeights[pageCount]
 //   [7+MAX .. 7+2*MAX-1]      = pageQuadCounts[pageCount]
 //   [7+2*MAX]                 = mode (ASS_PACK_MODE_ATLAS | ASS_PACK_MODE_COMPOSITE)
-#define ASS_HEADER_INTS (7 + 2 * ASS_PACK_MAX_PAGES + 1)
+//   [8+2*MAX .. 11+2*MAX]     = layoutId, baseLayoutId, dirtyTop, dirtyBottom (AssPackResult)
+//   [12+2*MAX]                = occupancyPermille
+#define ASS_HEADER_INTS (7 + 2 * ASS_PACK_MAX_PAGES + 1 + 5)
 
 static jint writeAtlasHeader(
     JNIEnv* env, jintArray headerBuf, int atlasWidth, int quadCount, int changed, int truncated, int requiredPages,
-    int hasOutput, int pageCount, const int* pageHeights, const int* pageQuads, int mode) {
+    int hasOutput, int pageCount, const int* pageHeights, const int* pageQuads, int mode, const AssPackResult* pack) {
   int hdr[ASS_HEADER_INTS];
   memset(hdr, 0, sizeof(hdr));
   hdr[0] = atlasWidth;
@@ -287,6 +407,13 @@ static jint writeAtlasHeader(
     hdr[7 + ASS_PACK_MAX_PAGES + i] = pageQuads ? pageQuads[i] : 0;
   }
   hdr[7 + 2 * ASS_PACK_MAX_PAGES] = mode;
+  if (pack != NULL) {
+    hdr[8 + 2 * ASS_PACK_MAX_PAGES] = pack->layoutId;
+    hdr[9 + 2 * ASS_PACK_MAX_PAGES] = pack->baseLayoutId;
+    hdr[10 + 2 * ASS_PACK_MAX_PAGES] = pack->dirtyTop;
+    hdr[11 + 2 * ASS_PACK_MAX_PAGES] = pack->dirtyBottom;
+    hdr[12 + 2 * ASS_PACK_MAX_PAGES] = pack->occupancyPermille;
+  }
   (*env)->SetIntArrayRegion(env, headerBuf, 0, ASS_HEADER_INTS, hdr);
   return 1;
 }
@@ -313,9 +440,15 @@ static jint writeAtlasHeader(
 // the header was written. On changed == 0 the header carries (atlasWidth=0, quadCount=0,
 // changed, hasOutput) without touching the atlas/vertex buffers — hasOutput lets Kotlin
 // distinguish "reuse the previous atlas" from "blank, clear the GL surface."
+//
+// With a pack cache (nativeAssPackCacheInit) and a non-zero atlasBufferId naming
+// atlasBuf, single-page frames keep unchanged bitmaps where the last frame put
+// them and only write what this buffer does not hold yet; the header's layout ids
+// and dirty rows let the GL side upload just the rows that changed (AssPack.h).
+// atlasBufferId must change whenever the buffer is replaced.
 JNIEXPORT jint JNICALL Java_com_edde746_plezy_libass_AssRender_nativeAssRenderFrameAtlas(
     JNIEnv* env, jclass clazz, jlong render, jlong track, jlong time, jobject atlasBuf, jint atlasMaxW, jint atlasMaxH,
-    jobject vertexBuf, jintArray headerBuf) {
+    jobject vertexBuf, jintArray headerBuf, jlong packCache, jlong atlasBufferId) {
   if (!render || !track || !atlasBuf || !vertexBuf || !headerBuf || atlasMaxW <= 0 || atlasMaxH <= 0) return 0;
 
   const long long t0 = nowMs();
@@ -330,7 +463,7 @@ JNIEXPORT jint JNICALL Java_com_edde746_plezy_libass_AssRender_nativeAssRenderFr
           ANDROID_LOG_WARN, LOG_TAG, "slow render t=%lldms: ass=%lldms (changed=%d, hasOutput=%d)", (long long)time,
           tAss - t0, changed, hasOutput);
     }
-    return writeAtlasHeader(env, headerBuf, 0, 0, changed, 0, 1, hasOutput, 1, NULL, NULL, ASS_PACK_MODE_ATLAS);
+    return writeAtlasHeader(env, headerBuf, 0, 0, changed, 0, 1, hasOutput, 1, NULL, NULL, ASS_PACK_MODE_ATLAS, NULL);
   }
 
   if (image == NULL) {
@@ -339,7 +472,7 @@ JNIEXPORT jint JNICALL Java_com_edde746_plezy_libass_AssRender_nativeAssRenderFr
           ANDROID_LOG_WARN, LOG_TAG, "slow render t=%lldms: ass=%lldms (changed=%d, no output)", (long long)time,
           tAss - t0, changed);
     }
-    return writeAtlasHeader(env, headerBuf, 0, 0, changed, 0, 1, 0, 1, NULL, NULL, ASS_PACK_MODE_ATLAS);
+    return writeAtlasHeader(env, headerBuf, 0, 0, changed, 0, 1, 0, 1, NULL, NULL, ASS_PACK_MODE_ATLAS, NULL);
   }
 
   uint8_t* atlasPixels = (uint8_t*)(*env)->GetDirectBufferAddress(env, atlasBuf);
@@ -355,7 +488,9 @@ JNIEXPORT jint JNICALL Java_com_edde746_plezy_libass_AssRender_nativeAssRenderFr
   }
 
   AssPackResult pack;
-  if (!ass_pack_frame(image, atlasPixels, (size_t)atlasCap, atlasMaxW, atlasMaxH, vertices, (size_t)vertexCap, &pack)) {
+  if (!ass_pack_frame_persistent(
+          (AssPackCache*)packCache, atlasBufferId, image, atlasPixels, (size_t)atlasCap, atlasMaxW, atlasMaxH, vertices,
+          (size_t)vertexCap, &pack)) {
     return 0;
   }
 
@@ -381,9 +516,9 @@ JNIEXPORT jint JNICALL Java_com_edde746_plezy_libass_AssRender_nativeAssRenderFr
     __android_log_print(
         ANDROID_LOG_WARN, LOG_TAG,
         "slow render t=%lldms: total=%lldms ass=%lldms pack+copy=%lldms images=%d srcPx=%lldk "
-        "atlas=%dx%d pages=%d quads=%d mode=%d",
+        "atlas=%dx%d pages=%d quads=%d mode=%d occupancy=%d/1000",
         (long long)time, tEnd - t0, tAss - t0, tEnd - tAss, pack.totalTiles, pack.srcPixels / 1000, atlasMaxW,
-        atlasMaxH, pack.pageCount, pack.quadCount, pack.mode);
+        atlasMaxH, pack.pageCount, pack.quadCount, pack.mode, pack.occupancyPermille);
   }
 
   // ATLAS: atlasWidth is the full row stride (GLES2 can't upload with stride ≠ width)
@@ -391,7 +526,7 @@ JNIEXPORT jint JNICALL Java_com_edde746_plezy_libass_AssRender_nativeAssRenderFr
   // COMPOSITE: atlasWidth × pageHeights[0] are the RGBA rect dims for the one quad.
   return writeAtlasHeader(
       env, headerBuf, pack.atlasWidth, pack.quadCount, changed, pack.truncated, pack.requiredPages,
-      pack.totalTiles > 0 ? 1 : 0, pack.pageCount, pack.pageHeights, pack.pageQuads, pack.mode);
+      pack.totalTiles > 0 ? 1 : 0, pack.pageCount, pack.pageHeights, pack.pageQuads, pack.mode, &pack);
 }
 
 // --- AssFrameTimestamps (EGL_ANDROID_get_frame_timestamps) ---
@@ -4,6 +4,8 @@
 #include <stdlib.h>
 #include <string.h>
 
+#include "AssBlend.h"
+
 // A tile is a <= atlasMaxW x atlasMaxH sub-rect of an ASS_Image. A single image
 // can exceed one atlas page only when the render frame is larger than a page
 // (>4K, or a GPU whose max texture is below the frame) — multi-page can't split
@@ -11,7 +13,7 @@
 // the never-drop guarantee. (#1436 itself was atlas-AREA overflow, fixed by the
 // multi-page pack below, not oversized single images.) Tiles are built in list
 // order (= libass blend/painter order, preserved for emission); the single-page
-// pack runs height-sorted via a separate key array so emission order is untouched.
+// packs run height-sorted via a separate key array so emission order is untouched.
 typedef struct {
   ASS_Image* img;  // source image (for bitmap/stride/color/dst_x/dst_y)
   int ox, oy;      // tile offset within the source bitmap
@@ -26,7 +28,113 @@ typedef struct {
 } TileSortKey;
 
 static int compareTileKeysByHeightDesc(const void* a, const void* b) {
-  return ((const TileSortKey*)b)->th - ((const TileSortKey*)a)->th;
+  const TileSortKey* x = (const TileSortKey*)a;
+  const TileSortKey* y = (const TileSortKey*)b;
+  if (x->th != y->th) return y->th - x->th;
+  return x->idx - y->idx;
+}
+
+// One page's skyline: the top edge of everything placed so far, as
+// left-to-right segments covering the page width. A tile goes where its top
+// would end lowest (leftmost on ties), so a short tile nests into the step
+// beside a tall one instead of every row being as tall as its tallest tile,
+// which is where the old row packer lost most of a page on mixed heights.
+typedef struct {
+  int x, y, w;
+} SkylineSegment;
+
+// Places one w x h tile on the skyline segs[0..*segCount) of an atlasMaxW x
+// atlasMaxH page, writing its slot. `segs` needs room for one more segment
+// (a placement adds at most one). Returns 0, with the skyline untouched, when
+// the tile does not fit.
+static int skylinePlace(
+    SkylineSegment* segs, int* segCount, int atlasMaxW, int atlasMaxH, int w, int h, int* sx, int* sy) {
+  int count = *segCount;
+  int best = -1, bestX = 0, bestY = 0, bestTop = INT_MAX;
+  for (int i = 0; i < count && segs[i].x + w <= atlasMaxW; i++) {
+    // The tile rests on the highest segment it spans.
+    int y = 0;
+    for (int j = i, covered = 0; covered < w; covered += segs[j].w, j++) {
+      if (segs[j].y > y) y = segs[j].y;
+    }
+    if (y + h <= atlasMaxH && y + h < bestTop) {
+      best = i;
+      bestX = segs[i].x;
+      bestY = y;
+      bestTop = y + h;
+    }
+  }
+  if (best < 0) return 0;
+  *sx = bestX;
+  *sy = bestY;
+
+  // Segments wholly under the tile go; one it overhangs is trimmed.
+  const int end = bestX + w;
+  int j = best;
+  while (j < count && segs[j].x + segs[j].w <= end) j++;
+  if (j < count && segs[j].x < end) {
+    segs[j].w -= end - segs[j].x;
+    segs[j].x = end;
+  }
+  const int removed = j - best;
+  if (removed != 1) {
+    memmove(&segs[best + 1], &segs[j], sizeof(SkylineSegment) * (size_t)(count - j));
+    count += 1 - removed;
+  }
+  segs[best] = (SkylineSegment){.x = bestX, .y = bestTop, .w = w};
+  if (best + 1 < count && segs[best + 1].y == bestTop) {
+    segs[best].w += segs[best + 1].w;
+    memmove(&segs[best + 1], &segs[best + 2], sizeof(SkylineSegment) * (size_t)(count - best - 2));
+    count--;
+  }
+  if (best > 0 && segs[best - 1].y == bestTop) {
+    segs[best - 1].w += segs[best].w;
+    memmove(&segs[best], &segs[best + 1], sizeof(SkylineSegment) * (size_t)(count - best - 1));
+    count--;
+  }
+  *segCount = count;
+  return 1;
+}
+
+// Places tiles[keys[0..count)].idx, in that order, on an empty atlasMaxW x
+// atlasMaxH page, writing each tile's sx/sy and the packed height. `segs`
+// holds count + 1 segments. Returns 0, with placements unspecified, when the
+// run does not fit.
+static int skylinePackRun(
+    PackTile* tiles, const TileSortKey* keys, int count, int atlasMaxW, int atlasMaxH, SkylineSegment* segs,
+    int* packedH) {
+  int segCount = 1;
+  segs[0] = (SkylineSegment){.x = 0, .y = 0, .w = atlasMaxW};
+  int height = 0;
+  for (int k = 0; k < count; k++) {
+    PackTile* t = &tiles[keys[k].idx];
+    if (!skylinePlace(segs, &segCount, atlasMaxW, atlasMaxH, t->tw, t->th, &t->sx, &t->sy)) return 0;
+    if (t->sy + t->th > height) height = t->sy + t->th;
+  }
+  *packedH = height;
+  return 1;
+}
+
+// Packs tiles[start, end) onto one page, tallest first.
+static int packPageRun(
+    PackTile* tiles, TileSortKey* keys, int start, int end, int atlasMaxW, int atlasMaxH, SkylineSegment* segs,
+    int* packedH) {
+  const int count = end - start;
+  for (int i = 0; i < count; i++) keys[i] = (TileSortKey){.th = tiles[start + i].th, .idx = start + i};
+  qsort(keys, (size_t)count, sizeof(TileSortKey), compareTileKeysByHeightDesc);
+  return skylinePackRun(tiles, keys, count, atlasMaxW, atlasMaxH, segs, packedH);
+}
+
+// Packs tried per page when looking for the longest run that fits; see
+// ass_pack_frame.
+#define MAX_RUN_PROBES 8
+
+// Placed tile pixels per thousand pixels of the uploaded page rows.
+static int occupancyPermille(long long placedPixels, int atlasWidth, const int* pageHeights, int pageCount) {
+  long long rows = 0;
+  for (int p = 0; p < pageCount; p++) rows += pageHeights[p];
+  if (rows <= 0 || atlasWidth <= 0) return 0;
+  return (int)(placedPixels * 1000 / (rows * atlasWidth));
 }
 
 // 8 floats per vertex (x, y, u, v, r, g, b, a) x 6 vertices; layout must match
@@ -48,6 +156,17 @@ static void emitQuad(
   }
 }
 
+// The quad for a tile of `img` at (ox, oy), size tw x th, packed at (px, py).
+static void emitTileQuad(
+    float* vx, const ASS_Image* img, int ox, int oy, int tw, int th, int px, int py, int atlasMaxW, int atlasMaxH) {
+  const unsigned int c = img->color;
+  emitQuad(
+      vx, (float)(img->dst_x + ox), (float)(img->dst_y + oy), (float)(img->dst_x + ox + tw),
+      (float)(img->dst_y + oy + th), (float)px / (float)atlasMaxW, (float)py / (float)atlasMaxH,
+      (float)(px + tw) / (float)atlasMaxW, (float)(py + th) / (float)atlasMaxH, (float)((c >> 24) & 0xFFu) / 255.0f,
+      (float)((c >> 16) & 0xFFu) / 255.0f, (float)((c >> 8) & 0xFFu) / 255.0f, (float)(0xFFu - (c & 0xFFu)) / 255.0f);
+}
+
 // Flattens the whole image list into one premultiplied RGBA rect (the union
 // bounding box) at the start of `atlasPixels`, emitted as a single quad. The
 // blend is libass painter-order src-over, the same math the GL path applies to
@@ -95,15 +214,7 @@ static void compositeFrame(
     for (int y = 0; y < img->h; y++) {
       const uint8_t* src = img->bitmap + (size_t)y * img->stride;
       uint8_t* dst = atlasPixels + (((size_t)(img->dst_y - uy0 + y) * uw) + (size_t)(img->dst_x - ux0)) * 4;
-      for (int x = 0; x < img->w; x++, dst += 4) {
-        const unsigned a = (src[x] * ca + 127u) / 255u;
-        if (a == 0) continue;
-        const unsigned inv = 255u - a;
-        dst[0] = (uint8_t)((cr * a + dst[0] * inv + 127u) / 255u);
-        dst[1] = (uint8_t)((cg * a + dst[1] * inv + 127u) / 255u);
-        dst[2] = (uint8_t)((cb * a + dst[2] * inv + 127u) / 255u);
-        dst[3] = (uint8_t)((255u * a + dst[3] * inv + 127u) / 255u);
-      }
+      ass_blend_span(dst, src, img->w, cr, cg, cb, ca);
     }
   }
 
@@ -133,7 +244,7 @@ int ass_pack_frame(
 
   // Split every image into <= atlasMaxW x atlasMaxH tiles, then pack the tiles.
   // tiles[] stays in list order (= blend/painter order for emission); keys[] is
-  // sorted by height for the single-page pack so it produces tight rows.
+  // the height-sorted order each page's run packs in.
   int total = 0;
   for (ASS_Image* img = image; img != NULL; img = img->next) {
     if (img->w > 0 && img->h > 0) {
@@ -163,92 +274,105 @@ int ass_pack_frame(
         int tw = img->w - ox;
         if (tw > atlasMaxW) tw = atlasMaxW;
         tiles[n] = (PackTile){.img = img, .ox = ox, .oy = oy, .tw = tw, .th = th, .page = -1, .sx = -1, .sy = -1};
-        keys[n] = (TileSortKey){.th = th, .idx = n};
         n++;
       }
     }
   }
-  int truncated = 0;
 
-  // Pass 1a: height-sorted single page — the common case, minimal packed height
-  // (byte-identical to the prior single-page packer when the frame fits one page).
-  qsort(keys, (size_t)n, sizeof(TileSortKey), compareTileKeysByHeightDesc);
-  int cursorX = 0, cursorY = 0, rowH = 0, packedH = 0, accepted = 0;
-  for (int i = 0; i < n; i++) {
-    PackTile* t = &tiles[keys[i].idx];
-    if (accepted >= maxQuads) break;
-    int cx = cursorX, cy = cursorY, rh = rowH;
-    if (cx + t->tw > atlasMaxW) {
-      cy += rh;
-      cx = 0;
-      rh = 0;
-    }
-    if (cy + t->th > atlasMaxH) continue;  // doesn't fit a single page
-    t->page = 0;
-    t->sx = cx;
-    t->sy = cy;
-    cursorX = cx + t->tw;
-    cursorY = cy;
-    rowH = (t->th > rh) ? t->th : rh;
-    if (cy + t->th > packedH) packedH = cy + t->th;
-    accepted++;
-  }
-
-  if (accepted == n) {
-    out->pageHeights[0] = packedH;
-    out->pageQuads[0] = accepted;
-  } else {
-    // Pass 1b: the frame overflows one page. Re-pack in list order, starting a new
-    // page whenever a tile won't fit the current one. List order keeps the page
-    // index monotonic in painter order, so each page's quads stay one contiguous run.
-    for (int i = 0; i < n; i++) {
-      tiles[i].page = -1;
-      tiles[i].sx = -1;
-      tiles[i].sy = -1;
+  // Tiles that cannot all fit ASS_PACK_MAX_PAGES pages by area, or the vertex
+  // budget outright, never will: flatten instead of dropping the painter-order
+  // tail (#1868), without packing first.
+  long long tileArea = 0;
+  for (int i = 0; i < n; i++) tileArea += (long long)tiles[i].tw * tiles[i].th;
+  if (n > maxQuads || tileArea > (long long)ASS_PACK_MAX_PAGES * (long long)pageBytes) {
+    free(tiles);
+    free(keys);
+    compositeFrame(image, atlasPixels, atlasCap, pageBytes, vertices, vertexCap, out);
+    return 1;
+  }
+  SkylineSegment* segs = (SkylineSegment*)malloc(sizeof(SkylineSegment) * (size_t)(n + 1));
+  if (!segs) {
+    free(tiles);
+    free(keys);
+    return 0;
+  }
+
+  // Pages take consecutive runs of the list, so page assignment stays monotonic
+  // in painter order and each page's quads are one contiguous vertex run; within
+  // a page the run packs tallest first. The common frame is one run on one
+  // page. Otherwise each page takes the longest run that still packs. No run
+  // holding more than a page of area can, so the search starts from the longest
+  // that does not, steps back from it in growing strides, and bisects the last
+  // stride - at most MAX_RUN_PROBES packs of at most a page's worth of tiles,
+  // after which the longest run found to pack is taken.
+  int requiredPages = 0;
+  int accepted = 0;
+  long long placedPixels = 0;
+  int runStart = 0;
+  while (runStart < n && requiredPages <= ASS_PACK_MAX_PAGES) {
+    int packedH = 0;
+    long long runArea = 0;
+    int areaEnd = runStart;
+    while (areaEnd < n && runArea + (long long)tiles[areaEnd].tw * tiles[areaEnd].th <= (long long)pageBytes) {
+      runArea += (long long)tiles[areaEnd].tw * tiles[areaEnd].th;
+      areaEnd++;
     }
-    int requiredPages = 1;
-    int page = 0, cx = 0, cy = 0, rh = 0, placed = 0;
-    for (int i = 0; i < n; i++) {
-      PackTile* t = &tiles[i];
-      if (cx + t->tw > atlasMaxW) {
-        cy += rh;
-        cx = 0;
-        rh = 0;
+    int runEnd = areaEnd;
+    if (!packPageRun(tiles, keys, runStart, areaEnd, atlasMaxW, atlasMaxH, segs, &packedH)) {
+      // A single tile always fits: tiles are at most one page.
+      // `packed` is the run the placements are from, if the last pack fitted.
+      int fits = runStart + 1, fails = areaEnd, packed = 0, probes = 1;
+      int step = (areaEnd - runStart) / 32 > 0 ? (areaEnd - runStart) / 32 : 1;
+      while (fails - step > fits && probes < MAX_RUN_PROBES) {
+        probes++;
+        if (packPageRun(tiles, keys, runStart, fails - step, atlasMaxW, atlasMaxH, segs, &packedH)) {
+          fits = fails - step;
+          packed = fits;
+          break;
+        }
+        packed = 0;
+        fails -= step;
+        step *= 2;
       }
-      if (cy + t->th > atlasMaxH) {
-        page++;
-        cx = 0;
-        cy = 0;
-        rh = 0;
+      while (fails - fits > 1 && probes < MAX_RUN_PROBES) {
+        probes++;
+        const int mid = fits + (fails - fits) / 2;
+        if (packPageRun(tiles, keys, runStart, mid, atlasMaxW, atlasMaxH, segs, &packedH)) {
+          fits = mid;
+          packed = mid;
+        } else {
+          fails = mid;
+          packed = 0;
+        }
       }
-      if (page + 1 > requiredPages) requiredPages = page + 1;
-      if (page < providedPages && placed < maxQuads) {
-        t->page = page;
-        t->sx = cx;
-        t->sy = cy;
-        if (cy + t->th > out->pageHeights[page]) out->pageHeights[page] = cy + t->th;
-        out->pageQuads[page]++;
-        placed++;
-      }
-      cx += t->tw;
-      rh = (t->th > rh) ? t->th : rh;
+      runEnd = fits;
+      if (packed != runEnd) packPageRun(tiles, keys, runStart, runEnd, atlasMaxW, atlasMaxH, segs, &packedH);
     }
-    if (requiredPages > ASS_PACK_MAX_PAGES || n > maxQuads) {
-      // The frame can never fit the paged alpha atlas: its tiles exceed the page
-      // cap or the vertex budget outright. Flatten instead of dropping the
-      // painter-order tail (#1868).
-      free(tiles);
-      free(keys);
-      memset(out->pageHeights, 0, sizeof(out->pageHeights));
-      memset(out->pageQuads, 0, sizeof(out->pageQuads));
-      compositeFrame(image, atlasPixels, atlasCap, pageBytes, vertices, vertexCap, out);
-      return 1;
+    const int page = requiredPages++;
+    if (page < providedPages) {
+      for (int i = runStart; i < runEnd; i++) {
+        tiles[i].page = page;
+        placedPixels += (long long)tiles[i].tw * tiles[i].th;
+      }
+      out->pageHeights[page] = packedH;
+      out->pageQuads[page] = runEnd - runStart;
+      accepted += runEnd - runStart;
     }
-    out->requiredPages = requiredPages;
-    out->pageCount = (requiredPages < providedPages) ? requiredPages : providedPages;
-    accepted = placed;
-    truncated = n - placed;
+    runStart = runEnd;
+  }
+  free(segs);
+  if (requiredPages > ASS_PACK_MAX_PAGES) {
+    // Enough area in principle, but not once packed.
+    free(tiles);
+    free(keys);
+    memset(out->pageHeights, 0, sizeof(out->pageHeights));
+    memset(out->pageQuads, 0, sizeof(out->pageQuads));
+    compositeFrame(image, atlasPixels, atlasCap, pageBytes, vertices, vertexCap, out);
+    return 1;
   }
+  out->requiredPages = requiredPages;
+  out->pageCount = (requiredPages < providedPages) ? requiredPages : providedPages;
+  const int truncated = n - accepted;
 
   out->truncated = truncated;
   if (accepted == 0) {
@@ -282,13 +406,7 @@ int ass_pack_frame(
       memcpy(dst, src, (size_t)t->tw);
     }
 
-    const unsigned int c = img->color;
-    emitQuad(
-        vertices + (size_t)qi * 48, (float)(img->dst_x + t->ox), (float)(img->dst_y + t->oy),
-        (float)(img->dst_x + t->ox + t->tw), (float)(img->dst_y + t->oy + t->th), (float)px / (float)atlasMaxW,
-        (float)py / (float)atlasMaxH, (float)(px + t->tw) / (float)atlasMaxW, (float)(py + t->th) / (float)atlasMaxH,
-        (float)((c >> 24) & 0xFFu) / 255.0f, (float)((c >> 16) & 0xFFu) / 255.0f, (float)((c >> 8) & 0xFFu) / 255.0f,
-        (float)(0xFFu - (c & 0xFFu)) / 255.0f);
+    emitTileQuad(vertices + (size_t)qi * 48, img, t->ox, t->oy, t->tw, t->th, px, py, atlasMaxW, atlasMaxH);
     qi++;
   }
 
@@ -296,5 +414,366 @@ int ass_pack_frame(
   free(keys);
   out->quadCount = qi;
   out->atlasWidth = atlasMaxW;
+  out->occupancyPermille = occupancyPermille(placedPixels, atlasMaxW, out->pageHeights, out->pageCount);
+  return 1;
+}
+
+// --- Persistent layout ---
+
+// Atlas buffers whose contents are remembered: one per pipeline slot, with room
+// for a pipeline being replaced.
+#define PACK_CACHE_BUFFERS 6
+
+typedef struct {
+  uint64_t key;  // content hash, see hashBitmap
+  int w, h;
+  int sx, sy;  // slot on page 0
+} PackSlot;
+
+typedef struct {
+  long long bufferId;  // 0 = unused
+  PackSlot* slots;     // what the buffer holds, sorted by (sy, sx)
+  int count;
+  int capacity;
+} BufferSnapshot;
+
+struct AssPackCache {
+  int atlasMaxW, atlasMaxH;  // dims the layout was made for
+  PackSlot* slots;           // the live layout
+  int count;
+  int capacity;
+  // The skyline of everything placed since the last repack, live or not: the
+  // space above it has never been handed out, so new bitmaps go there. Rows
+  // from packedH down are untouched.
+  SkylineSegment* skyline;
+  int skylineCount;
+  int skylineCapacity;
+  int packedH;
+  int layoutId;  // 0 = none yet
+  BufferSnapshot buffers[PACK_CACHE_BUFFERS];
+  int nextEviction;
+};
+
+AssPackCache* ass_pack_cache_new(void) { return (AssPackCache*)calloc(1, sizeof(AssPackCache)); }
+
+void ass_pack_cache_free(AssPackCache* cache) {
+  if (cache == NULL) return;
+  free(cache->slots);
+  free(cache->skyline);
+  for (int i = 0; i < PACK_CACHE_BUFFERS; i++) free(cache->buffers[i].slots);
+  free(cache);
+}
+
+static int reserveSlots(PackSlot** slots, int* capacity, int count) {
+  if (count <= *capacity) return 1;
+  int grown = *capacity > 0 ? *capacity : 64;
+  while (grown < count) grown *= 2;
+  PackSlot* resized = (PackSlot*)realloc(*slots, (size_t)grown * sizeof(PackSlot));
+  if (resized == NULL) return 0;
+  *slots = resized;
+  *capacity = grown;
+  return 1;
+}
+
+static void resetSkyline(AssPackCache* cache) {
+  cache->skylineCount = 0;
+  cache->packedH = 0;
+}
+
+static void resetLayout(AssPackCache* cache) {
+  cache->count = 0;
+  resetSkyline(cache);
+  cache->layoutId = 0;
+}
+
+// Room for `more` placements on the cache's skyline, starting it over as one
+// empty segment if there is none. Returns 0 on allocation failure.
+static int reserveSkyline(AssPackCache* cache, int more) {
+  const int needed = cache->skylineCount + more + 1;
+  if (needed > cache->skylineCapacity) {
+    int grown = cache->skylineCapacity > 0 ? cache->skylineCapacity : 64;
+    while (grown < needed) grown *= 2;
+    SkylineSegment* resized = (SkylineSegment*)realloc(cache->skyline, (size_t)grown * sizeof(SkylineSegment));
+    if (resized == NULL) return 0;
+    cache->skyline = resized;
+    cache->skylineCapacity = grown;
+  }
+  if (cache->skylineCount == 0) {
+    cache->skyline[0] = (SkylineSegment){.x = 0, .y = 0, .w = cache->atlasMaxW};
+    cache->skylineCount = 1;
+  }
+  return 1;
+}
+
+// Process-wide, like the buffer ids: a texture can outlive the renderer that
+// filled it, and must never match a layout from a different cache.
+static unsigned gLayoutSeq = 0;
+
+static int nextLayoutId(void) {
+  for (;;) {
+    const int id = (int)(__atomic_add_fetch(&gLayoutSeq, 1u, __ATOMIC_RELAXED) & INT_MAX);
+    if (id != 0) return id;
+  }
+}
+
+static BufferSnapshot* findSnapshot(AssPackCache* cache, long long bufferId) {
+  for (int i = 0; i < PACK_CACHE_BUFFERS; i++) {
+    if (cache->buffers[i].bufferId == bufferId) return &cache->buffers[i];
+  }
+  return NULL;
+}
+
+// The buffer was written outside the persistent layout, so nothing in it can be
+// vouched for.
+static void forgetBuffer(AssPackCache* cache, long long bufferId) {
+  BufferSnapshot* snapshot = findSnapshot(cache, bufferId);
+  if (snapshot != NULL) {
+    snapshot->bufferId = 0;
+    snapshot->count = 0;
+  }
+}
+
+// Content hash of one image's bitmap, w x h bytes at `stride`. Position and
+// colour live in the vertices, so two images with the same mask share a slot.
+static uint64_t hashBitmap(const ASS_Image* img) {
+  uint64_t h = 0x9E3779B97F4A7C15ull ^ ((uint64_t)(uint32_t)img->w << 32) ^ (uint32_t)img->h;
+  for (int y = 0; y < img->h; y++) {
+    const uint8_t* row = img->bitmap + (size_t)y * img->stride;
+    int x = 0;
+    for (; x + 8 <= img->w; x += 8) {
+      uint64_t word;
+      memcpy(&word, row + x, sizeof(word));
+      h = (h ^ word) * 0x100000001B3ull;
+      h ^= h >> 29;
+    }
+    for (; x < img->w; x++) h = (h ^ row[x]) * 0x100000001B3ull;
+  }
+  return h;
+}
+
+static int compareSlotsByKey(const void* a, const void* b) {
+  const PackSlot* x = (const PackSlot*)a;
+  const PackSlot* y = (const PackSlot*)b;
+  return x->key < y->key ? -1 : (x->key > y->key ? 1 : 0);
+}
+
+static int compareSlotsByPosition(const void* a, const void* b) {
+  const PackSlot* x = (const PackSlot*)a;
+  const PackSlot* y = (const PackSlot*)b;
+  if (x->sy != y->sy) return x->sy - y->sy;
+  return x->sx - y->sx;
+}
+
+// Whether `snapshot` says its buffer already holds `slot`'s bitmap at its slot.
+static int snapshotHolds(const BufferSnapshot* snapshot, const PackSlot* slot) {
+  if (snapshot == NULL || snapshot->count == 0) return 0;
+  const PackSlot* found = (const PackSlot*)bsearch(
+      slot, snapshot->slots, (size_t)snapshot->count, sizeof(PackSlot), compareSlotsByPosition);
+  return found != NULL && found->key == slot->key && found->w == slot->w && found->h == slot->h;
+}
+
+// Places a w x h tile on the cache's skyline (reserveSkyline first). Returns 0
+// when the page has no room left for it.
+static int placeOnSkyline(AssPackCache* cache, int w, int h, int* sx, int* sy) {
+  if (!skylinePlace(cache->skyline, &cache->skylineCount, cache->atlasMaxW, cache->atlasMaxH, w, h, sx, sy)) return 0;
+  if (*sy + h > cache->packedH) cache->packedH = *sy + h;
+  return 1;
+}
+
+// Falls back to the ordinary pack, which writes the buffer in full.
+static int packUncached(
+    AssPackCache* cache, long long bufferId, ASS_Image* image, uint8_t* atlasPixels, size_t atlasCap, int atlasMaxW,
+    int atlasMaxH, float* vertices, size_t vertexCap, AssPackResult* out) {
+  if (cache != NULL && bufferId != 0) forgetBuffer(cache, bufferId);
+  return ass_pack_frame(image, atlasPixels, atlasCap, atlasMaxW, atlasMaxH, vertices, vertexCap, out);
+}
+
+int ass_pack_frame_persistent(
+    AssPackCache* cache, long long bufferId, ASS_Image* image, uint8_t* atlasPixels, size_t atlasCap, int atlasMaxW,
+    int atlasMaxH, float* vertices, size_t vertexCap, AssPackResult* out) {
+  if (cache == NULL || (size_t)atlasMaxW * atlasMaxH > atlasCap) {
+    return packUncached(cache, bufferId, image, atlasPixels, atlasCap, atlasMaxW, atlasMaxH, vertices, vertexCap, out);
+  }
+  if (cache->atlasMaxW != atlasMaxW || cache->atlasMaxH != atlasMaxH) {
+    resetLayout(cache);
+    for (int i = 0; i < PACK_CACHE_BUFFERS; i++) cache->buffers[i].bufferId = 0;
+    cache->atlasMaxW = atlasMaxW;
+    cache->atlasMaxH = atlasMaxH;
+  }
+
+  // Only frames whose every image is one tile, within the vertex budget.
+  const int maxQuads = (int)(vertexCap / 192);
+  int n = 0;
+  long long area = 0;
+  for (ASS_Image* img = image; img != NULL; img = img->next) {
+    if (img->w <= 0 || img->h <= 0) continue;
+    if (img->w > atlasMaxW || img->h > atlasMaxH) {
+      return packUncached(
+          cache, bufferId, image, atlasPixels, atlasCap, atlasMaxW, atlasMaxH, vertices, vertexCap, out);
+    }
+    area += (long long)img->w * img->h;
+    n++;
+  }
+  if (n == 0 || n > maxQuads || area > (long long)atlasMaxW * atlasMaxH) {
+    return packUncached(cache, bufferId, image, atlasPixels, atlasCap, atlasMaxW, atlasMaxH, vertices, vertexCap, out);
+  }
+
+  PackSlot* next = (PackSlot*)malloc(sizeof(PackSlot) * (size_t)n);
+  ASS_Image** images = (ASS_Image**)malloc(sizeof(ASS_Image*) * (size_t)n);
+  TileSortKey* keys = (TileSortKey*)malloc(sizeof(TileSortKey) * (size_t)n);
+  PackSlot* byKey = (PackSlot*)malloc(sizeof(PackSlot) * (size_t)(cache->count > 0 ? cache->count : 1));
+  unsigned char* used = (unsigned char*)calloc((size_t)(cache->count > 0 ? cache->count : 1), 1);
+  if (!next || !images || !keys || !byKey || !used) {
+    free(next);
+    free(images);
+    free(keys);
+    free(byKey);
+    free(used);
+    return 0;
+  }
+
+  int i = 0;
+  for (ASS_Image* img = image; img != NULL; img = img->next) {
+    if (img->w <= 0 || img->h <= 0) continue;
+    images[i] = img;
+    next[i] = (PackSlot){.key = hashBitmap(img), .w = img->w, .h = img->h, .sx = -1, .sy = -1};
+    i++;
+  }
+
+  // Each slot of the previous layout goes to at most one image with its bitmap.
+  if (cache->count > 0) memcpy(byKey, cache->slots, sizeof(PackSlot) * (size_t)cache->count);
+  qsort(byKey, (size_t)cache->count, sizeof(PackSlot), compareSlotsByKey);
+  int fresh = 0;
+  for (i = 0; i < n; i++) {
+    int lo = 0, hi = cache->count;
+    while (lo < hi) {
+      const int mid = lo + (hi - lo) / 2;
+      if (byKey[mid].key < next[i].key) {
+        lo = mid + 1;
+      } else {
+        hi = mid;
+      }
+    }
+    for (; lo < cache->count && byKey[lo].key == next[i].key; lo++) {
+      if (!used[lo] && byKey[lo].w == next[i].w && byKey[lo].h == next[i].h) {
+        used[lo] = 1;
+        next[i].sx = byKey[lo].sx;
+        next[i].sy = byKey[lo].sy;
+        break;
+      }
+    }
+    if (next[i].sx < 0) keys[fresh++] = (TileSortKey){.th = next[i].h, .idx = i};
+  }
+  free(byKey);
+  free(used);
+
+  // New bitmaps go on the skyline above what is already there, tallest first.
+  // A page that has run out of room, or is mostly slots nothing uses any more,
+  // is packed again from the top.
+  qsort(keys, (size_t)fresh, sizeof(TileSortKey), compareTileKeysByHeightDesc);
+  const int baseId = cache->layoutId;
+  int repack = baseId == 0;
+  int dirtyTop = INT_MAX;
+  if (!repack && fresh > 0 && !reserveSkyline(cache, fresh)) repack = 1;
+  for (int k = 0; k < fresh && !repack; k++) {
+    PackSlot* slot = &next[keys[k].idx];
+    if (!placeOnSkyline(cache, slot->w, slot->h, &slot->sx, &slot->sy)) {
+      repack = 1;
+    } else if (slot->sy < dirtyTop) {
+      dirtyTop = slot->sy;
+    }
+  }
+  if (!repack && (long long)4 * area < (long long)atlasMaxW * cache->packedH) repack = 1;
+  if (repack) {
+    resetSkyline(cache);
+    if (!reserveSkyline(cache, n)) {
+      free(next);
+      free(images);
+      free(keys);
+      resetLayout(cache);
+      return 0;
+    }
+    for (i = 0; i < n; i++) keys[i] = (TileSortKey){.th = next[i].h, .idx = i};
+    qsort(keys, (size_t)n, sizeof(TileSortKey), compareTileKeysByHeightDesc);
+    for (int k = 0; k < n; k++) {
+      PackSlot* slot = &next[keys[k].idx];
+      if (!placeOnSkyline(cache, slot->w, slot->h, &slot->sx, &slot->sy)) {
+        // Enough area, but not once packed: the ordinary pack spreads it over pages.
+        free(next);
+        free(images);
+        free(keys);
+        resetLayout(cache);
+        return packUncached(
+            cache, bufferId, image, atlasPixels, atlasCap, atlasMaxW, atlasMaxH, vertices, vertexCap, out);
+      }
+    }
+    dirtyTop = 0;
+  }
+  free(keys);
+
+  if (!reserveSlots(&cache->slots, &cache->capacity, n)) {
+    free(next);
+    free(images);
+    resetLayout(cache);
+    return 0;
+  }
+  memcpy(cache->slots, next, sizeof(PackSlot) * (size_t)n);
+  cache->count = n;
+  const int frontier = cache->packedH;
+  if (repack || fresh > 0) cache->layoutId = nextLayoutId();
+
+  // Copy in whatever this buffer does not already hold, then record that it now
+  // holds exactly this layout.
+  BufferSnapshot* snapshot = bufferId != 0 ? findSnapshot(cache, bufferId) : NULL;
+  if (bufferId != 0 && snapshot == NULL) {
+    snapshot = &cache->buffers[cache->nextEviction];
+    cache->nextEviction = (cache->nextEviction + 1) % PACK_CACHE_BUFFERS;
+    snapshot->bufferId = bufferId;
+    snapshot->count = 0;
+  }
+  for (i = 0; i < n; i++) {
+    if (snapshotHolds(snapshot, &next[i])) continue;
+    const ASS_Image* img = images[i];
+    for (int y = 0; y < img->h; y++) {
+      memcpy(
+          atlasPixels + (size_t)(next[i].sy + y) * atlasMaxW + next[i].sx, img->bitmap + (size_t)y * img->stride,
+          (size_t)img->w);
+    }
+  }
+  if (snapshot != NULL) {
+    if (reserveSlots(&snapshot->slots, &snapshot->capacity, n)) {
+      memcpy(snapshot->slots, next, sizeof(PackSlot) * (size_t)n);
+      qsort(snapshot->slots, (size_t)n, sizeof(PackSlot), compareSlotsByPosition);
+      snapshot->count = n;
+    } else {
+      snapshot->bufferId = 0;
+      snapshot->count = 0;
+    }
+  }
+
+  // Painter order, as ever; every quad is on page 0.
+  for (i = 0; i < n; i++) {
+    emitTileQuad(
+        vertices + (size_t)i * 48, images[i], 0, 0, next[i].w, next[i].h, next[i].sx, next[i].sy, atlasMaxW,
+        atlasMaxH);
+  }
+  free(next);
+  free(images);
+
+  memset(out, 0, sizeof(*out));
+  out->mode = ASS_PACK_MODE_ATLAS;
+  out->atlasWidth = atlasMaxW;
+  out->quadCount = n;
+  out->requiredPages = 1;
+  out->pageCount = 1;
+  out->totalTiles = n;
+  out->srcPixels = area;
+  out->pageHeights[0] = frontier;
+  out->pageQuads[0] = n;
+  out->occupancyPermille = occupancyPermille(area, atlasMaxW, out->pageHeights, 1);
+  out->layoutId = cache->layoutId;
+  out->baseLayoutId = repack ? 0 : baseId;
+  out->dirtyTop = dirtyTop == INT_MAX ? 0 : dirtyTop;
+  out->dirtyBottom = dirtyTop == INT_MAX ? 0 : frontier;
   return 1;
 }
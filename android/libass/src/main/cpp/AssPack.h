@@ -38,10 +38,22 @@ typedef struct {
   int pageCount;
   int totalTiles;       // tiles the frame splits into (caller-side logging)
   long long srcPixels;  // summed source image area (caller-side logging)
+  // ATLAS: how full the uploaded rows are, as placed tile pixels per thousand
+  // pixels of atlasWidth x sum(pageHeights). 0 for composite and empty frames.
+  int occupancyPermille;
   // ATLAS: packed rows per page / quads per page (contiguous vertex runs).
   // COMPOSITE: pageHeights[0] = RGBA rect height, pageQuads[0] = 1.
   int pageHeights[ASS_PACK_MAX_PAGES];
   int pageQuads[ASS_PACK_MAX_PAGES];
+  // Persistent packs only (ass_pack_frame_persistent); all 0 otherwise. Page 0
+  // holds layout `layoutId`, unique across every cache in the process. When
+  // the texture already holds `baseLayoutId` (never 0), only rows
+  // [dirtyTop, dirtyBottom) need uploading, possibly none; otherwise upload
+  // pageHeights[0] rows as usual.
+  int layoutId;
+  int baseLayoutId;
+  int dirtyTop;
+  int dirtyBottom;
 } AssPackResult;
 
 // Packs libass's image list for `atlasPixels`/`vertices` (layout documented at
@@ -54,4 +66,21 @@ int ass_pack_frame(
     ASS_Image* image, uint8_t* atlasPixels, size_t atlasCap, int atlasMaxW, int atlasMaxH, float* vertices,
     size_t vertexCap, AssPackResult* out);
 
+// Tiles kept where they were from one frame to the next, for frames that fit a
+// single page without splitting an image: static signs and karaoke backgrounds
+// stay in their atlas slots, and only images libass has not produced before are
+// copied in and reported dirty. Frames that do not qualify pack as above.
+typedef struct AssPackCache AssPackCache;
+
+AssPackCache* ass_pack_cache_new(void);
+void ass_pack_cache_free(AssPackCache* cache);
+
+// ass_pack_frame, reusing the layout in `cache`. `bufferId` names the atlas
+// buffer being written - unique per allocation, 0 for unknown - so slots the
+// buffer already holds from an earlier frame are not copied again. The buffer
+// always ends up holding the whole layout, so a full upload stays correct.
+int ass_pack_frame_persistent(
+    AssPackCache* cache, long long bufferId, ASS_Image* image, uint8_t* atlasPixels, size_t atlasCap, int atlasMaxW,
+    int atlasMaxH, float* vertices, size_t vertexCap, AssPackResult* out);
+
 #endif  // PLEZY_ASS_PACK_H
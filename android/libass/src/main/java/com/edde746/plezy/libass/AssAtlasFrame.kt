@@ -42,6 +42,16 @@ package com.edde746.plezy.libass
  *                       rewritten. false means this timestamp should be blank.
  * @param mode           [MODE_ATLAS] or [MODE_COMPOSITE]; must match the ASS_PACK_MODE_*
  *                       constants in AssPack.h
+ * @param layoutId       non-zero when page 0 was packed against the renderer's persistent
+ *                       layout: the page holds layout [layoutId]
+ * @param baseLayoutId   the layout this one was derived from, never 0 when set. A texture
+ *                       that already holds it only needs rows [dirtyTop, dirtyBottom)
+ *                       uploaded, possibly none; any other texture needs the whole page
+ * @param dirtyTop       first row that differs from [baseLayoutId]
+ * @param dirtyBottom    one past the last row that differs; equal to [dirtyTop] when none do
+ * @param occupancyPermille placed tile pixels per thousand pixels of the uploaded page rows
+ *                       ([atlasWidth] × the sum of [pageHeights]); 0 for [MODE_COMPOSITE]
+ *                       and empty frames
  */
 class AssAtlasFrame(
   val atlasWidth: Int,
@@ -52,7 +62,12 @@ class AssAtlasFrame(
   val truncated: Int,
   val requiredPages: Int,
   val hasOutput: Boolean,
-  val mode: Int = MODE_ATLAS
+  val mode: Int = MODE_ATLAS,
+  val layoutId: Int = 0,
+  val baseLayoutId: Int = 0,
+  val dirtyTop: Int = 0,
+  val dirtyBottom: Int = 0,
+  val occupancyPermille: Int = 0
 ) {
   companion object {
     /** One or more ALPHA_8 atlas pages, per-quad colors in the vertex stream. */
@@ -10,7 +10,7 @@ class AssRender(nativeAss: Long, private val lock: ReentrantLock) {
 
     /** Must match ASS_PACK_MAX_PAGES + the header layout in AssPack.h/AssKt.c (`writeAtlasHeader`). */
     private const val MAX_ATLAS_PAGES = 4
-    private const val HEADER_INTS = 7 + 2 * MAX_ATLAS_PAGES + 1
+    private const val HEADER_INTS = 7 + 2 * MAX_ATLAS_PAGES + 1 + 5
 
     @JvmStatic
     external fun nativeAssRenderInit(ass: Long): Long
@@ -48,15 +48,26 @@ class AssRender(nativeAss: Long, private val lock: ReentrantLock) {
       atlasMaxWidth: Int,
       atlasMaxHeight: Int,
       vertexBuf: ByteBuffer,
-      header: IntArray
+      header: IntArray,
+      packCache: Long,
+      atlasBufferId: Long
     ): Int
 
+    @JvmStatic
+    external fun nativeAssPackCacheInit(): Long
+
+    @JvmStatic
+    external fun nativeAssPackCacheDeinit(cache: Long)
+
     @JvmStatic
     external fun nativeAssRenderDeinit(render: Long)
   }
 
   private var nativeRender: Long = nativeAssRenderInit(nativeAss)
 
+  /** Where the last single-page frame put each bitmap (`AssPackCache` in AssPack.h). */
+  private var nativePackCache: Long = nativeAssPackCacheInit()
+
   /** Reusable JNI frame-metadata header (see `writeAtlasHeader` in AssKt.c). Calls to
    *  [renderFrameAtlas] are serialized by [lock], so one buffer is safe to reuse. */
   private val frameHeader = IntArray(HEADER_INTS)
@@ -151,13 +162,18 @@ class AssRender(nativeAss: Long, private val lock: ReentrantLock) {
    * @param atlasMaxW  per-page atlas row stride in pixels (bound by `GL_MAX_TEXTURE_SIZE`)
    * @param atlasMaxH  per-page atlas height in pixels (bound by `GL_MAX_TEXTURE_SIZE`)
    * @param vertexBuf  direct ByteBuffer receiving the vertex stream (192 bytes per quad)
+   * @param atlasBufferId non-zero id naming [atlasBuf], changed whenever the buffer is
+   *                   replaced. With one, single-page frames leave unchanged bitmaps where
+   *                   the previous frame put them and report the rows that changed
+   *                   ([AssAtlasFrame.layoutId]); 0 repacks every frame from scratch.
    */
   fun renderFrameAtlas(
     time: Long,
     atlasBuf: ByteBuffer,
     atlasMaxW: Int,
     atlasMaxH: Int,
-    vertexBuf: ByteBuffer
+    vertexBuf: ByteBuffer,
+    atlasBufferId: Long = 0
   ): AssAtlasFrame? {
     val tQueue = System.nanoTime()
     lock.withLock {
@@ -167,7 +183,10 @@ class AssRender(nativeAss: Long, private val lock: ReentrantLock) {
       if (t.released || t.nativeAssTrack == 0L) return null
       val header = frameHeader
       val status =
-        nativeAssRenderFrameAtlas(nativeRender, t.nativeAssTrack, time, atlasBuf, atlasMaxW, atlasMaxH, vertexBuf, header)
+        nativeAssRenderFrameAtlas(
+          nativeRender, t.nativeAssTrack, time, atlasBuf, atlasMaxW, atlasMaxH, vertexBuf, header,
+          nativePackCache, atlasBufferId
+        )
       if (status == 0) return null
       val pageCount = header[6]
       return AssAtlasFrame(
@@ -179,7 +198,12 @@ class AssRender(nativeAss: Long, private val lock: ReentrantLock) {
         truncated = header[3],
         requiredPages = header[4],
         hasOutput = header[5] != 0,
-        mode = header[7 + 2 * MAX_ATLAS_PAGES]
+        mode = header[7 + 2 * MAX_ATLAS_PAGES],
+        layoutId = header[8 + 2 * MAX_ATLAS_PAGES],
+        baseLayoutId = header[9 + 2 * MAX_ATLAS_PAGES],
+        dirtyTop = header[10 + 2 * MAX_ATLAS_PAGES],
+        dirtyBottom = header[11 + 2 * MAX_ATLAS_PAGES],
+        occupancyPermille = header[12 + 2 * MAX_ATLAS_PAGES]
       )
     }
   }
@@ -193,6 +217,10 @@ class AssRender(nativeAss: Long, private val lock: ReentrantLock) {
         nativeAssRenderDeinit(nativeRender)
         nativeRender = 0
       }
+      if (nativePackCache != 0L) {
+        nativeAssPackCacheDeinit(nativePackCache)
+        nativePackCache = 0
+      }
     }
   }
 
@@ -1,5 +1,6 @@
 package com.edde746.plezy.libass
 
+import java.nio.ByteBuffer
 import java.util.concurrent.locks.ReentrantLock
 import kotlin.concurrent.withLock
 
@@ -16,19 +17,44 @@ class AssTrack(private val ass: Long, private val lock: ReentrantLock) {
     @JvmStatic
     external fun nativeAssTrackReadChunk(track: Long, start: Long, duration: Long, byteArray: ByteArray, offset: Int, length: Int)
 
+    @JvmStatic
+    external fun nativeAssTrackReadBufferDirect(track: Long, buffer: ByteBuffer, offset: Int, length: Int)
+
+    @JvmStatic
+    external fun nativeAssTrackReadChunkDirect(track: Long, start: Long, duration: Long, buffer: ByteBuffer, offset: Int, length: Int)
+
+    @JvmStatic
+    external fun nativeAssTrackReadChunks(track: Long, buffer: ByteBuffer, chunks: LongArray, count: Int): Int
+
     @JvmStatic
     external fun nativeAssTrackDeinit(track: Long)
 
+    /** Longs per record in [readChunks]: start, duration, offset, length. Matches ASS_CHUNK_LONGS in AssKt.c. */
+    const val CHUNK_LONGS = 4
+
     @JvmStatic
-    external fun nativeAssTrackNextEventStart(track: Long, afterMs: Long): Long
+    external fun nativeAssTrackIndexInit(): Long
 
     @JvmStatic
-    external fun nativeAssTrackNextEventChange(track: Long, afterMs: Long): Long
+    external fun nativeAssTrackIndexDeinit(index: Long)
+
+    @JvmStatic
+    external fun nativeAssTrackNextEventStart(track: Long, index: Long, afterMs: Long): Long
+
+    @JvmStatic
+    external fun nativeAssTrackNextEventChange(track: Long, index: Long, afterMs: Long): Long
+
+    @JvmStatic
+    external fun nativeAssTrackEventsInWindow(track: Long, index: Long, fromMs: Long, toMs: Long, out: LongArray): Int
   }
 
   var nativeAssTrack = nativeAssTrackInit(ass)
     private set
 
+  // Sorted event boundaries behind the next-event and window queries, caught up with newly read
+  // dialogue on each query. Guarded by [lock] like the track itself.
+  private var nativeIndex = nativeAssTrackIndexInit()
+
   @Volatile
   var released = false
     private set
@@ -44,11 +70,39 @@ class AssTrack(private val ass: Long, private val lock: ReentrantLock) {
 
   fun readChunk(start: Long, duration: Long, array: ByteArray, offset: Int = 0, length: Int = array.size) = withNative { nativeAssTrackReadChunk(it, start, duration, array, offset, length) }
 
+  /**
+   * Direct-buffer variants: libass reads [buffer]'s memory in place, with no copy. [offset] and
+   * [length] are absolute within the buffer, whatever its position and limit.
+   */
+  fun readBuffer(buffer: ByteBuffer, offset: Int = 0, length: Int = buffer.capacity()) = withNative {
+    require(buffer.isDirect) { "readBuffer needs a direct ByteBuffer" }
+    nativeAssTrackReadBufferDirect(it, buffer, offset, length)
+  }
+
+  fun readChunk(start: Long, duration: Long, buffer: ByteBuffer, offset: Int = 0, length: Int = buffer.capacity()) = withNative {
+    require(buffer.isDirect) { "readChunk needs a direct ByteBuffer" }
+    nativeAssTrackReadChunkDirect(it, start, duration, buffer, offset, length)
+  }
+
+  /**
+   * Feeds [count] timed dialogue lines in one call. Each takes [CHUNK_LONGS] longs of [chunks]:
+   * start and duration in ms, then the line's offset and length within the direct [buffer].
+   * Lines whose span lies outside the buffer are skipped. Returns how many were fed.
+   */
+  fun readChunks(buffer: ByteBuffer, chunks: LongArray, count: Int = chunks.size / CHUNK_LONGS): Int {
+    require(buffer.isDirect) { "readChunks needs a direct ByteBuffer" }
+    require(count >= 0 && count.toLong() * CHUNK_LONGS <= chunks.size) { "chunks holds fewer than $count records" }
+    lock.withLock {
+      if (released || nativeAssTrack == 0L) return 0
+      return nativeAssTrackReadChunks(nativeAssTrack, buffer, chunks, count)
+    }
+  }
+
   /** Earliest event start strictly after [afterMs], or -1 if none (yet). */
   fun nextEventStartMs(afterMs: Long): Long {
     lock.withLock {
       if (released || nativeAssTrack == 0L) return -1
-      return nativeAssTrackNextEventStart(nativeAssTrack, afterMs)
+      return nativeAssTrackNextEventStart(nativeAssTrack, nativeIndex, afterMs)
     }
   }
 
@@ -56,7 +110,23 @@ class AssTrack(private val ass: Long, private val lock: ReentrantLock) {
   fun nextEventChangeMs(afterMs: Long): Long {
     lock.withLock {
       if (released || nativeAssTrack == 0L) return -1
-      return nativeAssTrackNextEventChange(nativeAssTrack, afterMs)
+      return nativeAssTrackNextEventChange(nativeAssTrack, nativeIndex, afterMs)
+    }
+  }
+
+  /**
+   * Events showing at any point of [[fromMs], [toMs]), in start order, as (start, end) pairs:
+   * event `i` is `[2i]..[2i + 1]`. Empty if none (yet) or once released.
+   */
+  fun eventsInWindow(fromMs: Long, toMs: Long): LongArray {
+    lock.withLock {
+      if (released || nativeAssTrack == 0L) return LongArray(0)
+      var out = LongArray(32)
+      while (true) {
+        val total = nativeAssTrackEventsInWindow(nativeAssTrack, nativeIndex, fromMs, toMs, out)
+        if (total * 2 <= out.size) return out.copyOf(total * 2)
+        out = LongArray(total * 2)
+      }
     }
   }
 
@@ -68,6 +138,10 @@ class AssTrack(private val ass: Long, private val lock: ReentrantLock) {
         nativeAssTrackDeinit(nativeAssTrack)
         nativeAssTrack = 0
       }
+      if (nativeIndex != 0L) {
+        nativeAssTrackIndexDeinit(nativeIndex)
+        nativeIndex = 0
+      }
     }
   }
 
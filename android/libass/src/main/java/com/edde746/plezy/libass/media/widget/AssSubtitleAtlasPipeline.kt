@@ -126,12 +126,23 @@ internal class AtlasPayload(
   var requestSeq: Long = 0L,
   var stateGeneration: Long = 0L
 ) {
+  /** Names [atlasBuf] to the native pack cache, which remembers what each buffer
+   *  holds; a new buffer gets a new id. */
+  var atlasBufferId: Long = nextAtlasBufferId.incrementAndGet()
+    private set
+
   /** Reallocates [atlasBuf] to hold [pages] stacked atlasW×atlasH pages. Runs on the
    *  libass thread before hand-off, so no GL reader can be looking at the old buffer. */
   fun growAtlas(pages: Int, atlasW: Int, atlasH: Int) {
     atlasBuf = ByteBuffer.allocateDirect(atlasW * atlasH * pages).order(ByteOrder.nativeOrder())
+    atlasBufferId = nextAtlasBufferId.incrementAndGet()
     pageCapacity = pages
   }
+
+  private companion object {
+    /** Process-wide so a pipeline rebuilt against the same renderer never reuses an id. */
+    val nextAtlasBufferId = AtomicLong(0L)
+  }
 }
 
 private class AtlasDrawSnapshot(
@@ -349,6 +360,9 @@ internal class AssAtlasPipeline(
   /** Worst observed libass render duration, in milliseconds. */
   val maxLibassMs: Long get() = libassThread.maxLibassMs
 
+  /** How full the last changed atlas frame's uploaded rows were, per thousand pixels. */
+  val lastAtlasOccupancy: Int get() = libassThread.lastAtlasOccupancy
+
   /** Changed-render duration histogram: [≤10ms, ≤25ms, ≤42ms, ≤84ms, >84ms]. */
   val libassMsHistogram: List<Long> get() = libassThread.histogramSnapshot()
 
@@ -361,6 +375,9 @@ internal class AssAtlasPipeline(
   /** Speculation rounds skipped (paused, pending request, no confident cadence). */
   val specSkips: Long get() = libassThread.specSkips
 
+  /** Requests held on screen while a deeper render-ahead for a slow frame was pending. */
+  val specHeld: Long get() = libassThread.specHeld
+
   /** changed==0/no-output renders forced into explicit transparent swaps. */
   val blankClearCount: Long get() = libassThread.blankClearCount
 
@@ -596,6 +613,7 @@ private class AtlasLibassThread(
   val specHits: Long get() = engine?.specHits ?: 0L
   val specMisses: Long get() = engine?.specMisses ?: 0L
   val specSkips: Long get() = engine?.specSkips ?: 0L
+  val specHeld: Long get() = engine?.specHeld ?: 0L
   val blankClearCount: Long get() = engine?.blankClearCount ?: 0L
   val prefetchCount: Long get() = engine?.prefetchCount ?: 0L
 
@@ -624,6 +642,12 @@ private class AtlasLibassThread(
   @Volatile var maxLibassMs = 0L
     private set
 
+  @Volatile var lastAtlasOccupancy = 0
+    private set
+
+  /** Duration of the most recent changed render: what a speculation will likely cost. */
+  private var lastChangedLibassMs = 0L
+
   /** Changed-render durations bucketed at ≤10 / ≤25 / ≤42 / ≤84 / >84 ms. */
   private val histogram = java.util.concurrent.atomic.AtomicLongArray(5)
 
@@ -724,8 +748,9 @@ private class AtlasLibassThread(
     val render = assHandler.render ?: return null
     val payload = slots.payloads[slot]
     val t0 = System.nanoTime()
-    var frame = render.renderFrameAtlas(timeMs, payload.atlasBuf, slots.atlasW, slots.atlasH, payload.vertexBuf)
-      ?: return null
+    var frame = render.renderFrameAtlas(
+      timeMs, payload.atlasBuf, slots.atlasW, slots.atlasH, payload.vertexBuf, payload.atlasBufferId
+    ) ?: return null
     // A frame overflows one atlas page only on dense full-screen typesetting. When it
     // does — multi-page atlas or an RGBA composite rect needing more than one page —
     // grow this slot's buffer to the pages it needs (capped) and render once more:
@@ -737,8 +762,9 @@ private class AtlasLibassThread(
         slots.atlasW,
         slots.atlasH
       )
-      frame = render.renderFrameAtlas(timeMs, payload.atlasBuf, slots.atlasW, slots.atlasH, payload.vertexBuf)
-        ?: return null
+      frame = render.renderFrameAtlas(
+        timeMs, payload.atlasBuf, slots.atlasW, slots.atlasH, payload.vertexBuf, payload.atlasBufferId
+      ) ?: return null
     }
     val libassMs = (System.nanoTime() - t0) / 1_000_000
     renderCount++
@@ -747,6 +773,8 @@ private class AtlasLibassThread(
     if (frame.truncated > 0) overflowCount++
     if (frame.changed != 0) {
       changedRenderCount++
+      lastChangedLibassMs = libassMs
+      if (frame.mode == AssAtlasFrame.MODE_ATLAS && frame.quadCount > 0) lastAtlasOccupancy = frame.occupancyPermille
       recordChangedRenderMs(libassMs)
       unchangedStreak = 0
     } else {
@@ -790,7 +818,7 @@ private class AtlasLibassThread(
     // Budget left until the video frame's vsync when we START servicing.
     val budgetMs = if (pinned) (releaseNs - tDrain) / 1_000_000 else -1L
 
-    when (val outcome = engine.service(pts, pinned)) {
+    when (val outcome = engine.service(pts, pinned, releaseNs)) {
       is SpecRenderEngine.Outcome.Post -> {
         if (stateGeneration() != generation) {
           staleGenerationCount++
@@ -827,15 +855,24 @@ private class AtlasLibassThread(
       }
       SpecRenderEngine.Outcome.Skip -> {
         if (AssAtlasPipelineConfig.TIMING_LOGS) {
-          Log.d(TAG, "skip pts=${pts / 1000}ms waitMs=$waitMs budgetMs=$budgetMs (no content)")
+          Log.d(TAG, "skip pts=${pts / 1000}ms waitMs=$waitMs budgetMs=$budgetMs (no content or held)")
         }
       }
     }
 
     // Pre-render the predicted next frame in the dead time between requests so the
-    // next service is (usually) a GL-only hit. Never delays a waiting request.
+    // next service is (usually) a GL-only hit. Never delays a waiting request. The
+    // cost of the last changed render and the track's next boundary tell the
+    // engine how far ahead that frame should be.
     if (stateGeneration() != generation) return
-    engine.speculateAfter(pts, pinned, hasPending = pending.get() != null)?.let { write ->
+    val nextChangeMs = if (pinned) assHandler.track?.nextEventChangeMs(Math.floorDiv(pts, 1_000L)) ?: -1L else -1L
+    engine.speculateAfter(
+      pts,
+      pinned,
+      hasPending = pending.get() != null,
+      renderCostMs = lastChangedLibassMs,
+      nextChangeMs = nextChangeMs
+    )?.let { write ->
       val payload = slots.payloads[write.slot]
       payload.frame = write.frame
       payload.contentSeq = ++contentSeqCounter
@@ -1493,6 +1530,9 @@ private class AtlasRenderer(private val assHandler: AssHandler) {
   private var atlasAllocatedW = 0
   private var atlasAllocatedH = 0
 
+  /** The persistent layout (AssAtlasFrame.layoutId) page 0's texture holds, 0 for none. */
+  private var uploadedLayoutId = 0
+
   /**
    * Records the per-page texture dims and allocates the first page's texture. The C
    * side bakes UV denominators = these dims into the vertex stream and stacks pages
@@ -1504,6 +1544,7 @@ private class AtlasRenderer(private val assHandler: AssHandler) {
     atlasAllocatedW = width
     atlasAllocatedH = height
     allocatedPages = 0
+    uploadedLayoutId = 0
     ensurePageTexture(0)
   }
 
@@ -1611,7 +1652,13 @@ private class AtlasRenderer(private val assHandler: AssHandler) {
       if (pageQuads > 0) {
         ensurePageTexture(p)
         GLES20.glBindTexture(GLES20.GL_TEXTURE_2D, atlasTexIds[p])
-        if (!reuseUploads) uploadPage(payload.atlasBuf, p, frame.atlasWidth, frame.pageHeights[p])
+        if (!reuseUploads) {
+          if (frame.layoutId != 0 && frame.pageCount == 1) {
+            uploadLayout(payload.atlasBuf, frame)
+          } else {
+            uploadPage(payload.atlasBuf, p, frame.atlasWidth, frame.pageHeights[p])
+          }
+        }
         GLES20.glDrawArrays(GLES20.GL_TRIANGLES, quadOffset * 6, pageQuads * 6)
       }
       quadOffset += pageQuads
@@ -1663,21 +1710,41 @@ private class AtlasRenderer(private val assHandler: AssHandler) {
   /** Uploads page [page]'s packed rows from the stacked atlas buffer into the
    *  currently-bound page texture. */
   private fun uploadPage(atlasBuf: ByteBuffer, page: Int, atlasW: Int, pageH: Int) {
-    if (pageH <= 0) return
-    if (atlasW != atlasAllocatedW || pageH > atlasAllocatedH) {
+    if (page == 0) uploadedLayoutId = 0
+    uploadRows(atlasBuf, page, atlasW, 0, pageH)
+  }
+
+  /** Brings the bound page-0 texture to [frame]'s persistent layout: just the rows
+   *  that changed when it holds the layout they changed from, the whole page otherwise. */
+  private fun uploadLayout(atlasBuf: ByteBuffer, frame: AssAtlasFrame) {
+    val uploaded = if (frame.baseLayoutId != 0 && frame.baseLayoutId == uploadedLayoutId) {
+      uploadRows(atlasBuf, 0, frame.atlasWidth, frame.dirtyTop, frame.dirtyBottom)
+    } else {
+      uploadRows(atlasBuf, 0, frame.atlasWidth, 0, frame.pageHeights[0])
+    }
+    uploadedLayoutId = if (uploaded) frame.layoutId else 0
+  }
+
+  /** Uploads rows [top, bottom) of page [page]. Always full-width bands: GLES2 has no
+   *  UNPACK_ROW_LENGTH, so a narrower rect would read at the wrong stride. Returns
+   *  false when the rows fall outside the allocation. */
+  private fun uploadRows(atlasBuf: ByteBuffer, page: Int, atlasW: Int, top: Int, bottom: Int): Boolean {
+    if (bottom <= top) return true
+    if (atlasW != atlasAllocatedW || top < 0 || bottom > atlasAllocatedH) {
       // Defensive: dims disagree with the allocation (shouldn't happen — both sides
       // resolve dims through the same first-wins gate).
-      Log.w("AssAtlasRenderer", "page upload ${atlasW}x$pageH outside allocation ${atlasAllocatedW}x$atlasAllocatedH")
-      return
+      Log.w("AssAtlasRenderer", "page upload ${atlasW}x$bottom outside allocation ${atlasAllocatedW}x$atlasAllocatedH")
+      return false
     }
-    val start = page * atlasW * atlasAllocatedH
+    val start = page * atlasW * atlasAllocatedH + top * atlasW
     atlasBuf.clear()
-    atlasBuf.limit(start + atlasW * pageH)
+    atlasBuf.limit(start + atlasW * (bottom - top))
     atlasBuf.position(start)
     GLES20.glTexSubImage2D(
-      GLES20.GL_TEXTURE_2D, 0, 0, 0, atlasW, pageH,
+      GLES20.GL_TEXTURE_2D, 0, 0, top, atlasW, bottom - top,
       GLES20.GL_ALPHA, GLES20.GL_UNSIGNED_BYTE, atlasBuf
     )
+    return true
   }
 
   private fun uploadVertices(vertexBuf: ByteBuffer, quadCount: Int) {
@@ -1693,6 +1760,7 @@ private class AtlasRenderer(private val assHandler: AssHandler) {
       atlasTexIds.fill(0)
       allocatedPages = 0
     }
+    uploadedLayoutId = 0
     if (rgbaTexId != 0) {
       val tex = intArrayOf(rgbaTexId)
       GLES20.glDeleteTextures(1, tex, 0)
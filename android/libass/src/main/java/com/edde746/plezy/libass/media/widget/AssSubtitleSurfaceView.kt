@@ -75,6 +75,9 @@ class AssSubtitleSurfaceView(
   /** Worst observed libass render duration, in milliseconds. */
   val maxLibassMs: Long get() = pipeline?.maxLibassMs ?: 0L
 
+  /** How full the last changed atlas frame's uploaded rows were, per thousand pixels. */
+  val lastAtlasOccupancy: Int get() = pipeline?.lastAtlasOccupancy ?: 0
+
   /** Changed-render duration histogram: [≤10ms, ≤25ms, ≤42ms, ≤84ms, >84ms]. */
   val libassMsHistogram: List<Long> get() = pipeline?.libassMsHistogram ?: emptyList()
 
@@ -87,6 +90,9 @@ class AssSubtitleSurfaceView(
   /** Speculation rounds skipped (paused, pending request, no confident cadence). */
   val specSkips: Long get() = pipeline?.specSkips ?: 0L
 
+  /** Requests held on screen while a deeper render-ahead for a slow frame was pending. */
+  val specHeld: Long get() = pipeline?.specHeld ?: 0L
+
   /** changed==0/no-output renders forced into explicit transparent swaps. */
   val blankClearCount: Long get() = pipeline?.blankClearCount ?: 0L
 
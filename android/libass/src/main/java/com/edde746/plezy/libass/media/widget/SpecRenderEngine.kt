@@ -17,10 +17,21 @@ import com.edde746.plezy.libass.AssAtlasFrame
  * are behind injected closures, so the state machine is unit-testable. Only the
  * stat fields are read from other threads.
  *
+ * How far ahead is decided per speculation. Normally one request (the cadence
+ * delta). When a changed render costs more wall time than a frame lasts, one
+ * frame of lead can never be enough, so the engine speculates as many frames
+ * ahead as the render takes and holds the screen on the frames in between: the
+ * typesetting steps at a lower rate but lands on its video frame. And on a
+ * static screen it targets the frame where the next event boundary lands, so
+ * the sign that appears there is the frame already rendered.
+ *
  * Slot ownership invariant: a slot handed to GL ([lastPostedSlot]) or currently
- * read by GL ([glTakenSlot]) is never chosen as a render target. With 3 slots and
- * at most 2 exclusions a target always exists; with 2 slots (low-RAM devices)
- * speculation must be disabled and the legacy alternation behavior falls out.
+ * read by GL ([glTakenSlot]) is never chosen as a render target. With 3 slots
+ * and those 2 exclusions a target always exists. A slot holding a pending
+ * speculation is passed over too while another is free; when the GL slots and
+ * it cover all three, the speculation is dropped and its slot rendered into.
+ * With 2 slots (low-RAM devices) speculation must be disabled and the legacy
+ * alternation behavior falls out.
  *
  * Key subtlety inherited from libass: `ass_render_frame`'s `changed` flag compares
  * against libass's *previous render* — which, with speculation, may be content
@@ -65,25 +76,36 @@ internal class SpecRenderEngine(
   /** A speculative render that wrote new content into [slot] (bump its seq). */
   class SpecWrite(val slot: Int, val frame: AssAtlasFrame)
 
-  // Speculation state: content for specPtsUs is pre-rendered and lives either in
-  // specSlot, or — when the spec render returned changed == 0 — is identical to
-  // libassLastSlot's content (specIsLibassLast).
+  // Speculation state: content for specPtsUs is pre-rendered into specSlot as
+  // specFrame — or, when the spec render returned changed == 0, was already
+  // there: the slot libass last wrote. specAfterUs is the request it was
+  // speculated after; requests strictly between the two are served without
+  // dropping it, and held (nothing posted) when specHolds.
   private var specPtsUs = UNSET
+  private var specAfterUs = UNSET
   private var specSlot = -1
-  private var specIsLibassLast = false
+  private var specFrame: AssAtlasFrame? = null
+  private var specHolds = false
   private var specGen = 0L
 
   // The slot holding libass's most recent render output and its frame.
   private var libassLastSlot = -1
   private var libassLastFrame: AssAtlasFrame? = null
   private var lastPostedSlot = -1
+  private var lastRenderUnchanged = false
 
   // Request-cadence estimator over pinned (playing) requests: median of the last
   // 8 PTS deltas, valid after 4, reset on any non-monotonic or > 250 ms jump.
+  // The release (vsync) times of the same requests give the wall time between
+  // them, which is the PTS delta over the playback rate.
   private val deltas = LongArray(DELTA_SAMPLES)
   private var deltaCount = 0
   private var deltaIndex = 0
   private var lastPinnedPtsUs = UNSET
+  private val wallDeltas = LongArray(DELTA_SAMPLES)
+  private var wallCount = 0
+  private var wallIndex = 0
+  private var lastPinnedReleaseNs = UNSET
 
   // Stats; single-writer (the libass thread), read from the stats path.
   @Volatile
@@ -102,23 +124,39 @@ internal class SpecRenderEngine(
   var blankClearCount = 0L
     private set
 
+  /** Requests held on the current screen while a deeper speculation was pending. */
+  @Volatile
+  var specHeld = 0L
+    private set
+
   /**
    * Services a render request for [ptsUs]. [pinned] is false for invalidate
    * repaints (paused margin changes etc.), which never feed the cadence
    * estimator and never count as speculation misses against playback.
+   * [releaseNs] is the request's target vsync, when it has one.
    */
-  fun service(ptsUs: Long, pinned: Boolean): Outcome {
-    if (pinned) updateDeltaEstimator(ptsUs)
+  fun service(ptsUs: Long, pinned: Boolean, releaseNs: Long = UNSET): Outcome {
+    if (pinned) updateDeltaEstimator(ptsUs, releaseNs)
 
     val ptsMs = toLibassMs(ptsUs)
     if (specPtsUs != UNSET) {
       val specPtsMs = toLibassMs(specPtsUs)
       val genNow = stateGeneration()
+      if (pinned && genNow == specGen && ptsUs > specAfterUs && ptsMs < specPtsMs) {
+        // On the way to a deeper speculation: leave it in place.
+        if (specHolds) {
+          specHeld++
+          debugLog?.invoke("hold pts=${ptsMs}ms spec=${specPtsMs}ms")
+          return Outcome.Skip
+        }
+        debugLog?.invoke("short-of-spec pts=${ptsMs}ms spec=${specPtsMs}ms")
+        return renderOnDemand(ptsMs)
+      }
       val hit = genNow == specGen && ptsMs == specPtsMs
-      val slot = if (specIsLibassLast) libassLastSlot else specSlot
-      val frame = libassLastFrame
+      val slot = specSlot
+      val frame = specFrame
       val specPts = specPtsUs
-      specPtsUs = UNSET
+      clearSpec()
       if (hit && slot >= 0 && frame != null) {
         specHits++
         lastPostedSlot = slot
@@ -135,11 +173,15 @@ internal class SpecRenderEngine(
     } else {
       debugLog?.invoke("no-spec pts=${ptsMs}ms")
     }
+    return renderOnDemand(ptsMs)
+  }
 
-    // On-demand render. For changed == 0 with visible output, the buffers were
-    // untouched and libassLastSlot already holds the right content.
+  // On-demand render. For changed == 0 with visible output, the buffers were
+  // untouched and libassLastSlot already holds the right content.
+  private fun renderOnDemand(ptsMs: Long): Outcome {
     val target = renderTargetSlot() ?: return Outcome.Skip
     val frame = renderAt(ptsMs, target) ?: return Outcome.Skip
+    lastRenderUnchanged = frame.changed == 0
     if (frame.changed == 0) {
       if (isImplicitBlank(frame)) {
         blankClearCount++
@@ -161,13 +203,26 @@ internal class SpecRenderEngine(
   }
 
   /**
-   * Speculatively renders the predicted next request ([servicedPtsUs] + median
-   * delta) into a free slot. Call after posting the current frame; skipped while
-   * paused ([pinned] false), when a newer request is already waiting, or while
-   * the cadence estimator has no confident delta.
+   * Speculatively renders a predicted upcoming request into a free slot: the
+   * next one ([servicedPtsUs] + median delta), or further ahead (see the class
+   * doc) when [renderCostMs], the cost of a recent changed render, exceeds the
+   * wall time between requests, or when the screen is static and
+   * [nextChangeMs], the track's next event start or end (-1 for none), lands a
+   * few requests out. Call after posting the current frame; skipped while
+   * paused ([pinned] false), when a newer request is already waiting, while the
+   * cadence estimator has no confident delta, or while an earlier deeper
+   * speculation is still ahead.
    */
-  fun speculateAfter(servicedPtsUs: Long, pinned: Boolean, hasPending: Boolean): SpecWrite? {
+  fun speculateAfter(
+    servicedPtsUs: Long,
+    pinned: Boolean,
+    hasPending: Boolean,
+    renderCostMs: Long = 0L,
+    nextChangeMs: Long = -1L
+  ): SpecWrite? {
     if (!speculationEnabled) return null
+    // A speculation made after an earlier request is still ahead; keep it.
+    if (specPtsUs != UNSET && servicedPtsUs > specAfterUs) return null
     if (!pinned || hasPending || !deltaValid()) {
       specSkips++
       debugLog?.invoke(
@@ -175,41 +230,65 @@ internal class SpecRenderEngine(
       )
       return null
     }
+    clearSpec()
     val target = renderTargetSlot() ?: run {
       specSkips++
       debugLog?.invoke("spec-skip after=${servicedPtsUs / 1000}ms no-free-slot")
       return null
     }
     val gen = stateGeneration()
-    val specPts = servicedPtsUs + medianDeltaUs()
+    val deltaUs = medianDeltaUs()
+    var frames = 1
+    var holds = false
+    val wallUs = medianWallUs()
+    // Requests until the first one at or past the next event boundary.
+    val untilBoundary = if (nextChangeMs >= 0) ceilDiv(nextChangeMs * 1000 - servicedPtsUs, deltaUs) else -1L
+    if (renderCostMs * 1000 > wallUs) {
+      frames = ceilDiv(renderCostMs * 1000, wallUs).coerceAtMost(MAX_LOOKAHEAD_FRAMES.toLong()).toInt()
+      // Holding past a boundary would show the old content late; stop at it.
+      if (untilBoundary in 1 until frames) frames = untilBoundary.toInt()
+      holds = frames > 1
+    } else if (untilBoundary in 2..MAX_LOOKAHEAD_FRAMES && lastRenderUnchanged) {
+      frames = untilBoundary.toInt()
+    }
+    val specPts = servicedPtsUs + frames * deltaUs
     val frame = renderAt(toLibassMs(specPts), target) ?: run {
       specSkips++
       return null
     }
     specGen = gen
     specPtsUs = specPts
+    specAfterUs = servicedPtsUs
+    specHolds = holds
+    lastRenderUnchanged = frame.changed == 0
     if (frame.changed == 0) {
       if (isImplicitBlank(frame)) {
         blankClearCount++
         libassLastSlot = target
         libassLastFrame = frame
-        specIsLibassLast = false
         specSlot = target
+        specFrame = frame
         return SpecWrite(target, frame)
       }
       // Content at specPts is identical to libass's last render — nothing was
       // written; a hit will repost libassLastSlot (and GL will skip the upload).
-      specIsLibassLast = true
-      specSlot = -1
+      specSlot = libassLastSlot
+      specFrame = libassLastFrame
       return null
     }
     libassLastSlot = target
     libassLastFrame = frame
-    specIsLibassLast = false
     specSlot = target
+    specFrame = frame
     return SpecWrite(target, frame)
   }
 
+  private fun clearSpec() {
+    specPtsUs = UNSET
+    specSlot = -1
+    specFrame = null
+  }
+
   private fun isImplicitBlank(frame: AssAtlasFrame): Boolean = !frame.hasOutput && libassLastFrame?.hasOutput == true
 
   /**
@@ -225,10 +304,11 @@ internal class SpecRenderEngine(
    * nothing was rendered.
    */
   fun prefetch(ptsUs: Long): SpecWrite? {
-    specPtsUs = UNSET
+    clearSpec()
     val target = renderTargetSlot() ?: return null
     val frame = renderAt(toLibassMs(ptsUs), target) ?: return null
     prefetchCount++
+    lastRenderUnchanged = frame.changed == 0
     if (frame.changed == 0) return null
     libassLastSlot = target
     libassLastFrame = frame
@@ -244,38 +324,65 @@ internal class SpecRenderEngine(
     // The GL exclusion only exists in ≥3-slot mode; with 2 slots this reduces to
     // the legacy "don't write the posted slot" alternation.
     val taken = if (slotCount > 2) glTakenSlot() else -1
+    val held = if (specPtsUs != UNSET) specSlot else -1
+    freeSlot(taken, held)?.let { return it }
+    if (held < 0) return null
+    // GL has the other two: a request now beats a frame that may never come.
+    debugLog?.invoke("spec-drop slot=$held no-free-slot")
+    clearSpec()
+    return freeSlot(taken, -1)
+  }
+
+  private fun freeSlot(taken: Int, held: Int): Int? {
     val last = libassLastSlot
-    if (last >= 0 && last != lastPostedSlot && last != taken) return last
+    if (last >= 0 && last != lastPostedSlot && last != taken && last != held) return last
     for (s in 0 until slotCount) {
-      if (s != lastPostedSlot && s != taken) return s
+      if (s != lastPostedSlot && s != taken && s != held) return s
     }
     return null
   }
 
-  private fun updateDeltaEstimator(ptsUs: Long) {
+  private fun updateDeltaEstimator(ptsUs: Long, releaseNs: Long) {
     val prev = lastPinnedPtsUs
+    val prevRelease = lastPinnedReleaseNs
     lastPinnedPtsUs = ptsUs
+    lastPinnedReleaseNs = releaseNs
     if (prev == UNSET) return
     val d = ptsUs - prev
     if (d <= 0 || d > MAX_DELTA_US) {
       // Seek/discontinuity (or duplicate PTS): forget the cadence.
       deltaCount = 0
       deltaIndex = 0
+      wallCount = 0
+      wallIndex = 0
       return
     }
     deltas[deltaIndex] = d
     deltaIndex = (deltaIndex + 1) % DELTA_SAMPLES
     if (deltaCount < DELTA_SAMPLES) deltaCount++
+    if (releaseNs == UNSET || prevRelease == UNSET) return
+    val wallUs = (releaseNs - prevRelease) / 1000
+    if (wallUs <= 0 || wallUs > MAX_DELTA_US) return
+    wallDeltas[wallIndex] = wallUs
+    wallIndex = (wallIndex + 1) % DELTA_SAMPLES
+    if (wallCount < DELTA_SAMPLES) wallCount++
   }
 
   private fun deltaValid() = deltaCount >= MIN_DELTA_SAMPLES
 
-  private fun medianDeltaUs(): Long {
-    val copy = deltas.copyOfRange(0, deltaCount)
+  private fun medianDeltaUs(): Long = median(deltas, deltaCount)
+
+  /** Wall time between requests; the PTS delta until release times say otherwise. */
+  private fun medianWallUs(): Long = if (wallCount >= MIN_DELTA_SAMPLES) median(wallDeltas, wallCount) else medianDeltaUs()
+
+  private fun median(values: LongArray, count: Int): Long {
+    val copy = values.copyOfRange(0, count)
     copy.sort()
-    return copy[deltaCount / 2]
+    return copy[count / 2]
   }
 
+  private fun ceilDiv(a: Long, b: Long): Long = -Math.floorDiv(-a, b)
+
   private fun toLibassMs(ptsUs: Long): Long = Math.floorDiv(ptsUs, 1_000L)
 
   private companion object {
@@ -283,5 +390,9 @@ internal class SpecRenderEngine(
     const val DELTA_SAMPLES = 8
     const val MIN_DELTA_SAMPLES = 4
     const val MAX_DELTA_US = 250_000L
+
+    /** Deepest speculation, in requests: a render slower than this many frames
+     *  is late anyway, and the prediction drifts with every step. */
+    const val MAX_LOOKAHEAD_FRAMES = 4
   }
 }
@@ -0,0 +1,108 @@
+extern "C" {
+#include "../../main/cpp/AssBlend.h"
+}
+
+#include <cstdio>
+#include <cstdlib>
+#include <cstring>
+
+namespace {
+
+bool check(bool condition, const char* message) {
+  if (!condition) std::fprintf(stderr, "%s\n", message);
+  return condition;
+}
+
+// The kernels' divide, (x + 1 + (x >> 8)) >> 8, for every value they divide.
+bool divideIsExactOverTheBlendRange() {
+  for (unsigned x = 0; x <= 255u * 255u + 127u; x++) {
+    if (x / 255u != ((x + 1u + (x >> 8)) >> 8)) return check(false, "shift divide differs from x / 255");
+  }
+  return true;
+}
+
+// Every (mask, opacity, destination) byte through a full 8-pixel vector. The
+// colour channels vary with the destination so each lane sees its own inputs.
+bool matchesScalarForEveryPixelValue() {
+  for (unsigned s = 0; s < 256; s++) {
+    uint8_t mask[8];
+    std::memset(mask, (int)s, sizeof(mask));
+    for (unsigned a = 0; a < 256; a++) {
+      for (unsigned d = 0; d < 256; d++) {
+        uint8_t expected[32];
+        uint8_t actual[32];
+        for (int i = 0; i < 32; i++) expected[i] = actual[i] = (uint8_t)(d + i);
+        ass_blend_span_scalar(expected, mask, 8, d, 255 - d, s, a);
+        ass_blend_span(actual, mask, 8, d, 255 - d, s, a);
+        if (std::memcmp(expected, actual, sizeof(actual)) != 0) {
+          std::fprintf(stderr, "mask %u opacity %u dst %u: ", s, a, d);
+          return check(false, "SIMD blend differs from scalar");
+        }
+      }
+    }
+  }
+  return true;
+}
+
+// Random spans of every length up to 300: clear runs the kernels skip, solid
+// runs, sparse and noisy masks, and the scalar tail after the last vector.
+bool matchesScalarOnRandomSpans() {
+  std::srand(7);
+  static uint8_t mask[300];
+  static uint8_t expected[1200];
+  static uint8_t actual[1200];
+  for (int iteration = 0; iteration < 50000; iteration++) {
+    const int count = std::rand() % 300;
+    const int shape = std::rand() % 4;
+    for (int i = 0; i < count; i++) {
+      mask[i] = shape == 0   ? 0
+                : shape == 1 ? (std::rand() % 3 ? 0 : (uint8_t)std::rand())
+                : shape == 2 ? 255
+                             : (uint8_t)std::rand();
+    }
+    for (int i = 0; i < count * 4; i++) expected[i] = actual[i] = (uint8_t)std::rand();
+    const unsigned r = std::rand() & 255, g = std::rand() & 255, b = std::rand() & 255;
+    const unsigned a = std::rand() % 5 == 0 ? 255 : std::rand() & 255;
+    ass_blend_span_scalar(expected, mask, count, r, g, b, a);
+    ass_blend_span(actual, mask, count, r, g, b, a);
+    if (std::memcmp(expected, actual, (size_t)count * 4) != 0) {
+      std::fprintf(stderr, "span of %d, shape %d: ", count, shape);
+      return check(false, "SIMD blend differs from scalar");
+    }
+  }
+  return true;
+}
+
+bool leavesDestinationUnderAClearMask() {
+  uint8_t mask[19] = {};
+  uint8_t pixels[19 * 4];
+  for (int i = 0; i < (int)sizeof(pixels); i++) pixels[i] = (uint8_t)(i * 7);
+  uint8_t before[sizeof(pixels)];
+  std::memcpy(before, pixels, sizeof(pixels));
+  ass_blend_span(pixels, mask, 19, 255, 255, 255, 255);
+  return check(std::memcmp(before, pixels, sizeof(pixels)) == 0, "clear mask changed the destination");
+}
+
+}  // namespace
+
+int main() {
+  struct TestCase {
+    const char* name;
+    bool (*run)();
+  };
+  const TestCase tests[] = {
+      {"exact shift divide", divideIsExactOverTheBlendRange},
+      {"every pixel value", matchesScalarForEveryPixelValue},
+      {"random spans", matchesScalarOnRandomSpans},
+      {"clear mask", leavesDestinationUnderAClearMask},
+  };
+
+  for (const TestCase& test : tests) {
+    if (!test.run()) {
+      std::fprintf(stderr, "FAILED: %s\n", test.name);
+      return 1;
+    }
+  }
+  std::printf("Passed %zu ass_blend tests\n", sizeof(tests) / sizeof(tests[0]));
+  return 0;
+}
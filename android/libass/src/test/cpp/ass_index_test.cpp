@@ -0,0 +1,193 @@
+extern "C" {
+#include "../../main/cpp/AssIndex.h"
+}
+
+#include <algorithm>
+#include <cstdio>
+#include <random>
+#include <vector>
+
+namespace {
+
+bool check(bool condition, const char* message) {
+  if (!condition) std::fprintf(stderr, "%s\n", message);
+  return condition;
+}
+
+// A track whose events the test edits the way libass does, plus every answer
+// the index gives worked out again by scanning them all.
+struct Track {
+  std::vector<ASS_Event> events;
+  ASS_Track track = {};
+
+  const ASS_Track* view() {
+    track.n_events = (int)events.size();
+    track.events = events.data();
+    return &track;
+  }
+
+  long long nextStart(long long afterMs) const {
+    long long best = -1;
+    for (const ASS_Event& e : events) {
+      if (e.Start > afterMs && (best < 0 || e.Start < best)) best = e.Start;
+    }
+    return best;
+  }
+
+  long long nextChange(long long afterMs) const {
+    long long best = -1;
+    for (const ASS_Event& e : events) {
+      for (long long t : {e.Start, e.Start + e.Duration}) {
+        if (t > afterMs && (best < 0 || t < best)) best = t;
+      }
+    }
+    return best;
+  }
+
+  std::vector<AssIndexEntry> window(long long fromMs, long long toMs) const {
+    std::vector<AssIndexEntry> showing;
+    if (toMs <= fromMs) return showing;
+    for (int i = 0; i < (int)events.size(); i++) {
+      const long long end = events[i].Start + events[i].Duration;
+      if (events[i].Start < toMs && end > fromMs) showing.push_back({events[i].Start, end, i});
+    }
+    std::sort(showing.begin(), showing.end(), [](const AssIndexEntry& x, const AssIndexEntry& y) {
+      if (x.start != y.start) return x.start < y.start;
+      if (x.end != y.end) return x.end < y.end;
+      return x.event < y.event;
+    });
+    return showing;
+  }
+};
+
+ASS_Event randomEvent(std::mt19937& rng) {
+  // A coarse grid so starts, ends and query times often coincide.
+  const long long start = (long long)(rng() % 400) * 50;
+  const long long duration = rng() % 8 == 0 ? 0 : (long long)(1 + rng() % 60) * 50;
+  return {start, duration};
+}
+
+bool sameEntries(const AssIndexEntry* got, const std::vector<AssIndexEntry>& want, int count) {
+  for (int i = 0; i < count; i++) {
+    if (got[i].start != want[i].start || got[i].end != want[i].end || got[i].event != want[i].event) return false;
+  }
+  return true;
+}
+
+// Every query at every grid point (and either side of it) against the scan.
+bool agreesWithScan(const AssEventIndex* index, const Track& track) {
+  std::vector<AssIndexEntry> out(track.events.size() + 1);
+  for (long long point = -50; point <= 23100; point += 25) {
+    for (long long t = point - 1; t <= point + 1; t++) {
+      if (ass_index_next_start(index, t) != track.nextStart(t)) {
+        std::fprintf(stderr, "after %lld: ", t);
+        return check(false, "next start differs from a scan");
+      }
+      if (ass_index_next_change(index, t) != track.nextChange(t)) {
+        std::fprintf(stderr, "after %lld: ", t);
+        return check(false, "next change differs from a scan");
+      }
+      for (long long span : {0LL, 1LL, 50LL, 775LL, 4000LL}) {
+        const std::vector<AssIndexEntry> want = track.window(t, t + span);
+        const int found = ass_index_window(index, t, t + span, out.data(), (int)out.size());
+        if (found != (int)want.size() || !sameEntries(out.data(), want, found)) {
+          std::fprintf(stderr, "window [%lld, %lld): ", t, t + span);
+          return check(false, "window differs from a scan");
+        }
+      }
+    }
+  }
+  return true;
+}
+
+bool answersEmptyTrack() {
+  AssEventIndex* index = ass_index_new();
+  Track track;
+  const bool ok = check(ass_index_sync(index, track.view()) == 1, "empty sync failed") &&
+                  check(ass_index_next_start(index, 0) == -1, "empty track has a next start") &&
+                  check(ass_index_next_change(index, 0) == -1, "empty track has a next change") &&
+                  check(ass_index_window(index, 0, 1000, nullptr, 0) == 0, "empty track has a window");
+  ass_index_free(index);
+  return ok;
+}
+
+bool followsAppends() {
+  std::mt19937 rng(21);
+  AssEventIndex* index = ass_index_new();
+  Track track;
+  bool ok = true;
+  for (int round = 0; round < 60 && ok; round++) {
+    const int batch = round % 5 == 0 ? 0 : 1 + (int)(rng() % 40);
+    for (int i = 0; i < batch; i++) track.events.push_back(randomEvent(rng));
+    ok = check(ass_index_sync(index, track.view()) == 1, "append sync failed") && agreesWithScan(index, track);
+  }
+  ass_index_free(index);
+  return ok;
+}
+
+// A flush or prune drops events; a reload can replace them at the same count.
+bool rebuildsAfterTruncationAndReload() {
+  std::mt19937 rng(22);
+  AssEventIndex* index = ass_index_new();
+  Track track;
+  bool ok = true;
+  for (int round = 0; round < 60 && ok; round++) {
+    switch (rng() % 4) {
+      case 0:
+        track.events.resize(track.events.empty() ? 0 : rng() % track.events.size());
+        break;
+      case 1:
+        for (ASS_Event& e : track.events) e = randomEvent(rng);
+        break;
+      case 2:
+        if (!track.events.empty()) track.events.back() = randomEvent(rng);
+        break;
+      default:
+        break;
+    }
+    const int batch = (int)(rng() % 30);
+    for (int i = 0; i < batch; i++) track.events.push_back(randomEvent(rng));
+    ok = check(ass_index_sync(index, track.view()) == 1, "sync after an edit failed") && agreesWithScan(index, track);
+  }
+  ass_index_free(index);
+  return ok;
+}
+
+// A buffer too small for the window still gets the total, and the first events.
+bool countsPastASmallBuffer() {
+  AssEventIndex* index = ass_index_new();
+  Track track;
+  for (int i = 0; i < 10; i++) track.events.push_back({(long long)(9 - i) * 100, 1000});
+  AssIndexEntry out[3];
+  const bool synced = ass_index_sync(index, track.view()) == 1;
+  const std::vector<AssIndexEntry> want = track.window(500, 600);
+  const int found = ass_index_window(index, 500, 600, out, 3);
+  const bool ok = check(synced, "sync failed") && check(found == (int)want.size(), "window total differs") &&
+                  check(sameEntries(out, want, 3), "window's first entries differ");
+  ass_index_free(index);
+  return ok;
+}
+
+}  // namespace
+
+int main() {
+  struct TestCase {
+    const char* name;
+    bool (*run)();
+  };
+  const TestCase tests[] = {
+      {"empty track", answersEmptyTrack},
+      {"appends", followsAppends},
+      {"truncation and reload", rebuildsAfterTruncationAndReload},
+      {"small window buffer", countsPastASmallBuffer},
+  };
+
+  for (const TestCase& test : tests) {
+    if (!test.run()) {
+      std::fprintf(stderr, "FAILED: %s\n", test.name);
+      return 1;
+    }
+  }
+  std::printf("Passed %zu ass_index tests\n", sizeof(tests) / sizeof(tests[0]));
+  return 0;
+}
@@ -0,0 +1,494 @@
+extern "C" {
+#include "../../main/cpp/AssPack.h"
+}
+
+#include <algorithm>
+#include <cmath>
+#include <cstdio>
+#include <map>
+#include <random>
+#include <set>
+#include <vector>
+
+namespace {
+
+bool check(bool condition, const char* message) {
+  if (!condition) std::fprintf(stderr, "%s\n", message);
+  return condition;
+}
+
+// A mask whose every byte says which bitmap and which pixel it is, so a slot
+// holding the wrong bitmap, or an overlapping one, cannot read back right.
+struct Bitmap {
+  int w = 0, h = 0, stride = 0;
+  std::vector<uint8_t> pixels;
+};
+
+Bitmap makeBitmap(int id, int w, int h) {
+  Bitmap bitmap;
+  bitmap.w = w;
+  bitmap.h = h;
+  bitmap.stride = w + 3;  // row padding, as libass leaves
+  bitmap.pixels.assign((size_t)bitmap.stride * h, 0);
+  for (int y = 0; y < h; y++) {
+    for (int x = 0; x < w; x++) {
+      bitmap.pixels[(size_t)y * bitmap.stride + x] = (uint8_t)(1 + (id * 31 + x * 7 + y * 13) % 251);
+    }
+  }
+  return bitmap;
+}
+
+struct Placement {
+  const Bitmap* bitmap;
+  int dstX, dstY;
+};
+
+// An ASS_Image list over `placements`, in painter order.
+struct Frame {
+  std::vector<ASS_Image> images;
+
+  explicit Frame(const std::vector<Placement>& placements) : images(placements.size()) {
+    for (size_t i = 0; i < placements.size(); i++) {
+      const Bitmap* bitmap = placements[i].bitmap;
+      images[i] = ASS_Image{};
+      images[i].w = bitmap->w;
+      images[i].h = bitmap->h;
+      images[i].stride = bitmap->stride;
+      images[i].bitmap = const_cast<unsigned char*>(bitmap->pixels.data());
+      images[i].color = 0xFFFFFF00u;
+      images[i].dst_x = placements[i].dstX;
+      images[i].dst_y = placements[i].dstY;
+      images[i].next = i + 1 < placements.size() ? &images[i + 1] : nullptr;
+    }
+  }
+
+  ASS_Image* head() { return images.empty() ? nullptr : &images[0]; }
+};
+
+// One emitted quad read back: where it draws and which atlas slot it samples.
+struct Quad {
+  int dstX, dstY;
+  int sx, sy, w, h;
+};
+
+Quad readQuad(const std::vector<float>& vertices, int index, int atlasMaxW, int atlasMaxH) {
+  const float* v = vertices.data() + (size_t)index * 48;
+  const float* opposite = v + 4 * 8;  // the (x1, y1) corner
+  Quad quad;
+  quad.dstX = (int)std::lround(v[0]);
+  quad.dstY = (int)std::lround(v[1]);
+  quad.sx = (int)std::lround(v[2] * atlasMaxW);
+  quad.sy = (int)std::lround(v[3] * atlasMaxH);
+  quad.w = (int)std::lround(opposite[0] - v[0]);
+  quad.h = (int)std::lround(opposite[1] - v[1]);
+  return quad;
+}
+
+bool overlaps(const Quad& a, const Quad& b) {
+  return a.sx < b.sx + b.w && b.sx < a.sx + a.w && a.sy < b.sy + b.h && b.sy < a.sy + a.h;
+}
+
+bool noneOverlap(const std::vector<Quad>& quads) {
+  for (size_t i = 0; i < quads.size(); i++) {
+    for (size_t j = i + 1; j < quads.size(); j++) {
+      if (overlaps(quads[i], quads[j])) return false;
+    }
+  }
+  return true;
+}
+
+// Whether `page` holds the w x h part of `bitmap` from (ox, oy) at the quad's slot.
+bool pageHolds(const uint8_t* page, int atlasMaxW, const Quad& quad, const Bitmap& bitmap, int ox, int oy) {
+  for (int y = 0; y < quad.h; y++) {
+    for (int x = 0; x < quad.w; x++) {
+      if (page[(size_t)(quad.sy + y) * atlasMaxW + quad.sx + x] !=
+          bitmap.pixels[(size_t)(oy + y) * bitmap.stride + ox + x]) {
+        return false;
+      }
+    }
+  }
+  return true;
+}
+
+// --- ass_pack_frame ---
+
+// A frame packed into up to ASS_PACK_MAX_PAGES pages of kW x kH, with every
+// quad read back and given the page its contiguous run puts it on.
+struct FramePack {
+  static constexpr int kW = 64;
+  static constexpr int kH = 64;
+  int atlasMaxW;
+  int atlasMaxH;
+  std::vector<uint8_t> pages;
+  std::vector<float> vertices = std::vector<float>(256 * 48);
+  AssPackResult result = {};
+  std::vector<Quad> quads;
+  std::vector<int> quadPages;
+
+  explicit FramePack(int w = kW, int h = kH)
+      : atlasMaxW(w), atlasMaxH(h), pages((size_t)w * h * ASS_PACK_MAX_PAGES, 0xEE) {}
+
+  bool pack(const std::vector<Placement>& placements) {
+    Frame frame(placements);
+    if (!ass_pack_frame(
+            frame.head(), pages.data(), pages.size(), atlasMaxW, atlasMaxH, vertices.data(),
+            vertices.size() * sizeof(float), &result)) {
+      return false;
+    }
+    quads.clear();
+    quadPages.clear();
+    for (int page = 0; page < result.pageCount; page++) {
+      for (int q = 0; q < result.pageQuads[page]; q++) quadPages.push_back(page);
+    }
+    for (int i = 0; i < result.quadCount; i++) quads.push_back(readQuad(vertices, i, atlasMaxW, atlasMaxH));
+    return true;
+  }
+
+  const uint8_t* page(int index) const { return pages.data() + (size_t)index * atlasMaxW * atlasMaxH; }
+};
+
+bool nestsShortTilesBesideATallOne() {
+  const Bitmap a = makeBitmap(1, 40, 30);
+  const Bitmap b = makeBitmap(2, 24, 10);
+  const Bitmap c = makeBitmap(3, 24, 10);
+  const Bitmap d = makeBitmap(4, 24, 10);
+  FramePack pack;
+  if (!check(pack.pack({{&b, 0, 0}, {&a, 0, 0}, {&c, 0, 0}, {&d, 0, 0}}), "pack failed")) return false;
+  const std::vector<Quad>& q = pack.quads;
+  // 40x30 + 3 x 24x10 = 1920 pixels over 30 rows of 64.
+  return check(pack.result.mode == ASS_PACK_MODE_ATLAS && pack.result.quadCount == 4, "four quads expected") &&
+         check(q[1].sx == 0 && q[1].sy == 0, "the tallest tile goes first") &&
+         check(q[0].sx == 40 && q[0].sy == 0, "a short tile nests beside the tall one") &&
+         check(q[2].sx == 40 && q[2].sy == 10 && q[3].sx == 40 && q[3].sy == 20, "short tiles stack in the step") &&
+         check(pack.result.pageHeights[0] == 30, "the page is as tall as the tallest tile") &&
+         check(pack.result.occupancyPermille == 1000, "a page packed solid is 1000 permille full");
+}
+
+bool reportsOccupancyOfThePackedRows() {
+  const Bitmap a = makeBitmap(1, 32, 16);
+  const Bitmap b = makeBitmap(2, 16, 8);
+  FramePack pack;
+  if (!check(pack.pack({{&a, 0, 0}, {&b, 0, 0}}), "pack failed")) return false;
+  // 32x16 + 16x8 = 640 pixels over 16 rows of 64 = 1024.
+  return check(pack.result.pageHeights[0] == 16, "two tiles side by side take 16 rows") &&
+         check(pack.result.occupancyPermille == 625, "640 of 1024 pixels is 625 permille");
+}
+
+bool splitsRunsAcrossPagesInPainterOrder() {
+  std::vector<Bitmap> bitmaps;
+  for (int id = 0; id < 5; id++) bitmaps.push_back(makeBitmap(id, 40, 40));
+  std::vector<Placement> placements;
+  for (int id = 0; id < 4; id++) placements.push_back({&bitmaps[id], id * 10, 0});
+
+  // Two 40x40 tiles fit a 64x64 page by area, not once packed.
+  FramePack pack;
+  if (!check(pack.pack(placements), "pack failed")) return false;
+  bool ok = check(pack.result.mode == ASS_PACK_MODE_ATLAS, "four pages of tiles stay in the atlas") &&
+            check(pack.result.requiredPages == 4 && pack.result.pageCount == 4, "one tile per page") &&
+            check(pack.result.truncated == 0 && pack.result.quadCount == 4, "no tile may be dropped");
+  for (int p = 0; p < 4 && ok; p++) {
+    ok = check(pack.result.pageQuads[p] == 1 && pack.result.pageHeights[p] == 40, "each page holds one tile") &&
+         check(pack.quads[p].dstX == p * 10, "pages follow painter order") &&
+         check(pageHolds(pack.page(p), FramePack::kW, pack.quads[p], bitmaps[p], 0, 0), "page holds its tile");
+  }
+
+  // A fifth needs more pages than there are: the frame flattens instead.
+  placements.push_back({&bitmaps[4], 0, 0});
+  if (!check(pack.pack(placements), "pack failed")) return false;
+  return ok && check(pack.result.mode == ASS_PACK_MODE_COMPOSITE, "a frame past the page cap must composite") &&
+         check(pack.result.truncated == 0 && pack.result.quadCount == 1, "a composite is one whole quad");
+}
+
+// Random frames of mixed, wide and oversized images: whatever the page-run
+// search settles on, every tile is placed once, inside its page's packed
+// rows, clear of the other tiles there, on a page no earlier than the tile
+// painted before it, and reads back from that page.
+bool randomFramesPackWithinTheirPages() {
+  constexpr int kW = 128;
+  constexpr int kH = 128;
+  std::mt19937 rng(99);
+  FramePack pack(kW, kH);
+  int multiPage = 0;
+  bool ok = true;
+
+  for (int f = 0; f < 500 && ok; f++) {
+    std::vector<Bitmap> bitmaps;
+    const int count = 1 + (int)(rng() % 40);
+    for (int id = 0; id < count; id++) {
+      const int kind = (int)(rng() % 10);
+      const int w = kind < 7 ? 1 + (int)(rng() % 40) : kind < 9 ? 60 + (int)(rng() % 69) : 100 + (int)(rng() % 200);
+      const int h = kind < 9 ? 1 + (int)(rng() % 50) : 100 + (int)(rng() % 200);
+      bitmaps.push_back(makeBitmap(f * 64 + id, w, h));
+    }
+    std::vector<Placement> placements;
+    for (const Bitmap& bitmap : bitmaps) placements.push_back({&bitmap, (int)(rng() % 1800), (int)(rng() % 1000)});
+    ok = check(pack.pack(placements), "pack failed");
+    if (!ok || pack.result.mode != ASS_PACK_MODE_ATLAS) continue;
+
+    // The tiles, in painter order, that the frame should split into.
+    struct Tile {
+      const Bitmap* bitmap;
+      int dstX, dstY, ox, oy, w, h;
+    };
+    std::vector<Tile> tiles;
+    for (const Placement& p : placements) {
+      for (int oy = 0; oy < p.bitmap->h; oy += kH) {
+        for (int ox = 0; ox < p.bitmap->w; ox += kW) {
+          tiles.push_back(
+              {p.bitmap, p.dstX + ox, p.dstY + oy, ox, oy, std::min(kW, p.bitmap->w - ox),
+               std::min(kH, p.bitmap->h - oy)});
+        }
+      }
+    }
+
+    const AssPackResult& r = pack.result;
+    int summed = 0;
+    long long rows = 0;
+    long long placed = 0;
+    for (int p = 0; p < r.pageCount; p++) {
+      summed += r.pageQuads[p];
+      rows += r.pageHeights[p];
+      ok = ok && check(r.pageHeights[p] > 0 && r.pageHeights[p] <= kH, "a page's packed rows must fit the page");
+    }
+    ok = ok && check(r.truncated == 0 && r.pageCount == r.requiredPages, "enough pages were provided") &&
+         check(summed == r.quadCount, "pageQuads must sum to quadCount") &&
+         check(r.quadCount == (int)tiles.size(), "every tile must be placed once");
+    if (!ok) break;
+    multiPage += r.pageCount > 1;
+
+    for (int i = 0; i < r.quadCount && ok; i++) {
+      const Quad& quad = pack.quads[i];
+      const Tile& tile = tiles[i];
+      const int page = pack.quadPages[i];
+      placed += (long long)quad.w * quad.h;
+      ok = check(quad.dstX == tile.dstX && quad.dstY == tile.dstY, "quads must follow painter order") &&
+           check(quad.w == tile.w && quad.h == tile.h, "a quad must be its tile's size") &&
+           check(i == 0 || page >= pack.quadPages[i - 1], "page assignment must be monotonic in painter order") &&
+           check(quad.sx >= 0 && quad.sy >= 0 && quad.sx + quad.w <= kW, "a tile must lie inside the page") &&
+           check(quad.sy + quad.h <= r.pageHeights[page], "a tile must lie inside its page's packed rows") &&
+           check(pageHolds(pack.page(page), kW, quad, *tile.bitmap, tile.ox, tile.oy), "the page must hold the tile");
+      for (int j = 0; j < i && ok; j++) {
+        if (pack.quadPages[j] == page) ok = check(!overlaps(pack.quads[j], quad), "placements must not overlap");
+      }
+    }
+    ok = ok && check(r.occupancyPermille == (int)(placed * 1000 / (rows * kW)), "occupancy counts placed pixels");
+  }
+  return ok && check(multiPage > 0, "some frames should need more than one page");
+}
+
+// --- ass_pack_frame_persistent ---
+
+struct PersistentPack {
+  static constexpr int kW = 64;
+  static constexpr int kH = 64;
+  AssPackCache* cache = ass_pack_cache_new();
+  std::vector<uint8_t> buffer = std::vector<uint8_t>((size_t)kW * kH, 0xEE);
+  std::vector<float> vertices = std::vector<float>(64 * 48);
+  AssPackResult result = {};
+  std::vector<Quad> quads;
+
+  ~PersistentPack() { ass_pack_cache_free(cache); }
+
+  bool pack(const std::vector<Placement>& placements, long long bufferId = 1) {
+    Frame frame(placements);
+    if (!ass_pack_frame_persistent(
+            cache, bufferId, frame.head(), buffer.data(), buffer.size(), kW, kH, vertices.data(),
+            vertices.size() * sizeof(float), &result)) {
+      return false;
+    }
+    quads.clear();
+    for (int i = 0; i < result.quadCount; i++) quads.push_back(readQuad(vertices, i, kW, kH));
+    return true;
+  }
+
+  bool sameSlot(int a, const Quad& b) const { return quads[a].sx == b.sx && quads[a].sy == b.sy; }
+};
+
+bool keepsSlotsOfUnchangedBitmaps() {
+  const Bitmap a = makeBitmap(1, 20, 10);
+  const Bitmap b = makeBitmap(2, 10, 20);
+  const Bitmap c = makeBitmap(3, 16, 6);
+  PersistentPack pack;
+
+  if (!check(pack.pack({{&a, 0, 0}, {&b, 30, 0}}), "first pack failed")) return false;
+  const AssPackResult first = pack.result;
+  const std::vector<Quad> firstQuads = pack.quads;
+  bool ok = check(first.layoutId != 0 && first.baseLayoutId == 0, "a first layout must be a full one") &&
+            check(first.dirtyTop == 0 && first.dirtyBottom == first.pageHeights[0], "a full layout is all dirty");
+
+  // Moved on screen, same masks, plus one new one.
+  if (!check(pack.pack({{&b, 5, 5}, {&c, 7, 7}, {&a, 50, 40}}), "second pack failed")) return false;
+  ok = ok && check(pack.result.baseLayoutId == first.layoutId, "an added bitmap must build on the last layout") &&
+       check(pack.result.layoutId != first.layoutId, "an added bitmap makes a new layout") &&
+       check(
+           pack.sameSlot(0, firstQuads[1]) && pack.sameSlot(2, firstQuads[0]),
+           "unchanged bitmaps must keep their slots") &&
+       check(pack.quads[0].dstX == 5 && pack.quads[2].dstX == 50, "quads must draw where the frame puts them") &&
+       check(
+           pack.quads[1].sy >= pack.result.dirtyTop && pack.quads[1].sy + pack.quads[1].h <= pack.result.dirtyBottom,
+           "a new slot must lie inside the dirty rows") &&
+       check(noneOverlap(pack.quads), "slots must not overlap");
+  const AssPackResult second = pack.result;
+
+  if (!check(pack.pack({{&b, 1, 1}, {&c, 2, 2}, {&a, 3, 3}}), "third pack failed")) return false;
+  ok = ok && check(pack.result.layoutId == second.layoutId, "an unchanged frame keeps its layout") &&
+       check(pack.result.baseLayoutId == second.layoutId, "an unchanged frame builds on its own layout") &&
+       check(pack.result.dirtyTop == 0 && pack.result.dirtyBottom == 0, "an unchanged frame has nothing to upload");
+  return ok;
+}
+
+bool repacksAFullPageFromTheTop() {
+  const Bitmap a = makeBitmap(1, 64, 32);
+  const Bitmap b = makeBitmap(2, 64, 32);
+  const Bitmap c = makeBitmap(3, 64, 32);
+  PersistentPack pack;
+  if (!pack.pack({{&a, 0, 0}}) || !pack.pack({{&b, 0, 0}})) return check(false, "pack failed");
+  bool ok = check(pack.result.baseLayoutId != 0, "a bitmap that fits above the skyline must not repack") &&
+            check(pack.quads[0].sy == 32, "a new bitmap goes above what is already placed");
+  if (!pack.pack({{&c, 0, 0}})) return check(false, "pack failed");
+  return ok && check(pack.result.baseLayoutId == 0, "a repack must report base 0") &&
+         check(pack.quads[0].sx == 0 && pack.quads[0].sy == 0, "a repack packs from the top") &&
+         check(
+             pack.result.dirtyTop == 0 && pack.result.dirtyBottom == pack.result.pageHeights[0],
+             "a repack is all dirty");
+}
+
+bool layoutIdsAreUniqueAcrossCaches() {
+  const Bitmap a = makeBitmap(1, 8, 8);
+  PersistentPack first;
+  PersistentPack second;
+  if (!first.pack({{&a, 0, 0}}) || !second.pack({{&a, 0, 0}})) return check(false, "pack failed");
+  return check(first.result.layoutId != second.result.layoutId, "two caches must never share a layout id");
+}
+
+// Random frames written into two alternating buffers, each uploaded to one
+// texture the way the pipeline does: only the dirty rows when the texture
+// holds the base layout, all packed rows otherwise. Every slot must read back
+// its bitmap from the buffer and from the texture, every frame.
+bool randomFramesKeepTheUploadContract() {
+  constexpr int kW = 256;
+  constexpr int kH = 256;
+  std::mt19937 rng(1234);
+  std::vector<Bitmap> pool;
+  for (int id = 0; id < 48; id++) pool.push_back(makeBitmap(id, 2 + (int)(rng() % 47), 2 + (int)(rng() % 47)));
+
+  AssPackCache* cache = ass_pack_cache_new();
+  std::vector<uint8_t> buffers[2] = {
+      std::vector<uint8_t>((size_t)kW * kH, 0xEE), std::vector<uint8_t>((size_t)kW * kH, 0xEE)};
+  std::vector<uint8_t> texture((size_t)kW * kH, 0xDD);
+  int textureLayout = 0;
+  std::vector<float> vertices(64 * 48);
+  std::set<int> layoutIds;
+  int lastLayoutId = 0;
+  std::map<int, Quad> lastSlots;  // bitmap id -> slot in the last layout
+  std::vector<int> showing;
+  bool ok = true;
+
+  for (int f = 0; f < 400 && ok; f++) {
+    // Most bitmaps stay from one frame to the next, as signs and karaoke do.
+    std::vector<int> kept;
+    for (int id : showing) {
+      if (rng() % 4 != 0) kept.push_back(id);
+    }
+    const size_t target = 4 + rng() % 13;
+    while (kept.size() < target) {
+      const int id = (int)(rng() % pool.size());
+      bool present = false;
+      for (int k : kept) present = present || k == id;
+      if (!present) kept.push_back(id);
+    }
+    showing = kept;
+    std::vector<Placement> placements;
+    for (int id : showing) placements.push_back({&pool[id], (int)(rng() % 1800), (int)(rng() % 1000)});
+    Frame frame(placements);
+
+    std::vector<uint8_t>& buffer = buffers[f % 2];
+    AssPackResult result;
+    ok = check(
+        ass_pack_frame_persistent(
+            cache, 1 + f % 2, frame.head(), buffer.data(), buffer.size(), kW, kH, vertices.data(),
+            vertices.size() * sizeof(float), &result) != 0,
+        "persistent pack failed");
+    if (!ok) break;
+    ok = check(result.layoutId != 0 && result.pageCount == 1, "a frame within one page must keep a layout") &&
+         check(
+             result.quadCount == (int)showing.size() && result.pageQuads[0] == result.quadCount,
+             "one quad per image");
+    if (!ok) break;
+
+    const bool base = result.baseLayoutId != 0;
+    if (base) {
+      ok = ok && check(result.baseLayoutId == lastLayoutId, "the base must be the last layout");
+    } else {
+      ok = ok && check(result.dirtyTop == 0 && result.dirtyBottom == result.pageHeights[0], "a repack is all dirty");
+    }
+    if (result.layoutId != lastLayoutId) {
+      ok = ok && check(layoutIds.insert(result.layoutId).second, "a new layout must have a new id");
+    } else {
+      ok = ok && check(result.dirtyTop == result.dirtyBottom, "an unchanged layout has nothing to upload");
+    }
+
+    if (base && textureLayout == result.baseLayoutId) {
+      for (int y = result.dirtyTop; y < result.dirtyBottom; y++) {
+        std::copy(&buffer[(size_t)y * kW], &buffer[(size_t)(y + 1) * kW], &texture[(size_t)y * kW]);
+      }
+    } else {
+      std::copy(buffer.begin(), buffer.begin() + (size_t)result.pageHeights[0] * kW, texture.begin());
+    }
+    textureLayout = result.layoutId;
+
+    std::vector<Quad> quads;
+    std::map<int, Quad> slots;
+    for (int i = 0; i < result.quadCount && ok; i++) {
+      const Quad quad = readQuad(vertices, i, kW, kH);
+      const Bitmap& bitmap = pool[showing[i]];
+      quads.push_back(quad);
+      slots[showing[i]] = quad;
+      ok = check(quad.w == bitmap.w && quad.h == bitmap.h, "a quad must be its bitmap's size") &&
+           check(quad.sx >= 0 && quad.sy >= 0 && quad.sx + quad.w <= kW, "a slot must lie inside the page") &&
+           check(quad.sy + quad.h <= result.pageHeights[0], "a slot must lie inside the packed rows") &&
+           check(pageHolds(buffer.data(), kW, quad, bitmap, 0, 0), "the buffer must hold every slot's bitmap") &&
+           check(pageHolds(texture.data(), kW, quad, bitmap, 0, 0), "the texture must hold every slot's bitmap");
+      if (!ok || !base) continue;
+      const auto last = lastSlots.find(showing[i]);
+      if (last != lastSlots.end()) {
+        ok = check(last->second.sx == quad.sx && last->second.sy == quad.sy, "an unchanged bitmap must keep its slot");
+      } else {
+        ok = check(quad.sy >= result.dirtyTop && quad.sy + quad.h <= result.dirtyBottom, "a new slot must be dirty");
+      }
+    }
+    ok = ok && check(noneOverlap(quads), "slots must not overlap");
+    lastSlots = slots;
+    lastLayoutId = result.layoutId;
+  }
+  ass_pack_cache_free(cache);
+  return ok;
+}
+
+}  // namespace
+
+int main() {
+  struct TestCase {
+    const char* name;
+    bool (*run)();
+  };
+  const TestCase tests[] = {
+      {"skyline nesting", nestsShortTilesBesideATallOne},
+      {"occupancy", reportsOccupancyOfThePackedRows},
+      {"page runs", splitsRunsAcrossPagesInPainterOrder},
+      {"random frames", randomFramesPackWithinTheirPages},
+      {"persistent slots", keepsSlotsOfUnchangedBitmaps},
+      {"persistent repack", repacksAFullPageFromTheTop},
+      {"layout ids", layoutIdsAreUniqueAcrossCaches},
+      {"persistent upload contract", randomFramesKeepTheUploadContract},
+  };
+
+  for (const TestCase& test : tests) {
+    if (!test.run()) {
+      std::fprintf(stderr, "FAILED: %s\n", test.name);
+      return 1;
+    }
+  }
+  std::printf("Passed %zu ass_pack tests\n", sizeof(tests) / sizeof(tests[0]));
+  return 0;
+}
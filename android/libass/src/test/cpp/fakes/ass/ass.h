@@ -0,0 +1,24 @@
+#pragma once
+
+#include <stdint.h>
+
+// The slice of libass's public structs that AssIndex.c and AssPack.c read.
+
+typedef struct ass_event {
+  long long Start;     // ms
+  long long Duration;  // ms
+} ASS_Event;
+
+typedef struct ass_track {
+  int n_events;
+  ASS_Event* events;
+} ASS_Track;
+
+typedef struct ass_image {
+  int w, h;
+  int stride;
+  unsigned char* bitmap;
+  uint32_t color;  // RGBA, alpha as transparency
+  int dst_x, dst_y;
+  struct ass_image* next;
+} ASS_Image;
@@ -401,4 +401,104 @@ class SpecRenderEngineTest {
     val expected = (0 until 3).first { it != posted && it != h.glTaken }
     assertEquals(expected, write!!.slot)
   }
+
+  @Test
+  fun `slow render speculates several frames ahead and holds until it`() {
+    val h = Harness()
+    val last = h.prime()
+
+    // A 100 ms render against 42 ms frames: three frames of lead.
+    h.script.add(changed())
+    assertNotNull(h.engine.speculateAfter(last, pinned = true, hasPending = false, renderCostMs = 100))
+    assertEquals((last + 3 * DELTA) / 1000, h.calls.last().timeMs)
+
+    val before = h.calls.size
+    for (step in 1..2) {
+      val pts = last + step * DELTA
+      assertEquals(SpecRenderEngine.Outcome.Skip, h.engine.service(pts, pinned = true))
+      assertNull(h.engine.speculateAfter(pts, pinned = true, hasPending = false, renderCostMs = 100))
+    }
+    assertEquals("held requests must not render", before, h.calls.size)
+    assertEquals(2L, h.engine.specHeld)
+
+    val outcome = h.engine.service(last + 3 * DELTA, pinned = true) as SpecRenderEngine.Outcome.Post
+    assertTrue(outcome.specHit)
+    assertEquals(before, h.calls.size)
+  }
+
+  @Test
+  fun `static screen speculates the frame at the next event boundary`() {
+    val h = Harness()
+    val last = h.prime()
+    h.script.add(unchanged())
+    h.engine.speculateAfter(last, pinned = true, hasPending = false)
+    assertTrue((h.engine.service(last + DELTA, pinned = true) as SpecRenderEngine.Outcome.Post).specHit)
+
+    // A sign starts 100 ms on: the third request from here is the first to show it.
+    val now = last + DELTA
+    h.script.add(changed())
+    val write = h.engine.speculateAfter(now, pinned = true, hasPending = false, nextChangeMs = now / 1000 + 100)
+    assertNotNull(write)
+    assertEquals((now + 3 * DELTA) / 1000, h.calls.last().timeMs)
+
+    // Requests before it render on demand around the spec slot and keep the spec.
+    for (step in 1..2) {
+      val pts = now + step * DELTA
+      h.script.add(changed())
+      val outcome = h.engine.service(pts, pinned = true) as SpecRenderEngine.Outcome.Post
+      assertFalse(outcome.specHit)
+      assertTrue("on-demand render must not overwrite the spec slot", outcome.slot != write!!.slot)
+      assertNull(h.engine.speculateAfter(pts, pinned = true, hasPending = false))
+    }
+    assertEquals(0L, h.engine.specMisses)
+
+    val hit = h.engine.service(now + 3 * DELTA, pinned = true) as SpecRenderEngine.Outcome.Post
+    assertTrue(hit.specHit)
+    assertEquals(write!!.slot, hit.slot)
+  }
+
+  @Test
+  fun `short of spec with every other slot taken drops the spec instead of skipping`() {
+    val h = Harness()
+    val last = h.prime()
+    h.script.add(unchanged())
+    h.engine.speculateAfter(last, pinned = true, hasPending = false)
+    val posted = (h.engine.service(last + DELTA, pinned = true) as SpecRenderEngine.Outcome.Post).slot
+
+    val now = last + DELTA
+    h.script.add(changed())
+    val write = h.engine.speculateAfter(now, pinned = true, hasPending = false, nextChangeMs = now / 1000 + 100)!!
+    // GL still reads the third slot: posted, taken and held are all different.
+    h.glTaken = (0 until 3).first { it != posted && it != write.slot }
+
+    h.script.add(changed())
+    val outcome = h.engine.service(now + DELTA, pinned = true)
+    assertTrue("a request must not be skipped for want of a slot", outcome is SpecRenderEngine.Outcome.Post)
+    outcome as SpecRenderEngine.Outcome.Post
+    assertTrue(outcome.newContent)
+    assertEquals("the dropped spec's slot is the only one left", write.slot, outcome.slot)
+
+    // The spec is gone: its frame renders on demand rather than posting overwritten content.
+    val before = h.calls.size
+    h.script.add(changed())
+    val next = h.engine.service(now + 3 * DELTA, pinned = true) as SpecRenderEngine.Outcome.Post
+    assertFalse(next.specHit)
+    assertEquals(before + 1, h.calls.size)
+  }
+
+  @Test
+  fun `lookahead follows the wall time between requests`() {
+    // 2x playback: 42 ms of video every 21 ms of vsyncs.
+    val h = Harness()
+    var pts = 0L
+    repeat(6) { i ->
+      pts = i * DELTA
+      h.engine.service(pts, pinned = true, releaseNs = i * 21_000_000L)
+    }
+
+    // 30 ms is under a 42 ms PTS step but over the 21 ms it really lasts.
+    h.script.add(changed())
+    h.engine.speculateAfter(pts, pinned = true, hasPending = false, renderCostMs = 30)
+    assertEquals((pts + 2 * DELTA) / 1000, h.calls.last().timeMs)
+  }
 }
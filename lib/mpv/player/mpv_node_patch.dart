@@ -0,0 +1,102 @@
+/// Applies the patches a native side sends for a node property observed with
+/// `patch: true`, in place of the property's whole value.
+///
+/// A patch is a list of ops, each a list led by its kind: `[0, path, value]`
+/// sets the value at `path` (an index one past the end of a list appends),
+/// `[1, path]` removes a map key, and `[2, path, length]` truncates the list at
+/// `path`. A path lists the map keys and list indices from the root.
+///
+/// The base is left untouched, since listeners may still hold it: the
+/// containers along each path are copied once per patch and the rest is
+/// shared. Anything that does not fit the base throws a [FormatException], and
+/// the caller is expected to ask for the whole value again.
+abstract final class MpvNodePatch {
+  static const _set = 0;
+  static const _remove = 1;
+  static const _truncate = 2;
+
+  static Object? apply(Object? base, Object? ops) {
+    if (ops is! List) throw FormatException('Node patch is not a list', ops);
+    final copied = Set<Object>.identity();
+    var result = base;
+    for (final op in ops) {
+      result = _applyOp(result, op, copied);
+    }
+    return result;
+  }
+
+  static Object? _applyOp(Object? root, Object? op, Set<Object> copied) {
+    if (op is! List || op.length < 2) throw FormatException('Malformed node patch op', op);
+    final kind = op[0];
+    final path = op[1];
+    if (path is! List || op.length != (kind == _remove ? 2 : 3)) {
+      throw FormatException('Malformed node patch op', op);
+    }
+    if (kind == _set && path.isEmpty) return op[2];
+
+    // Set and remove address an entry of the last container; truncate
+    // addresses the container itself.
+    final depth = kind == _truncate ? path.length : path.length - 1;
+    final result = _own(root, copied);
+    var container = result;
+    for (var i = 0; i < depth; i++) {
+      final child = _own(_child(container, path[i], op), copied);
+      _assign(container, path[i], child, op);
+      container = child;
+    }
+
+    switch (kind) {
+      case _set:
+        _assign(container, path.last, op[2], op);
+      case _remove:
+        final key = path.last;
+        if (container is! Map || key is! String) throw FormatException('Node patch removes from a non-map', op);
+        container.remove(key);
+      case _truncate:
+        final length = op[2];
+        if (container is! List || length is! int || length < 0 || length > container.length) {
+          throw FormatException('Node patch truncates a non-list', op);
+        }
+        container.length = length;
+      default:
+        throw FormatException('Unknown node patch op', op);
+    }
+    return result;
+  }
+
+  static Object? _own(Object? node, Set<Object> copied) {
+    if (node == null || copied.contains(node)) return node;
+    final Object copy;
+    if (node is List) {
+      copy = List<Object?>.of(node);
+    } else if (node is Map) {
+      copy = Map<Object?, Object?>.of(node);
+    } else {
+      return node;
+    }
+    copied.add(copy);
+    return copy;
+  }
+
+  static Object? _child(Object? container, Object? step, List op) {
+    if (container is List && step is int && step >= 0 && step < container.length) return container[step];
+    if (container is Map && step is String && container.containsKey(step)) return container[step];
+    throw FormatException('Node patch path does not match the base', op);
+  }
+
+  static void _assign(Object? container, Object? step, Object? value, List op) {
+    if (container is List && step is int && step >= 0 && step <= container.length) {
+      if (step == container.length) {
+        container.add(value);
+      } else {
+        container[step] = value;
+      }
+      return;
+    }
+    if (container is Map && step is String) {
+      container[step] = value;
+      return;
+    }
+    throw FormatException('Node patch path does not match the base', op);
+  }
+}
@@ -11,6 +11,7 @@ import '../../utils/track_label_builder.dart';
 import '../font_loader.dart';
 import '../models.dart';
 import 'mpv_node_decoder.dart';
+import 'mpv_node_patch.dart';
 import 'audio_rendering_mode.dart';
 import 'player.dart';
 import 'player_state.dart';
@@ -158,6 +159,11 @@ abstract class PlayerBase with PlayerStreamControllersMixin implements Player {
   Duration? _timelineDuration;
   int _nextPropId = 0;
   final Map<int, String> _propIdToName = {};
+  // Patch-mode observations: the last whole value of each, which the next
+  // patch applies to, and those whose whole value has been asked for again.
+  final Set<int> _patchedPropIds = {};
+  final Map<int, Object?> _patchBases = {};
+  final Set<int> _resyncingPropIds = {};
   Map<String, List<SubtitleTrack>> _externalSubtitleMetadataByUri = const {};
   bool _primaryMediaLoadStarted = false;
   bool _primaryMediaReadyEmitted = false;
@@ -270,33 +276,104 @@ abstract class PlayerBase with PlayerStreamControllersMixin implements Player {
   /// Register [corePropertyObservations] plus `track-list` in the
   /// backend's preferred format. Called from each subclass's initialize.
   @protected
-  Future<void> observeCoreProperties({required String trackListFormat}) async {
+  Future<void> observeCoreProperties({required String trackListFormat, bool patchTrackList = false}) async {
     for (final (name, format) in corePropertyObservations) {
       await observeProperty(name, format);
     }
-    await observeProperty('track-list', trackListFormat);
+    await observeProperty('track-list', trackListFormat, patch: patchTrackList);
   }
 
+  /// [minIntervalMs] lets a native side that batches property changes hold
+  /// this property to at most one delivery per interval (its last value still
+  /// arrives). Backends that do not batch ignore it.
+  ///
+  /// [patch] lets a native side send a `node` property's changes as patches
+  /// against the value it last sent (see [MpvNodePatch]); listeners still see
+  /// whole values. Backends that do not patch ignore it.
   @protected
-  Future<void> observeProperty(String name, String format) async {
+  Future<void> observeProperty(String name, String format, {int? minIntervalMs, bool patch = false}) async {
     final propId = _nextPropId++;
     _propIdToName[propId] = name;
-    await invoke('observeProperty', {'name': name, 'format': format, 'id': propId});
+    if (patch) _patchedPropIds.add(propId);
+    await invoke('observeProperty', {
+      'name': name,
+      'format': format,
+      'id': propId,
+      if (minIntervalMs != null) 'minIntervalMs': minIntervalMs,
+      if (patch) 'patch': true,
+    });
   }
 
+  void _handlePropertyEvent(Object? propertyId, Object? value) {
+    if (propertyId is! int) return;
+    var id = propertyId;
+    if (id < 0) {
+      // A patch, under the property's patch id, against its last value.
+      id = -1 - id;
+      if (!_patchedPropIds.contains(id)) return;
+      if (!_patchBases.containsKey(id)) {
+        _requestPropertyResync(id);
+        return;
+      }
+      try {
+        value = MpvNodePatch.apply(_patchBases[id], value);
+      } on FormatException catch (e) {
+        appLogger.w('MPV: dropping patch for ${_propIdToName[id]}: ${e.message}');
+        _patchBases.remove(id);
+        _requestPropertyResync(id);
+        return;
+      }
+    } else if (_patchedPropIds.contains(id)) {
+      _resyncingPropIds.remove(id);
+    }
+    if (_patchedPropIds.contains(id)) _patchBases[id] = value;
+
+    final name = _propIdToName[id];
+    if (name != null) {
+      handlePropertyChange(name, value);
+    }
+  }
+
+  /// Asks the native side for a patched property's whole value once; patches
+  /// that arrive before it have nothing to apply to and are dropped.
+  void _requestPropertyResync(int id) {
+    if (_disposed || !_resyncingPropIds.add(id)) return;
+    unawaited(
+      invoke('resyncProperty', {'id': id}).catchError((Object e) {
+        appLogger.w('MPV: failed to resync ${_propIdToName[id]}: $e');
+        return null;
+      }),
+    );
+  }
+
+  /// On Linux, property changes - single `[id, value]` pairs and
+  /// `property-batch` maps - skip the native FlEventChannel. The runner
+  /// encodes them itself (StandardMessageWriter in
+  /// shared/mpv/mpv_player_common.h) and posts the bytes on [eventChannel]'s
+  /// name, so this stream's [StandardMethodCodec] decodes them like any other
+  /// event. They must stay a success envelope (a 0 byte, then one value)
+  /// holding only the null, bool, int, double, string, list and map types that
+  /// writer knows. A new property event shape or a different channel codec
+  /// has to be made on both sides. Because these bytes bypass the native
+  /// listen state, they can also arrive with no active stream, and the engine
+  /// drops them.
   void _handleEvent(dynamic event) {
     if (_disposed) return;
     if (event is List && event.length == 2) {
-      final propertyId = event.first;
-      if (propertyId is! int) return;
-      final name = _propIdToName[propertyId];
-      if (name != null) {
-        handlePropertyChange(name, event[1]);
-      }
+      _handlePropertyEvent(event.first, event[1]);
     } else if (event is Map) {
       final type = event['type'];
       final name = event['name'];
-      if (type == 'event' && name is String) {
+      if (type == 'property-batch') {
+        // Flat [id, value, id, value, ...] pairs from a native side that
+        // coalesces each drain of mpv's event queue into one message.
+        final changes = event['changes'];
+        if (changes is! List) return;
+        for (var i = 0; i + 1 < changes.length; i += 2) {
+          if (_disposed) return;
+          _handlePropertyEvent(changes[i], changes[i + 1]);
+        }
+      } else if (type == 'event' && name is String) {
         final rawData = event['data'];
         handlePlayerEvent(name, rawData is Map ? rawData : null);
       }
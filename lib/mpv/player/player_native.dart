@@ -61,6 +61,18 @@ class PlayerNative extends PlayerBase {
   String? _armedNextUri;
   int? _armedNextFd;
 
+  // The title [preload] queued behind the playing one (video, Linux/Windows).
+  Media? _preloadedMedia;
+
+  /// The Linux runner's last `decode-path` report: the hwdec mode asked for
+  /// (`requested`) and the one mpv is using (`current`), whether the video
+  /// plane's GL context can import hardware frames (`interopAvailable`) or is
+  /// a software renderer (`softwareRenderer`), `decoderDrops` and `voDrops`,
+  /// and how far the fallback ladder has stepped down (`fallbackSteps`). Sent
+  /// on every decoder change and every automatic fallback. Null elsewhere.
+  Map<String, Object?>? get decodePath => _decodePath;
+  Map<String, Object?>? _decodePath;
+
   /// Host tests aren't Android, so the content:// → fdclose:// path would be
   /// unreachable; forces the conversion regardless of platform.
   @visibleForTesting
@@ -77,6 +89,11 @@ class PlayerNative extends PlayerBase {
   /// tests agree on which path is live without reading a test-only field.
   static bool get usesLinuxVideoPlane => debugUseLinuxVideoPlane ?? Platform.isLinux;
 
+  /// Overrides whether node properties are observed in patch mode, which only
+  /// the Linux runner implements.
+  @visibleForTesting
+  static bool? debugPatchNodeProperties;
+
   // Set by open() and consumed by that load's file-loaded event, so it is
   // not mistaken for a gapless advance (see _handleAudioFileLoaded).
   bool _expectOpenFileLoad = false;
@@ -237,10 +254,15 @@ class PlayerNative extends PlayerBase {
       // Subscribe to MPV properties before flipping `initialized` so partial
       // failures don't leave us in a half-initialized state that the memoized
       // future would falsely treat as ready.
-      await observeCoreProperties(trackListFormat: _nodeFormat);
+      // Linux can send these as patches: a track switch flips a flag or two
+      // in an otherwise unchanged track-list.
+      final patchNodes = debugPatchNodeProperties ?? Platform.isLinux;
+      await observeCoreProperties(trackListFormat: _nodeFormat, patchTrackList: patchNodes);
       await observeProperty('secondary-sid', 'string');
-      await observeProperty('demuxer-cache-state', _nodeFormat);
-      await observeProperty('audio-device-list', _nodeFormat);
+      // Its consumers throttle to 250 ms anyway, so a batching native side
+      // need not send it any faster.
+      await observeProperty('demuxer-cache-state', _nodeFormat, minIntervalMs: 250, patch: patchNodes);
+      await observeProperty('audio-device-list', _nodeFormat, patch: patchNodes);
       await observeProperty('audio-device', 'string');
 
       if (audioOnly) {
@@ -264,6 +286,12 @@ class PlayerNative extends PlayerBase {
         }
       }
 
+      // The Linux and Windows runners can coalesce each drain of mpv's event
+      // queue into a single channel message; PlayerBase unpacks the batches.
+      if (Platform.isLinux || Platform.isWindows) {
+        await invoke('setPropertyBatching', {'enabled': true});
+      }
+
       if (_nativeCoreUnavailable) throw StateError('Player was disposed during initialization');
       initialized = true;
     } catch (e) {
@@ -330,6 +358,8 @@ class PlayerNative extends PlayerBase {
     // gapless entry armed via setNext — settle its content-fd claim first.
     // No transition is surfaced: the caller is replacing playback anyway.
     await _clearArmedNext(adoptIfRolledIn: false);
+    // The replace drops a preloaded title along with the rest of the playlist.
+    _preloadedMedia = null;
     final startPosition = media.start ?? Duration.zero;
     configureTimeline(duration: timelineDuration);
     clearTracks();
@@ -592,9 +622,79 @@ class PlayerNative extends PlayerBase {
   @override
   void handlePlayerEvent(String name, Map? data) {
     if (audioOnly && name == 'file-loaded') _handleAudioFileLoaded();
+    if (name == 'preload') _handlePreloadEvent(data);
+    if (name == 'decode-path') _handleDecodePathEvent(data);
     super.handlePlayerEvent(name, data);
   }
 
+  /// Queues [media] behind the playing title on Linux and Windows, so mpv
+  /// opens its stream and demuxer while the current one still plays and the
+  /// episode boundary skips the cold open. Replaces any title queued before.
+  /// The switch happens on [promote], or on its own when the current title
+  /// plays to its end; either surfaces [media]'s URI on the track-transition
+  /// stream. Video players only: the audio player has [setNext].
+  Future<void> preload(Media media) async {
+    if (_nativeCoreUnavailable || audioOnly || !(Platform.isLinux || Platform.isWindows) || !initialized) return;
+    final options = <String>[];
+    final start = media.start;
+    if (start != null && start > Duration.zero) options.add('start=${start.inMilliseconds / 1000.0}');
+    final headerOption = _httpHeaderFieldsLoadfileOption(media.headers);
+    if (headerOption != null) options.add(headerOption);
+    _preloadedMedia = media;
+    try {
+      await invoke('preload', {'url': media.uri, 'options': options.join(',')});
+    } catch (_) {
+      if (identical(_preloadedMedia, media)) _preloadedMedia = null;
+      rethrow;
+    }
+  }
+
+  /// Switches to the title [preload] queued. False when none is queued.
+  Future<bool> promote() async {
+    if (_nativeCoreUnavailable || _preloadedMedia == null) return false;
+    try {
+      await invoke('promote');
+      return true;
+    } on PlatformException catch (e) {
+      if (e.code == 'NO_PRELOAD') return false;
+      rethrow;
+    }
+  }
+
+  /// A preloaded title became the playing one, or could not be opened. The
+  /// promotion installs it the way [open] would have, minus the open.
+  void _handlePreloadEvent(Map? data) {
+    final state = data?['state'];
+    final url = data?['url'];
+    final media = _preloadedMedia;
+    if (media == null || url is! String || url != media.uri) return;
+    if (state == 'failed') {
+      appLogger.w('$logPrefix: preload failed for ${_uriTail(url)}: ${data?['message']}');
+      _preloadedMedia = null;
+    } else if (state == 'promoted') {
+      _preloadedMedia = null;
+      configureTimeline();
+      clearTracks();
+      setExternalSubtitleMetadata(null);
+      resetPlaybackProgress(media.start ?? Duration.zero);
+      setSeekable(false);
+      trackTransitionController.add(url);
+    }
+  }
+
+  void _handleDecodePathEvent(Map? data) {
+    if (data == null) return;
+    _decodePath = data.cast<String, Object?>();
+    final summary =
+        'hwdec ${data['requested']} -> ${data['current']} (interop=${data['interopAvailable']}, '
+        'software GL=${data['softwareRenderer']}, decoder drops=${data['decoderDrops']}, vo drops=${data['voDrops']})';
+    if (data['cause'] == 'fallback') {
+      appLogger.w('$logPrefix: decoder cannot keep up, stepping hwdec down: $summary');
+    } else {
+      appLogger.d('$logPrefix: decode path $summary');
+    }
+  }
+
   /// Gapless auto-advance detection: a `file-loaded` that open() didn't
   /// produce while an entry is armed means mpv rolled into the armed entry.
   /// Surface the transition, then rebase the playlist so the now playing
@@ -845,6 +945,122 @@ class PlayerNative extends PlayerBase {
     await invoke('setLogLevel', {'level': level});
   }
 
+  /// The desktop event loop's latency histograms: wakeup-to-dispatch, events
+  /// per drain, time in each event's handler and async reply round trips, each
+  /// as count/sum/max, p50/p90/p99 and log2 buckets, in microseconds. Null on
+  /// the platforms that do not record them. [reset] starts them over.
+  Future<Map<String, Object?>?> getEventLoopStats({bool reset = false}) async {
+    if (_nativeCoreUnavailable || !(Platform.isLinux || Platform.isWindows)) return null;
+    await _ensureInitialized();
+    final stats = await invoke<Map<Object?, Object?>>('getEventLoopStats', {'reset': reset});
+    return stats?.cast<String, Object?>();
+  }
+
+  /// Has the desktop event loop log its percentiles every [interval] there
+  /// were events, as `event-loop` log messages. Null stops it.
+  Future<void> setEventLoopStatsLogInterval(Duration? interval) async {
+    if (_nativeCoreUnavailable || !(Platform.isLinux || Platform.isWindows)) return;
+    await _ensureInitialized();
+    await invoke('setEventLoopStatsLogInterval', {'intervalMs': interval?.inMilliseconds ?? 0});
+  }
+
+  /// What the Linux runner's native teardown thread is still holding: pending
+  /// batches, the mpv cores and EGL contexts they retain, the oldest one's age,
+  /// retry attempts, and how many it released and the slowest release. The
+  /// queue is process-wide, so this outlives any one player. Null elsewhere.
+  Future<Map<String, Object?>?> getTeardownStats() async {
+    if (_nativeCoreUnavailable || !usesLinuxVideoPlane) return null;
+    final stats = await invoke<Map<Object?, Object?>>('getTeardownStats');
+    return stats?.cast<String, Object?>();
+  }
+
+  /// How often the Linux video plane found the HDR decision it was asked for
+  /// already in force and skipped the colour transaction (`hits`), and how
+  /// often it had to run one (`misses`). Null elsewhere.
+  Future<Map<String, Object?>?> getHdrDecisionStats() async {
+    if (_nativeCoreUnavailable || audioOnly || !usesLinuxVideoPlane) return null;
+    final stats = await invoke<Map<Object?, Object?>>('getHdrDecisionStats');
+    return stats?.cast<String, Object?>();
+  }
+
+  /// How the Linux teardown thread retries a batch it could not release:
+  /// every 100 ms (the default), or with [backoff] doubling up to 10 s and
+  /// starting over whenever new work arrives. Process-wide.
+  Future<void> setTeardownRetryBackoff(bool backoff) async {
+    if (_nativeCoreUnavailable || !usesLinuxVideoPlane) return;
+    await invoke('setTeardownRetryPolicy', {'policy': backoff ? 'backoff' : 'fixed'});
+  }
+
+  /// Whether the Linux runner steps hwdec down on its own (zero-copy, then
+  /// copy-back, then software) when playback drops frames. On by default;
+  /// turning it off restores the mode last set through `hwdec`.
+  Future<void> setHwdecFallback(bool enabled) async {
+    if (_nativeCoreUnavailable || audioOnly || !usesLinuxVideoPlane) return;
+    await _ensureInitialized();
+    await invoke('setHwdecFallback', {'enabled': enabled});
+  }
+
+  /// Runs the Linux video plane at 8 bits per channel for 8-bit SDR sources
+  /// and at its deep config for HDR and deeper sources, switching at file
+  /// boundaries. Needs EGL_KHR_no_config_context, and applies to planes
+  /// created after the first call; other planes keep the depth they were
+  /// created at. Off by default.
+  Future<void> setPlaneFormatPerSource(bool perSource) async {
+    if (_nativeCoreUnavailable || audioOnly || !usesLinuxVideoPlane) return;
+    await invoke('setPlaneFormatMode', {'mode': perSource ? 'per-source' : 'fixed'});
+  }
+
+  /// Frame pacing on the Linux video plane over its last 240 presented frames:
+  /// counters for skipped, discarded and unacknowledged frames, and render
+  /// cost, mpv-update-to-render, swap, frame-callback latency and the present
+  /// and content intervals, in microseconds. [samples] adds the raw per-frame
+  /// timestamps. Null without a Linux video plane.
+  Future<Map<String, Object?>?> getFramePacingStats({bool reset = false, bool samples = false}) async {
+    if (_nativeCoreUnavailable || audioOnly || !usesLinuxVideoPlane) return null;
+    await _ensureInitialized();
+    final stats = await invoke<Map<Object?, Object?>>('getFramePacingStats', {'reset': reset, 'samples': samples});
+    return stats?.cast<String, Object?>();
+  }
+
+  /// Has the Linux video plane log a frame-pacing summary every [interval] it
+  /// presented anything, as `frame-pacing` log messages. Null stops it.
+  Future<void> setFramePacingLogInterval(Duration? interval) async {
+    if (_nativeCoreUnavailable || audioOnly || !usesLinuxVideoPlane) return;
+    await _ensureInitialized();
+    await invoke('setFramePacingLogInterval', {'intervalMs': interval?.inMilliseconds ?? 0});
+  }
+
+  /// Times each render on the Linux video plane to the vblank its frame is
+  /// meant for, from the compositor's presentation feedback, instead of
+  /// rendering as soon as mpv has the frame. Falls back to the latter where
+  /// the compositor gives no fixed-rate timing. Off by default.
+  Future<void> setDisplaySyncedRendering(bool enabled) async {
+    if (_nativeCoreUnavailable || audioOnly || !usesLinuxVideoPlane) return;
+    await _ensureInitialized();
+    await invoke('setRenderScheduling', {'mode': enabled ? 'display' : 'immediate'});
+  }
+
+  /// Renders the Linux video plane on a dedicated thread that owns its EGL
+  /// context, so a heavy render no longer blocks the UI and UI work no longer
+  /// delays frames. Geometry, visibility and HDR changes still come from the
+  /// main thread, which waits for an in-flight frame before applying them.
+  /// Off by default.
+  Future<void> setVideoRenderThread(bool enabled) async {
+    if (_nativeCoreUnavailable || audioOnly || !usesLinuxVideoPlane) return;
+    await _ensureInitialized();
+    await invoke('setRenderThread', {'enabled': enabled});
+  }
+
+  /// Keeps one initialised mpv core warming in the background on Linux and
+  /// Windows, so the next initialize claims it instead of creating a core on
+  /// the spot; refilled after each claim and each dispose. The setting belongs
+  /// to the native channel, not this player, and holds until turned off. Off
+  /// by default.
+  Future<void> setStandbyCore(bool enabled) async {
+    if (_nativeCoreUnavailable || !(Platform.isLinux || Platform.isWindows)) return;
+    await invoke('setStandbyCore', {'enabled': enabled});
+  }
+
   @override
   Future<bool> setVisible(bool visible, {bool restoreOnWindowVisible = false}) async {
     if (_nativeCoreUnavailable) return false;
@@ -0,0 +1,114 @@
+#ifndef PLEZY_LINUX_MPV_DISPLAY_SYNC_H_
+#define PLEZY_LINUX_MPV_DISPLAY_SYNC_H_
+
+#include <cstdint>
+
+// When to render the video plane's next frame so it lands on a chosen refresh,
+// from the compositor's presentation feedback.
+//
+// wp_presentation reports, for each presented buffer, the time the refresh that
+// showed it started and the output's refresh period. Those two numbers place
+// every later vblank; a render started one render-cost plus a compositor margin
+// ahead of one of them is the latest start that still makes it, and the latest
+// start is what keeps the picture as fresh as possible without missing.
+//
+// This header is deliberately free of Wayland and GTK, like the other pure
+// headers beside it: times are plain microseconds on CLOCK_MONOTONIC, which is
+// both g_get_monotonic_time()'s clock and the presentation clock the surface
+// insists on before it feeds anything in.
+
+namespace mpv {
+
+class DisplaySyncScheduler {
+ public:
+  // Time the compositor needs between a commit and the vblank it is latched
+  // for. Compositors repaint a few milliseconds ahead of the flip (mutter and
+  // KWin both aim for about that much, adjusting for their own render time),
+  // so a buffer committed later than this is shown a refresh late.
+  static constexpr int64_t kCompositorMarginUs = 3000;
+  // The render-cost estimate decays by 1/kCostDecay of itself per frame, so a
+  // single slow frame raises it at once and it takes a few dozen fast ones to
+  // come back down: a late start costs a whole refresh, an early one only a
+  // little freshness.
+  static constexpr int64_t kCostDecay = 16;
+  // A refresh period outside this range is not a fixed-rate output (VRR, or a
+  // compositor reporting 0 for "unknown"), and nothing can be predicted.
+  static constexpr int64_t kMinRefreshUs = 2000;    // 500 Hz
+  static constexpr int64_t kMaxRefreshUs = 100000;  // 10 Hz
+  // How many refreshes past the earliest reachable one a frame may be held for
+  // its target time. mpv only asks for a render when a frame is close to due,
+  // so a target further out than this is stale timing (a seek, a pause), and
+  // waiting on it would freeze the picture instead of pacing it.
+  static constexpr int64_t kMaxHeldRefreshes = 4;
+
+  // One presentation from wp_presentation_feedback.presented. `vsync` is the
+  // VSYNC kind flag: without it the time is not tied to a refresh at all.
+  void OnPresented(int64_t presented_us, int64_t refresh_us, bool vsync) {
+    if (!vsync || refresh_us < kMinRefreshUs || refresh_us > kMaxRefreshUs) {
+      valid_ = false;
+      return;
+    }
+    valid_ = true;
+    vblank_us_ = presented_us;
+    refresh_us_ = refresh_us;
+  }
+
+  void OnRenderCost(int64_t cost_us) {
+    if (cost_us < 0) return;
+    const int64_t decayed = render_cost_us_ - render_cost_us_ / kCostDecay;
+    render_cost_us_ = cost_us > decayed ? cost_us : decayed;
+  }
+
+  void Reset() { *this = DisplaySyncScheduler(); }
+
+  bool has_timing() const { return valid_; }
+
+  // Whether mpv should still wait out each frame's target time itself. Only
+  // display-synced rendering with timing to aim at times the render; without
+  // timing RenderStartFor starts it at once, and a frame would be shown ahead
+  // of its time unless mpv holds it.
+  bool LeavesTimingToMpv(bool display_synced) const { return !display_synced || !valid_; }
+  int64_t refresh_us() const { return refresh_us_; }
+  int64_t render_cost_us() const { return render_cost_us_; }
+
+  // The first predicted vblank at or after `t_us`. Only meaningful with
+  // has_timing().
+  int64_t VblankAtOrAfter(int64_t t_us) const {
+    if (t_us <= vblank_us_) {
+      // Only for a time before the last presentation, which still has an
+      // answer: some whole number of refreshes back.
+      return vblank_us_ - ((vblank_us_ - t_us) / refresh_us_) * refresh_us_;
+    }
+    const int64_t periods = (t_us - vblank_us_ + refresh_us_ - 1) / refresh_us_;
+    return vblank_us_ + periods * refresh_us_;
+  }
+
+  // When to start rendering the next frame. It is aimed at the earliest vblank
+  // the render can still make from `now_us`, and at no vblank earlier than
+  // the one closest to `target_us` - the time mpv wants the frame shown, 0 when
+  // it has none - so a frame is never shown a refresh before its time just
+  // because there was time to spare. Returns `now_us` when there is nothing to
+  // wait for, including when there is no timing to predict from.
+  int64_t RenderStartFor(int64_t now_us, int64_t target_us) const {
+    if (!valid_) return now_us;
+    const int64_t lead = render_cost_us_ + kCompositorMarginUs;
+    int64_t vblank = VblankAtOrAfter(now_us + lead);
+    if (target_us > 0) {
+      const int64_t wanted = VblankAtOrAfter(target_us - refresh_us_ / 2);
+      const int64_t latest = vblank + kMaxHeldRefreshes * refresh_us_;
+      if (wanted > vblank) vblank = wanted < latest ? wanted : latest;
+    }
+    const int64_t start = vblank - lead;
+    return start > now_us ? start : now_us;
+  }
+
+ private:
+  bool valid_ = false;
+  int64_t vblank_us_ = 0;
+  int64_t refresh_us_ = 0;
+  int64_t render_cost_us_ = 0;
+};
+
+}  // namespace mpv
+
+#endif  // PLEZY_LINUX_MPV_DISPLAY_SYNC_H_
@@ -0,0 +1,123 @@
+#include "display_sync.h"
+
+#include <iostream>
+
+namespace {
+
+int failures = 0;
+
+void Expect(bool condition, const char* expression, int line) {
+  if (condition) return;
+  std::cerr << "line " << line << ": check failed: " << expression << '\n';
+  ++failures;
+}
+
+#define EXPECT(condition) Expect(static_cast<bool>(condition), #condition, __LINE__)
+
+constexpr int64_t kRefresh60 = 16667;
+
+mpv::DisplaySyncScheduler Synced(int64_t vblank_us, int64_t refresh_us, int64_t render_cost_us) {
+  mpv::DisplaySyncScheduler scheduler;
+  scheduler.OnPresented(vblank_us, refresh_us, true);
+  scheduler.OnRenderCost(render_cost_us);
+  return scheduler;
+}
+
+// No feedback yet, VRR, a refresh of 0, or a presentation not tied to vsync:
+// there is nothing to aim at, and the render goes out at once, which is what
+// the plane did before it had a scheduler at all.
+void TestWithoutTimingRendersAtOnce() {
+  mpv::DisplaySyncScheduler scheduler;
+  EXPECT(scheduler.RenderStartFor(5000, 0) == 5000);
+  scheduler.OnPresented(1000000, 0, true);
+  EXPECT(!scheduler.has_timing());
+  scheduler.OnPresented(1000000, kRefresh60, false);
+  EXPECT(!scheduler.has_timing());
+  scheduler.OnPresented(1000000, 500000, true);
+  EXPECT(!scheduler.has_timing());
+  EXPECT(scheduler.RenderStartFor(1005000, 0) == 1005000);
+}
+
+// Display-synced rendering only takes the wait for a frame's target time off
+// mpv while it has timing to aim with; before the first presentation, and
+// whenever the timing goes (VRR, a presentation not tied to vsync), mpv keeps
+// holding frames itself or they would be shown as soon as rendered.
+void TestMpvKeepsTheWaitWithoutTiming() {
+  mpv::DisplaySyncScheduler scheduler;
+  EXPECT(scheduler.LeavesTimingToMpv(false));
+  EXPECT(scheduler.LeavesTimingToMpv(true));
+  scheduler.OnPresented(1000000, kRefresh60, true);
+  EXPECT(!scheduler.LeavesTimingToMpv(true));
+  EXPECT(scheduler.LeavesTimingToMpv(false));
+  scheduler.OnPresented(1000000 + kRefresh60, kRefresh60, false);
+  EXPECT(scheduler.LeavesTimingToMpv(true));
+  scheduler.OnPresented(1000000 + 2 * kRefresh60, kRefresh60, true);
+  EXPECT(!scheduler.LeavesTimingToMpv(true));
+  scheduler.Reset();
+  EXPECT(scheduler.LeavesTimingToMpv(true));
+}
+
+void TestVblanksRepeatAtTheRefreshPeriod() {
+  const auto scheduler = Synced(1000000, kRefresh60, 0);
+  EXPECT(scheduler.VblankAtOrAfter(1000000) == 1000000);
+  EXPECT(scheduler.VblankAtOrAfter(1000001) == 1000000 + kRefresh60);
+  EXPECT(scheduler.VblankAtOrAfter(1000000 + 3 * kRefresh60) == 1000000 + 3 * kRefresh60);
+  // Before the anchor, still on the grid and never before the time asked.
+  EXPECT(scheduler.VblankAtOrAfter(1000000 - kRefresh60 - 1) == 1000000 - kRefresh60);
+}
+
+// The render starts as late as it can and still make the next vblank: one
+// render cost plus the compositor margin ahead of it.
+void TestRenderStartsJustInTime() {
+  const auto scheduler = Synced(1000000, kRefresh60, 4000);
+  const int64_t lead = 4000 + mpv::DisplaySyncScheduler::kCompositorMarginUs;
+  const int64_t now = 1000000 + 1000;
+  EXPECT(scheduler.RenderStartFor(now, 0) == 1000000 + kRefresh60 - lead);
+  // Too late for that one: aim at the next, rather than start now and miss.
+  const int64_t late = 1000000 + kRefresh60 - lead + 1;
+  EXPECT(scheduler.RenderStartFor(late, 0) == 1000000 + 2 * kRefresh60 - lead);
+}
+
+// mpv's target time picks the vblank nearest it, so a 24p frame is held for
+// the refresh it belongs on rather than shown one early - but never for more
+// than a few refreshes, whatever the target says.
+void TestTargetTimeHoldsTheFrameForItsRefresh() {
+  const auto scheduler = Synced(1000000, kRefresh60, 2000);
+  const int64_t lead = 2000 + mpv::DisplaySyncScheduler::kCompositorMarginUs;
+  const int64_t now = 1000000 + 1000;
+  const int64_t third = 1000000 + 3 * kRefresh60;
+  EXPECT(scheduler.RenderStartFor(now, third - 5000) == third - lead);
+  EXPECT(scheduler.RenderStartFor(now, third + 5000) == third - lead);
+  // A target already past only means "as soon as possible".
+  EXPECT(scheduler.RenderStartFor(now, 900000) == 1000000 + kRefresh60 - lead);
+  const int64_t cap = 1000000 + (1 + mpv::DisplaySyncScheduler::kMaxHeldRefreshes) * kRefresh60;
+  EXPECT(scheduler.RenderStartFor(now, 1000000 + 60 * kRefresh60) == cap - lead);
+}
+
+// One slow frame raises the estimate at once; fast frames bring it down only
+// gradually.
+void TestRenderCostRisesFastAndDecaysSlowly() {
+  mpv::DisplaySyncScheduler scheduler;
+  scheduler.OnRenderCost(1600);
+  EXPECT(scheduler.render_cost_us() == 1600);
+  scheduler.OnRenderCost(8000);
+  EXPECT(scheduler.render_cost_us() == 8000);
+  scheduler.OnRenderCost(100);
+  EXPECT(scheduler.render_cost_us() == 7500);
+  scheduler.OnRenderCost(-5);
+  EXPECT(scheduler.render_cost_us() == 7500);
+  for (int i = 0; i < 200; ++i) scheduler.OnRenderCost(100);
+  EXPECT(scheduler.render_cost_us() < 200);
+}
+
+}  // namespace
+
+int main() {
+  TestWithoutTimingRendersAtOnce();
+  TestMpvKeepsTheWaitWithoutTiming();
+  TestVblanksRepeatAtTheRefreshPeriod();
+  TestRenderStartsJustInTime();
+  TestTargetTimeHoldsTheFrameForItsRefresh();
+  TestRenderCostRisesFastAndDecaysSlowly();
+  return failures == 0 ? 0 : 1;
+}
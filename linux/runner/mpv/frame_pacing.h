@@ -0,0 +1,261 @@
+#ifndef PLEZY_LINUX_MPV_FRAME_PACING_H_
+#define PLEZY_LINUX_MPV_FRAME_PACING_H_
+
+#include <algorithm>
+#include <array>
+#include <cmath>
+#include <cstddef>
+#include <cstdint>
+#include <cstdio>
+#include <string>
+#include <vector>
+
+// Per-frame timestamps for the Wayland video plane, and what they add up to.
+//
+// Each presented frame leaves one sample: when mpv said the frame existed, when
+// the render started and finished, when eglSwapBuffers returned, and when the
+// compositor's frame callback came back for it. Judder on 24p content at 60 or
+// 120 Hz shows up as a present interval that does not follow the content's,
+// and these are the numbers that tell a slow render from a late callback from
+// a skipped one.
+//
+// This header is deliberately free of Wayland and GTK, like the other pure
+// headers beside it: the plane feeds it g_get_monotonic_time() and the
+// compositor's own timestamp, and the arithmetic can be tested without either.
+// Everything runs on the GTK main thread, so there is no locking.
+
+namespace mpv {
+
+struct FramePacingSample {
+  // When mpv's render update flipped the redraw latch, or 0 when the render
+  // was forced (a resize, a colour commit) with no new mpv frame behind it.
+  int64_t mpv_update_us = 0;
+  int64_t render_start_us = 0;
+  int64_t render_end_us = 0;
+  int64_t swap_us = 0;
+  // 0 until the compositor acknowledges the frame, and for good when it never
+  // does (see FramePacingLog::FrameAckMissed).
+  int64_t frame_done_us = 0;
+  // The compositor's own timestamp from wl_callback.done, in milliseconds with
+  // an undefined base. Only its differences mean anything.
+  uint32_t compositor_time_ms = 0;
+  bool forced = false;
+};
+
+// Percentiles over one derived quantity in the current window, in
+// microseconds. `count` is how many samples had the quantity at all.
+struct FramePacingDistribution {
+  size_t count = 0;
+  int64_t mean = 0;
+  int64_t stddev = 0;
+  int64_t p50 = 0;
+  int64_t p90 = 0;
+  int64_t p99 = 0;
+  int64_t max = 0;
+};
+
+struct FramePacingSummary {
+  // Samples in the window, at most FramePacingLog::kCapacity.
+  size_t frames = 0;
+
+  // Counts since the last Reset, not just over the window.
+  uint64_t presented = 0;
+  uint64_t forced = 0;
+  // Render requests that had something to draw - a new mpv frame or an owed
+  // refresh - but found the previous frame still unacknowledged, and so did
+  // nothing. A steady trickle is normal at content rates above the output's; a
+  // burst is the plane waiting on the compositor.
+  uint64_t skipped_frame_pending = 0;
+  // Renders that never reached the screen: the swap failed, or Present() was
+  // held after the render had already run.
+  uint64_t discarded = 0;
+  uint64_t swap_failures = 0;
+  // Frame callbacks the acknowledgement watchdog gave up on.
+  uint64_t ack_misses = 0;
+
+  FramePacingDistribution render_us;            // render start to end
+  FramePacingDistribution update_to_render_us;  // mpv update to render start
+  FramePacingDistribution swap_us;              // render end to swap returning
+  FramePacingDistribution callback_latency_us;  // swap to frame callback
+  FramePacingDistribution present_interval_us;  // swap to the next swap
+  FramePacingDistribution content_interval_us;  // mpv update to the next one
+};
+
+// Nearest-rank percentiles over the exact values; the window is small enough.
+// Sorts `values` in place.
+inline FramePacingDistribution SummarizeFramePacing(std::vector<int64_t>* values) {
+  FramePacingDistribution out;
+  if (values->empty()) return out;
+  std::sort(values->begin(), values->end());
+  out.count = values->size();
+  double sum = 0.0;
+  for (int64_t value : *values) sum += static_cast<double>(value);
+  const double mean = sum / static_cast<double>(out.count);
+  double squares = 0.0;
+  for (int64_t value : *values) {
+    const double delta = static_cast<double>(value) - mean;
+    squares += delta * delta;
+  }
+  out.mean = static_cast<int64_t>(std::llround(mean));
+  out.stddev = static_cast<int64_t>(std::llround(std::sqrt(squares / static_cast<double>(out.count))));
+  auto rank = [&](double q) {
+    size_t index = static_cast<size_t>(std::ceil(q * static_cast<double>(out.count)));
+    index = index == 0 ? 0 : index - 1;
+    return (*values)[std::min(index, out.count - 1)];
+  };
+  out.p50 = rank(0.50);
+  out.p90 = rank(0.90);
+  out.p99 = rank(0.99);
+  out.max = values->back();
+  return out;
+}
+
+// A ring of the last kCapacity presented frames plus counters.
+//
+// The plane drives it in order: RenderStarted and RenderFinished around the
+// render, then Presented or PresentFailed, then FrameDone when the callback
+// arrives. A render that is started over before it was presented counts as
+// discarded, so a caller that bails between the render and the swap needs no
+// cleanup of its own.
+class FramePacingLog {
+ public:
+  // Two seconds at 120 Hz, and ten of 24p.
+  static constexpr size_t kCapacity = 240;
+
+  void RenderStarted(int64_t now_us, int64_t mpv_update_us, bool forced) {
+    if (open_) ++discarded_;
+    open_ = true;
+    open_sample_ = FramePacingSample();
+    open_sample_.mpv_update_us = mpv_update_us;
+    open_sample_.render_start_us = now_us;
+    open_sample_.render_end_us = now_us;
+    open_sample_.forced = forced;
+  }
+
+  void RenderFinished(int64_t now_us) {
+    if (open_) open_sample_.render_end_us = now_us;
+  }
+
+  // A present with no render in front of it has nothing to time and is not
+  // recorded.
+  void Presented(int64_t now_us) {
+    if (!open_) return;
+    open_ = false;
+    open_sample_.swap_us = now_us;
+    ring_[next_] = open_sample_;
+    next_ = (next_ + 1) % kCapacity;
+    if (size_ < kCapacity) ++size_;
+    ++presented_;
+    if (open_sample_.forced) ++forced_;
+  }
+
+  void PresentFailed(bool swap_failed) {
+    if (swap_failed) ++swap_failures_;
+    if (!open_) return;
+    open_ = false;
+    ++discarded_;
+  }
+
+  // Belongs to the newest frame: the plane never presents over an
+  // unacknowledged one, so there is no older frame it could be for.
+  void FrameDone(int64_t now_us, uint32_t compositor_time_ms) {
+    if (size_ == 0) return;
+    FramePacingSample& newest = ring_[(next_ + kCapacity - 1) % kCapacity];
+    if (newest.frame_done_us != 0) return;
+    newest.frame_done_us = now_us;
+    newest.compositor_time_ms = compositor_time_ms;
+  }
+
+  void FrameAckMissed() { ++ack_misses_; }
+  void RenderSkippedFramePending() { ++skipped_frame_pending_; }
+
+  void Reset() { *this = FramePacingLog(); }
+
+  size_t size() const { return size_; }
+  uint64_t presented() const { return presented_; }
+
+  // Oldest first.
+  const FramePacingSample& at(size_t index) const {
+    return ring_[(next_ + kCapacity - size_ + index) % kCapacity];
+  }
+
+  FramePacingSummary Summarize() const {
+    FramePacingSummary summary;
+    summary.frames = size_;
+    summary.presented = presented_;
+    summary.forced = forced_;
+    summary.skipped_frame_pending = skipped_frame_pending_;
+    summary.discarded = discarded_;
+    summary.swap_failures = swap_failures_;
+    summary.ack_misses = ack_misses_;
+
+    std::vector<int64_t> render, update_to_render, swap, callback, present, content;
+    const FramePacingSample* previous = nullptr;
+    int64_t previous_update_us = 0;
+    for (size_t i = 0; i < size_; ++i) {
+      const FramePacingSample& sample = at(i);
+      render.push_back(sample.render_end_us - sample.render_start_us);
+      swap.push_back(sample.swap_us - sample.render_end_us);
+      if (sample.mpv_update_us != 0) {
+        update_to_render.push_back(sample.render_start_us - sample.mpv_update_us);
+        if (previous_update_us != 0) content.push_back(sample.mpv_update_us - previous_update_us);
+        previous_update_us = sample.mpv_update_us;
+      }
+      if (sample.frame_done_us != 0) callback.push_back(sample.frame_done_us - sample.swap_us);
+      if (previous != nullptr) present.push_back(sample.swap_us - previous->swap_us);
+      previous = &sample;
+    }
+    summary.render_us = SummarizeFramePacing(&render);
+    summary.update_to_render_us = SummarizeFramePacing(&update_to_render);
+    summary.swap_us = SummarizeFramePacing(&swap);
+    summary.callback_latency_us = SummarizeFramePacing(&callback);
+    summary.present_interval_us = SummarizeFramePacing(&present);
+    summary.content_interval_us = SummarizeFramePacing(&content);
+    return summary;
+  }
+
+ private:
+  std::array<FramePacingSample, kCapacity> ring_{};
+  size_t next_ = 0;
+  size_t size_ = 0;
+  bool open_ = false;
+  FramePacingSample open_sample_;
+
+  uint64_t presented_ = 0;
+  uint64_t forced_ = 0;
+  uint64_t skipped_frame_pending_ = 0;
+  uint64_t discarded_ = 0;
+  uint64_t swap_failures_ = 0;
+  uint64_t ack_misses_ = 0;
+};
+
+// One line for the periodic log: the counters, then p50/p99/max per quantity
+// in milliseconds, which is the unit anyone reading judder thinks in.
+inline std::string FormatFramePacing(const FramePacingSummary& summary) {
+  std::string text;
+  char buffer[160];
+  std::snprintf(
+      buffer, sizeof(buffer), "frames=%zu presented=%llu forced=%llu skipped=%llu discarded=%llu swap-fail=%llu "
+      "ack-miss=%llu", summary.frames, static_cast<unsigned long long>(summary.presented),
+      static_cast<unsigned long long>(summary.forced), static_cast<unsigned long long>(summary.skipped_frame_pending),
+      static_cast<unsigned long long>(summary.discarded), static_cast<unsigned long long>(summary.swap_failures),
+      static_cast<unsigned long long>(summary.ack_misses));
+  text += buffer;
+  auto append = [&](const char* name, const FramePacingDistribution& d) {
+    if (d.count == 0) return;
+    std::snprintf(
+        buffer, sizeof(buffer), " %s=%.2f/%.2f/%.2fms", name, d.p50 / 1000.0, d.p99 / 1000.0, d.max / 1000.0);
+    text += buffer;
+  };
+  append("render", summary.render_us);
+  append("update-to-render", summary.update_to_render_us);
+  append("swap", summary.swap_us);
+  append("callback", summary.callback_latency_us);
+  append("present-interval", summary.present_interval_us);
+  append("content-interval", summary.content_interval_us);
+  return text;
+}
+
+}  // namespace mpv
+
+#endif  // PLEZY_LINUX_MPV_FRAME_PACING_H_
@@ -0,0 +1,170 @@
+#include "frame_pacing.h"
+
+#include <iostream>
+#include <vector>
+
+namespace {
+
+int failures = 0;
+
+void Expect(bool condition, const char* expression, int line) {
+  if (condition) return;
+  std::cerr << "line " << line << ": check failed: " << expression << '\n';
+  ++failures;
+}
+
+#define EXPECT(condition) Expect(static_cast<bool>(condition), #condition, __LINE__)
+
+// One frame through every stage, at fixed offsets from `base`.
+void PresentFrame(mpv::FramePacingLog* log, int64_t base, int64_t update_us, bool ack = true) {
+  log->RenderStarted(base + 1000, update_us, update_us == 0);
+  log->RenderFinished(base + 3000);
+  log->Presented(base + 3500);
+  if (ack) log->FrameDone(base + 8000, static_cast<uint32_t>(base / 1000));
+}
+
+// Every quantity is read off the right pair of stamps.
+void TestOneFrameDerivesEachStage() {
+  mpv::FramePacingLog log;
+  PresentFrame(&log, 100000, 99000);
+  const auto summary = log.Summarize();
+  EXPECT(summary.frames == 1);
+  EXPECT(summary.presented == 1);
+  EXPECT(summary.render_us.count == 1 && summary.render_us.p50 == 2000);
+  EXPECT(summary.update_to_render_us.p50 == 2000);
+  EXPECT(summary.swap_us.p50 == 500);
+  EXPECT(summary.callback_latency_us.p50 == 4500);
+  // Intervals need two frames.
+  EXPECT(summary.present_interval_us.count == 0);
+  EXPECT(summary.content_interval_us.count == 0);
+  EXPECT(log.at(0).compositor_time_ms == 100);
+}
+
+// 24p on a 60 Hz output: presents alternate three and two refreshes apart
+// while the content interval stays flat. That split is what the two interval
+// distributions exist to show.
+void TestPulldownCadenceShowsInPresentIntervals() {
+  mpv::FramePacingLog log;
+  int64_t t = 1000000;
+  int64_t update = t;
+  for (int i = 0; i < 20; ++i) {
+    PresentFrame(&log, t, update);
+    t += (i % 2 == 0) ? 50000 : 33333;
+    update += 41667;
+  }
+  const auto summary = log.Summarize();
+  EXPECT(summary.present_interval_us.count == 19);
+  EXPECT(summary.present_interval_us.p50 == 50000);
+  EXPECT(summary.present_interval_us.mean > 41000 && summary.present_interval_us.mean < 43000);
+  EXPECT(summary.present_interval_us.stddev > 8000);
+  EXPECT(summary.content_interval_us.p50 == 41667);
+  EXPECT(summary.content_interval_us.stddev == 0);
+}
+
+// A forced render has no mpv frame behind it, so it must not feed the
+// update-to-render or content figures with a stale stamp.
+void TestForcedRendersSkipTheMpvFigures() {
+  mpv::FramePacingLog log;
+  PresentFrame(&log, 100000, 99000);
+  PresentFrame(&log, 200000, 0);
+  PresentFrame(&log, 300000, 290000);
+  const auto summary = log.Summarize();
+  EXPECT(summary.forced == 1);
+  EXPECT(summary.update_to_render_us.count == 2);
+  EXPECT(summary.content_interval_us.count == 1);
+  EXPECT(summary.content_interval_us.p50 == 191000);
+}
+
+// Skips, discards, swap failures and missed acknowledgements are all counted,
+// and only presented frames enter the window.
+void TestCountersTrackWhatNeverReachedTheScreen() {
+  mpv::FramePacingLog log;
+  log.RenderSkippedFramePending();
+  log.RenderSkippedFramePending();
+  log.RenderStarted(1000, 500, false);
+  log.RenderStarted(2000, 500, false);  // started over: the first is discarded
+  log.RenderFinished(3000);
+  log.PresentFailed(true);
+  log.FrameAckMissed();
+  // A callback with nothing presented has nowhere to go.
+  log.FrameDone(4000, 4);
+  // Nor does a present with no render in front of it.
+  log.Presented(5000);
+  const auto summary = log.Summarize();
+  EXPECT(summary.frames == 0);
+  EXPECT(summary.presented == 0);
+  EXPECT(summary.skipped_frame_pending == 2);
+  EXPECT(summary.discarded == 2);
+  EXPECT(summary.swap_failures == 1);
+  EXPECT(summary.ack_misses == 1);
+}
+
+// A late callback belongs to the newest frame and is never applied twice, so
+// an unacknowledged frame stays unacknowledged.
+void TestFrameDoneOnlyAnswersTheNewestFrame() {
+  mpv::FramePacingLog log;
+  PresentFrame(&log, 100000, 99000, false);
+  PresentFrame(&log, 200000, 199000);
+  log.FrameDone(300000, 300);
+  EXPECT(log.at(0).frame_done_us == 0);
+  EXPECT(log.at(1).frame_done_us == 208000);
+  EXPECT(log.Summarize().callback_latency_us.count == 1);
+}
+
+// The window keeps the newest kCapacity frames, oldest first, while the
+// counters keep counting.
+void TestRingKeepsTheNewestFrames() {
+  mpv::FramePacingLog log;
+  const size_t total = mpv::FramePacingLog::kCapacity + 10;
+  for (size_t i = 0; i < total; ++i) PresentFrame(&log, static_cast<int64_t>(i + 1) * 10000, 0);
+  EXPECT(log.size() == mpv::FramePacingLog::kCapacity);
+  EXPECT(log.at(0).swap_us == 11 * 10000 + 3500);
+  EXPECT(log.at(log.size() - 1).swap_us == static_cast<int64_t>(total) * 10000 + 3500);
+  const auto summary = log.Summarize();
+  EXPECT(summary.presented == total);
+  EXPECT(summary.present_interval_us.count == mpv::FramePacingLog::kCapacity - 1);
+  EXPECT(summary.present_interval_us.max == 10000);
+
+  log.Reset();
+  EXPECT(log.size() == 0);
+  EXPECT(log.Summarize().presented == 0);
+}
+
+void TestPercentilesUseNearestRank() {
+  std::vector<int64_t> values;
+  for (int64_t i = 100; i >= 1; --i) values.push_back(i);
+  const auto d = mpv::SummarizeFramePacing(&values);
+  EXPECT(d.count == 100);
+  EXPECT(d.p50 == 50);
+  EXPECT(d.p90 == 90);
+  EXPECT(d.p99 == 99);
+  EXPECT(d.max == 100);
+  EXPECT(d.mean == 51);  // 50.5, rounded half away from zero
+
+  std::vector<int64_t> empty;
+  EXPECT(mpv::SummarizeFramePacing(&empty).count == 0);
+}
+
+void TestFormatNamesOnlyWhatWasMeasured() {
+  mpv::FramePacingLog log;
+  EXPECT(mpv::FormatFramePacing(log.Summarize()).find("render=") == std::string::npos);
+  PresentFrame(&log, 100000, 99000);
+  const std::string text = mpv::FormatFramePacing(log.Summarize());
+  EXPECT(text.find("frames=1 presented=1") == 0);
+  EXPECT(text.find("render=2.00/2.00/2.00ms") != std::string::npos);
+  EXPECT(text.find("present-interval=") == std::string::npos);
+}
+
+}  // namespace
+
+int main() {
+  TestOneFrameDerivesEachStage();
+  TestPulldownCadenceShowsInPresentIntervals();
+  TestForcedRendersSkipTheMpvFigures();
+  TestCountersTrackWhatNeverReachedTheScreen();
+  TestFrameDoneOnlyAnswersTheNewestFrame();
+  TestRingKeepsTheNewestFrames();
+  TestPercentilesUseNearestRank();
+  TestFormatNamesOnlyWhatWasMeasured();
+  return failures == 0 ? 0 : 1;
+}
@@ -414,6 +414,62 @@ inline HdrDecision DecideHdr(const HdrInputs& inputs, const HdrMetadata& source)
   return decision;
 }
 
+inline bool operator==(const HdrInputs& a, const HdrInputs& b) {
+  return a.allowed == b.allowed && a.client_can_describe == b.client_can_describe &&
+         a.output_is_hdr == b.output_is_hdr && a.source_describable == b.source_describable &&
+         a.requested == b.requested && a.display_peak_nits == b.display_peak_nits &&
+         a.sdr_reference_nits == b.sdr_reference_nits;
+}
+
+inline bool operator!=(const HdrInputs& a, const HdrInputs& b) { return !(a == b); }
+
+// The decision last put in force, with everything DecideHdr read to make it.
+//
+// A transaction is requested far more often than anything changes: every seek
+// is a playback restart, and a compositor repeats preferred_changed with the
+// same description. Each one stages the surface and queues an mpv sequence,
+// which holds Present() while they settle, so playing HDR stalls on every seek
+// for nothing. DecideHdr is a pure function of its inputs and the source, so
+// when both match the transaction that last landed, its decision is still the
+// one in force and there is nothing to do.
+//
+// Only a transaction that landed in full may be remembered, and anything that
+// moves the surface or mpv outside one has to Forget(): the memo answers for
+// what is on screen, not just for what was decided.
+class HdrDecisionMemo {
+ public:
+  // The decision in force for exactly these inputs and source, or null.
+  const HdrDecision* Lookup(const HdrInputs& inputs, const HdrMetadata& source) {
+    if (valid_ && inputs_ == inputs && source_ == source) {
+      ++hits_;
+      return &decision_;
+    }
+    ++misses_;
+    return nullptr;
+  }
+
+  void Remember(const HdrInputs& inputs, const HdrMetadata& source, const HdrDecision& decision) {
+    valid_ = true;
+    inputs_ = inputs;
+    source_ = source;
+    decision_ = decision;
+  }
+
+  void Forget() { valid_ = false; }
+
+  // Lookups answered from the memo, and lookups that had to run a transaction.
+  uint64_t hits() const { return hits_; }
+  uint64_t misses() const { return misses_; }
+
+ private:
+  bool valid_ = false;
+  HdrInputs inputs_;
+  HdrMetadata source_;
+  HdrDecision decision_;
+  uint64_t hits_ = 0;
+  uint64_t misses_ = 0;
+};
+
 }  // namespace mpv
 
 #endif  // PLEZY_LINUX_MPV_HDR_METADATA_H_
@@ -757,6 +757,43 @@ void TestMetadataEqualityComparesEveryField() {
   EXPECT(!(base == transfer) && (base != transfer));
 }
 
+// A seek re-requests the decision already in force; only that may skip the
+// transaction.
+void TestMemoAnswersOnlyTheDecisionInForce() {
+  const auto pq = Metadata(1000, 400, 1000, 0.0001);
+  auto inputs = AllGatesPass();
+  inputs.requested = mpv::HdrToneMapping::kPlayer;
+  inputs.display_peak_nits = 600;
+  mpv::HdrDecisionMemo memo;
+  EXPECT(memo.Lookup(inputs, pq) == nullptr);
+
+  const auto decision = mpv::DecideHdr(inputs, pq);
+  memo.Remember(inputs, pq, decision);
+  const mpv::HdrDecision* remembered = memo.Lookup(inputs, pq);
+  EXPECT(remembered != nullptr);
+  EXPECT(remembered != nullptr && remembered->describe == decision.describe &&
+         remembered->target_peak_nits == decision.target_peak_nits);
+
+  // Another output, another file, another mode: each is a new decision.
+  auto brighter = inputs;
+  brighter.display_peak_nits = 1000;
+  EXPECT(memo.Lookup(brighter, pq) == nullptr);
+  EXPECT(memo.Lookup(inputs, Metadata(1000, 400, 4000, 0.0001)) == nullptr);
+  auto compositor = inputs;
+  compositor.requested = mpv::HdrToneMapping::kCompositor;
+  EXPECT(memo.Lookup(compositor, pq) == nullptr);
+  auto sdr_reference = inputs;
+  sdr_reference.sdr_reference_nits = 203;
+  EXPECT(memo.Lookup(sdr_reference, pq) == nullptr);
+
+  EXPECT(memo.hits() == 1);
+  EXPECT(memo.misses() == 5);
+
+  // Anything that moved the plane outside a transaction.
+  memo.Forget();
+  EXPECT(memo.Lookup(inputs, pq) == nullptr);
+}
+
 }  // namespace
 
 int main() {
@@ -806,5 +843,6 @@ int main() {
   TestVersionTwoKeepsBothLightLevelsOutsideTheMasteringRange();
   TestEveryVetoStillAdoptsTheSdrReference();
   TestMetadataEqualityComparesEveryField();
+  TestMemoAnswersOnlyTheDecisionInForce();
   return failures == 0 ? 0 : 1;
 }
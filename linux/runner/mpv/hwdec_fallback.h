@@ -0,0 +1,116 @@
+#ifndef PLEZY_LINUX_MPV_HWDEC_FALLBACK_H_
+#define PLEZY_LINUX_MPV_HWDEC_FALLBACK_H_
+
+#include <cstddef>
+#include <cstdint>
+#include <string>
+
+// When the player steps hardware decoding down a rung on its own.
+//
+// A decode path that cannot keep up shows as dropped frames. On Linux the usual
+// cause is the zero-copy VAAPI path: the decode is hardware, but the dmabuf
+// import into the plane's GL context is slow or broken on the driver, and 4K
+// stutters while everything reports hardware decoding. With mpv's default
+// framedrop=vo those frames are dropped at the VO (frame-drop-count), since the
+// import happens at render time, and decoder-frame-drop-count only moves when
+// framedrop includes the decoder. The ladder counts both. vaapi-copy takes the
+// import out of the loop at the cost of a readback, and software decoding takes
+// the driver out entirely; either is better than a title that cannot play.
+//
+// So the ladder is zero-copy, then its -copy variant, then software ("no"),
+// stepped from what hwdec-current says mpv is actually using rather than from
+// what was requested, since "auto" names no rung. A step happens when
+// kDropThreshold drops land within one kWindowMs window. Drops in the
+// kSettleMs after a decoder change or a new file are not counted: a decoder
+// (re)init and the first seek drop frames by themselves.
+//
+// The step down lasts until the next request: a new hwdec write from the app
+// starts the ladder over from it.
+//
+// Free of libmpv like the other pure headers beside it, so the policy is
+// testable without it.
+
+namespace mpv {
+
+// The mode one rung below |current|, a hwdec-current value: a zero-copy mode
+// steps to its -copy variant and a -copy mode to software. Software, and no
+// decoder at all, have nowhere left to go (empty).
+inline std::string NextHwdecRung(const std::string& current) {
+  if (current.empty() || current == "no") return std::string();
+  static const char kCopySuffix[] = "-copy";
+  const size_t suffix_length = sizeof(kCopySuffix) - 1;
+  if (current.size() > suffix_length &&
+      current.compare(current.size() - suffix_length, suffix_length, kCopySuffix) == 0) {
+    return "no";
+  }
+  return current + kCopySuffix;
+}
+
+class HwdecFallbackLadder {
+ public:
+  static constexpr int64_t kDropThreshold = 30;
+  static constexpr int64_t kWindowMs = 10000;
+  static constexpr int64_t kSettleMs = 3000;
+
+  void SetEnabled(bool enabled) { enabled_ = enabled; }
+  bool enabled() const { return enabled_; }
+
+  // The app asked for |mode|. Whatever the ladder stepped down to is
+  // forgotten.
+  void Request(const std::string& mode, int64_t now_ms) {
+    requested_ = mode;
+    steps_ = 0;
+    Settle(now_ms);
+  }
+  const std::string& requested() const { return requested_; }
+  // Rungs stepped down since the last request.
+  int steps() const { return steps_; }
+
+  // hwdec-current changed: a different decoder, whose drops count afresh.
+  void OnDecoderChanged(const std::string& current, int64_t now_ms) {
+    current_ = current;
+    Settle(now_ms);
+  }
+  const std::string& current() const { return current_; }
+
+  void OnFileStarted(int64_t now_ms) { Settle(now_ms); }
+
+  // A new decoder-frame-drop-count or frame-drop-count; the ladder takes both
+  // every time. Returns the hwdec mode to switch to, or empty to stay.
+  std::string OnDrops(int64_t decoder_drops, int64_t vo_drops, int64_t now_ms) {
+    if (!enabled_) return std::string();
+    const int64_t drops = decoder_drops + vo_drops;
+    if (now_ms < settle_until_ms_) return std::string();
+    // The counters restart with each file, so a decrease is a new count too.
+    if (window_start_drops_ < 0 || drops < window_start_drops_ || now_ms - window_start_ms_ > kWindowMs) {
+      window_start_drops_ = drops;
+      window_start_ms_ = now_ms;
+      return std::string();
+    }
+    if (drops - window_start_drops_ < kDropThreshold) return std::string();
+    const std::string next = NextHwdecRung(current_);
+    if (next.empty()) return next;
+    ++steps_;
+    // Until hwdec-current confirms it, the drops are still the old decoder's.
+    Settle(now_ms);
+    return next;
+  }
+
+ private:
+  void Settle(int64_t now_ms) {
+    settle_until_ms_ = now_ms + kSettleMs;
+    window_start_drops_ = -1;
+  }
+
+  bool enabled_ = true;
+  std::string requested_ = "auto";
+  std::string current_;
+  int steps_ = 0;
+  int64_t settle_until_ms_ = 0;
+  int64_t window_start_ms_ = 0;
+  int64_t window_start_drops_ = -1;
+};
+
+}  // namespace mpv
+
+#endif  // PLEZY_LINUX_MPV_HWDEC_FALLBACK_H_
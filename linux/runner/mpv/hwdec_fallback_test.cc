@@ -0,0 +1,137 @@
+#include "hwdec_fallback.h"
+
+#include <iostream>
+#include <string>
+
+namespace {
+
+int failures = 0;
+
+void Expect(bool condition, const char* expression, int line) {
+  if (condition) return;
+  std::cerr << "line " << line << ": check failed: " << expression << '\n';
+  ++failures;
+}
+
+#define EXPECT(condition) Expect(static_cast<bool>(condition), #condition, __LINE__)
+
+// A ladder on |decoder| whose settle period is over, with a window begun at
+// |drops|.
+mpv::HwdecFallbackLadder SettledOn(const std::string& decoder, int64_t drops, int64_t* now_ms) {
+  mpv::HwdecFallbackLadder ladder;
+  ladder.OnDecoderChanged(decoder, 0);
+  *now_ms = mpv::HwdecFallbackLadder::kSettleMs;
+  EXPECT(ladder.OnDrops(drops, 0, *now_ms).empty());
+  return ladder;
+}
+
+void TestRungs() {
+  EXPECT(mpv::NextHwdecRung("vaapi") == "vaapi-copy");
+  EXPECT(mpv::NextHwdecRung("vaapi-copy") == "no");
+  EXPECT(mpv::NextHwdecRung("nvdec") == "nvdec-copy");
+  EXPECT(mpv::NextHwdecRung("no").empty());
+  EXPECT(mpv::NextHwdecRung("").empty());
+}
+
+void TestStepsDownWhenDropsCrossTheThreshold() {
+  int64_t now = 0;
+  auto ladder = SettledOn("vaapi", 0, &now);
+  EXPECT(ladder.OnDrops(mpv::HwdecFallbackLadder::kDropThreshold - 1, 0, now + 1000).empty());
+  EXPECT(ladder.OnDrops(mpv::HwdecFallbackLadder::kDropThreshold, 0, now + 2000) == "vaapi-copy");
+  EXPECT(ladder.steps() == 1);
+  // Still the old decoder's drops until hwdec-current moves.
+  EXPECT(ladder.OnDrops(mpv::HwdecFallbackLadder::kDropThreshold * 3, 0, now + 2500).empty());
+
+  ladder.OnDecoderChanged("vaapi-copy", now + 3000);
+  now += 3000 + mpv::HwdecFallbackLadder::kSettleMs;
+  EXPECT(ladder.OnDrops(100, 0, now).empty());
+  EXPECT(ladder.OnDrops(100 + mpv::HwdecFallbackLadder::kDropThreshold, 0, now + 100) == "no");
+  EXPECT(ladder.steps() == 2);
+
+  ladder.OnDecoderChanged("no", now + 200);
+  now += 200 + mpv::HwdecFallbackLadder::kSettleMs;
+  EXPECT(ladder.OnDrops(0, 0, now).empty());
+  EXPECT(ladder.OnDrops(1000, 0, now + 100).empty());
+}
+
+// Drops spread thinner than the threshold per window are a slow machine having
+// an occasional bad frame, not a decoder that cannot keep up.
+void TestSlowDropsDoNotStepDown() {
+  int64_t now = 0;
+  auto ladder = SettledOn("vaapi", 0, &now);
+  int64_t drops = 0;
+  for (int i = 0; i < 10; ++i) {
+    now += mpv::HwdecFallbackLadder::kWindowMs + 1;
+    drops += mpv::HwdecFallbackLadder::kDropThreshold - 1;
+    EXPECT(ladder.OnDrops(drops, 0, now).empty());
+  }
+  EXPECT(ladder.steps() == 0);
+}
+
+void TestDropsWhileSettlingAreIgnored() {
+  mpv::HwdecFallbackLadder ladder;
+  ladder.OnDecoderChanged("vaapi", 0);
+  EXPECT(ladder.OnDrops(0, 0, 10).empty());
+  EXPECT(ladder.OnDrops(500, 0, mpv::HwdecFallbackLadder::kSettleMs - 1).empty());
+  // The first sample after settling only starts the window.
+  EXPECT(ladder.OnDrops(600, 0, mpv::HwdecFallbackLadder::kSettleMs).empty());
+  EXPECT(ladder.OnDrops(601, 0, mpv::HwdecFallbackLadder::kSettleMs + 10).empty());
+}
+
+// The drop counters start over with each file.
+void TestCounterResetStartsANewWindow() {
+  int64_t now = 0;
+  auto ladder = SettledOn("vaapi", 20, &now);
+  EXPECT(ladder.OnDrops(0, 0, now + 100).empty());
+  EXPECT(ladder.OnDrops(mpv::HwdecFallbackLadder::kDropThreshold - 1, 0, now + 200).empty());
+}
+
+// Under mpv's default framedrop=vo a slow dmabuf import drops at the VO and
+// the decoder count never moves; those drops step down all the same.
+void TestVoDropsStepDown() {
+  int64_t now = 0;
+  auto ladder = SettledOn("vaapi", 0, &now);
+  EXPECT(ladder.OnDrops(0, mpv::HwdecFallbackLadder::kDropThreshold - 1, now + 1000).empty());
+  EXPECT(ladder.OnDrops(0, mpv::HwdecFallbackLadder::kDropThreshold, now + 2000) == "vaapi-copy");
+  EXPECT(ladder.steps() == 1);
+}
+
+// Drops split between the two counters add up.
+void TestMixedDropsAddUp() {
+  int64_t now = 0;
+  auto ladder = SettledOn("vaapi", 0, &now);
+  const int64_t half = mpv::HwdecFallbackLadder::kDropThreshold / 2;
+  EXPECT(ladder.OnDrops(half, 0, now + 100).empty());
+  EXPECT(ladder.OnDrops(half, mpv::HwdecFallbackLadder::kDropThreshold - half, now + 200) == "vaapi-copy");
+}
+
+void TestDisabledNeverSteps() {
+  int64_t now = 0;
+  auto ladder = SettledOn("vaapi", 0, &now);
+  ladder.SetEnabled(false);
+  EXPECT(ladder.OnDrops(1000, 0, now + 100).empty());
+}
+
+void TestRequestStartsOver() {
+  int64_t now = 0;
+  auto ladder = SettledOn("vaapi", 0, &now);
+  EXPECT(ladder.OnDrops(mpv::HwdecFallbackLadder::kDropThreshold, 0, now + 100) == "vaapi-copy");
+  ladder.Request("auto", now + 200);
+  EXPECT(ladder.requested() == "auto");
+  EXPECT(ladder.steps() == 0);
+}
+
+}  // namespace
+
+int main() {
+  TestRungs();
+  TestStepsDownWhenDropsCrossTheThreshold();
+  TestSlowDropsDoNotStepDown();
+  TestDropsWhileSettlingAreIgnored();
+  TestCounterResetStartsANewWindow();
+  TestVoDropsStepDown();
+  TestMixedDropsAddUp();
+  TestDisabledNeverSteps();
+  TestRequestStartsOver();
+  return failures == 0 ? 0 : 1;
+}
@@ -21,9 +21,12 @@
 #define EGL_CONTEXT_MINOR_VERSION 0x30FB
 #endif
 
+#include <algorithm>
 #include <chrono>
 #include <cstdint>
 #include <cstring>
+#include <map>
+#include <utility>
 
 #include "sanitize_utf8.h"
 
@@ -54,6 +57,15 @@ constexpr uint64_t kVideoParamsUserdata = UINT64_MAX;
 // side rather than inferred from an overlay readout.
 constexpr uint64_t kHwdecCurrentUserdata = UINT64_MAX - 1;
 
+// The drop counters behind the decode-path report and the hwdec fallback
+// ladder. Both feed the ladder (under the default framedrop=vo a slow decode
+// path drops at the VO) and are reported apart, so a stutter can be told apart
+// from a decoder that cannot keep up.
+constexpr uint64_t kDecoderDropsUserdata = UINT64_MAX - 2;
+constexpr uint64_t kVoDropsUserdata = UINT64_MAX - 3;
+
+int64_t MonotonicMs() { return g_get_monotonic_time() / 1000; }
+
 }  // namespace
 
 // Flutter on Linux uses EGL (OpenGL ES) for both X11 and Wayland.
@@ -90,6 +102,12 @@ NativeRenderTeardownOperations ProductionTeardownOperations() {
       },
       [](mpv_render_context* render) { mpv_render_context_free(render); },
       [](mpv_handle* handle) { mpv_terminate_destroy(handle); },
+      [](EGLDisplay display) {
+        if (!eglMakeCurrent(display, EGL_NO_SURFACE, EGL_NO_SURFACE, EGL_NO_CONTEXT)) {
+          g_warning("MPV: Failed to unbind a teardown thread's EGL context: 0x%x", eglGetError());
+        }
+        eglReleaseThread();
+      },
   };
 }
 
@@ -100,8 +118,23 @@ NativeRenderTeardownOperations*& TestTeardownOperationsOverride() {
 }
 #endif
 
+// Releases the batch's contexts each on a thread of its own, then terminates
+// its handle once none is left. Defined with the serial pass below.
+bool ReleaseNativeRenderTeardownInParallel(
+    NativeRenderTeardownBatch& batch, const NativeRenderTeardownOperations& operations);
+
+// Process-wide teardown of what disposed players leave behind. Each batch is
+// released on a short-lived worker of its own, so closing one session never
+// waits behind another core's demuxer shutdown, up to
+// kMaxConcurrentTeardownBatches at a time; beyond that, and for batches
+// waiting out a retry delay, a dispatcher thread holds them. Workers are
+// detached rather than joined: native teardown can block indefinitely, and
+// static destruction must not wait on it. WaitUntilIdle is the bounded join for
+// a caller that wants the work finished.
 class NativeRenderTeardownQueue {
  public:
+  using Clock = std::chrono::steady_clock;
+
   static NativeRenderTeardownQueue& Instance() {
     // Native driver/libmpv teardown can block indefinitely. Keep both the
     // queue and its worker state alive until the OS ends the process so static
@@ -114,61 +147,164 @@ class NativeRenderTeardownQueue {
     if (batch.resources.empty() && !batch.handle) return;
     {
       std::lock_guard<std::mutex> lock(mutex_);
-      batches_.push_back(std::move(batch));
-      ++generation_;
+      const auto now = Clock::now();
+      PendingBatch pending;
+      pending.batch = std::move(batch);
+      pending.enqueued_at = now;
+      pending.schedule.SetPolicy(policy_);
+      batches_.push_back(std::move(pending));
+      // New work is also a hint that whatever held the retained batches may
+      // have moved on, exactly as an explicit Retry is.
+      RetryAllLocked(now);
     }
-    condition_.notify_one();
+    condition_.notify_all();
   }
 
   void Retry() {
     {
       std::lock_guard<std::mutex> lock(mutex_);
+      RetryAllLocked(Clock::now());
+    }
+    condition_.notify_all();
+  }
+
+  void SetPolicy(TeardownRetryPolicy policy) {
+    {
+      std::lock_guard<std::mutex> lock(mutex_);
+      policy_ = policy;
+      for (auto& pending : batches_) pending.schedule.SetPolicy(policy);
       ++generation_;
     }
-    condition_.notify_one();
+    condition_.notify_all();
+  }
+
+  // Waits up to |timeout| for every batch, queued or in flight, to be released.
+  bool WaitUntilIdle(std::chrono::milliseconds timeout) {
+    std::unique_lock<std::mutex> lock(mutex_);
+    return condition_.wait_for(lock, timeout, [this]() { return batches_.empty() && in_flight_.empty(); });
+  }
+
+  TeardownQueueStats Stats() {
+    std::lock_guard<std::mutex> lock(mutex_);
+    TeardownQueueStats stats = counters_;
+    stats.policy = policy_;
+    Clock::time_point oldest{};
+    auto count = [&](bool handle, uint64_t contexts, Clock::time_point enqueued_at) {
+      ++stats.pending_batches;
+      if (handle) ++stats.retained_handles;
+      stats.retained_contexts += contexts;
+      if (oldest == Clock::time_point{} || enqueued_at < oldest) oldest = enqueued_at;
+    };
+    for (const auto& pending : batches_) {
+      count(pending.batch.handle != nullptr, pending.batch.resources.size(), pending.enqueued_at);
+    }
+    for (const auto& entry : in_flight_) count(entry.second.handle, entry.second.contexts, entry.second.enqueued_at);
+    if (oldest != Clock::time_point{}) {
+      stats.oldest_batch_age_ms =
+          std::chrono::duration_cast<std::chrono::milliseconds>(Clock::now() - oldest).count();
+    }
+    return stats;
   }
 
  private:
-  NativeRenderTeardownQueue() : worker_([this]() { Run(); }) {}
+  struct PendingBatch {
+    NativeRenderTeardownBatch batch;
+    Clock::time_point enqueued_at;
+    // Not before this; a failed attempt pushes it out by the batch's schedule.
+    Clock::time_point due;
+    TeardownRetrySchedule schedule;
+  };
+
+  // What a worker took out of batches_, so Stats still counts it while the
+  // worker runs unlocked.
+  struct InFlight {
+    bool handle = false;
+    uint64_t contexts = 0;
+    Clock::time_point enqueued_at;
+  };
+
+  NativeRenderTeardownQueue() : dispatcher_([this]() { Run(); }) {}
+
+  void RetryAllLocked(Clock::time_point now) {
+    for (auto& pending : batches_) {
+      pending.due = now;
+      pending.schedule.Reset();
+    }
+    ++generation_;
+  }
 
   void Run() {
 #ifdef PLEZY_MPV_PLAYER_LIFECYCLE_TEST
-    const NativeRenderTeardownOperations operations =
+    operations_ =
         TestTeardownOperationsOverride() ? *TestTeardownOperationsOverride() : ProductionTeardownOperations();
 #else
-    const NativeRenderTeardownOperations operations = ProductionTeardownOperations();
+    operations_ = ProductionTeardownOperations();
 #endif
     std::unique_lock<std::mutex> lock(mutex_);
     for (;;) {
-      condition_.wait(lock, [this]() { return !batches_.empty(); });
-      const uint64_t observed_generation = generation_;
-      std::vector<NativeRenderTeardownBatch> work = std::move(batches_);
-      batches_.clear();
-
-      // EGL activation and mpv shutdown can block in a driver. Keep queue
-      // admission independent so replacement initialization and disposal only
-      // pay the short ownership-transfer critical section.
-      lock.unlock();
-      std::vector<NativeRenderTeardownBatch> retry;
-      for (auto& batch : work) {
-        if (!TryReleaseNativeRenderTeardown(batch, operations)) retry.push_back(std::move(batch));
+      condition_.wait(
+          lock, [this]() { return !batches_.empty() && in_flight_.size() < kMaxConcurrentTeardownBatches; });
+      auto next = std::min_element(batches_.begin(), batches_.end(), [](const PendingBatch& a, const PendingBatch& b) {
+        return a.due < b.due;
+      });
+      if (next->due > Clock::now()) {
+        const uint64_t observed_generation = generation_;
+        const Clock::time_point due = next->due;
+        condition_.wait_until(
+            lock, due, [this, observed_generation]() { return generation_ != observed_generation; });
+        continue;
       }
-      lock.lock();
-      for (auto& batch : retry) batches_.push_back(std::move(batch));
 
-      if (batches_.empty()) continue;
+      PendingBatch pending = std::move(*next);
+      batches_.erase(next);
+      const uint64_t id = ++next_worker_id_;
+      InFlight& entry = in_flight_[id];
+      entry.handle = pending.batch.handle != nullptr;
+      entry.contexts = pending.batch.resources.size();
+      entry.enqueued_at = pending.enqueued_at;
+      // EGL activation and mpv shutdown can block in a driver. The worker runs
+      // unlocked, so replacement initialization and disposal only pay the
+      // short ownership-transfer critical section.
+      auto shared = std::make_shared<PendingBatch>(std::move(pending));
+      std::thread([this, id, shared]() { Release(id, std::move(*shared)); }).detach();
+    }
+  }
 
-      condition_.wait_for(lock, std::chrono::milliseconds(100), [this, observed_generation]() {
-        return generation_ != observed_generation;
-      });
+  void Release(uint64_t id, PendingBatch pending) {
+    const bool released = ReleaseNativeRenderTeardownInParallel(pending.batch, operations_);
+    {
+      std::lock_guard<std::mutex> lock(mutex_);
+      in_flight_.erase(id);
+      const auto now = Clock::now();
+      if (released) {
+        ++counters_.released_batches;
+        counters_.max_release_latency_ms = std::max<int64_t>(
+            counters_.max_release_latency_ms,
+            std::chrono::duration_cast<std::chrono::milliseconds>(now - pending.enqueued_at).count());
+        // Whatever blocked the retained batches may have held this one too.
+        for (auto& other : batches_) other.schedule.Reset();
+      } else {
+        ++counters_.retry_attempts;
+        pending.due = now + std::chrono::milliseconds(pending.schedule.NextDelayMs());
+        batches_.push_back(std::move(pending));
+      }
+      ++generation_;
     }
+    condition_.notify_all();
   }
 
   std::mutex mutex_;
+  // Both the dispatcher and WaitUntilIdle wait on it, for different things.
   std::condition_variable condition_;
-  std::vector<NativeRenderTeardownBatch> batches_;
+  std::vector<PendingBatch> batches_;
+  std::map<uint64_t, InFlight> in_flight_;
+  uint64_t next_worker_id_ = 0;
   uint64_t generation_ = 0;
-  std::thread worker_;
+  TeardownRetryPolicy policy_ = TeardownRetryPolicy::kFixed;
+  TeardownQueueStats counters_;
+  // Set once by the dispatcher before it starts anything; workers only read.
+  NativeRenderTeardownOperations operations_;
+  std::thread dispatcher_;
 };
 
 // Mesa's software rasterizers, as named in GL_RENDERER. The video plane lands
@@ -199,29 +335,37 @@ void EnqueueNativeRenderTeardownForTesting(NativeRenderTeardownBatch batch) {
 }
 #endif
 
-bool TryReleaseNativeRenderTeardown(
-    NativeRenderTeardownBatch& batch, const NativeRenderTeardownOperations& operations) {
-  for (auto it = batch.resources.begin(); it != batch.resources.end();) {
-    if (it->context == EGL_NO_CONTEXT || !operations.make_current(it->display, it->context)) {
-      ++it;
-      continue;
-    }
+namespace {
 
-    if (it->render) {
-      operations.free_render(it->render);
-      it->render = nullptr;
-    }
-    if (!operations.release_current(it->display)) {
-      ++it;
-      continue;
-    }
-    if (!operations.destroy_context(it->display, it->context)) {
-      ++it;
-      continue;
-    }
-    it = batch.resources.erase(it);
+// One render/context pair, on the calling thread. True once nothing of it is
+// left; otherwise whatever remains stays in |resource| for a later attempt.
+bool TryReleaseNativeRenderResource(
+    NativeRenderTeardownResource& resource, const NativeRenderTeardownOperations& operations) {
+  if (resource.context == EGL_NO_CONTEXT || !operations.make_current(resource.display, resource.context)) {
+    return false;
   }
+  if (resource.render) {
+    operations.free_render(resource.render);
+    resource.render = nullptr;
+  }
+  if (!operations.release_current(resource.display)) return false;
+  return operations.destroy_context(resource.display, resource.context);
+}
 
+// TryReleaseNativeRenderResource on a teardown worker, which exits right
+// after. A context a failed attempt left current to it could then never be
+// made current on another thread, and every retry would fail, so the worker
+// gives up its EGL state whether or not the release worked.
+bool ReleaseNativeRenderResourceOnWorker(
+    NativeRenderTeardownResource& resource, const NativeRenderTeardownOperations& operations) {
+  const EGLDisplay display = resource.display;
+  const bool released = TryReleaseNativeRenderResource(resource, operations);
+  if (operations.release_thread) operations.release_thread(display);
+  return released;
+}
+
+// The handle goes last, and only once every pair is gone.
+bool FinishNativeRenderTeardown(NativeRenderTeardownBatch& batch, const NativeRenderTeardownOperations& operations) {
   if (!batch.resources.empty()) return false;
   if (batch.handle) {
     operations.terminate_handle(batch.handle);
@@ -231,6 +375,48 @@ bool TryReleaseNativeRenderTeardown(
   return true;
 }
 
+bool ReleaseNativeRenderTeardownInParallel(
+    NativeRenderTeardownBatch& batch, const NativeRenderTeardownOperations& operations) {
+  const size_t count = batch.resources.size();
+  if (count > 1) {
+    // An EGLContext is current to one thread at a time, so each pair gets its
+    // own; the first runs here. std::vector<bool> would share bytes across
+    // threads.
+    std::vector<char> released(count, 0);
+    std::vector<std::thread> workers;
+    workers.reserve(count - 1);
+    for (size_t i = 1; i < count; ++i) {
+      workers.emplace_back([&batch, &operations, &released, i]() {
+        released[i] = ReleaseNativeRenderResourceOnWorker(batch.resources[i], operations);
+      });
+    }
+    released[0] = ReleaseNativeRenderResourceOnWorker(batch.resources[0], operations);
+    for (auto& worker : workers) worker.join();
+    size_t kept = 0;
+    for (size_t i = 0; i < count; ++i) {
+      if (!released[i]) batch.resources[kept++] = batch.resources[i];
+    }
+    batch.resources.resize(kept);
+  } else if (count == 1 && ReleaseNativeRenderResourceOnWorker(batch.resources.front(), operations)) {
+    batch.resources.clear();
+  }
+  return FinishNativeRenderTeardown(batch, operations);
+}
+
+}  // namespace
+
+bool TryReleaseNativeRenderTeardown(
+    NativeRenderTeardownBatch& batch, const NativeRenderTeardownOperations& operations) {
+  for (auto it = batch.resources.begin(); it != batch.resources.end();) {
+    if (TryReleaseNativeRenderResource(*it, operations)) {
+      it = batch.resources.erase(it);
+    } else {
+      ++it;
+    }
+  }
+  return FinishNativeRenderTeardown(batch, operations);
+}
+
 MpvPlayer::CallbackContext::Lease::Lease(CallbackContext* context, MpvPlayer* player)
     : context_(context), player_(player) {}
 
@@ -311,45 +497,31 @@ bool MpvPlayer::HasMpvHandle() const {
   return mpv_ != nullptr;
 }
 
-bool MpvPlayer::Initialize() {
-  std::lock_guard<std::mutex> lock(native_mutex_);
-  if (disposed_) {
-    g_warning("MPV: initialization requested after disposal");
-    return false;
-  }
-  if (mpv_) {
-    return true;  // Already initialized.
-  }
-
-  if (!EnsureProcessNumericLocale()) {
-    g_warning("MPV: Failed to establish the process-wide C numeric locale");
-    return false;
-  }
-
+mpv_handle* MpvPlayer::CreateCore(bool audio_only, bool hdr_enabled) {
   // Create mpv instance.
-  mpv_ = mpv_create();
-  if (!mpv_) {
+  mpv_handle* mpv = mpv_create();
+  if (!mpv) {
     g_warning("MPV: mpv_create() failed");
-    return false;
+    return nullptr;
   }
 
-  if (audio_only_) {
+  if (audio_only) {
     // Music core: no VO, no video decode. vid=no keeps embedded cover art
     // from ever becoming a video track, and force-window/audio-display make
     // sure mpv never opens a video output for it either.
-    mpv_set_option_string(mpv_, "vid", "no");
-    mpv_set_option_string(mpv_, "force-window", "no");
-    mpv_set_option_string(mpv_, "audio-display", "no");
-    mpv_set_option_string(mpv_, "gapless-audio", "weak");
+    mpv_set_option_string(mpv, "vid", "no");
+    mpv_set_option_string(mpv, "force-window", "no");
+    mpv_set_option_string(mpv, "audio-display", "no");
+    mpv_set_option_string(mpv, "gapless-audio", "weak");
   } else {
     // Configure mpv for embedded playback.
-    mpv_set_option_string(mpv_, "vo", "libmpv");
-    mpv_set_option_string(mpv_, "hwdec", "auto");
+    mpv_set_option_string(mpv, "vo", "libmpv");
+    mpv_set_option_string(mpv, "hwdec", "auto");
   }
-  mpv_set_option_string(mpv_, "keep-open", "yes");
-  mpv_set_option_string(mpv_, "audio-fallback-to-null", "yes");
+  mpv_set_option_string(mpv, "keep-open", "yes");
+  mpv_set_option_string(mpv, "audio-fallback-to-null", "yes");
 
-  if (!audio_only_) {
+  if (!audio_only) {
     // hdr-compute-peak is nested under the same predicate as the tone-map pass -
     // it runs exactly when the source's declared peak exceeds target-peak - so it
     // costs nothing while the compositor owns tone mapping and gives
@@ -358,24 +530,24 @@ bool MpvPlayer::Initialize() {
     // `tone-mapping` is deliberately *not* set here: it travels with the output
     // description and is applied and withdrawn in RunPendingHdrOutput instead.
     // See applied_tone_mapping_ in mpv_player.h for why it cannot be global.
-    mpv_set_option_string(mpv_, "hdr-compute-peak", "auto");
+    mpv_set_option_string(mpv, "hdr-compute-peak", "auto");
     // Declared by vo_gpu_next only, so inert for the render API this player
     // runs. Set anyway so the startup value agrees with what a later
     // `hdr-enabled` write puts here through SetHDREnabled.
-    mpv_set_option_string(mpv_, "target-colorspace-hint", plezy::mpv_common::TargetColorspaceHint(hdr_enabled_));
+    mpv_set_option_string(mpv, "target-colorspace-hint", plezy::mpv_common::TargetColorspaceHint(hdr_enabled));
   }
-  mpv_set_option_string(mpv_, "idle", "yes");
-  mpv_set_option_string(mpv_, "input-default-bindings", "no");
-  mpv_set_option_string(mpv_, "input-vo-keyboard", "no");
-  mpv_set_option_string(mpv_, "osc", "no");
-  mpv_set_option_string(mpv_, "terminal", "no");
+  mpv_set_option_string(mpv, "idle", "yes");
+  mpv_set_option_string(mpv, "input-default-bindings", "no");
+  mpv_set_option_string(mpv, "input-vo-keyboard", "no");
+  mpv_set_option_string(mpv, "osc", "no");
+  mpv_set_option_string(mpv, "terminal", "no");
   // Every URL Plezy opens is a media-server stream or a local file, never a
   // site mpv's bundled ytdl_hook could resolve. Loading it costs an on_load
   // hook per open and, on a failed open, spawns yt-dlp with the full stream
   // URL — access token included — in its argv, where /proc exposes it. mpv
   // gates loading the builtin script on this option at mpv_initialize time,
   // so it has to be set here rather than from Dart.
-  mpv_set_option_string(mpv_, "ytdl", "no");
+  mpv_set_option_string(mpv, "ytdl", "no");
 
   // Default to info-level logging. The vaapi hwdec probe and the "Using
   // software decoding" fallback are MSGL_INFO messages, and both are the only
@@ -384,14 +556,62 @@ bool MpvPlayer::Initialize() {
   // global level - there is no per-module syntax here), so a hwdec regression
   // is indistinguishable from a working one. Debug logging raises this
   // further via setLogLevel.
-  mpv_request_log_messages(mpv_, "info");
+  mpv_request_log_messages(mpv, "info");
 
   // Initialize mpv.
-  int err = mpv_initialize(mpv_);
+  int err = mpv_initialize(mpv);
   if (err < 0) {
     g_warning("MPV: mpv_initialize() failed: %s", mpv_error_string(err));
-    mpv_destroy(mpv_);
-    mpv_ = nullptr;
+    mpv_destroy(mpv);
+    return nullptr;
+  }
+  return mpv;
+}
+
+bool MpvPlayer::PrepareStandbyCore() {
+  // Here rather than on the warming thread: setlocale must not race the
+  // locale-dependent calls of whatever else the main thread is doing.
+  return EnsureProcessNumericLocale();
+}
+
+void MpvPlayer::WarmStandbyCore(StandbyCore* core, bool audio_only) {
+  // A new player always starts with HDR enabled.
+  core->mpv = CreateCore(audio_only, true);
+}
+
+void MpvPlayer::DiscardStandbyCore(StandbyCore core) {
+  if (!core.mpv) return;
+  // Idle, but terminating still joins mpv's threads; the teardown thread takes
+  // it like a disposed player's handle.
+  NativeRenderTeardownBatch teardown;
+  teardown.handle = core.mpv;
+  NativeRenderTeardownQueue::Instance().Enqueue(std::move(teardown));
+}
+
+bool MpvPlayer::Initialize(StandbyCore* standby) {
+  std::lock_guard<std::mutex> lock(native_mutex_);
+  if (disposed_) {
+    g_warning("MPV: initialization requested after disposal");
+    return false;
+  }
+  if (mpv_) {
+    return true;  // Already initialized.
+  }
+
+  if (!EnsureProcessNumericLocale()) {
+    g_warning("MPV: Failed to establish the process-wide C numeric locale");
+    return false;
+  }
+
+  // A standby core whose warm failed has no handle, and one is made here.
+  const bool adopted = standby && standby->mpv;
+  if (adopted) {
+    mpv_ = standby->mpv;
+    standby->mpv = nullptr;
+  } else {
+    mpv_ = CreateCore(audio_only_, hdr_enabled_);
+  }
+  if (!mpv_) {
     return false;
   }
 
@@ -412,17 +632,32 @@ bool MpvPlayer::Initialize() {
     // Which decode path is in use. mpv only emits on change, so each event is
     // a real transition worth a log line.
     mpv_observe_property(mpv_, kHwdecCurrentUserdata, "hwdec-current", MPV_FORMAT_STRING);
+    mpv_observe_property(mpv_, kDecoderDropsUserdata, "decoder-frame-drop-count", MPV_FORMAT_INT64);
+    mpv_observe_property(mpv_, kVoDropsUserdata, "frame-drop-count", MPV_FORMAT_INT64);
   }
 
-  g_message("MPV: Initialization successful (%s)", audio_only_ ? "audio-only" : "render context deferred");
+  g_message(
+      "MPV: Initialization successful (%s%s)", audio_only_ ? "audio-only" : "render context deferred",
+      adopted ? ", standby core" : "");
   return true;
 }
 
 void MpvPlayer::RetryPendingNativeTeardown() { NativeRenderTeardownQueue::Instance().Retry(); }
 
+TeardownQueueStats MpvPlayer::NativeTeardownStats() { return NativeRenderTeardownQueue::Instance().Stats(); }
+
+bool MpvPlayer::WaitForNativeTeardown(std::chrono::milliseconds timeout) {
+  return NativeRenderTeardownQueue::Instance().WaitUntilIdle(timeout);
+}
+
+void MpvPlayer::SetNativeTeardownRetryPolicy(TeardownRetryPolicy policy) {
+  NativeRenderTeardownQueue::Instance().SetPolicy(policy);
+}
+
 bool MpvPlayer::InitRenderContextForSurface(EGLDisplay display, EGLConfig config, EGLSurface surface, int depth_bits) {
   RetryPendingNativeTeardown();
 
+  std::lock_guard<std::mutex> render_lock(render_mutex_);
   std::lock_guard<std::mutex> lock(native_mutex_);
   if (audio_only_ || disposed_) {
     g_warning("MPV: Video-plane render context requested for an unavailable player");
@@ -552,7 +787,9 @@ bool MpvPlayer::InitRenderContextForSurface(EGLDisplay display, EGLConfig config
   const bool has_image_base = egl_exts != nullptr && strstr(egl_exts, "EGL_KHR_image_base") != nullptr;
   const bool has_oes_egl_image =
       gl_exts != nullptr && strstr(reinterpret_cast<const char*>(gl_exts), "GL_OES_EGL_image") != nullptr;
-  if (!has_dma_buf || !has_image_base || !has_oes_egl_image) {
+  hwdec_interop_available_ = has_dma_buf && has_image_base && has_oes_egl_image;
+  software_gl_renderer_ = software_renderer;
+  if (!hwdec_interop_available_) {
     g_warning(
         "MPV video plane: VAAPI dmabuf interop prerequisites missing "
         "(EGL_EXT_image_dma_buf_import=%d EGL_KHR_image_base=%d GL_OES_EGL_image=%d); "
@@ -568,6 +805,7 @@ bool MpvPlayer::InitRenderContextForSurface(EGLDisplay display, EGLConfig config
   if (!eglSwapInterval(display, 0)) {
     g_warning("MPV: could not disable EGL swap throttling on the video plane: 0x%x", eglGetError());
   }
+  swap_interval_surface_ = surface;
 
   mpv_opengl_init_params gl_init_params{};
   gl_init_params.get_proc_address = get_opengl_proc_address;
@@ -622,14 +860,44 @@ bool MpvPlayer::InitRenderContextForSurface(EGLDisplay display, EGLConfig config
 }
 
 bool MpvPlayer::RenderToSurface(EGLSurface surface, int width, int height) {
-  std::lock_guard<std::mutex> lock(native_mutex_);
-  if (disposed_ || !mpv_gl_ || egl_context_ == EGL_NO_CONTEXT || surface == EGL_NO_SURFACE) return false;
+  // The render runs under render_mutex_ alone: native_mutex_ is only held to
+  // copy out what it needs, so the main thread's event handling and HDR
+  // decisions never wait out a render on the plane's thread.
+  std::lock_guard<std::mutex> render_lock(render_mutex_);
+#ifdef PLEZY_MPV_PLAYER_LIFECYCLE_TEST
+  if (test_render_) {
+    {
+      std::lock_guard<std::mutex> lock(native_mutex_);
+      if (disposed_) return false;
+    }
+    test_render_();
+    return true;
+  }
+#endif
+  mpv_render_context* render_context = nullptr;
+  EGLDisplay display = EGL_NO_DISPLAY;
+  EGLContext context = EGL_NO_CONTEXT;
+  int depth_bits = 8;
+  {
+    std::lock_guard<std::mutex> lock(native_mutex_);
+    if (disposed_ || !mpv_gl_ || egl_context_ == EGL_NO_CONTEXT || surface == EGL_NO_SURFACE) return false;
+    render_context = mpv_gl_;
+    display = egl_display_;
+    context = egl_context_;
+    depth_bits = surface_depth_bits_;
+  }
   if (width < 1 || height < 1) return false;
 
-  if (!eglBindAPI(EGL_OPENGL_ES_API) || !eglMakeCurrent(egl_display_, surface, surface, egl_context_)) {
+  if (!eglBindAPI(EGL_OPENGL_ES_API) || !eglMakeCurrent(display, surface, surface, context)) {
     g_warning("MPV: Failed to activate the video-plane EGL context for render: 0x%x", eglGetError());
     return false;
   }
+  if (surface != swap_interval_surface_) {
+    if (!eglSwapInterval(display, 0)) {
+      g_warning("MPV: could not disable EGL swap throttling on the video plane: 0x%x", eglGetError());
+    }
+    swap_interval_surface_ = surface;
+  }
 
   // Consume the redraw latch before rendering: OnMpvRenderUpdate drops further
   // notifications until it is cleared.
@@ -642,24 +910,67 @@ bool MpvPlayer::RenderToSurface(EGLSurface surface, int width, int height) {
   // Ignored by the render API's OpenGL backend, which reads the depth param
   // instead, but it is what mpv#16818's gpu-next backend will read, so state
   // it truthfully rather than leave a lie in place for that day.
-  mpv_fbo.internal_format = surface_depth_bits_ >= 16 ? GL_RGBA16F : surface_depth_bits_ >= 10 ? GL_RGB10_A2 : GL_RGBA8;
+  mpv_fbo.internal_format = depth_bits >= 16 ? GL_RGBA16F : depth_bits >= 10 ? GL_RGB10_A2 : GL_RGBA8;
 
   // The default framebuffer is bottom-up relative to mpv's image orientation,
   // so this flips.
   int flip_y = 1;
   // Without this mpv assumes 8 bits and dithers a 10-bit PQ plane down to 8,
   // which bands precisely in the dark ramp PQ spends most of its code space on.
-  int depth = surface_depth_bits_;
+  int depth = depth_bits;
+  int block_for_target_time = block_for_target_time_.load() ? 1 : 0;
   mpv_render_param params[] = {
       {MPV_RENDER_PARAM_OPENGL_FBO, &mpv_fbo},
       {MPV_RENDER_PARAM_FLIP_Y, &flip_y},
       {MPV_RENDER_PARAM_DEPTH, &depth},
+      {MPV_RENDER_PARAM_BLOCK_FOR_TARGET_TIME, &block_for_target_time},
       {MPV_RENDER_PARAM_INVALID, nullptr},
   };
-  mpv_render_context_render(mpv_gl_, params);
+  mpv_render_context_render(render_context, params);
   return true;
 }
 
+void MpvPlayer::SetSurfaceDepthBits(int depth_bits) {
+  std::lock_guard<std::mutex> lock(native_mutex_);
+  surface_depth_bits_ = depth_bits > 0 ? depth_bits : 8;
+}
+
+bool MpvPlayer::NextFrameTargetTime(int64_t* monotonic_us) {
+  // mpv takes one mpv_render_* call at a time, so this waits on a render.
+  std::lock_guard<std::mutex> render_lock(render_mutex_);
+  std::lock_guard<std::mutex> lock(native_mutex_);
+  if (disposed_ || !mpv_gl_ || !mpv_) return false;
+  mpv_render_frame_info info{};
+  mpv_render_param param = {MPV_RENDER_PARAM_NEXT_FRAME_INFO, &info};
+  if (mpv_render_context_get_info(mpv_gl_, param) < 0) return false;
+  if ((info.flags & MPV_RENDER_FRAME_INFO_PRESENT) == 0 || info.target_time <= 0) return false;
+  // mpv's clock is monotonic with a base of its own; carry the distance over.
+  *monotonic_us = g_get_monotonic_time() + (info.target_time - mpv_get_time_us(mpv_));
+  return true;
+}
+
+void MpvPlayer::ReleaseRenderContext() {
+  std::lock_guard<std::mutex> render_lock(render_mutex_);
+  EGLDisplay display = EGL_NO_DISPLAY;
+  EGLContext context = EGL_NO_CONTEXT;
+  {
+    std::lock_guard<std::mutex> lock(native_mutex_);
+    display = egl_display_;
+    context = egl_context_;
+  }
+  if (context == EGL_NO_CONTEXT || eglGetCurrentContext() != context) return;
+  if (!eglMakeCurrent(display, EGL_NO_SURFACE, EGL_NO_SURFACE, EGL_NO_CONTEXT)) {
+    g_warning("MPV: Failed to release the video-plane EGL context: 0x%x", eglGetError());
+  }
+}
+
+void MpvPlayer::ReportSwap() {
+  std::lock_guard<std::mutex> render_lock(render_mutex_);
+  std::lock_guard<std::mutex> lock(native_mutex_);
+  if (disposed_ || !mpv_gl_) return;
+  mpv_render_context_report_swap(mpv_gl_);
+}
+
 void MpvPlayer::Dispose() {
   if (disposed_.exchange(true)) {
     return;
@@ -689,6 +1000,7 @@ void MpvPlayer::Dispose() {
     std::lock_guard<std::mutex> lock(callback_mutex_);
     redraw_callback_ = nullptr;
     event_callback_ = nullptr;
+    encoded_event_callback_ = nullptr;
     source_metadata_callback_ = nullptr;
   }
 
@@ -701,27 +1013,31 @@ void MpvPlayer::Dispose() {
   }
 
   RemoveTrackedSources();
-
-  // The plane's context is left current on this thread by RenderToSurface and
-  // nothing else releases it before the video surface is destroyed - which the
-  // plugin does *after* this call. An EGLContext can be current to at most one
-  // thread, so handing it to the teardown worker while it is still bound here
-  // makes the worker's eglMakeCurrent fail with EGL_BAD_ACCESS; the pair is then
-  // retained, and by the note below the mpv handle cannot be terminated until
-  // every pair drains. Repeated open/close would carry a whole stale mpv core
-  // across each gap. Only our own context is released: Flutter's must be left
-  // exactly where it is.
-  if (egl_context_ != EGL_NO_CONTEXT && eglGetCurrentContext() == egl_context_) {
-    if (!eglMakeCurrent(egl_display_, EGL_NO_SURFACE, EGL_NO_SURFACE, EGL_NO_CONTEXT)) {
-      g_warning("MPV: Failed to release the video-plane EGL context before teardown: 0x%x", eglGetError());
-    }
-  }
+  // Nobody is listening any more, so staged values are released, not sent.
+  property_batch_.Reset();
+  batch_property_changes_ = false;
+  patched_properties_.clear();
+  next_item_.Clear();
+
+  // The plane's context is left current on the rendering thread by
+  // RenderToSurface, and when that is this one nothing else releases it before
+  // the video surface is destroyed - which the plugin does *after* this call.
+  // (A render thread releases it itself on the way out.) An EGLContext can be
+  // current to at most one thread, so handing it to the teardown worker while
+  // it is still bound here makes the worker's eglMakeCurrent fail with
+  // EGL_BAD_ACCESS; the pair is then retained, and by the note below the mpv
+  // handle cannot be terminated until every pair drains. Repeated open/close
+  // would carry a whole stale mpv core across each gap. Only our own context is
+  // released: Flutter's must be left exactly where it is.
+  ReleaseRenderContext();
 
   // Transfer the render context, the EGL context and the shared mpv handle to
   // the managed teardown thread. A failed EGL bind leaves the complete pair in
   // the queue; the handle cannot be terminated until every pair is gone.
   NativeRenderTeardownBatch teardown;
   {
+    // After any render in progress: it holds the context being handed over.
+    std::lock_guard<std::mutex> render_lock(render_mutex_);
     std::lock_guard<std::mutex> lock(native_mutex_);
     if (mpv_gl_ || egl_context_ != EGL_NO_CONTEXT) {
       teardown.resources.push_back({mpv_gl_, egl_display_, egl_context_});
@@ -732,6 +1048,7 @@ void MpvPlayer::Dispose() {
     mpv_ = nullptr;
     egl_display_ = EGL_NO_DISPLAY;
     egl_context_ = EGL_NO_CONTEXT;
+    swap_interval_surface_ = EGL_NO_SURFACE;
     // The next player must not decide against this one's colour space.
     source_hdr_metadata_ = SourceHdrMetadata();
   }
@@ -751,6 +1068,44 @@ void MpvPlayer::CommandAsync(const std::vector<std::string>& args, CommandCallba
   plezy::mpv_common::SubmitCommandAsync(mpv_, pending_requests_, args, std::move(callback));
 }
 
+void MpvPlayer::Preload(const std::string& url, const std::string& options, StatusCallback callback) {
+  if (disposed_ || !mpv_) {
+    if (callback) callback(MPV_ERROR_UNINITIALIZED);
+    return;
+  }
+
+  const uint64_t generation = next_item_.Begin(url);
+  // mpv opens the next entry's stream and demuxer once the playing one has
+  // been read to its end, which is what takes the cold open off the boundary.
+  SetPropertyAsync("prefetch-playlist", "yes", nullptr);
+  // Drops any title queued before, and keeps the playing entry, so the append
+  // below is always the one playlist-next reaches.
+  CommandAsync({"playlist-clear"}, nullptr);
+  CommandAsync(plezy::mpv_common::PreloadLoadfileArgs(url, options), [this, generation, url, callback](int error) {
+    if (error < 0) {
+      if (next_item_.Abandon(generation, nullptr)) SendPreloadEvent("failed", url, error);
+      if (callback) callback(error);
+      return;
+    }
+    if (callback) callback(error);
+    // The entry id is what start-file and end-file name it by.
+    GetPropertyAsync("playlist/1/id", [this, generation, url](int error, const std::string& value) {
+      const int64_t entry_id = error >= 0 ? g_ascii_strtoll(value.c_str(), nullptr, 10) : 0;
+      if (entry_id <= 0) {
+        if (next_item_.Abandon(generation, nullptr)) SendPreloadEvent("failed", url, error < 0 ? error : -1);
+        return;
+      }
+      if (next_item_.Queued(generation, entry_id)) SendPreloadEvent("ready", url);
+    });
+  });
+}
+
+bool MpvPlayer::Promote(StatusCallback callback) {
+  if (disposed_ || !mpv_ || !next_item_.HasQueued()) return false;
+  CommandAsync({"playlist-next", "force"}, std::move(callback));
+  return true;
+}
+
 void MpvPlayer::SetProperty(const std::string& name, const std::string& value) {
   SetPropertyAsync(name, value, nullptr);
 }
@@ -773,6 +1128,9 @@ void MpvPlayer::SetPropertyAsync(const std::string& name, const std::string& val
     SetHDREnabled(plezy::mpv_common::ParseEnabledFlag(value), std::move(callback));
     return;
   }
+  // The app's choice is where the fallback ladder starts over; the write itself
+  // goes through unchanged.
+  if (name == "hwdec") hwdec_ladder_.Request(value, MonotonicMs());
   plezy::mpv_common::SubmitSetPropertyAsync(
       mpv_, pending_requests_, name, value, [this, name, value, cb = std::move(callback)](int error) mutable {
         // Native-side attribution for the same failure the platform channel
@@ -830,19 +1188,56 @@ void MpvPlayer::GetPropertyAsync(const std::string& name, GetPropertyCallback ca
   plezy::mpv_common::SubmitGetPropertyAsync(mpv_, pending_requests_, name, std::move(callback));
 }
 
-void MpvPlayer::ObserveProperty(const std::string& name, const std::string& format, int id) {
+void MpvPlayer::ObserveProperty(
+    const std::string& name, const std::string& format, int id, int min_interval_ms, bool patch) {
   if (disposed_ || !mpv_) return;
 
   const auto request = observed_properties_.Register(name, format, id);
   if (!request.added) return;
+  if (min_interval_ms > 0) property_batch_.SetMinInterval(id, std::chrono::milliseconds(min_interval_ms));
+  // Only a node has structure to patch; anything else is always sent whole.
+  if (patch && request.format == MPV_FORMAT_NODE) patched_properties_[id] = PatchedProperty();
   mpv_observe_property(mpv_, request.userdata, name.c_str(), request.format);
 }
 
+void MpvPlayer::ResyncProperty(int id) {
+  auto it = patched_properties_.find(id);
+  if (it == patched_properties_.end()) return;
+  PatchedProperty& property = it->second;
+
+  if (property.has_pending) {
+    property.latest = property.pending;
+  } else if (property.has_committed) {
+    property.latest = property.committed;
+  } else {
+    return;  // Nothing sent yet; the first value is whole anyway.
+  }
+  // Dart's copy is no longer a base to patch. While batching, a change staged
+  // after this must replace it whole too, not as a patch Dart cannot apply.
+  property.has_committed = false;
+  SendPatchedPropertyChange(id, property);
+}
+
+void MpvPlayer::SetPropertyBatching(bool enabled) {
+  if (batch_property_changes_ == enabled) return;
+  // Whatever was staged under batching still owes Dart its last value.
+  if (!enabled) FlushPropertyBatch(true);
+  batch_property_changes_ = enabled;
+}
+
 void MpvPlayer::SetEventCallback(EventCallback callback) {
   std::lock_guard<std::mutex> lock(callback_mutex_);
   event_callback_ = std::move(callback);
 }
 
+void MpvPlayer::SetEncodedEventCallback(EncodedEventCallback callback) {
+  // Staged changes are in the old sink's form and owed to it.
+  FlushPropertyBatch(true);
+  encode_property_changes_ = static_cast<bool>(callback);
+  std::lock_guard<std::mutex> lock(callback_mutex_);
+  encoded_event_callback_ = std::move(callback);
+}
+
 void MpvPlayer::SetRedrawCallback(RedrawCallback callback) {
   std::lock_guard<std::mutex> lock(callback_mutex_);
   redraw_callback_ = std::move(callback);
@@ -872,7 +1267,12 @@ void MpvPlayer::OnMpvRenderUpdate(void* ctx) {
   MpvPlayer* player = lease.player();
   if (player->disposed_) return;
 
+  // Stamped ahead of the latch so a render that sees the latch set also sees
+  // a time no older than the frame it is for.
+  const int64_t now = g_get_monotonic_time();
   bool expected = false;
+  if (player->needs_redraw_.load()) return;
+  player->redraw_requested_at_.store(now, std::memory_order_relaxed);
   if (!player->needs_redraw_.compare_exchange_strong(expected, true)) {
     return;
   }
@@ -892,6 +1292,10 @@ void MpvPlayer::ScheduleWakeupSource() {
   g_source_set_priority(source, G_PRIORITY_HIGH_IDLE);
   auto* data = new SourceCallbackData(callback_context_);
   g_source_set_callback(source, DispatchWakeupSource, data, DestroySourceCallbackData);
+  // Stamped before the attach: the main context may dispatch the source before
+  // g_source_attach returns, and would then find no stamp to take.
+  wakeup_scheduled_at_.store(
+      plezy::mpv_common::EventLoopStats::Clock::now().time_since_epoch().count(), std::memory_order_relaxed);
   data->source_id = g_source_attach(source, callback_context_->main_context());
   wakeup_source_id_ = data->source_id;
   g_source_unref(source);
@@ -925,6 +1329,18 @@ void MpvPlayer::ScheduleRecoverySource() {
   g_source_unref(source);
 }
 
+void MpvPlayer::SchedulePropertyFlushSource(guint delay_ms) {
+  std::lock_guard<std::mutex> lock(source_mutex_);
+  if (disposed_ || property_flush_source_id_ != 0) return;
+
+  GSource* source = g_timeout_source_new(delay_ms);
+  auto* data = new SourceCallbackData(callback_context_);
+  g_source_set_callback(source, DispatchPropertyFlushSource, data, DestroySourceCallbackData);
+  data->source_id = g_source_attach(source, callback_context_->main_context());
+  property_flush_source_id_ = data->source_id;
+  g_source_unref(source);
+}
+
 gboolean MpvPlayer::DispatchWakeupSource(gpointer data) {
   auto* source_data = static_cast<SourceCallbackData*>(data);
   auto lease = source_data->context->Acquire();
@@ -986,6 +1402,22 @@ gboolean MpvPlayer::DispatchRecoverySource(gpointer data) {
   return G_SOURCE_REMOVE;
 }
 
+gboolean MpvPlayer::DispatchPropertyFlushSource(gpointer data) {
+  auto* source_data = static_cast<SourceCallbackData*>(data);
+  auto lease = source_data->context->Acquire();
+  if (!lease) return G_SOURCE_REMOVE;
+
+  MpvPlayer* player = lease.player();
+  {
+    std::lock_guard<std::mutex> lock(player->source_mutex_);
+    if (player->property_flush_source_id_ == source_data->source_id) {
+      player->property_flush_source_id_ = 0;
+    }
+  }
+  if (!player->disposed_) player->FlushPropertyBatch(false);
+  return G_SOURCE_REMOVE;
+}
+
 void MpvPlayer::RemoveTrackedSources() {
   std::lock_guard<std::mutex> lock(source_mutex_);
   GMainContext* context = callback_context_->main_context();
@@ -998,22 +1430,67 @@ void MpvPlayer::RemoveTrackedSources() {
   remove(wakeup_source_id_);
   remove(redraw_source_id_);
   remove(recovery_source_id_);
+  remove(property_flush_source_id_);
 }
 
 bool MpvPlayer::ProcessEvents() {
   if (disposed_ || !mpv_) return false;
 
+  using Clock = plezy::mpv_common::EventLoopStats::Clock;
+  // How long the main context took to get to the wakeup. A drain that is not
+  // answering one (the flush timer's, say) has nothing to measure.
+  const int64_t scheduled_at = wakeup_scheduled_at_.exchange(0, std::memory_order_relaxed);
+  if (scheduled_at != 0) {
+    event_loop_stats_.RecordWakeupToDispatch(Clock::now() - Clock::time_point(Clock::duration(scheduled_at)));
+  }
+
+  bool running = true;
+  size_t handled = 0;
   while (true) {
     mpv_event* event = mpv_wait_event(mpv_, 0);
     if (event->event_id == MPV_EVENT_NONE) {
       break;
     }
     if (event->event_id == MPV_EVENT_SHUTDOWN) {
-      return false;
+      running = false;
+      break;
     }
+    const auto started = Clock::now();
+    const mpv_event_id event_id = event->event_id;
     HandleMpvEvent(event);
-  }
-  return true;
+    event_loop_stats_.RecordHandler(event_id, Clock::now() - started);
+    ++handled;
+  }
+  event_loop_stats_.RecordDrain(handled);
+  // One channel hop for everything this drain staged, rather than one per
+  // change; a no-op unless batching is on.
+  FlushPropertyBatch(false);
+  MaybeLogEventLoopStats();
+  return running;
+}
+
+void MpvPlayer::MaybeLogEventLoopStats() {
+  if (stats_log_interval_.count() <= 0) return;
+  const auto now = plezy::mpv_common::EventLoopStats::Clock::now();
+  if (now - stats_logged_at_ < stats_log_interval_) return;
+
+  const auto current = event_loop_stats_.Read();
+  const std::string text = plezy::mpv_common::FormatEventLoopStats(current.Since(stats_logged_));
+  stats_logged_ = current;
+  stats_logged_at_ = now;
+  g_message("MPV event-loop: %s", text.c_str());
+  FlValue* data = fl_value_new_map();
+  fl_value_set_string_take(data, "prefix", fl_value_new_string("event-loop"));
+  fl_value_set_string_take(data, "level", fl_value_new_string("info"));
+  fl_value_set_string_take(data, "text", fl_value_new_string(text.c_str()));
+  SendEvent("log-message", data);
+  fl_value_unref(data);
+}
+
+void MpvPlayer::SetEventLoopStatsLogInterval(int interval_ms) {
+  stats_log_interval_ = std::chrono::milliseconds(std::max(interval_ms, 0));
+  stats_logged_ = event_loop_stats_.Read();
+  stats_logged_at_ = plezy::mpv_common::EventLoopStats::Clock::now();
 }
 
 void MpvPlayer::LogRecovery(const std::string& text) {
@@ -1060,7 +1537,7 @@ void MpvPlayer::EnsureAudioRecoveryTimer() {
 
 void MpvPlayer::HandleMpvEvent(mpv_event* event) {
   if (plezy::mpv_common::DispatchReplyEvent(
-          pending_requests_, event, [](const char* value) { return SanitizeUtf8(value); })) {
+          pending_requests_, event, [](const char* value) { return SanitizeUtf8(value); }, &event_loop_stats_)) {
     return;
   }
 
@@ -1094,6 +1571,22 @@ void MpvPlayer::HandleMpvEvent(mpv_event* event) {
       if (event->reply_userdata == kHwdecCurrentUserdata) {
         const char* value = node.format == MPV_FORMAT_STRING ? node.u.string : nullptr;
         g_message("MPV: hwdec-current=%s", value && value[0] != '\0' ? value : "(none)");
+        hwdec_ladder_.OnDecoderChanged(value ? value : "", MonotonicMs());
+        SendDecodePathReport("hwdec-current");
+        break;
+      }
+      if (event->reply_userdata == kDecoderDropsUserdata) {
+        if (node.format == MPV_FORMAT_INT64) {
+          decoder_drops_ = node.u.int64;
+          OnFrameDrops();
+        }
+        break;
+      }
+      if (event->reply_userdata == kVoDropsUserdata) {
+        if (node.format == MPV_FORMAT_INT64) {
+          vo_drops_ = node.u.int64;
+          OnFrameDrops();
+        }
         break;
       }
 
@@ -1102,7 +1595,7 @@ void MpvPlayer::HandleMpvEvent(mpv_event* event) {
       // Recovery runs off a GLib timer here, so newly queued work has to arm it.
       if (notice.scheduled_work) EnsureAudioRecoveryTimer();
 
-      SendPropertyChange(prop->name, &node);
+      SendPropertyChange(event->reply_userdata, &node);
       break;
     }
     case MPV_EVENT_END_FILE: {
@@ -1127,10 +1620,22 @@ void MpvPlayer::HandleMpvEvent(mpv_event* event) {
       }
       SendEvent("end-file", data);
       fl_value_unref(data);
+      std::string preloaded;
+      if (next_item_.OnEndFile(end->playlist_entry_id, end->reason == MPV_END_FILE_REASON_ERROR, &preloaded) ==
+          plezy::mpv_common::NextItemPreload::Outcome::kFailed) {
+        SendPreloadEvent("failed", preloaded, end->error);
+      }
       break;
     }
     case MPV_EVENT_START_FILE: {
+      hwdec_ladder_.OnFileStarted(MonotonicMs());
       SendEvent("start-file");
+      auto* start = static_cast<mpv_event_start_file*>(event->data);
+      std::string preloaded;
+      if (start && next_item_.OnStartFile(start->playlist_entry_id, &preloaded) ==
+                       plezy::mpv_common::NextItemPreload::Outcome::kPromoted) {
+        SendPreloadEvent("promoted", preloaded);
+      }
       break;
     }
     case MPV_EVENT_FILE_LOADED: {
@@ -1155,6 +1660,7 @@ struct FlValueNodeBuilder {
   using Value = FlValue*;
   using ListBuilder = FlValue*;
   using MapBuilder = FlValue*;
+  using Key = std::string;
 
   static Value Null() { return fl_value_new_null(); }
   static Value Boolean(bool value) { return fl_value_new_bool(value); }
@@ -1164,39 +1670,82 @@ struct FlValueNodeBuilder {
     return fl_value_new_string(SanitizeUtf8(value, length).c_str());
   }
 
-  static ListBuilder NewList() { return fl_value_new_list(); }
+  static ListBuilder NewList(size_t) { return fl_value_new_list(); }
   static void Append(ListBuilder& list, Value value) { fl_value_append_take(list, value); }
   static Value FinishList(ListBuilder list) { return list; }
 
-  static MapBuilder NewMap() { return fl_value_new_map(); }
-  static void Insert(MapBuilder& map, const char* key, size_t key_length, Value value) {
-    fl_value_set_string_take(map, SanitizeUtf8(key, key_length).c_str(), value);
-  }
+  static MapBuilder NewMap(size_t) { return fl_value_new_map(); }
+  static Key MapKey(const char* key, size_t key_length) { return SanitizeUtf8(key, key_length); }
+  static void Insert(MapBuilder& map, Key key, Value value) { fl_value_set_string_take(map, key.c_str(), value); }
   static Value FinishMap(MapBuilder map) { return map; }
   static void AbandonMap(MapBuilder& map) { fl_value_unref(map); }
 };
 
+// First byte of a StandardMethodCodec success envelope; the event channel
+// wraps every event in one.
+constexpr uint8_t kSuccessEnvelope = 0;
+
 }  // namespace
 
+void StagedPropertyRelease::operator()(StagedPropertyValue& staged) const {
+  if (staged.value) fl_value_unref(staged.value);
+  staged.value = nullptr;
+}
+
+FlValue* MpvPlayer::GetEventLoopStats(bool reset) {
+  FlValueNodeBuilder builder;
+  FlValue* stats = plezy::mpv_common::EmitEventLoopStats(event_loop_stats_.Read(), builder);
+  if (reset) {
+    event_loop_stats_.Reset();
+    // The periodic log measures from here too, rather than going negative.
+    stats_logged_ = plezy::mpv_common::EventLoopStats::Snapshot();
+  }
+  return stats;
+}
+
 FlValue* MpvPlayer::NodeToFlValue(mpv_node* node) { return plezy::mpv_common::ConvertNode<FlValueNodeBuilder>(node); }
 
 FlValue* MpvPlayer::NodeToFlValue(mpv_node* node, plezy::mpv_common::NodeConversionBudget* budget) {
   return plezy::mpv_common::ConvertNode<FlValueNodeBuilder>(node, 0, budget);
 }
 
-void MpvPlayer::SendPropertyChange(const char* name, mpv_node* data) {
-  if (!name) return;
+template <typename Emit>
+void MpvPlayer::DeliverPropertyValue(int id, int wire_id, Emit emit) {
+  if (batch_property_changes_) {
+    // Converted now because mpv reclaims the node with the next event; a
+    // later change to the same property releases this one unsent.
+    StagedPropertyValue staged;
+    staged.wire_id = wire_id;
+    if (encode_property_changes_) {
+      property_writer_.Clear();
+      plezy::mpv_common::StandardCodecNodeBuilder<SimdutfUtf8> builder(&property_writer_);
+      emit(builder);
+      staged.encoded = property_writer_.TakeEncoded();
+    } else {
+      FlValueNodeBuilder builder;
+      staged.value = emit(builder);
+    }
+    property_batch_.Stage(id, std::move(staged));
+    return;
+  }
 
-  int id = 0;
-  if (!observed_properties_.LookupId(name, &id)) return;
+  if (encode_property_changes_) {
+    // [id, value] inside a success envelope, exactly what the event channel's
+    // codec would have produced from the tree.
+    property_writer_.Clear();
+    property_writer_.WriteByte(kSuccessEnvelope);
+    property_writer_.BeginList(2);
+    property_writer_.WriteInt(wire_id);
+    plezy::mpv_common::StandardCodecNodeBuilder<SimdutfUtf8> builder(&property_writer_);
+    emit(builder);
+    SendEncoded();
+    return;
+  }
 
+  FlValueNodeBuilder builder;
   FlValue* list = fl_value_new_list();
-  fl_value_append_take(list, fl_value_new_int(id));
-  if (data) {
-    fl_value_append_take(list, NodeToFlValue(data));
-  } else {
-    fl_value_append_take(list, fl_value_new_null());
-  }
+  fl_value_append_take(list, fl_value_new_int(wire_id));
+  fl_value_append_take(list, emit(builder));
 
   EventCallback callback;
   {
@@ -1207,7 +1756,189 @@ void MpvPlayer::SendPropertyChange(const char* name, mpv_node* data) {
   fl_value_unref(list);
 }
 
+void MpvPlayer::SendPropertyChange(uint64_t userdata, mpv_node* data) {
+  int id = 0;
+  if (!observed_properties_.LookupIdForUserdata(userdata, &id)) return;
+
+  auto patched = patched_properties_.find(id);
+  if (patched != patched_properties_.end()) {
+    plezy::mpv_common::RefillNodeSnapshot(data, &patched->second.latest);
+    SendPatchedPropertyChange(id, patched->second);
+    return;
+  }
+
+  // A missing node goes out as null, which is what the walk makes of it.
+  DeliverPropertyValue(id, id, [&](auto& builder) {
+    plezy::mpv_common::NodeConversionBudget budget;
+    return plezy::mpv_common::ConvertNode(data, 0, &budget, builder);
+  });
+}
+
+void MpvPlayer::SendPatchedPropertyChange(int id, PatchedProperty& property) {
+  const plezy::mpv_common::NodeSnapshot& snapshot = property.latest;
+  std::vector<plezy::mpv_common::NodePatchOp> ops;
+  const bool patch = property.has_committed &&
+                     plezy::mpv_common::DiffNodeSnapshots(
+                         property.committed, snapshot, plezy::mpv_common::kMaxNodePatchOps, &ops);
+  // Back to exactly what Dart holds. A staged value would still replace it,
+  // so only then does the empty patch need to go.
+  if (patch && ops.empty() && !property.has_pending) return;
+
+  // The ops point into both snapshots; they are emitted before either moves.
+  if (patch) {
+    DeliverPropertyValue(id, plezy::mpv_common::PatchPropertyId(id), [&](auto& builder) {
+      return plezy::mpv_common::EmitNodePatch(ops, builder);
+    });
+  } else {
+    DeliverPropertyValue(
+        id, id, [&](auto& builder) { return plezy::mpv_common::EmitNodeSnapshot(snapshot, builder); });
+  }
+
+  // Without batching Dart has it now; with it, once the flush sends it. The
+  // value it replaces is left in `latest` for the next change to refill.
+  if (batch_property_changes_) {
+    std::swap(property.pending, property.latest);
+    property.has_pending = true;
+  } else {
+    std::swap(property.committed, property.latest);
+    property.has_committed = true;
+  }
+}
+
+void MpvPlayer::FlushPropertyBatch(bool force) {
+  if (!batch_property_changes_ || !property_batch_.HasStaged()) return;
+
+  using Coalescer = plezy::mpv_common::PropertyChangeCoalescer<StagedPropertyValue, StagedPropertyRelease>;
+  const auto now = Coalescer::Clock::now();
+  std::vector<Coalescer::Change> due;
+  Coalescer::Clock::time_point next_due{};
+  const bool held = property_batch_.TakeDue(now, force, &due, &next_due);
+  if (held) {
+    const auto delay = std::chrono::duration_cast<std::chrono::milliseconds>(next_due - now).count();
+    SchedulePropertyFlushSource(static_cast<guint>(std::max<int64_t>(delay, 1)));
+  }
+  if (due.empty()) return;
+
+  // What goes out now is what Dart will patch against next.
+  for (const auto& change : due) {
+    auto patched = patched_properties_.find(change.id);
+    if (patched == patched_properties_.end() || !patched->second.has_pending) continue;
+    std::swap(patched->second.committed, patched->second.pending);
+    patched->second.has_committed = true;
+    patched->second.has_pending = false;
+  }
+
+  // Flat [id, value, id, value, ...] pairs, in the order the properties first
+  // changed during the drain: Dart applies them exactly as it would the same
+  // changes sent one at a time. Everything staged has the same form, because
+  // switching sinks flushes first.
+  if (encode_property_changes_) {
+    static constexpr char kType[] = "type";
+    static constexpr char kBatch[] = "property-batch";
+    static constexpr char kChanges[] = "changes";
+    property_writer_.Clear();
+    property_writer_.WriteByte(kSuccessEnvelope);
+    property_writer_.BeginMap(2);
+    property_writer_.WriteString(kType, sizeof(kType) - 1);
+    property_writer_.WriteString(kBatch, sizeof(kBatch) - 1);
+    property_writer_.WriteString(kChanges, sizeof(kChanges) - 1);
+    property_writer_.BeginList(due.size() * 2);
+    for (const auto& change : due) {
+      property_writer_.WriteInt(change.value.wire_id);
+      property_writer_.AppendEncoded(change.value.encoded);
+    }
+    SendEncoded();
+    return;
+  }
+
+  FlValue* changes = fl_value_new_list();
+  for (auto& change : due) {
+    fl_value_append_take(changes, fl_value_new_int(change.value.wire_id));
+    fl_value_append_take(changes, change.value.value);
+  }
+  FlValue* batch = fl_value_new_map();
+  fl_value_set_string_take(batch, "type", fl_value_new_string("property-batch"));
+  fl_value_set_string_take(batch, "changes", changes);
+
+  EventCallback callback;
+  {
+    std::lock_guard<std::mutex> lock(callback_mutex_);
+    callback = event_callback_;
+  }
+  if (callback) callback(batch);
+  fl_value_unref(batch);
+}
+
+void MpvPlayer::SendEncoded() {
+  EncodedEventCallback callback;
+  {
+    std::lock_guard<std::mutex> lock(callback_mutex_);
+    callback = encoded_event_callback_;
+  }
+  if (callback) callback(property_writer_.data(), property_writer_.size());
+}
+
+void MpvPlayer::SendPreloadEvent(const char* state, const std::string& url, int error) {
+  FlValue* data = fl_value_new_map();
+  fl_value_set_string_take(data, "state", fl_value_new_string(state));
+  fl_value_set_string_take(data, "url", fl_value_new_string(SanitizeUtf8(url.data(), url.size()).c_str()));
+  if (error < 0) {
+    fl_value_set_string_take(data, "error", fl_value_new_int(error));
+    fl_value_set_string_take(data, "message", fl_value_new_string(SanitizeUtf8(mpv_error_string(error)).c_str()));
+  }
+  SendEvent("preload", data);
+  fl_value_unref(data);
+}
+
+void MpvPlayer::SendDecodePathReport(const char* cause) {
+  FlValue* data = fl_value_new_map();
+  fl_value_set_string_take(data, "cause", fl_value_new_string(cause));
+  fl_value_set_string_take(
+      data, "requested", fl_value_new_string(SanitizeUtf8(hwdec_ladder_.requested().c_str()).c_str()));
+  fl_value_set_string_take(
+      data, "current", fl_value_new_string(SanitizeUtf8(hwdec_ladder_.current().c_str()).c_str()));
+  fl_value_set_string_take(data, "interopAvailable", fl_value_new_bool(hwdec_interop_available_));
+  fl_value_set_string_take(data, "softwareRenderer", fl_value_new_bool(software_gl_renderer_));
+  fl_value_set_string_take(data, "decoderDrops", fl_value_new_int(decoder_drops_));
+  fl_value_set_string_take(data, "voDrops", fl_value_new_int(vo_drops_));
+  fl_value_set_string_take(data, "fallbackEnabled", fl_value_new_bool(hwdec_ladder_.enabled()));
+  fl_value_set_string_take(data, "fallbackSteps", fl_value_new_int(hwdec_ladder_.steps()));
+  SendEvent("decode-path", data);
+  fl_value_unref(data);
+}
+
+void MpvPlayer::OnFrameDrops() {
+  const std::string next = hwdec_ladder_.OnDrops(decoder_drops_, vo_drops_, MonotonicMs());
+  if (next.empty() || disposed_ || !mpv_) return;
+  g_warning(
+      "MPV: dropping frames on hwdec-current=%s (decoder %" G_GINT64_FORMAT ", vo %" G_GINT64_FORMAT
+      " so far); falling back to hwdec=%s",
+      hwdec_ladder_.current().c_str(), static_cast<gint64>(decoder_drops_), static_cast<gint64>(vo_drops_),
+      next.c_str());
+  // Straight to the core rather than through SetPropertyAsync, which would
+  // take this for a new request and start the ladder over.
+  plezy::mpv_common::SubmitSetPropertyAsync(mpv_, pending_requests_, "hwdec", next, [this, next](int error) {
+    if (error < 0 && !disposed_) {
+      g_warning("MPV: hwdec fallback to %s failed: %s", next.c_str(), mpv_error_string(error));
+    }
+  });
+  SendDecodePathReport("fallback");
+}
+
+void MpvPlayer::SetHwdecFallbackEnabled(bool enabled) {
+  hwdec_ladder_.SetEnabled(enabled);
+  if (enabled || hwdec_ladder_.steps() == 0) return;
+  const std::string requested = hwdec_ladder_.requested();
+  SetPropertyAsync("hwdec", requested, nullptr);
+}
+
 void MpvPlayer::SendEvent(const std::string& name, FlValue* data) {
+  // A property that changed before this event must not reach Dart after it:
+  // file-loaded, end-file and playback-restart are all read against the
+  // property state they follow. Log lines carry no such ordering and arrive
+  // often enough to defeat the minimum intervals, so they do not flush.
+  if (name != "log-message") FlushPropertyBatch(true);
+
   FlValue* event_map = fl_value_new_map();
   fl_value_set_string_take(event_map, "type", fl_value_new_string("event"));
   fl_value_set_string_take(event_map, "name", fl_value_new_string(name.c_str()));
@@ -1344,6 +2075,11 @@ void MpvPlayer::ConfigurePropertyWritesForTesting(PropertyWriteForTesting writer
   test_property_write_ = std::move(writer);
 }
 
+void MpvPlayer::ConfigureRenderForTesting(std::function<void()> render) {
+  std::lock_guard<std::mutex> render_lock(render_mutex_);
+  test_render_ = std::move(render);
+}
+
 MpvPlayer::AppliedOutputColourSpace MpvPlayer::AppliedOutputColourSpaceForTesting() const {
   return {applied_target_trc_, applied_target_prim_, applied_tone_mapping_, applied_target_peak_};
 }
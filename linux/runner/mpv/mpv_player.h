@@ -9,6 +9,7 @@
 #include <mpv/render_gl.h>
 
 #include <atomic>
+#include <chrono>
 #include <condition_variable>
 #include <deque>
 #include <functional>
@@ -17,10 +18,13 @@
 #include <string>
 #include <thread>
 #include <tuple>
+#include <unordered_map>
 #include <vector>
 
 #include "../../../shared/mpv/mpv_player_common.h"
 #include "hdr_metadata.h"
+#include "hwdec_fallback.h"
+#include "teardown_retry.h"
 #include "video_params.h"
 
 // Forward declaration for Flutter types
@@ -35,6 +39,24 @@ using EventCallback = std::function<void(::_FlValue*)>;
 /// Callback for requesting a redraw (called from mpv render update thread).
 using RedrawCallback = std::function<void()>;
 
+/// Callback for property changes that arrive already encoded: a complete
+/// StandardMethodCodec success envelope, ready for the event channel as is.
+using EncodedEventCallback = std::function<void(const uint8_t* data, size_t size)>;
+
+/// A staged property change, in the form of the sink that will carry it: a
+/// tree for EventCallback, bytes for EncodedEventCallback.
+struct StagedPropertyValue {
+  // The id Dart receives it under: the property's own, or its patch id.
+  int wire_id = 0;
+  ::_FlValue* value = nullptr;
+  plezy::mpv_common::StandardMessageWriter::Encoded encoded;
+};
+
+/// Drops the reference a staged tree holds; defined where FlValue is.
+struct StagedPropertyRelease {
+  void operator()(StagedPropertyValue& staged) const;
+};
+
 // Linux-runner-internal teardown boundary. A render context may only be
 // released while its EGL context is current; the batch retains the shared mpv
 // handle until every render/context pair has been safely released.
@@ -56,6 +78,9 @@ struct NativeRenderTeardownOperations {
   std::function<bool(EGLDisplay, EGLContext)> destroy_context;
   std::function<void(mpv_render_context*)> free_render;
   std::function<void(mpv_handle*)> terminate_handle;
+  // Unbinds whatever the calling teardown worker still has current and frees
+  // its EGL thread state, before the worker exits. Optional.
+  std::function<void(EGLDisplay)> release_thread;
 };
 
 // Attempts one teardown pass. Failed resources remain owned by |batch| for a
@@ -79,11 +104,27 @@ class MpvPlayer {
   explicit MpvPlayer(bool audio_only = false);
   ~MpvPlayer();
 
-  /// Initializes the mpv instance and configures options.
+  /// A core warmed ahead of its player by the plugin's standby pool (see
+  /// plezy::mpv_common::StandbyCorePool): an initialised, idle handle, or null
+  /// when warming failed.
+  struct StandbyCore {
+    mpv_handle* mpv = nullptr;
+  };
+
+  /// Main thread, before each warm. False when no core can be made.
+  static bool PrepareStandbyCore();
+  /// Any thread: creates and initialises a standby core's handle.
+  static void WarmStandbyCore(StandbyCore* core, bool audio_only);
+  /// Hands a core no player claimed to the teardown thread.
+  static void DiscardStandbyCore(StandbyCore core);
+
+  /// Initializes the mpv instance and configures options, adopting a claimed
+  /// |standby| core's handle instead of creating one; whatever the call takes
+  /// from it is cleared.
   /// Does NOT create the render context — call InitRenderContextForSurface()
   /// once the video plane's EGL surface exists.
   /// @return true if initialization succeeded.
-  bool Initialize();
+  bool Initialize(StandbyCore* standby = nullptr);
 
   /// Creates the mpv render context bound to the app-owned EGL window surface
   /// backing the Wayland video plane. This is the only render path: nothing
@@ -95,14 +136,40 @@ class MpvPlayer {
   /// the render API's OpenGL backend ignores mpv_opengl_fbo::internal_format —
   /// and assumes 8 when it is absent, which would dither a PQ plane to 8 bits
   /// and band it exactly where the 10-bit config was chosen to avoid that.
+  /// `config` may be EGL_NO_CONFIG_KHR, for a plane that changes depth later.
   /// @return true if render context creation succeeded.
   bool InitRenderContextForSurface(EGLDisplay display, EGLConfig config, EGLSurface surface, int depth_bits);
 
+  /// The plane moved to a surface of `depth_bits` per channel (see
+  /// plane_format.h); renders from now on tell mpv so.
+  void SetSurfaceDepthBits(int depth_bits);
+
   /// Renders one frame into |surface|'s default framebuffer. The caller
-  /// presents it (eglSwapBuffers) once this returns.
+  /// presents it (eglSwapBuffers) once this returns. The context is made
+  /// current on the calling thread and left there, so renders come from one
+  /// thread at a time, and moving them to another starts with
+  /// ReleaseRenderContext() on the old one.
   /// @return true if the frame was rendered.
   bool RenderToSurface(EGLSurface surface, int width, int height);
 
+  /// Releases the plane's context if it is current on the calling thread.
+  /// An EGLContext is current to at most one thread, so this is what lets
+  /// another thread - a render thread, or the teardown worker - bind it next.
+  void ReleaseRenderContext();
+
+  /// Whether RenderToSurface waits inside mpv for the frame's target time,
+  /// which is mpv's default. A caller that times its renders to the display
+  /// itself turns this off, or the wait would land on the GTK main thread.
+  void SetBlockForTargetTime(bool block) { block_for_target_time_.store(block); }
+
+  /// When mpv wants its next frame shown, on g_get_monotonic_time()'s clock.
+  /// False when no new frame is queued or mpv gives it no time.
+  bool NextFrameTargetTime(int64_t* monotonic_us);
+
+  /// Tells mpv a rendered frame has just reached the screen, so its timing
+  /// follows real presentations rather than the render calls.
+  void ReportSwap();
+
   /// Disposes mpv and releases resources.
   void Dispose();
 
@@ -127,6 +194,22 @@ class MpvPlayer {
   /// Executes an mpv command asynchronously to prevent UI blocking.
   void CommandAsync(const std::vector<std::string>& args, CommandCallback callback);
 
+  /// Queues |url| as the next title (see plezy::mpv_common::NextItemPreload):
+  /// appended after the playing one with prefetch on, replacing any title
+  /// queued before it. |options| are mpv per-entry options for it alone. The
+  /// callback reports the append; a `preload` event follows with `ready`, and
+  /// later `promoted` or `failed`.
+  void Preload(const std::string& url, const std::string& options, StatusCallback callback);
+
+  /// Switches to the preloaded title. False, without calling back, when there
+  /// is none queued.
+  bool Promote(StatusCallback callback);
+
+  /// Whether frame drops step hwdec down on their own (see
+  /// hwdec_fallback.h). On by default; turning it off restores the requested
+  /// mode if the ladder had stepped away from it.
+  void SetHwdecFallbackEnabled(bool enabled);
+
   /// Sets an mpv property by name.
   void SetProperty(const std::string& name, const std::string& value);
 
@@ -200,6 +283,11 @@ class MpvPlayer {
     std::string target_peak;
   };
   AppliedOutputColourSpace AppliedOutputColourSpaceForTesting() const;
+
+  /// Replaces RenderToSurface's EGL and mpv work with |render|, run under the
+  /// same locks, so what a render holds while it runs can be observed without
+  /// a GPU.
+  void ConfigureRenderForTesting(std::function<void()> render);
 #endif
 
   /// Copies the current source's colour space and HDR10 static metadata out of
@@ -224,18 +312,52 @@ class MpvPlayer {
   /// Gets an mpv property value asynchronously.
   void GetPropertyAsync(const std::string& name, GetPropertyCallback callback);
 
-  /// Observes an mpv property for changes.
-  void ObserveProperty(const std::string& name, const std::string& format, int id);
+  /// Observes an mpv property for changes. A positive |min_interval_ms| holds
+  /// the property's changes back to at most one per interval while property
+  /// batching is on; its latest value still goes out once the interval ends.
+  /// |patch| makes a node property send a patch against the value Dart last
+  /// received instead of the whole value, whenever that is smaller.
+  void ObserveProperty(
+      const std::string& name, const std::string& format, int id, int min_interval_ms = 0, bool patch = false);
+
+  /// Sends a patched property's latest value whole, for a Dart side that could
+  /// not apply a patch to what it holds.
+  void ResyncProperty(int id);
+
+  /// Switches property-change delivery between one event per change (the
+  /// default) and one `property-batch` event per drain of mpv's queue, carrying
+  /// only the last value each observed property reached. Turning it off flushes
+  /// whatever is staged first.
+  void SetPropertyBatching(bool enabled);
+
+  /// The event loop's histograms (see plezy::mpv_common::EventLoopStats) as a
+  /// map for the method channel. |reset| starts them over once read.
+  ::_FlValue* GetEventLoopStats(bool reset);
+
+  /// Logs the event loop's percentiles for each interval of |interval_ms| that
+  /// saw events, as a `log-message` as well as to the GLib log. 0 stops it.
+  void SetEventLoopStatsLogInterval(int interval_ms);
 
   /// Sets the event callback for property changes and events.
   void SetEventCallback(EventCallback callback);
 
+  /// Sets the sink for pre-encoded property changes. While one is set,
+  /// property changes are streamed straight from mpv's node into codec bytes
+  /// and go here instead of to the event callback; named events still use the
+  /// event callback. Anything staged for the previous sink is flushed to it
+  /// first.
+  void SetEncodedEventCallback(EncodedEventCallback callback);
+
   /// Sets the redraw callback (called when mpv has a new frame ready).
   void SetRedrawCallback(RedrawCallback callback);
 
   /// Returns true if a redraw is needed.
   bool NeedsRedraw() const { return needs_redraw_.load(); }
 
+  /// When mpv last set the redraw flag, on g_get_monotonic_time()'s clock.
+  /// Only meaningful while NeedsRedraw() holds.
+  int64_t RedrawRequestedAt() const { return redraw_requested_at_.load(std::memory_order_relaxed); }
+
   /// Clears the redraw flag.
   void ClearRedrawFlag() { needs_redraw_.store(false); }
 
@@ -251,9 +373,21 @@ class MpvPlayer {
   bool CanCommandOutputProperties() const;
 
   /// Retries process-owned native teardown work on the managed EGL teardown
-  /// thread. Primarily useful before creating another render context.
+  /// workers. Primarily useful before creating another render context.
   static void RetryPendingNativeTeardown();
 
+  /// What the teardown workers are still holding, and how they have fared.
+  static TeardownQueueStats NativeTeardownStats();
+
+  /// Blocks up to |timeout| for every disposed core to be released; false if
+  /// some were still queued or tearing down when it expired. For application
+  /// exit, which otherwise leaves in-flight teardown to die with the process.
+  static bool WaitForNativeTeardown(std::chrono::milliseconds timeout);
+
+  /// How often the teardown workers retry what it could not release; see
+  /// teardown_retry.h. Process-wide.
+  static void SetNativeTeardownRetryPolicy(TeardownRetryPolicy policy);
+
  private:
   class CallbackContext {
    public:
@@ -301,6 +435,7 @@ class MpvPlayer {
   friend class MpvPlayerLifecycleTestPeer;
 
   /// MPV event wakeup callback (called from mpv thread).
+  static mpv_handle* CreateCore(bool audio_only, bool hdr_enabled);
   static void OnMpvWakeup(void* ctx);
 
   /// MPV render update callback (called when frame is ready).
@@ -309,11 +444,13 @@ class MpvPlayer {
   static gboolean DispatchWakeupSource(gpointer data);
   static gboolean DispatchRedrawSource(gpointer data);
   static gboolean DispatchRecoverySource(gpointer data);
+  static gboolean DispatchPropertyFlushSource(gpointer data);
   static void DestroySourceCallbackData(gpointer data);
 
   void ScheduleWakeupSource();
   void ScheduleRedrawSource();
   void ScheduleRecoverySource();
+  void SchedulePropertyFlushSource(guint delay_ms);
   void RemoveTrackedSources();
 
   /// Processes pending mpv events.
@@ -322,8 +459,44 @@ class MpvPlayer {
   /// Handles a single mpv event.
   void HandleMpvEvent(mpv_event* event);
 
-  /// Sends a property change notification.
-  void SendPropertyChange(const char* name, mpv_node* data);
+  /// Sends a property change notification for the Dart observation that owns
+  /// `userdata` (the event's reply_userdata), or stages it while batching.
+  void SendPropertyChange(uint64_t userdata, mpv_node* data);
+
+  /// A node property observed in patch mode. `committed` is the value Dart
+  /// holds; while batching, `pending` is the one staged to replace it.
+  /// `latest` is the value being sent. The three trade places by swapping,
+  /// so each change refills storage an earlier one left behind.
+  struct PatchedProperty {
+    bool has_committed = false;
+    plezy::mpv_common::NodeSnapshot committed;
+    bool has_pending = false;
+    plezy::mpv_common::NodeSnapshot pending;
+    plezy::mpv_common::NodeSnapshot latest;
+  };
+
+  /// Sends a patched property's `latest` value as a patch against what Dart
+  /// holds, or whole when there is no such value or the patch would not be
+  /// smaller.
+  void SendPatchedPropertyChange(int id, PatchedProperty& property);
+
+  /// Delivers one property value under |wire_id|, in whichever form the
+  /// current sink and batching mode call for. |emit| builds the value with
+  /// the node builder it is handed.
+  template <typename Emit>
+  void DeliverPropertyValue(int id, int wire_id, Emit emit);
+
+  /// Sends every staged property change that is due as one `property-batch`
+  /// event, and arms a timer for any a minimum interval is still holding.
+  /// |force| sends the held ones too.
+  void FlushPropertyBatch(bool force);
+
+  /// Hands property_writer_'s content to the encoded sink, if there is one.
+  void SendEncoded();
+
+  /// Logs what the event loop recorded since the last log, once the log
+  /// interval has passed.
+  void MaybeLogEventLoopStats();
 
   /// Reparses the `video-params` payload into source_hdr_metadata_ and tells
   /// the source-metadata callback that it moved. The parse happens under
@@ -333,6 +506,15 @@ class MpvPlayer {
 
   /// Sends an event notification.
   void SendEvent(const std::string& name, ::_FlValue* data = nullptr);
+  /// Sends a `preload` event: |state| of the title queued as |url|.
+  void SendPreloadEvent(const char* state, const std::string& url, int error = 0);
+  /// Sends a `decode-path` event: what was asked of hwdec, what mpv is using,
+  /// whether the plane's GL context can take zero-copy frames at all, and the
+  /// drop counters, with |cause| naming what prompted it.
+  void SendDecodePathReport(const char* cause);
+  /// Feeds both drop counters to the hwdec fallback ladder and steps down when
+  /// it says to.
+  void OnFrameDrops();
   void MaybeRunAudioRecovery();
   void TryAudioReload(const char* reason, int attempt, uint64_t request_generation);
   void EnsureAudioRecoveryTimer();
@@ -432,25 +614,68 @@ class MpvPlayer {
   // The substituted property-write primitive; empty in every build that has a
   // real core to write to. See ConfigurePropertyWritesForTesting.
   PropertyWriteForTesting test_property_write_;
+  // Guarded by render_mutex_; see ConfigureRenderForTesting.
+  std::function<void()> test_render_;
 #endif
   // Bits per colour channel of the video plane, told to mpv on every render so
   // it dithers to the plane's real precision instead of the assumed 8.
   int surface_depth_bits_ = 8;
+  // The surface eglSwapInterval was last set on. The interval belongs to the
+  // surface, so one the plane swaps in later needs it set again. Guarded by
+  // render_mutex_.
+  EGLSurface swap_interval_surface_ = EGL_NO_SURFACE;
+  std::atomic<bool> block_for_target_time_{true};
   // What `video-params` last reported, parsed once on the change event instead
   // of read back from the core on every HDR decision. Guarded by native_mutex_:
   // written from event handling, read by ReadSourceHdrMetadata.
   SourceHdrMetadata source_hdr_metadata_;
   mutable std::mutex native_mutex_;
+  // Held for each use of the render context: a render, the next-frame and swap
+  // calls mpv serialises with it, and Dispose's handoff of the context to
+  // teardown. Taken before native_mutex_, never after, and separate from it so
+  // the main thread's uses of native_mutex_ do not wait out a render on the
+  // plane's thread.
+  std::mutex render_mutex_;
 
   std::atomic<bool> needs_redraw_{false};
+  std::atomic<int64_t> redraw_requested_at_{0};
   std::atomic<bool> disposed_{false};
   EventCallback event_callback_;
+  EncodedEventCallback encoded_event_callback_;
   RedrawCallback redraw_callback_;
   SourceMetadataCallback source_metadata_callback_;
   std::mutex callback_mutex_;
   plezy::mpv_common::AudioRecoveryState audio_recovery_;
   plezy::mpv_common::AsyncRequestRegistry pending_requests_;
   plezy::mpv_common::PropertyObservationRegistry observed_properties_;
+  plezy::mpv_common::EventLoopStats event_loop_stats_;
+  plezy::mpv_common::NextItemPreload next_item_;
+  // Decode-path telemetry and the hwdec fallback ladder. Main-context only:
+  // the GL probe runs in InitRenderContextForSurface and the rest in event
+  // handling.
+  HwdecFallbackLadder hwdec_ladder_;
+  bool hwdec_interop_available_ = false;
+  bool software_gl_renderer_ = false;
+  int64_t decoder_drops_ = 0;
+  int64_t vo_drops_ = 0;
+  // When the pending wakeup source was attached, as steady_clock ticks; 0 when
+  // none is pending. Written under source_mutex_, taken by ProcessEvents.
+  std::atomic<int64_t> wakeup_scheduled_at_{0};
+  // Periodic stats logging. Main-context only.
+  std::chrono::milliseconds stats_log_interval_{0};
+  plezy::mpv_common::EventLoopStats::Clock::time_point stats_logged_at_{};
+  plezy::mpv_common::EventLoopStats::Snapshot stats_logged_;
+  // Property batching state. Main-context only, like everything else that
+  // ProcessEvents touches.
+  bool batch_property_changes_ = false;
+  plezy::mpv_common::PropertyChangeCoalescer<StagedPropertyValue, StagedPropertyRelease> property_batch_;
+  // Whether an encoded sink is installed; decides which form SendPropertyChange
+  // produces. The writer is reused for every encoded message so it stops
+  // allocating once it has held the largest one.
+  bool encode_property_changes_ = false;
+  plezy::mpv_common::StandardMessageWriter property_writer_;
+  // Node properties observed in patch mode, by Dart id.
+  std::unordered_map<int, PatchedProperty> patched_properties_;
   bool hdr_enabled_ = true;
 
   // All player-carrying sources are attached to CallbackContext::main_context()
@@ -460,6 +685,7 @@ class MpvPlayer {
   guint wakeup_source_id_ = 0;
   guint redraw_source_id_ = 0;
   guint recovery_source_id_ = 0;
+  guint property_flush_source_id_ = 0;
 };
 
 }  // namespace mpv
@@ -9,15 +9,19 @@
 #include <condition_variable>
 #include <csignal>
 #include <cstdlib>
+#include <cstring>
 #include <exception>
+#include <functional>
 #include <iostream>
 #include <memory>
 #include <mutex>
 #include <stdexcept>
 #include <thread>
 #include <utility>
+#include <vector>
 
 #include "mpv_player.h"
+#include "plane_render_worker.h"
 
 namespace mpv {
 
@@ -55,8 +59,12 @@ class MpvPlayerLifecycleTestPeer {
     plezy::mpv_common::NodeConversionBudget budget{remaining_entries, remaining_bytes};
     return player.NodeToFlValue(node, &budget);
   }
-  static void RegisterObservedNode(MpvPlayer& player, const std::string& name, int id) {
-    player.observed_properties_.Register(name, "node", id);
+  static uint64_t RegisterObservedNode(MpvPlayer& player, const std::string& name, int id) {
+    return player.observed_properties_.Register(name, "node", id).userdata;
+  }
+  static uint64_t RegisterPatchedNode(MpvPlayer& player, const std::string& name, int id) {
+    player.patched_properties_[id] = MpvPlayer::PatchedProperty();
+    return RegisterObservedNode(player, name, id);
   }
   static void HandleEvent(MpvPlayer& player, mpv_event* event) { player.HandleMpvEvent(event); }
 
@@ -253,7 +261,7 @@ void TestNodeConversionRejectsMalformedPayloads() {
 
 void TestNullNodePropertyPayloadDecodesAsNull() {
   MpvPlayer player;
-  MpvPlayerLifecycleTestPeer::RegisterObservedNode(player, "track-list", 42);
+  const uint64_t userdata = MpvPlayerLifecycleTestPeer::RegisterObservedNode(player, "track-list", 42);
   bool delivered = false;
   player.SetEventCallback([&delivered](FlValue* event) {
     Check(fl_value_get_type(event) == FL_VALUE_TYPE_LIST, "property event must remain a list");
@@ -271,11 +279,98 @@ void TestNullNodePropertyPayloadDecodesAsNull() {
   property.data = nullptr;
   mpv_event event{};
   event.event_id = MPV_EVENT_PROPERTY_CHANGE;
+  event.reply_userdata = userdata;
   event.data = &property;
   MpvPlayerLifecycleTestPeer::HandleEvent(player, &event);
   Check(delivered, "null node property event was not delivered");
 }
 
+void TestEncodedPropertyChangeIsAStandardCodecEnvelope() {
+  MpvPlayer player;
+  const uint64_t userdata = MpvPlayerLifecycleTestPeer::RegisterObservedNode(player, "time-pos", 42);
+  bool tree_delivered = false;
+  player.SetEventCallback([&tree_delivered](FlValue*) { tree_delivered = true; });
+  std::vector<uint8_t> sent;
+  player.SetEncodedEventCallback([&sent](const uint8_t* data, size_t size) { sent.assign(data, data + size); });
+
+  const double position = 12.5;
+  mpv_event_property property{};
+  property.name = "time-pos";
+  property.format = MPV_FORMAT_DOUBLE;
+  property.data = const_cast<double*>(&position);
+  mpv_event event{};
+  event.event_id = MPV_EVENT_PROPERTY_CHANGE;
+  event.reply_userdata = userdata;
+  event.data = &property;
+  MpvPlayerLifecycleTestPeer::HandleEvent(player, &event);
+
+  // Success envelope, list of two, int32 42, then a float64 padded to the
+  // 8-byte boundary of the whole message - the envelope byte included, as the
+  // Dart decoder counts it.
+  std::vector<uint8_t> expected = {0, 12, 2, 3, 42, 0, 0, 0, 6, 0, 0, 0, 0, 0, 0, 0};
+  uint8_t raw[sizeof(position)];
+  std::memcpy(raw, &position, sizeof(position));
+  expected.insert(expected.end(), raw, raw + sizeof(raw));
+  Check(sent == expected, "encoded property change is not the event channel's envelope");
+  Check(!tree_delivered, "an encoded property change must not also be sent as a tree");
+}
+
+void TestPatchedPropertySendsOnlyWhatChanged() {
+  MpvPlayer player;
+  const uint64_t userdata = MpvPlayerLifecycleTestPeer::RegisterPatchedNode(player, "demuxer-cache-state", 42);
+  std::vector<FlValue*> sent;
+  player.SetEventCallback([&sent](FlValue* event) { sent.push_back(fl_value_ref(event)); });
+
+  char* keys[] = {const_cast<char*>("cache-end"), const_cast<char*>("eof")};
+  mpv_node values[2] = {};
+  values[0].format = MPV_FORMAT_DOUBLE;
+  values[0].u.double_ = 10.0;
+  values[1].format = MPV_FORMAT_FLAG;
+  values[1].u.flag = 0;
+  mpv_node_list map{2, values, keys};
+  mpv_node root{};
+  root.format = MPV_FORMAT_NODE_MAP;
+  root.u.list = &map;
+  mpv_event_property property{};
+  property.name = "demuxer-cache-state";
+  property.format = MPV_FORMAT_NODE;
+  property.data = &root;
+  mpv_event event{};
+  event.event_id = MPV_EVENT_PROPERTY_CHANGE;
+  event.reply_userdata = userdata;
+  event.data = &property;
+
+  auto sent_id = [&sent](size_t index) { return fl_value_get_int(fl_value_get_list_value(sent[index], 0)); };
+  MpvPlayerLifecycleTestPeer::HandleEvent(player, &event);
+  Check(sent.size() == 1 && sent_id(0) == 42, "the first value of a patched property must be whole");
+  Check(
+      fl_value_get_type(fl_value_get_list_value(sent[0], 1)) == FL_VALUE_TYPE_MAP,
+      "the first value of a patched property must be the node itself");
+
+  values[0].u.double_ = 12.0;
+  MpvPlayerLifecycleTestPeer::HandleEvent(player, &event);
+  Check(sent.size() == 2 && sent_id(1) == -43, "a changed patched property must travel under its patch id");
+  FlValue* ops = fl_value_get_list_value(sent[1], 1);
+  Check(fl_value_get_length(ops) == 1, "one changed leaf must be one patch op");
+  FlValue* op = fl_value_get_list_value(ops, 0);
+  Check(fl_value_get_int(fl_value_get_list_value(op, 0)) == 0, "a changed leaf must be a set");
+  Check(
+      strcmp(fl_value_get_string(fl_value_get_list_value(fl_value_get_list_value(op, 1), 0)), "cache-end") == 0,
+      "the set must name the changed key");
+  Check(fl_value_get_float(fl_value_get_list_value(op, 2)) == 12.0, "the set must carry the new value");
+
+  MpvPlayerLifecycleTestPeer::HandleEvent(player, &event);
+  Check(sent.size() == 2, "an unchanged patched property must send nothing");
+
+  player.ResyncProperty(42);
+  Check(sent.size() == 3 && sent_id(2) == 42, "a resync must send the whole value");
+  values[1].u.flag = 1;
+  MpvPlayerLifecycleTestPeer::HandleEvent(player, &event);
+  Check(sent.size() == 4 && sent_id(3) == -43, "changes after a resync must patch the resent value");
+
+  for (FlValue* value : sent) fl_value_unref(value);
+}
+
 void TestUnavailableCommandFails() {
   MpvPlayer player;
   int callback_count = 0;
@@ -379,6 +474,55 @@ void TestNativeLeaseBlocksDispose() {
   MpvPlayerLifecycleTestPeer::RenderUpdate(callback_context);
 }
 
+// A render on the plane's thread must not hold the lock the GTK main thread
+// takes for event handling and HDR decisions (video-params, end-file, the
+// source metadata read), or a slow render stalls the UI all the same.
+void TestMainThreadDoesNotWaitOutARender() {
+  MpvPlayer player;
+  std::mutex mutex;
+  std::condition_variable condition;
+  bool rendering = false;
+  bool release = false;
+  bool render_ended = false;
+  player.ConfigureRenderForTesting([&]() {
+    std::unique_lock<std::mutex> lock(mutex);
+    rendering = true;
+    condition.notify_all();
+    // A slow render: it ends when the test says so, or after five seconds if
+    // the main thread below never gets the chance.
+    condition.wait_for(lock, std::chrono::seconds(5), [&release]() { return release; });
+    render_ended = true;
+  });
+
+  PlaneRenderWorker worker([]() {}, []() {});
+  bool rendered = false;
+  const bool submitted = worker.Submit(
+      [&]() { rendered = player.RenderToSurface(EGL_NO_SURFACE, 1, 1); }, [](bool) {}, PlaneRenderWorker::Clock::now());
+  Check(submitted, "the render worker must accept a frame");
+  {
+    std::unique_lock<std::mutex> lock(mutex);
+    condition.wait(lock, [&rendering]() { return rendering; });
+  }
+
+  SourceHdrMetadata metadata;
+  player.ReadSourceHdrMetadata(&metadata);
+  player.HasMpvHandle();
+  player.IsInitialized();
+  bool still_rendering = false;
+  {
+    std::lock_guard<std::mutex> lock(mutex);
+    still_rendering = !render_ended;
+    release = true;
+  }
+  condition.notify_all();
+  Check(still_rendering, "the main thread waited for the render to finish");
+
+  worker.Settle();
+  Check(rendered, "the substituted render must report a frame");
+  worker.Stop();
+  player.Dispose();
+}
+
 void TestWakeupAndRedrawCoalesce(GMainContext* context) {
   int redraws = 0;
   MpvPlayer player;
@@ -557,6 +701,136 @@ void TestFailedTeardownIsRetriedAndConsumedExactlyOnce() {
   Check(free_calls == 1 && destroy_calls == 1, "teardown must release each native object exactly once");
 }
 
+// The process-wide queue reports what it retains while a batch cannot be
+// released, and counts it released once it can. The queue's worker reads its
+// operations once, when it starts, so this has to be the first test in the
+// process to reach the queue; the operations outlive it along with the queue.
+std::atomic<bool> g_queue_allows_make_current{false};
+std::atomic<int> g_queue_terminated{0};
+// Teardown workers that gave up their EGL thread state on the way out.
+std::atomic<int> g_queue_threads_released{0};
+// While set, make_current parks the worker calling it, counting how many are
+// parked at once.
+std::atomic<bool> g_queue_hold{false};
+std::atomic<int> g_queue_held{0};
+std::atomic<int> g_queue_peak_held{0};
+
+bool QueueMakeCurrent() {
+  if (g_queue_hold.load()) {
+    const int held = g_queue_held.fetch_add(1) + 1;
+    int peak = g_queue_peak_held.load();
+    while (held > peak && !g_queue_peak_held.compare_exchange_weak(peak, held)) {
+    }
+    while (g_queue_hold.load()) std::this_thread::sleep_for(std::chrono::milliseconds(1));
+    g_queue_held.fetch_sub(1);
+  }
+  return g_queue_allows_make_current.load();
+}
+
+bool WaitForHeld(int count) {
+  const auto deadline = std::chrono::steady_clock::now() + std::chrono::seconds(5);
+  while (g_queue_held.load() < count && std::chrono::steady_clock::now() < deadline) {
+    std::this_thread::sleep_for(std::chrono::milliseconds(1));
+  }
+  return g_queue_held.load() >= count;
+}
+
+TeardownQueueStats WaitForTeardownStats(const std::function<bool(const TeardownQueueStats&)>& done) {
+  const auto deadline = std::chrono::steady_clock::now() + std::chrono::seconds(5);
+  TeardownQueueStats stats = MpvPlayer::NativeTeardownStats();
+  while (!done(stats) && std::chrono::steady_clock::now() < deadline) {
+    std::this_thread::sleep_for(std::chrono::milliseconds(5));
+    stats = MpvPlayer::NativeTeardownStats();
+  }
+  return stats;
+}
+
+void TestTeardownQueueReportsWhatItRetains() {
+  ConfigureNativeRenderTeardownQueueForTesting({
+      [](EGLDisplay, EGLContext) { return QueueMakeCurrent(); },
+      [](EGLDisplay) { return true; },
+      [](EGLDisplay, EGLContext) { return true; },
+      [](mpv_render_context*) {},
+      [](mpv_handle*) { g_queue_terminated.fetch_add(1); },
+      [](EGLDisplay) { g_queue_threads_released.fetch_add(1); },
+  });
+  MpvPlayer::SetNativeTeardownRetryPolicy(TeardownRetryPolicy::kBackoff);
+
+  NativeRenderTeardownBatch batch;
+  batch.resources.push_back(
+      {reinterpret_cast<mpv_render_context*>(21), reinterpret_cast<EGLDisplay>(22), reinterpret_cast<EGLContext>(23)});
+  batch.handle = reinterpret_cast<mpv_handle*>(24);
+  EnqueueNativeRenderTeardownForTesting(std::move(batch));
+
+  TeardownQueueStats stats =
+      WaitForTeardownStats([](const TeardownQueueStats& stats) { return stats.retry_attempts >= 2; });
+  Check(stats.policy == TeardownRetryPolicy::kBackoff, "the queue must report the policy it runs");
+  Check(stats.retry_attempts >= 2, "a batch that cannot bind must be retried without being asked");
+  Check(stats.pending_batches == 1, "a retained batch must be counted as pending");
+  Check(stats.retained_handles == 1 && stats.retained_contexts == 1, "a retained batch must report what it holds");
+  Check(stats.released_batches == 0 && g_queue_terminated.load() == 0, "a retained batch must not be released");
+  Check(g_queue_threads_released.load() >= 2, "a worker whose release failed must still give up its EGL thread");
+
+  g_queue_allows_make_current.store(true);
+  MpvPlayer::RetryPendingNativeTeardown();
+  stats = WaitForTeardownStats([](const TeardownQueueStats& stats) { return stats.released_batches == 1; });
+  Check(stats.released_batches == 1 && g_queue_terminated.load() == 1, "a releasable batch must be released once");
+  Check(
+      stats.pending_batches == 0 && stats.retained_handles == 0 && stats.retained_contexts == 0,
+      "a released batch must leave nothing counted as retained");
+  Check(stats.oldest_batch_age_ms == 0, "an empty queue has no oldest batch");
+  MpvPlayer::SetNativeTeardownRetryPolicy(TeardownRetryPolicy::kFixed);
+}
+
+// One core's blocked teardown must not hold up the next one's, up to the cap,
+// and a batch's contexts are released side by side. Runs on the operations
+// TestTeardownQueueReportsWhatItRetains installed, after it.
+void TestTeardownQueueReleasesBatchesConcurrentlyUpToTheCap() {
+  g_queue_allows_make_current.store(true);
+  g_queue_hold.store(true);
+  const int terminated_before = g_queue_terminated.load();
+  const int batches = static_cast<int>(kMaxConcurrentTeardownBatches) + 2;
+  for (int i = 0; i < batches; ++i) {
+    NativeRenderTeardownBatch batch;
+    batch.resources.push_back({nullptr, reinterpret_cast<EGLDisplay>(31), reinterpret_cast<EGLContext>(32 + i)});
+    batch.handle = reinterpret_cast<mpv_handle*>(64 + i);
+    EnqueueNativeRenderTeardownForTesting(std::move(batch));
+  }
+  Check(
+      WaitForHeld(static_cast<int>(kMaxConcurrentTeardownBatches)),
+      "blocked batches must not serialize the ones queued after them");
+  std::this_thread::sleep_for(std::chrono::milliseconds(50));
+  Check(
+      g_queue_peak_held.load() == static_cast<int>(kMaxConcurrentTeardownBatches),
+      "no more than the cap of batches may tear down at once");
+  Check(
+      MpvPlayer::NativeTeardownStats().pending_batches == static_cast<uint64_t>(batches),
+      "batches being released must still be counted as pending");
+  Check(
+      !MpvPlayer::WaitForNativeTeardown(std::chrono::milliseconds(20)),
+      "waiting for teardown must give up when its timeout expires");
+  g_queue_hold.store(false);
+  Check(MpvPlayer::WaitForNativeTeardown(std::chrono::seconds(5)), "waiting for teardown must see every batch finish");
+  Check(g_queue_terminated.load() == terminated_before + batches, "each core must be terminated exactly once");
+
+  g_queue_peak_held.store(0);
+  g_queue_hold.store(true);
+  const int threads_released_before = g_queue_threads_released.load();
+  NativeRenderTeardownBatch batch;
+  batch.resources.push_back({nullptr, reinterpret_cast<EGLDisplay>(31), reinterpret_cast<EGLContext>(96)});
+  batch.resources.push_back({nullptr, reinterpret_cast<EGLDisplay>(31), reinterpret_cast<EGLContext>(97)});
+  batch.handle = reinterpret_cast<mpv_handle*>(98);
+  EnqueueNativeRenderTeardownForTesting(std::move(batch));
+  Check(WaitForHeld(2), "a batch's contexts must each be made current on a thread of its own");
+  g_queue_hold.store(false);
+  Check(MpvPlayer::WaitForNativeTeardown(std::chrono::seconds(5)), "a multi-context batch must be released");
+  Check(
+      g_queue_terminated.load() == terminated_before + batches + 1, "its core must be terminated after both contexts");
+  Check(
+      g_queue_threads_released.load() == threads_released_before + 2,
+      "each thread that held one of its contexts must give up its EGL state");
+}
+
 }  // namespace
 }  // namespace mpv
 
@@ -566,17 +840,22 @@ int main() {
 
   try {
     mpv::TestProcessShutdownDoesNotJoinBlockedNativeTeardown();
+    mpv::TestTeardownQueueReportsWhatItRetains();
+    mpv::TestTeardownQueueReleasesBatchesConcurrentlyUpToTheCap();
     mpv::TestUnavailablePropertyWriteFails();
     mpv::TestNodeConversionRejectsMalformedPayloads();
     mpv::TestUnavailableCommandFails();
     mpv::TestPendingPropertyWriteFailsOnDispose();
     mpv::TestQueuedSourcesAreRetired(context);
     mpv::TestNativeLeaseBlocksDispose();
+    mpv::TestMainThreadDoesNotWaitOutARender();
     mpv::TestWakeupAndRedrawCoalesce(context);
     mpv::TestRapidReplacementCannotReceiveOldCallbacks(context);
     mpv::TestRenderTeardownRetainsOwnershipUntilContextIsCurrent();
     mpv::TestRenderTeardownDoesNotDestroyAStillCurrentContext();
     mpv::TestNullNodePropertyPayloadDecodesAsNull();
+    mpv::TestEncodedPropertyChangeIsAStandardCodecEnvelope();
+    mpv::TestPatchedPropertySendsOnlyWhatChanged();
     mpv::TestFailedTeardownIsRetriedAndConsumedExactlyOnce();
   } catch (const std::exception& error) {
     g_main_context_pop_thread_default(context);
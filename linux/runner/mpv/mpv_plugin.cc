@@ -1,16 +1,24 @@
 #include "mpv_plugin.h"
 
+#include <algorithm>
+#include <chrono>
 #include <cstring>
 #include <deque>
 #include <functional>
 #include <limits>
+#include <memory>
 #include <new>
 #include <optional>
+#include <string>
 
+#include "plane_format.h"
+#include "plane_render_worker.h"
 #include "wayland_video_surface.h"
 
 using PlayerPtr = std::unique_ptr<mpv::MpvPlayer>;
 using VideoSurfacePtr = std::unique_ptr<mpv::WaylandVideoSurface>;
+using RenderWorkerPtr = std::unique_ptr<mpv::PlaneRenderWorker>;
+using StandbyPoolPtr = std::unique_ptr<plezy::mpv_common::StandbyCorePool<mpv::MpvPlayer::StandbyCore>>;
 
 // One queued HDR transaction: what to apply, and who to tell when it settles.
 //
@@ -33,6 +41,9 @@ struct _MpvPlugin {
   FlPluginRegistrar* registrar;
   FlMethodChannel* method_channel;
   FlEventChannel* event_channel;
+  // The event channel's name, for property changes the player has already
+  // encoded: those skip FlEventChannel, which only accepts a tree to encode.
+  gchar* event_channel_name;
 
   PlayerPtr player;
   // The native Wayland plane every video instance renders into. Non-null once
@@ -111,6 +122,11 @@ struct _MpvPlugin {
   // against the display's current peak so a move between two HDR outputs is not
   // mistaken for no change at all.
   uint32_t applied_target_peak = 0;
+  // The decision the last fully landed transaction put in force, so a repeat
+  // of it - every seek in HDR content - skips staging the surface and the mpv
+  // sequence. Forgotten as each full transaction starts and with the plane.
+  // Placement-constructed in init - see the note by finalize.
+  mpv::HdrDecisionMemo hdr_decisions;
   // Set when a transaction ended in kUnknown: mpv stopped answering partway
   // through being put back, so what the plane emits cannot be named and the
   // surface carries no description. Recorded rather than inferred from the
@@ -122,6 +138,37 @@ struct _MpvPlugin {
   // default state means "no stream", which no real source matches, so the first
   // one always logs. Placement-constructed in init - see the note by finalize.
   mpv::HdrMetadata last_logged_source;
+  // The periodic frame-pacing summary (setFramePacingLogInterval): the timer,
+  // and how many frames had been presented at the last line, so an idle plane
+  // does not repeat it. Both belong to the plane's session and go with it.
+  guint frame_pacing_log_source;
+  uint64_t frame_pacing_logged_presented;
+  // setRenderScheduling: render each frame just in time for the vblank it is
+  // meant for, from the plane's presentation timing, instead of as soon as mpv
+  // has it. A preference rather than plane state, so it outlives the plane and
+  // is applied to each new one. The source is the pending timed render.
+  gboolean display_synced;
+  guint synced_render_source;
+  // setRenderThread: render and swap on a thread of the plane's own, so a
+  // heavy render (tone mapping, scaling shaders at 4K) stops holding up the UI
+  // and a busy UI stops delaying frames. A preference like display_synced; the
+  // worker itself belongs to the plane and goes with it. The source is the
+  // render asked for once a threaded frame has been collected.
+  gboolean render_threaded;
+  RenderWorkerPtr render_worker;
+  guint render_follow_up_source;
+  // setStandbyCore: the next player's mpv core, created and initialised in the
+  // background so initialize() only claims it. Refilled after each claim and
+  // each dispose while the preference holds. The plane's EGL context is not
+  // part of it: it is made for the plane's own config, which only exists once
+  // the plane does.
+  StandbyPoolPtr standby_pool;
+  // setPlaneFormatMode: whether the plane follows each source's depth (see
+  // plane_format.h). A preference read when a plane is created, because only a
+  // context created then without a config can follow its surface to another
+  // depth; plane_depth_switchable is whether the current plane's was.
+  mpv::PlaneFormatMode plane_format_mode;
+  gboolean plane_depth_switchable;
 };
 
 // g_type_create_instance zeroes the instance and runs no constructor, so the
@@ -131,6 +178,8 @@ struct _MpvPlugin {
 static_assert(
     static_cast<int>(mpv::HdrToneMapping::kCompositor) == 0,
     "MpvPlugin's zeroed instance memory must decode as kCompositor");
+static_assert(
+    static_cast<int>(mpv::PlaneFormatMode::kFixed) == 0, "MpvPlugin's zeroed instance memory must decode as kFixed");
 
 G_DEFINE_TYPE(MpvPlugin, mpv_plugin, G_TYPE_OBJECT)
 
@@ -138,6 +187,7 @@ G_DEFINE_TYPE(MpvPlugin, mpv_plugin, G_TYPE_OBJECT)
 static void mpv_plugin_handle_method_call(FlMethodChannel* channel, FlMethodCall* method_call, gpointer user_data);
 // The texture bootstrap's failure arms call this; it is defined below.
 static void release_video_resources(MpvPlugin* self);
+static void stop_render_worker(MpvPlugin* self);
 
 static mpv::HdrMetadata read_source_hdr_metadata(MpvPlugin* self);
 static void apply_hdr_state(MpvPlugin* self, bool allow, mpv::HdrToneMapping mode, std::function<void(int)> done);
@@ -184,6 +234,18 @@ static void send_event(MpvPlugin* self, FlValue* event) {
   }
 }
 
+// Property changes arrive as a finished success envelope, byte for byte what
+// fl_event_channel_send would have made of the equivalent tree, so they go out
+// on the event channel's name unchanged. The Dart side decodes them as channel
+// events; PlayerBase._handleEvent documents what the bytes must keep to.
+static void send_encoded_event(MpvPlugin* self, const uint8_t* data, size_t size) {
+  if (self->event_channel_name == nullptr) return;
+  g_autoptr(GBytes) message = g_bytes_new(data, size);
+  fl_binary_messenger_send_on_channel(
+      fl_plugin_registrar_get_messenger(self->registrar), self->event_channel_name, message, nullptr, nullptr,
+      nullptr);
+}
+
 // Every event Dart accepts carries type:"event" - its decoder silently drops a
 // map without it. Building the envelope in one place means the next caller
 // cannot omit it and quietly get nothing.
@@ -203,6 +265,21 @@ static void release_video_resources(MpvPlugin* self) {
     g_source_remove(self->hdr_mpv_leg_timeout_source_);
     self->hdr_mpv_leg_timeout_source_ = 0;
   }
+  if (self->frame_pacing_log_source != 0) {
+    g_source_remove(self->frame_pacing_log_source);
+    self->frame_pacing_log_source = 0;
+  }
+  if (self->synced_render_source != 0) {
+    g_source_remove(self->synced_render_source);
+    self->synced_render_source = 0;
+  }
+  // Ahead of the player: the worker's last act releases the player's context.
+  stop_render_worker(self);
+  self->plane_depth_switchable = FALSE;
+  if (self->render_follow_up_source != 0) {
+    g_source_remove(self->render_follow_up_source);
+    self->render_follow_up_source = 0;
+  }
   // Queued transactions will never run, and each may be holding a reference to a
   // Dart method call that has to be answered or it is leaked along with its
   // response.
@@ -220,6 +297,7 @@ static void release_video_resources(MpvPlugin* self) {
     self->player->SetRedrawCallback(nullptr);
     self->player->SetSourceMetadataCallback(nullptr);
     self->player->SetEventCallback(nullptr);
+    self->player->SetEncodedEventCallback(nullptr);
     self->player->Dispose();
     self->player.reset();
   }
@@ -243,6 +321,7 @@ static void release_video_resources(MpvPlugin* self) {
   self->hdr_tone_mapping = mpv::HdrToneMapping::kCompositor;
   self->hdr_tone_mapping_desired = mpv::HdrToneMapping::kCompositor;
   self->applied_target_peak = 0;
+  self->hdr_decisions.Forget();
   // The quarantine belongs to the mpv instance that stopped answering, not to
   // the app. A new plane and a new player have said nothing yet, so nothing
   // about them is unnameable, and leaving this set would hide the next session
@@ -278,10 +357,18 @@ static void apply_pending_rect(MpvPlugin* self) {
 //
 // |force| is for the callers who need pixels regardless of whether mpv has
 // produced a new frame: a resize, or the plane becoming visible again.
-static void render_video_plane(MpvPlugin* self, gboolean force) {
+//
+// With a render thread, the frame is handed to it instead, to start no earlier
+// than |not_before_us| (0 for now); see submit_threaded_render.
+static void submit_threaded_render(MpvPlugin* self, int64_t not_before_us);
+static void request_video_plane_render(MpvPlugin* self);
+
+static void render_video_plane_at(MpvPlugin* self, gboolean force, int64_t not_before_us) {
   if (force) self->plane_needs_render = TRUE;
   if (!self->player || !self->video_surface || !self->video_surface->valid()) return;
   if (!self->video_surface->visible() || !self->video_surface->has_size()) return;
+  // A threaded frame is already on its way; collecting it asks for the next.
+  if (self->video_surface->present_in_flight()) return;
   // Present() is held while a colour transition is staged, so a render now would
   // be discarded. The forced render after CommitHdrTransition is what resumes;
   // plane_needs_render stays set meanwhile, so nothing is lost.
@@ -297,17 +384,33 @@ static void render_video_plane(MpvPlugin* self, gboolean force) {
   // refresh owed by this call pending, so the first present still happens at
   // the right size the moment content exists.
   if (!self->video_surface->first_frame_presented() && !self->player->NeedsRedraw()) return;
+  mpv::FramePacingLog& pacing = self->video_surface->frame_pacing();
   // Skip entirely while the compositor has not acknowledged the last frame:
   // an occluded plane is never acknowledged, and rendering into it anyway
   // would burn GPU work on frames that can never be shown.
-  if (self->video_surface->frame_pending()) return;
+  if (self->video_surface->frame_pending()) {
+    if (self->plane_needs_render || self->player->NeedsRedraw()) pacing.RenderSkippedFramePending();
+    return;
+  }
   // The frame callback fires once per *display* refresh, so rendering from it
   // unconditionally pins the plane to the monitor's rate - 120 swaps/s for
   // 60fps content on a 120Hz output, half of them redrawing the same picture.
   // mpv's redraw latch is what says a new frame actually exists.
-  if (!self->plane_needs_render && !self->player->NeedsRedraw()) return;
-  if (self->player->RenderToSurface(
+  const bool mpv_frame = self->player->NeedsRedraw();
+  if (!self->plane_needs_render && !mpv_frame) return;
+  if (self->render_worker) {
+    submit_threaded_render(self, not_before_us);
+    return;
+  }
+  const int64_t render_start = g_get_monotonic_time();
+  pacing.RenderStarted(render_start, mpv_frame ? self->player->RedrawRequestedAt() : 0, !mpv_frame);
+  if (!self->player->RenderToSurface(
           self->video_surface->egl_surface(), self->video_surface->width(), self->video_surface->height())) {
+    pacing.PresentFailed(false);
+  } else {
+    const int64_t render_end = g_get_monotonic_time();
+    pacing.RenderFinished(render_end);
+    self->video_surface->display_sync().OnRenderCost(render_end - render_start);
     // Only once a frame has actually been published. Present() returns false on
     // an eglSwapBuffers failure having already destroyed its frame callback, so
     // clearing the flag first would drop both the retry and the thing that would
@@ -318,6 +421,314 @@ static void render_video_plane(MpvPlugin* self, gboolean force) {
   }
 }
 
+static void render_video_plane(MpvPlugin* self, gboolean force) { render_video_plane_at(self, force, 0); }
+
+// What a frame on the render thread reports back: written there, read by its
+// finish on the main thread, which the worker's handoff orders after it.
+struct ThreadedFrame {
+  bool mpv_frame = false;
+  int64_t mpv_update_us = 0;
+  int64_t render_start_us = 0;
+  int64_t render_end_us = 0;
+  bool rendered = false;
+  bool swapped = false;
+  int64_t swap_us = 0;
+};
+
+// Asks for the next render once a threaded frame is done with. Deferred to an
+// idle rather than run from the finish, because a finish can run inside the
+// render fence - in the middle of a resize or a colour commit, which must not
+// find a new frame in flight when it resumes.
+static void schedule_render_follow_up(MpvPlugin* self) {
+  if (self->render_follow_up_source != 0) return;
+  self->render_follow_up_source = g_idle_add_full(
+      G_PRIORITY_HIGH_IDLE,
+      +[](gpointer data) -> gboolean {
+        auto* plugin = static_cast<MpvPlugin*>(data);
+        plugin->render_follow_up_source = 0;
+        request_video_plane_render(plugin);
+        return G_SOURCE_REMOVE;
+      },
+      self, nullptr);
+}
+
+// The threaded half of render_video_plane. The main thread keeps every Wayland
+// object - BeginPresent arms the frame callback and feedback here, and the
+// finish records the outcome - while the worker only makes the context
+// current, renders and swaps. Width and height are taken now: the surface
+// settles the worker before it resizes, so they hold until the frame is done.
+//
+// plane_needs_render is taken now too and handed back if the frame never
+// reaches the screen, so a forced render asked for while this one is in
+// flight is still owed after it.
+static void submit_threaded_render(MpvPlugin* self, int64_t not_before_us) {
+  mpv::WaylandVideoSurface* surface = self->video_surface.get();
+  mpv::MpvPlayer* player = self->player.get();
+  if (!surface->BeginPresent()) return;
+  const gboolean owed = self->plane_needs_render;
+  self->plane_needs_render = FALSE;
+  const EGLSurface egl_surface = surface->egl_surface();
+  const int width = surface->width();
+  const int height = surface->height();
+  auto frame = std::make_shared<ThreadedFrame>();
+
+  auto work = [player, surface, egl_surface, width, height, frame]() {
+    frame->mpv_frame = player->NeedsRedraw();
+    frame->mpv_update_us = frame->mpv_frame ? player->RedrawRequestedAt() : 0;
+    frame->render_start_us = g_get_monotonic_time();
+    frame->rendered = player->RenderToSurface(egl_surface, width, height);
+    frame->render_end_us = g_get_monotonic_time();
+    if (!frame->rendered) return;
+    frame->swapped = surface->SwapBuffers();
+    frame->swap_us = g_get_monotonic_time();
+  };
+  auto finish = [self, owed, frame](bool ran) {
+    mpv::WaylandVideoSurface* surface = self->video_surface.get();
+    if (surface == nullptr) return;
+    bool presented = false;
+    if (!ran) {
+      surface->AbandonPresent();
+    } else {
+      mpv::FramePacingLog& pacing = surface->frame_pacing();
+      pacing.RenderStarted(frame->render_start_us, frame->mpv_update_us, !frame->mpv_frame);
+      if (!frame->rendered) {
+        pacing.PresentFailed(false);
+        surface->AbandonPresent();
+      } else {
+        pacing.RenderFinished(frame->render_end_us);
+        surface->display_sync().OnRenderCost(frame->render_end_us - frame->render_start_us);
+        presented = surface->FinishPresent(frame->swapped, frame->swap_us);
+      }
+    }
+    if (!presented && owed) self->plane_needs_render = TRUE;
+    schedule_render_follow_up(self);
+  };
+
+  const int64_t delay_us = not_before_us > 0 ? not_before_us - g_get_monotonic_time() : 0;
+  const auto not_before =
+      mpv::PlaneRenderWorker::Clock::now() + std::chrono::microseconds(std::max<int64_t>(delay_us, 0));
+  if (!self->render_worker->Submit(std::move(work), std::move(finish), not_before)) {
+    // Unreachable while present_in_flight() gates the caller, but a frame that
+    // was begun has to end somewhere.
+    surface->AbandonPresent();
+    if (owed) self->plane_needs_render = TRUE;
+  }
+}
+
+// The worker's notification, from its own thread. The reference keeps the
+// plugin alive for an idle that outlives the worker; a worker created since
+// collects its own frame, which is just as right.
+static void notify_render_worker(MpvPlugin* self) {
+  g_idle_add_full(
+      G_PRIORITY_HIGH,
+      +[](gpointer data) -> gboolean {
+        auto* plugin = static_cast<MpvPlugin*>(data);
+        if (plugin->render_worker) plugin->render_worker->Collect();
+        return G_SOURCE_REMOVE;
+      },
+      g_object_ref(self), g_object_unref);
+}
+
+// Moves the plane's renders onto a thread of their own. The context is left
+// current on this thread by every earlier render and can be current to only
+// one, so it is released here first, and the worker releases it again on its
+// way out for whoever renders next.
+static void start_render_worker(MpvPlugin* self) {
+  if (self->render_worker || !self->player || !self->video_surface) return;
+  mpv::MpvPlayer* player = self->player.get();
+  player->ReleaseRenderContext();
+  self->render_worker = std::make_unique<mpv::PlaneRenderWorker>(
+      [self]() { notify_render_worker(self); }, [player]() { player->ReleaseRenderContext(); });
+  g_message("MPV video plane: rendering on a dedicated thread");
+  request_video_plane_render(self);
+}
+
+static void stop_render_worker(MpvPlugin* self) {
+  if (!self->render_worker) return;
+  // Settles first, so the frame in flight is finished or withdrawn here.
+  self->render_worker->Stop();
+  self->render_worker.reset();
+}
+
+static void set_render_threaded(MpvPlugin* self, gboolean threaded) {
+  self->render_threaded = threaded;
+  if (threaded) {
+    start_render_worker(self);
+  } else if (self->render_worker) {
+    stop_render_worker(self);
+    render_video_plane(self, FALSE);
+  }
+}
+
+// A source that fires at a monotonic time to the microsecond, which a
+// g_timeout's whole milliseconds cannot express.
+static gboolean dispatch_synced_render_source(GSource* source, GSourceFunc callback, gpointer data) {
+  (void)source;
+  return callback(data);
+}
+
+static GSourceFuncs synced_render_source_funcs = {nullptr, nullptr, dispatch_synced_render_source, nullptr,
+                                                  nullptr, nullptr};
+
+// The render path for "mpv has a frame" and "the compositor took the last one".
+// In the immediate mode that is a render now. Display-synced, the render is
+// timed to start one render-cost plus the compositor's margin ahead of the
+// vblank the frame is meant for (see DisplaySyncScheduler), which both shortens
+// the wait between render and scan-out and takes the GLib idle queue's jitter
+// out of it. Forced renders never come through here: a resize or a colour
+// commit needs its pixels now.
+static void request_video_plane_render(MpvPlugin* self) {
+  if (!self->display_synced || !self->player || !self->video_surface) {
+    render_video_plane(self, FALSE);
+    return;
+  }
+  if (self->synced_render_source != 0) return;
+  // Nothing to time while a threaded frame is in flight, and asking mpv would
+  // wait on the render that holds it.
+  if (self->video_surface->present_in_flight()) return;
+  const int64_t now = g_get_monotonic_time();
+  int64_t target = 0;
+  if (!self->player->NextFrameTargetTime(&target)) target = 0;
+  const int64_t start = self->video_surface->display_sync().RenderStartFor(now, target);
+  if (start <= now) {
+    render_video_plane(self, FALSE);
+    return;
+  }
+  // The render thread waits out the lead itself, to the microsecond and off
+  // the main loop.
+  if (self->render_worker) {
+    render_video_plane_at(self, FALSE, start);
+    return;
+  }
+  GSource* source = g_source_new(&synced_render_source_funcs, sizeof(GSource));
+  g_source_set_priority(source, G_PRIORITY_HIGH);
+  g_source_set_ready_time(source, start);
+  g_source_set_callback(
+      source,
+      +[](gpointer data) -> gboolean {
+        auto* plugin = static_cast<MpvPlugin*>(data);
+        plugin->synced_render_source = 0;
+        render_video_plane(plugin, FALSE);
+        return G_SOURCE_REMOVE;
+      },
+      self, nullptr);
+  self->synced_render_source = g_source_attach(source, nullptr);
+  g_source_unref(source);
+}
+
+// mpv's own wait for the frame's target time is only wanted when nothing else
+// times the render: it follows the mode, and in the display-synced one whether
+// the plane has presentation timing (none yet, VRR, a clock that is not
+// monotonic), which can come and go with any presentation.
+static void update_block_for_target_time(MpvPlugin* self) {
+  if (!self->player) return;
+  const bool timing_left_to_mpv =
+      !self->video_surface || self->video_surface->display_sync().LeavesTimingToMpv(self->display_synced);
+  self->player->SetBlockForTargetTime(timing_left_to_mpv);
+}
+
+// Stops or starts display-synced rendering.
+static void set_display_synced(MpvPlugin* self, gboolean synced) {
+  self->display_synced = synced;
+  update_block_for_target_time(self);
+  if (!synced && self->synced_render_source != 0) {
+    g_source_remove(self->synced_render_source);
+    self->synced_render_source = 0;
+    render_video_plane(self, FALSE);
+  }
+}
+
+static FlValue* frame_pacing_distribution_value(const mpv::FramePacingDistribution& distribution) {
+  FlValue* value = fl_value_new_map();
+  fl_value_set_string_take(value, "count", fl_value_new_int(static_cast<int64_t>(distribution.count)));
+  fl_value_set_string_take(value, "mean", fl_value_new_int(distribution.mean));
+  fl_value_set_string_take(value, "stddev", fl_value_new_int(distribution.stddev));
+  fl_value_set_string_take(value, "p50", fl_value_new_int(distribution.p50));
+  fl_value_set_string_take(value, "p90", fl_value_new_int(distribution.p90));
+  fl_value_set_string_take(value, "p99", fl_value_new_int(distribution.p99));
+  fl_value_set_string_take(value, "max", fl_value_new_int(distribution.max));
+  return value;
+}
+
+// What getFramePacingStats answers: the counters and the distributions over the
+// current window, in microseconds, plus the raw samples oldest first when asked.
+static FlValue* frame_pacing_value(const mpv::FramePacingLog& log, bool include_frames) {
+  const mpv::FramePacingSummary summary = log.Summarize();
+  FlValue* value = fl_value_new_map();
+  auto count = [&](const char* key, uint64_t n) {
+    fl_value_set_string_take(value, key, fl_value_new_int(static_cast<int64_t>(n)));
+  };
+  count("frames", summary.frames);
+  count("presented", summary.presented);
+  count("forced", summary.forced);
+  count("skippedFramePending", summary.skipped_frame_pending);
+  count("discarded", summary.discarded);
+  count("swapFailures", summary.swap_failures);
+  count("ackMisses", summary.ack_misses);
+  fl_value_set_string_take(value, "renderUs", frame_pacing_distribution_value(summary.render_us));
+  fl_value_set_string_take(value, "updateToRenderUs", frame_pacing_distribution_value(summary.update_to_render_us));
+  fl_value_set_string_take(value, "swapUs", frame_pacing_distribution_value(summary.swap_us));
+  fl_value_set_string_take(value, "callbackLatencyUs", frame_pacing_distribution_value(summary.callback_latency_us));
+  fl_value_set_string_take(value, "presentIntervalUs", frame_pacing_distribution_value(summary.present_interval_us));
+  fl_value_set_string_take(value, "contentIntervalUs", frame_pacing_distribution_value(summary.content_interval_us));
+  if (include_frames) {
+    FlValue* frames = fl_value_new_list();
+    for (size_t i = 0; i < log.size(); ++i) {
+      const mpv::FramePacingSample& sample = log.at(i);
+      FlValue* frame = fl_value_new_map();
+      fl_value_set_string_take(frame, "mpvUpdateUs", fl_value_new_int(sample.mpv_update_us));
+      fl_value_set_string_take(frame, "renderStartUs", fl_value_new_int(sample.render_start_us));
+      fl_value_set_string_take(frame, "renderEndUs", fl_value_new_int(sample.render_end_us));
+      fl_value_set_string_take(frame, "swapUs", fl_value_new_int(sample.swap_us));
+      fl_value_set_string_take(frame, "frameDoneUs", fl_value_new_int(sample.frame_done_us));
+      fl_value_set_string_take(frame, "compositorTimeMs", fl_value_new_int(sample.compositor_time_ms));
+      fl_value_set_string_take(frame, "forced", fl_value_new_bool(sample.forced));
+      fl_value_append_take(frames, frame);
+    }
+    fl_value_set_string_take(value, "samples", frames);
+  }
+  return value;
+}
+
+// What getTeardownStats answers: the process-wide teardown queue's holdings
+// and history. Process-wide, so it needs no player.
+static FlValue* teardown_stats_value(const mpv::TeardownQueueStats& stats) {
+  FlValue* value = fl_value_new_map();
+  auto count = [&](const char* key, int64_t n) { fl_value_set_string_take(value, key, fl_value_new_int(n)); };
+  fl_value_set_string_take(value, "policy", fl_value_new_string(mpv::TeardownRetryPolicyName(stats.policy)));
+  count("pendingBatches", static_cast<int64_t>(stats.pending_batches));
+  count("retainedHandles", static_cast<int64_t>(stats.retained_handles));
+  count("retainedContexts", static_cast<int64_t>(stats.retained_contexts));
+  count("oldestBatchAgeMs", stats.oldest_batch_age_ms);
+  count("retryAttempts", static_cast<int64_t>(stats.retry_attempts));
+  count("releasedBatches", static_cast<int64_t>(stats.released_batches));
+  count("maxReleaseLatencyMs", stats.max_release_latency_ms);
+  return value;
+}
+
+// One summary line per interval in which the plane presented anything, to the
+// journal and to Dart's log as a `frame-pacing` log message.
+static gboolean log_frame_pacing(gpointer data) {
+  auto* self = static_cast<MpvPlugin*>(data);
+  if (self->video_surface == nullptr) return G_SOURCE_CONTINUE;
+  const mpv::FramePacingLog& log = self->video_surface->frame_pacing();
+  if (log.presented() == self->frame_pacing_logged_presented) return G_SOURCE_CONTINUE;
+  self->frame_pacing_logged_presented = log.presented();
+
+  const std::string text = mpv::FormatFramePacing(log.Summarize());
+  g_message("MPV video plane: frame pacing: %s", text.c_str());
+  g_autoptr(FlValue) event = fl_value_new_map();
+  fl_value_set_string_take(event, "type", fl_value_new_string("event"));
+  fl_value_set_string_take(event, "name", fl_value_new_string("log-message"));
+  FlValue* message = fl_value_new_map();
+  fl_value_set_string_take(message, "prefix", fl_value_new_string("frame-pacing"));
+  fl_value_set_string_take(message, "level", fl_value_new_string("info"));
+  fl_value_set_string_take(message, "text", fl_value_new_string(text.c_str()));
+  fl_value_set_string_take(event, "data", message);
+  send_event(self, event);
+  return G_SOURCE_CONTINUE;
+}
+
 // Collects what the source actually is, plus its HDR10 static metadata.
 //
 // Both halves matter. The colour space decides whether the plane may be
@@ -385,7 +796,7 @@ static bool hdr_available(MpvPlugin* self) {
 // and forgotten in the other - they would then disagree about what is on screen.
 //
 // The caller must have established that the surface exists.
-static mpv::HdrDecision decide_hdr(
+static mpv::HdrInputs hdr_inputs(
     MpvPlugin* self, bool allow, mpv::HdrToneMapping mode, const mpv::HdrMetadata& source) {
   mpv::HdrInputs inputs;
   inputs.allowed = allow;
@@ -395,7 +806,49 @@ static mpv::HdrDecision decide_hdr(
   inputs.requested = mode;
   inputs.display_peak_nits = self->video_surface->preferred().max_luminance;
   inputs.sdr_reference_nits = self->video_surface->preferred().reference_luminance;
-  return mpv::DecideHdr(inputs, source);
+  return inputs;
+}
+
+static mpv::HdrDecision decide_hdr(
+    MpvPlugin* self, bool allow, mpv::HdrToneMapping mode, const mpv::HdrMetadata& source) {
+  return mpv::DecideHdr(hdr_inputs(self, allow, mode, source), source);
+}
+
+// Moves the plane to the depth the current source wants (plane_format.h).
+// Deeper happens before a colour transition, so an HDR description is never
+// attached to an 8-bit surface; shallower only with no description attached,
+// which for a source leaving HDR is once its transition has committed. An
+// unloaded source leaves the plane as it is: between files is exactly when
+// the next one's depth is not known yet.
+//
+// The surface is replaced under the context, which may be current on one
+// thread only and must be current on none while its surface goes, so a render
+// worker is stopped around the swap and started again after.
+static void update_plane_depth(MpvPlugin* self) {
+  if (!self->plane_depth_switchable || self->video_surface == nullptr || self->player == nullptr) return;
+  mpv::SourceHdrMetadata source;
+  if (!self->player->ReadSourceHdrMetadata(&source) || source.transfer.empty()) return;
+  const bool hdr_transfer = source.transfer == "pq" || source.transfer == "hlg";
+  const int wanted = mpv::ChoosePlaneDepthBits(
+      self->plane_format_mode, self->video_surface->created_depth_bits(), hdr_transfer,
+      mpv::PixelFormatBitDepth(source.pixel_format));
+  const int current = self->video_surface->depth_bits();
+  if (wanted == current) return;
+  if (wanted < current && self->video_surface->hdr_active()) return;
+
+  const bool threaded = self->render_worker != nullptr;
+  if (threaded) stop_render_worker(self);
+  self->player->ReleaseRenderContext();
+  std::string error;
+  if (self->video_surface->SetDepthBits(wanted, &error)) {
+    self->player->SetSurfaceDepthBits(wanted);
+    g_message(
+        "MPV video plane: %d bits per channel for %s", wanted,
+        source.pixel_format.empty() ? "this source" : source.pixel_format.c_str());
+  } else {
+    g_warning("MPV video plane: staying at %d bits per channel: %s", current, error.c_str());
+  }
+  if (threaded) start_render_worker(self);
 }
 
 // Applies an HDR state to both halves of the plane, atomically on screen.
@@ -432,7 +885,20 @@ static void apply_hdr_state(MpvPlugin* self, bool allow, mpv::HdrToneMapping mod
   }
   const mpv::HdrMetadata source = read_source_hdr_metadata(self);
 
-  const mpv::HdrDecision decision = decide_hdr(self, allow, mode, source);
+  const mpv::HdrInputs inputs = hdr_inputs(self, allow, mode, source);
+  // Deeper now, ahead of any description; shallower too if none is attached.
+  update_plane_depth(self);
+
+  // Nothing DecideHdr reads has moved since the last transaction that landed,
+  // so its decision is on screen already. A quarantined plane is never in that
+  // state: its last transaction did not land.
+  if (!self->hdr_output_unnameable && self->hdr_decisions.Lookup(inputs, source) != nullptr) {
+    if (done) done(MPV_ERROR_SUCCESS);
+    return;
+  }
+  // From here until it lands, the surface and mpv may be anywhere.
+  self->hdr_decisions.Forget();
+  const mpv::HdrDecision decision = mpv::DecideHdr(inputs, source);
 
   // What the buffer will actually contain: the source untouched, or the same
   // curve and gamut reduced to the peak we are about to declare. DecideHdr
@@ -444,7 +910,8 @@ static void apply_hdr_state(MpvPlugin* self, bool allow, mpv::HdrToneMapping mod
   const guint64 generation = self->generation;
 
   self->video_surface->BeginHdrTransition(
-      decision.describe, described, [self, decision, transfer, mode, generation, done](uint64_t token, bool staged) {
+      decision.describe, described,
+      [self, inputs, source, decision, transfer, mode, generation, done](uint64_t token, bool staged) {
         if (self->generation != generation || self->video_surface == nullptr || self->player == nullptr) {
           if (done) done(MPV_ERROR_UNINITIALIZED);
           return;
@@ -478,7 +945,7 @@ static void apply_hdr_state(MpvPlugin* self, bool allow, mpv::HdrToneMapping mod
         };
         self->player->SetHdrOutput(
             transfer, decision.target_peak_nits,
-            [self, decision, mode, generation, token, leg_finished, finish_leg](
+            [self, inputs, source, decision, mode, generation, token, leg_finished, finish_leg](
                 mpv::MpvPlayer::HdrOutputResult result, int error) {
               using Result = mpv::MpvPlayer::HdrOutputResult;
               // Whatever this reply says, the timeout (if any) has no more
@@ -535,6 +1002,9 @@ static void apply_hdr_state(MpvPlugin* self, bool allow, mpv::HdrToneMapping mod
               }
               switch (result) {
                 case Result::kApplied: {
+                  // A source that left HDR can have its 8 bits once nothing
+                  // describes the plane as PQ any more.
+                  if (committed && !decision.describe) update_plane_depth(self);
                   // Pixels and state now agree; publish them together.
                   if (committed || unquarantined) render_video_plane(self, TRUE);
                   if (committed && decision.describe) {
@@ -559,6 +1029,7 @@ static void apply_hdr_state(MpvPlugin* self, bool allow, mpv::HdrToneMapping mod
                   }
                   self->hdr_tone_mapping = mode;
                   self->applied_target_peak = decision.target_peak_nits;
+                  self->hdr_decisions.Remember(inputs, source, decision);
                   break;
                 }
                 case Result::kRestored:
@@ -811,18 +1282,35 @@ static gboolean start_video_plane(MpvPlugin* self, FlView* view, std::string* er
 
   auto surface = std::make_unique<mpv::WaylandVideoSurface>();
   if (!surface->Create(widget, error)) return FALSE;
+  const bool depth_switchable =
+      self->plane_format_mode == mpv::PlaneFormatMode::kPerSource && surface->can_change_depth();
   if (!self->player->InitRenderContextForSurface(
-          surface->egl_display(), surface->egl_config(), surface->egl_surface(), surface->depth_bits())) {
+          surface->egl_display(), depth_switchable ? surface->switchable_context_config() : surface->egl_config(),
+          surface->egl_surface(), surface->depth_bits())) {
     surface->Destroy();
     *error = "The GPU driver would not create a render context for the video plane";
     return FALSE;
   }
+  self->plane_depth_switchable = depth_switchable;
 
   self->video_surface = std::move(surface);
-  self->video_surface->SetFrameCallback([self]() { render_video_plane(self, FALSE); });
+  self->video_surface->SetFrameCallback([self]() { request_video_plane_render(self); });
   self->video_surface->SetForcedRenderCallback([self]() { render_video_plane(self, TRUE); });
   self->video_surface->SetPreferredChangedCallback([self]() { handle_preferred_changed(self); });
-  self->player->SetRedrawCallback([self]() { render_video_plane(self, FALSE); });
+  self->player->SetRedrawCallback([self]() { request_video_plane_render(self); });
+  // Display-synced, mpv hears about each frame when it is actually on screen;
+  // otherwise it keeps estimating from the render calls, as it always has.
+  self->video_surface->SetPresentedCallback([self]() {
+    update_block_for_target_time(self);
+    if (self->display_synced && self->player) self->player->ReportSwap();
+  });
+  update_block_for_target_time(self);
+  // Whatever changes the surface's pending state waits for a threaded frame to
+  // land first; with no worker there is never one to wait for.
+  self->video_surface->SetRenderFence([self]() {
+    if (self->render_worker) self->render_worker->Settle();
+  });
+  if (self->render_threaded) start_render_worker(self);
   // playback-restart is not ordered against the video reconfigure that gives the
   // source its colour space, so the re-apply observe_event_for_hdr asks for can
   // land on the previous file's metadata - or on none at all for the first file.
@@ -840,8 +1328,10 @@ static gboolean start_video_plane(MpvPlugin* self, FlView* view, std::string* er
 static void mpv_plugin_dispose(GObject* object) {
   MpvPlugin* self = MPV_PLUGIN(object);
   release_video_resources(self);
+  self->standby_pool.reset();
   g_clear_object(&self->method_channel);
   g_clear_object(&self->event_channel);
+  g_clear_pointer(&self->event_channel_name, g_free);
   g_clear_object(&self->registrar);
   G_OBJECT_CLASS(mpv_plugin_parent_class)->dispose(object);
 }
@@ -857,6 +1347,8 @@ static void mpv_plugin_dispose(GObject* object) {
 // dereferences null.
 static void mpv_plugin_finalize(GObject* object) {
   MpvPlugin* self = MPV_PLUGIN(object);
+  self->standby_pool.~StandbyPoolPtr();
+  self->render_worker.~RenderWorkerPtr();
   self->hdr_queue.~HdrQueue();
   self->video_surface.~VideoSurfacePtr();
   self->player.~PlayerPtr();
@@ -872,10 +1364,13 @@ static void mpv_plugin_init(MpvPlugin* self) {
   new (&self->player) PlayerPtr();
   new (&self->video_surface) VideoSurfacePtr();
   new (&self->hdr_queue) HdrQueue();
+  new (&self->render_worker) RenderWorkerPtr();
+  new (&self->standby_pool) StandbyPoolPtr();
   // Its default member initialisers make it non-trivially-default-constructible,
   // so the zeroed storage is not yet an object even though every field is scalar.
   // Trivially destructible, so finalize has nothing to undo.
   new (&self->last_logged_source) mpv::HdrMetadata();
+  new (&self->hdr_decisions) mpv::HdrDecisionMemo();
   self->visible = FALSE;
   self->initialized = FALSE;
   self->audio_only = FALSE;
@@ -896,9 +1391,9 @@ MpvPlugin* mpv_plugin_new(FlPluginRegistrar* registrar, const gchar* channel_nam
 
   fl_method_channel_set_method_call_handler(self->method_channel, mpv_plugin_handle_method_call, self, nullptr);
 
-  g_autofree gchar* event_channel_name = g_strconcat(channel_name, "/events", nullptr);
-  self->event_channel =
-      fl_event_channel_new(fl_plugin_registrar_get_messenger(registrar), event_channel_name, FL_METHOD_CODEC(codec));
+  self->event_channel_name = g_strconcat(channel_name, "/events", nullptr);
+  self->event_channel = fl_event_channel_new(
+      fl_plugin_registrar_get_messenger(registrar), self->event_channel_name, FL_METHOD_CODEC(codec));
 
   return self;
 }
@@ -915,6 +1410,37 @@ void mpv_audio_plugin_register_with_registrar(FlPluginRegistrar* registrar) {
   g_mpv_audio_plugin = mpv_plugin_new(registrar, "com.plezy/mpv_audio_player", TRUE);
 }
 
+static void refill_standby_core(MpvPlugin* self) {
+  if (!self->standby_pool || self->standby_pool->has_standby()) return;
+  if (!mpv::MpvPlayer::PrepareStandbyCore()) return;
+  self->standby_pool->Refill(mpv::MpvPlayer::StandbyCore());
+}
+
+static void set_standby_core(MpvPlugin* self, gboolean enabled) {
+  if (!enabled) {
+    self->standby_pool.reset();
+    return;
+  }
+  if (self->standby_pool) return;
+  const bool audio_only = self->audio_only;
+  self->standby_pool = std::make_unique<plezy::mpv_common::StandbyCorePool<mpv::MpvPlayer::StandbyCore>>(
+      [audio_only](mpv::MpvPlayer::StandbyCore* core) { mpv::MpvPlayer::WarmStandbyCore(core, audio_only); },
+      [](mpv::MpvPlayer::StandbyCore core) { mpv::MpvPlayer::DiscardStandbyCore(core); });
+  refill_standby_core(self);
+}
+
+// Initializes the player from the standby core when there is one, then starts
+// warming the next while this one plays.
+static bool initialize_player(MpvPlugin* self) {
+  mpv::MpvPlayer::StandbyCore standby;
+  const bool claimed = self->standby_pool && self->standby_pool->Claim(&standby);
+  const bool initialized = self->player->Initialize(claimed ? &standby : nullptr);
+  // Whatever the player did not adopt is still ours to release.
+  if (claimed) mpv::MpvPlayer::DiscardStandbyCore(standby);
+  refill_standby_core(self);
+  return initialized;
+}
+
 /// Method call handler.
 static void mpv_plugin_handle_method_call(FlMethodChannel* channel, FlMethodCall* method_call, gpointer user_data) {
   (void)channel;
@@ -932,8 +1458,10 @@ static void mpv_plugin_handle_method_call(FlMethodChannel* channel, FlMethodCall
         if (!self->player || self->player->IsDisposed()) {
           self->player = std::make_unique<mpv::MpvPlayer>(/*audio_only=*/true);
         }
-        if (self->player->Initialize()) {
+        if (initialize_player(self)) {
           self->player->SetEventCallback([self](FlValue* event) { send_event(self, event); });
+          self->player->SetEncodedEventCallback(
+              [self](const uint8_t* data, size_t size) { send_encoded_event(self, data, size); });
           self->initialized = TRUE;
         }
       }
@@ -951,13 +1479,15 @@ static void mpv_plugin_handle_method_call(FlMethodChannel* channel, FlMethodCall
       }
 
       std::string error;
-      if (!self->player->Initialize()) {
+      if (!initialize_player(self)) {
         release_video_resources(self);
         response =
             FL_METHOD_RESPONSE(fl_method_error_response_new("INIT_FAILED", "Failed to initialize MPV player", nullptr));
       } else if (start_video_plane(self, fl_plugin_registrar_get_view(self->registrar), &error)) {
         ++self->generation;
         self->player->SetEventCallback([self](FlValue* event) { send_event(self, event); });
+        self->player->SetEncodedEventCallback(
+            [self](const uint8_t* data, size_t size) { send_encoded_event(self, data, size); });
         self->initialized = TRUE;
         response = FL_METHOD_RESPONSE(fl_method_success_response_new(fl_value_new_bool(TRUE)));
       } else {
@@ -970,7 +1500,16 @@ static void mpv_plugin_handle_method_call(FlMethodChannel* channel, FlMethodCall
     }
   } else if (strcmp(method, "dispose") == 0) {
     release_video_resources(self);
+    refill_standby_core(self);
     response = FL_METHOD_RESPONSE(fl_method_success_response_new(nullptr));
+  } else if (strcmp(method, "setStandbyCore") == 0) {
+    FlValue* enabled_value = fl_value_lookup_string(args, "enabled");
+    if (enabled_value == nullptr || fl_value_get_type(enabled_value) != FL_VALUE_TYPE_BOOL) {
+      response = FL_METHOD_RESPONSE(fl_method_error_response_new("INVALID_ARGS", "Missing 'enabled'", nullptr));
+    } else {
+      set_standby_core(self, fl_value_get_bool(enabled_value));
+      response = FL_METHOD_RESPONSE(fl_method_success_response_new(nullptr));
+    }
   } else if (strcmp(method, "command") == 0) {
     if (!self->player || !self->initialized) {
       response = FL_METHOD_RESPONSE(fl_method_error_response_new("NOT_INITIALIZED", "Player not initialized", nullptr));
@@ -1002,6 +1541,54 @@ static void mpv_plugin_handle_method_call(FlMethodChannel* channel, FlMethodCall
         return;  // Response sent asynchronously
       }
     }
+  } else if (strcmp(method, "preload") == 0) {
+    if (!self->player || !self->initialized) {
+      response = FL_METHOD_RESPONSE(fl_method_error_response_new("NOT_INITIALIZED", "Player not initialized", nullptr));
+    } else {
+      FlValue* url_value = fl_value_lookup_string(args, "url");
+      FlValue* options_value = fl_value_lookup_string(args, "options");
+      if (url_value == nullptr || fl_value_get_type(url_value) != FL_VALUE_TYPE_STRING) {
+        response = FL_METHOD_RESPONSE(fl_method_error_response_new("INVALID_ARGS", "Missing 'url'", nullptr));
+      } else {
+        const char* options = options_value != nullptr && fl_value_get_type(options_value) == FL_VALUE_TYPE_STRING
+                                  ? fl_value_get_string(options_value)
+                                  : "";
+        g_object_ref(method_call);
+        self->player->Preload(fl_value_get_string(url_value), options, [method_call](int error) {
+          g_autoptr(FlMethodResponse) async_response = nullptr;
+          if (error < 0) {
+            async_response =
+                FL_METHOD_RESPONSE(fl_method_error_response_new("PRELOAD_FAILED", mpv_error_string(error), nullptr));
+          } else {
+            async_response = FL_METHOD_RESPONSE(fl_method_success_response_new(nullptr));
+          }
+          fl_method_call_respond(method_call, async_response, nullptr);
+          g_object_unref(method_call);
+        });
+        return;  // Response sent asynchronously
+      }
+    }
+  } else if (strcmp(method, "promote") == 0) {
+    if (!self->player || !self->initialized) {
+      response = FL_METHOD_RESPONSE(fl_method_error_response_new("NOT_INITIALIZED", "Player not initialized", nullptr));
+    } else {
+      g_object_ref(method_call);
+      const bool queued = self->player->Promote([method_call](int error) {
+        g_autoptr(FlMethodResponse) async_response = nullptr;
+        if (error < 0) {
+          async_response =
+              FL_METHOD_RESPONSE(fl_method_error_response_new("COMMAND_FAILED", "MPV command failed", nullptr));
+        } else {
+          async_response = FL_METHOD_RESPONSE(fl_method_success_response_new(nullptr));
+        }
+        fl_method_call_respond(method_call, async_response, nullptr);
+        g_object_unref(method_call);
+      });
+      if (queued) return;  // Response sent asynchronously
+      g_object_unref(method_call);
+      response =
+          FL_METHOD_RESPONSE(fl_method_error_response_new("NO_PRELOAD", "No preloaded item to promote", nullptr));
+    }
   } else if (strcmp(method, "setProperty") == 0) {
     if (!self->player || !self->initialized) {
       response = FL_METHOD_RESPONSE(fl_method_error_response_new(
@@ -1233,9 +1820,167 @@ static void mpv_plugin_handle_method_call(FlMethodChannel* channel, FlMethodCall
       } else if (id_value == nullptr || fl_value_get_type(id_value) != FL_VALUE_TYPE_INT) {
         response = FL_METHOD_RESPONSE(fl_method_error_response_new("INVALID_ARGS", "Missing 'id'", nullptr));
       } else {
+        // Optional, and only honoured while property batching is on.
+        FlValue* interval_value = fl_value_lookup_string(args, "minIntervalMs");
+        int64_t min_interval_ms = 0;
+        if (interval_value != nullptr && fl_value_get_type(interval_value) == FL_VALUE_TYPE_INT) {
+          min_interval_ms = std::min<int64_t>(std::max<int64_t>(fl_value_get_int(interval_value), 0), 60000);
+        }
+        // Optional; Dart that asks for it must handle patch ids.
+        FlValue* patch_value = fl_value_lookup_string(args, "patch");
+        const bool patch = patch_value != nullptr && fl_value_get_type(patch_value) == FL_VALUE_TYPE_BOOL &&
+                           fl_value_get_bool(patch_value);
         self->player->ObserveProperty(
             fl_value_get_string(name_value), fl_value_get_string(format_value),
-            static_cast<int>(fl_value_get_int(id_value)));
+            static_cast<int>(fl_value_get_int(id_value)), static_cast<int>(min_interval_ms), patch);
+        response = FL_METHOD_RESPONSE(fl_method_success_response_new(nullptr));
+      }
+    }
+  } else if (strcmp(method, "resyncProperty") == 0) {
+    if (!self->player || !self->initialized) {
+      response = FL_METHOD_RESPONSE(fl_method_error_response_new("NOT_INITIALIZED", "Player not initialized", nullptr));
+    } else {
+      FlValue* id_value = fl_value_lookup_string(args, "id");
+      if (id_value == nullptr || fl_value_get_type(id_value) != FL_VALUE_TYPE_INT) {
+        response = FL_METHOD_RESPONSE(fl_method_error_response_new("INVALID_ARGS", "Missing 'id'", nullptr));
+      } else {
+        self->player->ResyncProperty(static_cast<int>(fl_value_get_int(id_value)));
+        response = FL_METHOD_RESPONSE(fl_method_success_response_new(nullptr));
+      }
+    }
+  } else if (strcmp(method, "getEventLoopStats") == 0) {
+    if (!self->player || !self->initialized) {
+      response = FL_METHOD_RESPONSE(fl_method_error_response_new("NOT_INITIALIZED", "Player not initialized", nullptr));
+    } else {
+      FlValue* reset_value = fl_value_lookup_string(args, "reset");
+      const bool reset = reset_value != nullptr && fl_value_get_type(reset_value) == FL_VALUE_TYPE_BOOL &&
+                         fl_value_get_bool(reset_value);
+      g_autoptr(FlValue) stats = self->player->GetEventLoopStats(reset);
+      response = FL_METHOD_RESPONSE(fl_method_success_response_new(stats));
+    }
+  } else if (strcmp(method, "getTeardownStats") == 0) {
+    g_autoptr(FlValue) stats = teardown_stats_value(mpv::MpvPlayer::NativeTeardownStats());
+    response = FL_METHOD_RESPONSE(fl_method_success_response_new(stats));
+  } else if (strcmp(method, "getHdrDecisionStats") == 0) {
+    g_autoptr(FlValue) stats = fl_value_new_map();
+    fl_value_set_string_take(stats, "hits", fl_value_new_int(static_cast<int64_t>(self->hdr_decisions.hits())));
+    fl_value_set_string_take(stats, "misses", fl_value_new_int(static_cast<int64_t>(self->hdr_decisions.misses())));
+    response = FL_METHOD_RESPONSE(fl_method_success_response_new(stats));
+  } else if (strcmp(method, "setTeardownRetryPolicy") == 0) {
+    FlValue* policy_value = fl_value_lookup_string(args, "policy");
+    mpv::TeardownRetryPolicy policy = mpv::TeardownRetryPolicy::kFixed;
+    if (policy_value == nullptr || fl_value_get_type(policy_value) != FL_VALUE_TYPE_STRING ||
+        !mpv::ParseTeardownRetryPolicy(fl_value_get_string(policy_value), &policy)) {
+      response = FL_METHOD_RESPONSE(
+          fl_method_error_response_new("INVALID_ARGS", "policy must be 'fixed' or 'backoff'", nullptr));
+    } else {
+      mpv::MpvPlayer::SetNativeTeardownRetryPolicy(policy);
+      response = FL_METHOD_RESPONSE(fl_method_success_response_new(nullptr));
+    }
+  } else if (strcmp(method, "setHwdecFallback") == 0) {
+    if (!self->player || !self->initialized) {
+      response = FL_METHOD_RESPONSE(fl_method_error_response_new("NOT_INITIALIZED", "Player not initialized", nullptr));
+    } else {
+      FlValue* enabled_value = fl_value_lookup_string(args, "enabled");
+      if (enabled_value == nullptr || fl_value_get_type(enabled_value) != FL_VALUE_TYPE_BOOL) {
+        response = FL_METHOD_RESPONSE(fl_method_error_response_new("INVALID_ARGS", "Missing 'enabled'", nullptr));
+      } else {
+        self->player->SetHwdecFallbackEnabled(fl_value_get_bool(enabled_value));
+        response = FL_METHOD_RESPONSE(fl_method_success_response_new(nullptr));
+      }
+    }
+  } else if (strcmp(method, "setPlaneFormatMode") == 0) {
+    FlValue* mode_value = fl_value_lookup_string(args, "mode");
+    mpv::PlaneFormatMode mode = mpv::PlaneFormatMode::kFixed;
+    if (mode_value == nullptr || fl_value_get_type(mode_value) != FL_VALUE_TYPE_STRING ||
+        !mpv::ParsePlaneFormatMode(fl_value_get_string(mode_value), &mode)) {
+      response = FL_METHOD_RESPONSE(
+          fl_method_error_response_new("INVALID_ARGS", "mode must be 'fixed' or 'per-source'", nullptr));
+    } else {
+      // Whether a plane can switch at all is settled when it is created; one
+      // that can follows the new mode from the current source on.
+      self->plane_format_mode = mode;
+      update_plane_depth(self);
+      response = FL_METHOD_RESPONSE(fl_method_success_response_new(nullptr));
+    }
+  } else if (strcmp(method, "setEventLoopStatsLogInterval") == 0) {
+    if (!self->player || !self->initialized) {
+      response = FL_METHOD_RESPONSE(fl_method_error_response_new("NOT_INITIALIZED", "Player not initialized", nullptr));
+    } else {
+      FlValue* interval_value = fl_value_lookup_string(args, "intervalMs");
+      if (interval_value == nullptr || fl_value_get_type(interval_value) != FL_VALUE_TYPE_INT) {
+        response = FL_METHOD_RESPONSE(fl_method_error_response_new("INVALID_ARGS", "Missing 'intervalMs'", nullptr));
+      } else {
+        const int64_t interval_ms = std::min<int64_t>(std::max<int64_t>(fl_value_get_int(interval_value), 0), 3600000);
+        self->player->SetEventLoopStatsLogInterval(static_cast<int>(interval_ms));
+        response = FL_METHOD_RESPONSE(fl_method_success_response_new(nullptr));
+      }
+    }
+  } else if (strcmp(method, "getFramePacingStats") == 0) {
+    if (self->video_surface == nullptr) {
+      response = FL_METHOD_RESPONSE(fl_method_error_response_new("NOT_INITIALIZED", "No video plane", nullptr));
+    } else {
+      FlValue* reset_value = fl_value_lookup_string(args, "reset");
+      FlValue* samples_value = fl_value_lookup_string(args, "samples");
+      const bool reset = reset_value != nullptr && fl_value_get_type(reset_value) == FL_VALUE_TYPE_BOOL &&
+                         fl_value_get_bool(reset_value);
+      const bool samples = samples_value != nullptr && fl_value_get_type(samples_value) == FL_VALUE_TYPE_BOOL &&
+                           fl_value_get_bool(samples_value);
+      g_autoptr(FlValue) stats = frame_pacing_value(self->video_surface->frame_pacing(), samples);
+      if (reset) {
+        self->video_surface->frame_pacing().Reset();
+        self->frame_pacing_logged_presented = 0;
+      }
+      response = FL_METHOD_RESPONSE(fl_method_success_response_new(stats));
+    }
+  } else if (strcmp(method, "setFramePacingLogInterval") == 0) {
+    FlValue* interval_value = fl_value_lookup_string(args, "intervalMs");
+    if (interval_value == nullptr || fl_value_get_type(interval_value) != FL_VALUE_TYPE_INT) {
+      response = FL_METHOD_RESPONSE(fl_method_error_response_new("INVALID_ARGS", "Missing 'intervalMs'", nullptr));
+    } else if (self->video_surface == nullptr) {
+      response = FL_METHOD_RESPONSE(fl_method_error_response_new("NOT_INITIALIZED", "No video plane", nullptr));
+    } else {
+      const int64_t interval_ms = std::min<int64_t>(std::max<int64_t>(fl_value_get_int(interval_value), 0), 3600000);
+      if (self->frame_pacing_log_source != 0) {
+        g_source_remove(self->frame_pacing_log_source);
+        self->frame_pacing_log_source = 0;
+      }
+      if (interval_ms > 0) {
+        self->frame_pacing_logged_presented = self->video_surface->frame_pacing().presented();
+        self->frame_pacing_log_source = g_timeout_add(static_cast<guint>(interval_ms), log_frame_pacing, self);
+      }
+      response = FL_METHOD_RESPONSE(fl_method_success_response_new(nullptr));
+    }
+  } else if (strcmp(method, "setRenderScheduling") == 0) {
+    FlValue* mode_value = fl_value_lookup_string(args, "mode");
+    const gchar* mode = nullptr;
+    if (mode_value != nullptr && fl_value_get_type(mode_value) == FL_VALUE_TYPE_STRING) {
+      mode = fl_value_get_string(mode_value);
+    }
+    if (g_strcmp0(mode, "immediate") == 0 || g_strcmp0(mode, "display") == 0) {
+      set_display_synced(self, g_strcmp0(mode, "display") == 0);
+      response = FL_METHOD_RESPONSE(fl_method_success_response_new(nullptr));
+    } else {
+      response = FL_METHOD_RESPONSE(
+          fl_method_error_response_new("INVALID_ARGS", "Expected 'mode' of 'immediate' or 'display'", nullptr));
+    }
+  } else if (strcmp(method, "setRenderThread") == 0) {
+    FlValue* enabled_value = fl_value_lookup_string(args, "enabled");
+    if (enabled_value == nullptr || fl_value_get_type(enabled_value) != FL_VALUE_TYPE_BOOL) {
+      response = FL_METHOD_RESPONSE(fl_method_error_response_new("INVALID_ARGS", "Missing 'enabled'", nullptr));
+    } else {
+      set_render_threaded(self, fl_value_get_bool(enabled_value));
+      response = FL_METHOD_RESPONSE(fl_method_success_response_new(nullptr));
+    }
+  } else if (strcmp(method, "setPropertyBatching") == 0) {
+    if (!self->player || !self->initialized) {
+      response = FL_METHOD_RESPONSE(fl_method_error_response_new("NOT_INITIALIZED", "Player not initialized", nullptr));
+    } else {
+      FlValue* enabled_value = fl_value_lookup_string(args, "enabled");
+      if (enabled_value == nullptr || fl_value_get_type(enabled_value) != FL_VALUE_TYPE_BOOL) {
+        response = FL_METHOD_RESPONSE(fl_method_error_response_new("INVALID_ARGS", "Missing 'enabled'", nullptr));
+      } else {
+        self->player->SetPropertyBatching(fl_value_get_bool(enabled_value));
         response = FL_METHOD_RESPONSE(fl_method_success_response_new(nullptr));
       }
     }
@@ -0,0 +1,102 @@
+#ifndef PLEZY_LINUX_MPV_PLANE_FORMAT_H_
+#define PLEZY_LINUX_MPV_PLANE_FORMAT_H_
+
+#include <cstddef>
+#include <cstdlib>
+#include <cstring>
+#include <string>
+
+// How deep the video plane's buffers are for a given source.
+//
+// The plane is created at the deepest window config the driver offers (see
+// WaylandVideoSurface::InitEgl), because PQ bands visibly in 8 bits. Most of
+// the catalogue is 8-bit SDR, though, where a 10-bit or half-float plane buys
+// nothing: the source has no more precision to keep, and the deeper buffers
+// cost compositor and scan-out bandwidth on every frame (twice the bytes per
+// pixel on the fp16 tier) while mpv dithers to a precision nobody sees.
+//
+// The per-source mode moves the plane to 8 bits for 8-bit SDR sources and back
+// to its deep config for anything HDR or deeper than 8 bits, swapping the EGL
+// window surface at the file boundary. That needs a context that is not tied
+// to one config (EGL_KHR_no_config_context); without it, or with no deep
+// config to leave, the plane stays where it was created.
+//
+// Free of EGL and libmpv like the other pure headers beside it, so the choice
+// is testable without either.
+
+namespace mpv {
+
+enum class PlaneFormatMode {
+  // The depth the plane was created at, whatever plays. The default.
+  kFixed,
+  // 8 bits for 8-bit SDR sources, the created depth otherwise.
+  kPerSource,
+};
+
+inline const char* PlaneFormatModeName(PlaneFormatMode mode) {
+  return mode == PlaneFormatMode::kPerSource ? "per-source" : "fixed";
+}
+
+inline bool ParsePlaneFormatMode(const char* name, PlaneFormatMode* mode) {
+  if (name == nullptr) return false;
+  if (std::strcmp(name, "fixed") == 0) {
+    *mode = PlaneFormatMode::kFixed;
+    return true;
+  }
+  if (std::strcmp(name, "per-source") == 0) {
+    *mode = PlaneFormatMode::kPerSource;
+    return true;
+  }
+  return false;
+}
+
+// Bits per component of an FFmpeg pixel format name as mpv reports it, or 0
+// for no name at all. Planar formats carry their depth as a suffix after the
+// layout ("yuv420p10", "gbrp12", "gray10"), the semi-planar and packed
+// high-depth ones in the name itself ("p010", "y210"). Anything else, which
+// covers every 8-bit format mpv decodes video to ("yuv420p", "nv12", "bgr0",
+// "rgb24"), is 8, bar the wide packed RGB and float formats named below.
+inline int PixelFormatBitDepth(std::string name) {
+  if (name.empty()) return 0;
+  if (name.size() > 2) {
+    const std::string endian = name.substr(name.size() - 2);
+    if (endian == "le" || endian == "be") name.resize(name.size() - 2);
+  }
+  if (name.find("f16") != std::string::npos || name.find("f32") != std::string::npos) return 16;
+  if (name == "rgb48" || name == "bgr48" || name == "rgba64" || name == "bgra64") return 16;
+  if (name == "x2rgb10" || name == "x2bgr10" || name == "xv30") return 10;
+  if (name == "xv36") return 12;
+
+  auto digit = [](char c) { return c >= '0' && c <= '9'; };
+  // p010, p210, p410, p016, y210, y212: a letter, a chroma layout digit, and
+  // two digits of depth.
+  if (name.size() == 4 && (name[0] == 'p' || name[0] == 'y') && digit(name[1]) && digit(name[2]) && digit(name[3])) {
+    return (name[2] - '0') * 10 + (name[3] - '0');
+  }
+  size_t start = name.size();
+  while (start > 0 && digit(name[start - 1])) --start;
+  if (start < name.size() && start > 0) {
+    const bool planar_suffix = name[start - 1] == 'p';
+    const bool gray = name.compare(0, 4, "gray") == 0 && start == 4;
+    if (planar_suffix || gray) {
+      const int bits = std::atoi(name.c_str() + start);
+      if (bits > 0) return bits;
+    }
+  }
+  return 8;
+}
+
+// The depth the plane should run at for a source. |deep_bits| is the depth the
+// plane was created at; |hdr_transfer| is whether the source carries PQ or HLG,
+// and |source_bits| is PixelFormatBitDepth of its format, 0 while unknown. An
+// unknown source keeps the deep plane: dropping precision on a guess is the
+// one outcome here that shows.
+inline int ChoosePlaneDepthBits(PlaneFormatMode mode, int deep_bits, bool hdr_transfer, int source_bits) {
+  if (mode == PlaneFormatMode::kFixed || deep_bits <= 8) return deep_bits;
+  if (hdr_transfer || source_bits == 0 || source_bits > 8) return deep_bits;
+  return 8;
+}
+
+}  // namespace mpv
+
+#endif  // PLEZY_LINUX_MPV_PLANE_FORMAT_H_
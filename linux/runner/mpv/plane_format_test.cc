@@ -0,0 +1,80 @@
+#include "plane_format.h"
+
+#include <iostream>
+#include <string>
+
+namespace {
+
+int failures = 0;
+
+void Expect(bool condition, const char* expression, int line) {
+  if (condition) return;
+  std::cerr << "line " << line << ": check failed: " << expression << '\n';
+  ++failures;
+}
+
+#define EXPECT(condition) Expect(static_cast<bool>(condition), #condition, __LINE__)
+
+void TestEightBitFormats() {
+  for (const char* name : {"yuv420p", "yuvj420p", "yuv444p", "nv12", "nv21", "bgr0", "rgb24", "gray"}) {
+    EXPECT(mpv::PixelFormatBitDepth(name) == 8);
+  }
+}
+
+void TestDeepFormats() {
+  EXPECT(mpv::PixelFormatBitDepth("yuv420p10") == 10);
+  EXPECT(mpv::PixelFormatBitDepth("yuv420p10le") == 10);
+  EXPECT(mpv::PixelFormatBitDepth("yuv444p12be") == 12);
+  EXPECT(mpv::PixelFormatBitDepth("gbrp16") == 16);
+  EXPECT(mpv::PixelFormatBitDepth("gray10") == 10);
+  EXPECT(mpv::PixelFormatBitDepth("p010") == 10);
+  EXPECT(mpv::PixelFormatBitDepth("p016") == 16);
+  EXPECT(mpv::PixelFormatBitDepth("p210") == 10);
+  EXPECT(mpv::PixelFormatBitDepth("y212") == 12);
+  EXPECT(mpv::PixelFormatBitDepth("x2rgb10") == 10);
+  EXPECT(mpv::PixelFormatBitDepth("rgba64") == 16);
+  EXPECT(mpv::PixelFormatBitDepth("rgbaf16") == 16);
+}
+
+void TestUnknownFormat() { EXPECT(mpv::PixelFormatBitDepth("") == 0); }
+
+void TestFixedKeepsTheCreatedDepth() {
+  EXPECT(mpv::ChoosePlaneDepthBits(mpv::PlaneFormatMode::kFixed, 10, false, 8) == 10);
+  EXPECT(mpv::ChoosePlaneDepthBits(mpv::PlaneFormatMode::kFixed, 16, false, 8) == 16);
+}
+
+void TestPerSource() {
+  const auto per_source = mpv::PlaneFormatMode::kPerSource;
+  EXPECT(mpv::ChoosePlaneDepthBits(per_source, 10, false, 8) == 8);
+  EXPECT(mpv::ChoosePlaneDepthBits(per_source, 16, false, 8) == 8);
+  // A 10-bit SDR encode still has the precision to keep.
+  EXPECT(mpv::ChoosePlaneDepthBits(per_source, 10, false, 10) == 10);
+  // HDR in an 8-bit container is rare, and still needs the depth for PQ.
+  EXPECT(mpv::ChoosePlaneDepthBits(per_source, 10, true, 8) == 10);
+  EXPECT(mpv::ChoosePlaneDepthBits(per_source, 10, false, 0) == 10);
+  // A plane created at 8 bits has nothing to switch between.
+  EXPECT(mpv::ChoosePlaneDepthBits(per_source, 8, true, 10) == 8);
+}
+
+void TestModeNames() {
+  mpv::PlaneFormatMode mode = mpv::PlaneFormatMode::kFixed;
+  EXPECT(mpv::ParsePlaneFormatMode("per-source", &mode));
+  EXPECT(mode == mpv::PlaneFormatMode::kPerSource);
+  EXPECT(std::string(mpv::PlaneFormatModeName(mode)) == "per-source");
+  EXPECT(mpv::ParsePlaneFormatMode("fixed", &mode));
+  EXPECT(mode == mpv::PlaneFormatMode::kFixed);
+  EXPECT(!mpv::ParsePlaneFormatMode("adaptive", &mode));
+  EXPECT(!mpv::ParsePlaneFormatMode(nullptr, &mode));
+}
+
+}  // namespace
+
+int main() {
+  TestEightBitFormats();
+  TestDeepFormats();
+  TestUnknownFormat();
+  TestFixedKeepsTheCreatedDepth();
+  TestPerSource();
+  TestModeNames();
+  return failures == 0 ? 0 : 1;
+}
@@ -0,0 +1,173 @@
+#ifndef PLEZY_LINUX_MPV_PLANE_RENDER_WORKER_H_
+#define PLEZY_LINUX_MPV_PLANE_RENDER_WORKER_H_
+
+#include <chrono>
+#include <condition_variable>
+#include <functional>
+#include <mutex>
+#include <thread>
+#include <utility>
+
+// A thread of its own for the video plane's renders, one frame at a time.
+//
+// The plane's EGL context and window surface are already private to mpv, so
+// nothing stops them living on another thread; what has to stay on the GTK
+// main thread is the Wayland side - the frame callback, presentation feedback,
+// geometry and colour state - because those are dispatched there. A frame is
+// therefore split in two: `work` runs here (make the context current, render,
+// swap), and `finish` runs back on the owner's thread with whether `work` ran
+// at all, to do the bookkeeping the main-thread path does after a present.
+//
+// Only one frame is ever in flight. The plane cannot present over an
+// unacknowledged frame anyway, so a queue would only hold renders that are
+// bound to be discarded.
+//
+// `notify` is called on the worker each time a frame's work completes; it must
+// arrange for Collect() to run on the owner's thread soon (an idle source).
+// Settle() is the synchronous alternative, for an owner about to change state
+// the in-flight frame's commit would otherwise carry.
+//
+// Kept free of GTK and EGL, like the pure headers beside it, so the handoff can
+// be tested on its own; the plugin supplies the closures that touch either.
+
+namespace mpv {
+
+class PlaneRenderWorker {
+ public:
+  using Clock = std::chrono::steady_clock;
+
+  // `on_exit` runs on the worker as its last act: the only place the context
+  // it made current can be released from.
+  PlaneRenderWorker(std::function<void()> notify, std::function<void()> on_exit)
+      : notify_(std::move(notify)), on_exit_(std::move(on_exit)), worker_([this]() { Run(); }) {}
+
+  ~PlaneRenderWorker() { Stop(); }
+
+  PlaneRenderWorker(const PlaneRenderWorker&) = delete;
+  PlaneRenderWorker& operator=(const PlaneRenderWorker&) = delete;
+
+  // Owner's thread. Hands over one frame, to start no earlier than
+  // `not_before`. False, with neither closure run, when a frame is already in
+  // flight or the worker has stopped.
+  bool Submit(std::function<void()> work, std::function<void(bool)> finish, Clock::time_point not_before) {
+    if (in_flight_) return false;
+    {
+      std::lock_guard<std::mutex> lock(mutex_);
+      if (stopping_) return false;
+      work_ = std::move(work);
+      not_before_ = not_before;
+      state_ = State::kQueued;
+    }
+    finish_ = std::move(finish);
+    in_flight_ = true;
+    condition_.notify_all();
+    return true;
+  }
+
+  // Owner's thread. True from Submit until the frame's finish has run.
+  bool busy() const { return in_flight_; }
+
+  // Owner's thread. Runs the finish of a frame whose work has completed, if
+  // there is one; a no-op otherwise, so a late notification is harmless.
+  void Collect() {
+    {
+      std::lock_guard<std::mutex> lock(mutex_);
+      if (state_ != State::kDone) return;
+      state_ = State::kIdle;
+    }
+    Finish(true);
+  }
+
+  // Owner's thread. Returns with nothing in flight. A frame still waiting for
+  // its start time is withdrawn rather than waited for - its finish is told
+  // the work never ran - and one already rendering is waited out and
+  // collected here, so nothing is left for the owner to race with.
+  void Settle() {
+    if (!in_flight_) return;
+    bool ran = true;
+    {
+      std::unique_lock<std::mutex> lock(mutex_);
+      if (state_ == State::kQueued) {
+        work_ = nullptr;
+        state_ = State::kIdle;
+        ran = false;
+      } else {
+        condition_.wait(lock, [this]() { return state_ == State::kDone; });
+        state_ = State::kIdle;
+      }
+    }
+    condition_.notify_all();
+    Finish(ran);
+  }
+
+  // Owner's thread. Settles, then ends the thread and waits for it.
+  // Idempotent.
+  void Stop() {
+    if (!worker_.joinable()) return;
+    Settle();
+    {
+      std::lock_guard<std::mutex> lock(mutex_);
+      stopping_ = true;
+    }
+    condition_.notify_all();
+    worker_.join();
+  }
+
+ private:
+  enum class State { kIdle, kQueued, kRunning, kDone };
+
+  void Run() {
+    std::unique_lock<std::mutex> lock(mutex_);
+    for (;;) {
+      condition_.wait(lock, [this]() { return stopping_ || state_ == State::kQueued; });
+      if (stopping_) break;
+      // Re-checked after every wake: Settle() may withdraw the frame while it
+      // waits, and a later Submit may bring a new start time.
+      if (Clock::now() < not_before_) {
+        condition_.wait_until(lock, not_before_);
+        continue;
+      }
+      state_ = State::kRunning;
+      std::function<void()> work = std::move(work_);
+      work_ = nullptr;
+      lock.unlock();
+      work();
+      lock.lock();
+      state_ = State::kDone;
+      condition_.notify_all();
+      lock.unlock();
+      if (notify_) notify_();
+      lock.lock();
+    }
+    lock.unlock();
+    if (on_exit_) on_exit_();
+  }
+
+  void Finish(bool ran) {
+    in_flight_ = false;
+    std::function<void(bool)> finish = std::move(finish_);
+    finish_ = nullptr;
+    if (finish) finish(ran);
+  }
+
+  const std::function<void()> notify_;
+  const std::function<void()> on_exit_;
+
+  std::mutex mutex_;
+  std::condition_variable condition_;
+  State state_ = State::kIdle;
+  bool stopping_ = false;
+  std::function<void()> work_;
+  Clock::time_point not_before_;
+
+  // Owner's thread only.
+  bool in_flight_ = false;
+  std::function<void(bool)> finish_;
+
+  // Last, so every member above exists before the thread starts.
+  std::thread worker_;
+};
+
+}  // namespace mpv
+
+#endif  // PLEZY_LINUX_MPV_PLANE_RENDER_WORKER_H_
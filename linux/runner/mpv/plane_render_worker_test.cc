@@ -0,0 +1,171 @@
+#include "plane_render_worker.h"
+
+#include <atomic>
+#include <chrono>
+#include <iostream>
+#include <thread>
+
+namespace {
+
+int failures = 0;
+
+void Expect(bool condition, const char* expression, int line) {
+  if (condition) return;
+  std::cerr << "line " << line << ": check failed: " << expression << '\n';
+  ++failures;
+}
+
+#define EXPECT(condition) Expect(static_cast<bool>(condition), #condition, __LINE__)
+
+using Clock = mpv::PlaneRenderWorker::Clock;
+
+// Stands in for the plugin's idle source: counts notifications, and lets the
+// test collect on "its" thread when it chooses to.
+struct Notifications {
+  std::atomic<int> count{0};
+
+  void WaitFor(int expected) const {
+    const auto deadline = Clock::now() + std::chrono::seconds(5);
+    while (count.load() < expected && Clock::now() < deadline) std::this_thread::yield();
+  }
+};
+
+// Work runs on the worker, finish on the owner's thread at Collect, and the
+// frame is in flight until then.
+void TestFrameRunsOnTheWorkerAndFinishesOnCollect() {
+  Notifications notified;
+  std::atomic<bool> exited{false};
+  const std::thread::id owner = std::this_thread::get_id();
+  std::thread::id worked_on;
+  bool finished = false;
+  bool ran = false;
+  {
+    mpv::PlaneRenderWorker worker([&]() { ++notified.count; }, [&]() { exited = true; });
+    EXPECT(!worker.busy());
+    EXPECT(worker.Submit(
+        [&]() { worked_on = std::this_thread::get_id(); },
+        [&](bool did_run) {
+          finished = true;
+          ran = did_run;
+        },
+        Clock::now()));
+    EXPECT(worker.busy());
+    notified.WaitFor(1);
+    EXPECT(notified.count.load() == 1);
+    EXPECT(!finished);
+    EXPECT(worker.busy());
+    worker.Collect();
+    EXPECT(finished && ran);
+    EXPECT(!worker.busy());
+    EXPECT(worked_on != owner);
+    // A notification that arrives after the frame was already collected finds
+    // nothing to do.
+    finished = false;
+    worker.Collect();
+    EXPECT(!finished);
+  }
+  EXPECT(exited.load());
+}
+
+// One frame at a time: a second submit is refused without touching either
+// closure, and accepted again once the first is collected.
+void TestOnlyOneFrameIsInFlight() {
+  Notifications notified;
+  mpv::PlaneRenderWorker worker([&]() { ++notified.count; }, nullptr);
+  int first = 0;
+  int second = 0;
+  EXPECT(worker.Submit([&]() { ++first; }, nullptr, Clock::now()));
+  EXPECT(!worker.Submit([&]() { ++second; }, [&](bool) { ++second; }, Clock::now()));
+  notified.WaitFor(1);
+  worker.Collect();
+  EXPECT(first == 1);
+  EXPECT(second == 0);
+  EXPECT(worker.Submit([&]() { ++second; }, nullptr, Clock::now()));
+  notified.WaitFor(2);
+  worker.Settle();
+  EXPECT(second == 1);
+}
+
+// A frame still waiting for its start time is withdrawn by Settle: its work
+// never runs, and its finish hears so.
+void TestSettleWithdrawsAWaitingFrame() {
+  mpv::PlaneRenderWorker worker(nullptr, nullptr);
+  std::atomic<bool> worked{false};
+  bool finished = false;
+  bool ran = true;
+  EXPECT(worker.Submit(
+      [&]() { worked = true; },
+      [&](bool did_run) {
+        finished = true;
+        ran = did_run;
+      },
+      Clock::now() + std::chrono::seconds(30)));
+  worker.Settle();
+  EXPECT(finished);
+  EXPECT(!ran);
+  EXPECT(!worker.busy());
+  std::this_thread::sleep_for(std::chrono::milliseconds(20));
+  EXPECT(!worked.load());
+}
+
+// A frame already rendering is waited out, and collected by Settle itself, so
+// the owner can change what the frame's commit would carry straight after.
+void TestSettleWaitsOutARunningFrame() {
+  mpv::PlaneRenderWorker worker(nullptr, nullptr);
+  std::atomic<bool> started{false};
+  std::atomic<bool> done{false};
+  bool ran = false;
+  EXPECT(worker.Submit(
+      [&]() {
+        started = true;
+        std::this_thread::sleep_for(std::chrono::milliseconds(30));
+        done = true;
+      },
+      [&](bool did_run) { ran = did_run; }, Clock::now()));
+  const auto deadline = Clock::now() + std::chrono::seconds(5);
+  while (!started.load() && Clock::now() < deadline) std::this_thread::yield();
+  worker.Settle();
+  EXPECT(done.load());
+  EXPECT(ran);
+  EXPECT(!worker.busy());
+}
+
+// The start time holds the work back, and the work is not late for it by more
+// than scheduling noise.
+void TestWorkWaitsForItsStartTime() {
+  Notifications notified;
+  mpv::PlaneRenderWorker worker([&]() { ++notified.count; }, nullptr);
+  const auto submitted = Clock::now();
+  Clock::time_point worked_at;
+  EXPECT(worker.Submit([&]() { worked_at = Clock::now(); }, nullptr, submitted + std::chrono::milliseconds(20)));
+  notified.WaitFor(1);
+  worker.Collect();
+  EXPECT(worked_at - submitted >= std::chrono::milliseconds(20));
+}
+
+// Stop settles first, runs the exit hook on the worker, and refuses anything
+// afterwards; a second Stop is a no-op.
+void TestStopSettlesAndRunsTheExitHookOnTheWorker() {
+  std::thread::id exited_on;
+  bool finished = false;
+  mpv::PlaneRenderWorker worker(nullptr, [&]() { exited_on = std::this_thread::get_id(); });
+  EXPECT(worker.Submit([]() {}, [&](bool) { finished = true; }, Clock::now() + std::chrono::seconds(30)));
+  worker.Stop();
+  EXPECT(finished);
+  EXPECT(exited_on != std::thread::id());
+  EXPECT(exited_on != std::this_thread::get_id());
+  EXPECT(!worker.Submit([]() {}, nullptr, Clock::now()));
+  worker.Stop();
+}
+
+}  // namespace
+
+int main() {
+  TestFrameRunsOnTheWorkerAndFinishesOnCollect();
+  TestOnlyOneFrameIsInFlight();
+  TestSettleWithdrawsAWaitingFrame();
+  TestSettleWaitsOutARunningFrame();
+  TestWorkWaitsForItsStartTime();
+  TestStopSettlesAndRunsTheExitHookOnTheWorker();
+  return failures == 0 ? 0 : 1;
+}
@@ -0,0 +1,105 @@
+#ifndef PLEZY_LINUX_MPV_TEARDOWN_RETRY_H_
+#define PLEZY_LINUX_MPV_TEARDOWN_RETRY_H_
+
+#include <cstddef>
+#include <cstdint>
+#include <cstring>
+
+// When the native teardown queue next retries what it could not release, and
+// what it is holding meanwhile.
+//
+// A batch stays queued while one of its EGL contexts cannot be made current
+// (it is still bound on another thread, or the driver refuses), and the mpv
+// core it carries cannot be terminated until every context is gone, so a
+// retained batch keeps a whole core's demuxer and decoder buffers alive. The
+// queue has always retried every 100 ms; the backoff policy spaces retries out
+// instead, doubling up to a cap, so a batch that will not release for a while
+// stops costing a wakeup and a warning ten times a second, while one that
+// becomes releasable still goes within the cap. New work and explicit retries
+// start the backoff over. Each batch keeps a schedule of its own, so one that
+// keeps failing does not push out the retries of one queued after it.
+//
+// Free of EGL and libmpv like the other pure headers beside it, so the
+// schedule is testable without either.
+
+namespace mpv {
+
+enum class TeardownRetryPolicy {
+  // A retry every kFixedDelayMs while anything is retained.
+  kFixed,
+  // kFirstBackoffMs, doubling per failed attempt, up to kMaxBackoffMs.
+  kBackoff,
+};
+
+inline const char* TeardownRetryPolicyName(TeardownRetryPolicy policy) {
+  return policy == TeardownRetryPolicy::kBackoff ? "backoff" : "fixed";
+}
+
+inline bool ParseTeardownRetryPolicy(const char* name, TeardownRetryPolicy* policy) {
+  if (name == nullptr) return false;
+  if (std::strcmp(name, "fixed") == 0) {
+    *policy = TeardownRetryPolicy::kFixed;
+    return true;
+  }
+  if (std::strcmp(name, "backoff") == 0) {
+    *policy = TeardownRetryPolicy::kBackoff;
+    return true;
+  }
+  return false;
+}
+
+class TeardownRetrySchedule {
+ public:
+  static constexpr int64_t kFixedDelayMs = 100;
+  static constexpr int64_t kFirstBackoffMs = 100;
+  // The bound on how long a releasable batch can wait for its retry.
+  static constexpr int64_t kMaxBackoffMs = 10000;
+
+  void SetPolicy(TeardownRetryPolicy policy) {
+    policy_ = policy;
+    Reset();
+  }
+  TeardownRetryPolicy policy() const { return policy_; }
+
+  // How long to wait after an attempt that left the batch retained.
+  int64_t NextDelayMs() {
+    if (policy_ == TeardownRetryPolicy::kFixed) return kFixedDelayMs;
+    const int64_t delay = backoff_ms_;
+    backoff_ms_ = backoff_ms_ * 2 < kMaxBackoffMs ? backoff_ms_ * 2 : kMaxBackoffMs;
+    return delay;
+  }
+
+  // Something changed that may make a retry succeed: new work, an explicit
+  // retry, or another batch released.
+  void Reset() { backoff_ms_ = kFirstBackoffMs; }
+
+ private:
+  TeardownRetryPolicy policy_ = TeardownRetryPolicy::kFixed;
+  int64_t backoff_ms_ = kFirstBackoffMs;
+};
+
+// Batches released at once, each on a worker of its own. Most of a worker's
+// life is mpv_terminate_destroy waiting on the core's demuxer and network
+// teardown, so a few overlap well; the cap keeps a burst of disposals from
+// becoming a burst of threads.
+constexpr size_t kMaxConcurrentTeardownBatches = 4;
+
+// A snapshot of the queue. Counts include the batches workers are releasing.
+struct TeardownQueueStats {
+  TeardownRetryPolicy policy = TeardownRetryPolicy::kFixed;
+  // Batches not yet fully released, and what they hold.
+  uint64_t pending_batches = 0;
+  uint64_t retained_handles = 0;
+  uint64_t retained_contexts = 0;
+  // How long the oldest of them has been queued; 0 with none.
+  int64_t oldest_batch_age_ms = 0;
+  // Release attempts that left a batch retained, since process start.
+  uint64_t retry_attempts = 0;
+  // Batches fully released, and the longest one of them took from enqueue.
+  uint64_t released_batches = 0;
+  int64_t max_release_latency_ms = 0;
+};
+
+}  // namespace mpv
+
+#endif  // PLEZY_LINUX_MPV_TEARDOWN_RETRY_H_
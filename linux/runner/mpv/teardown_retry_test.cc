@@ -0,0 +1,66 @@
+#include "teardown_retry.h"
+
+#include <iostream>
+#include <string>
+
+namespace {
+
+int failures = 0;
+
+void Expect(bool condition, const char* expression, int line) {
+  if (condition) return;
+  std::cerr << "line " << line << ": check failed: " << expression << '\n';
+  ++failures;
+}
+
+#define EXPECT(condition) Expect(static_cast<bool>(condition), #condition, __LINE__)
+
+// The queue's long-standing behaviour, and still the default.
+void TestFixedPolicyRetriesAtTheSameRate() {
+  mpv::TeardownRetrySchedule schedule;
+  EXPECT(schedule.policy() == mpv::TeardownRetryPolicy::kFixed);
+  for (int i = 0; i < 10; ++i) EXPECT(schedule.NextDelayMs() == mpv::TeardownRetrySchedule::kFixedDelayMs);
+}
+
+void TestBackoffDoublesUpToTheCap() {
+  mpv::TeardownRetrySchedule schedule;
+  schedule.SetPolicy(mpv::TeardownRetryPolicy::kBackoff);
+  EXPECT(schedule.NextDelayMs() == 100);
+  EXPECT(schedule.NextDelayMs() == 200);
+  EXPECT(schedule.NextDelayMs() == 400);
+  int64_t delay = 0;
+  for (int i = 0; i < 20; ++i) delay = schedule.NextDelayMs();
+  EXPECT(delay == mpv::TeardownRetrySchedule::kMaxBackoffMs);
+}
+
+// New work or a released batch may mean the blocker is gone, so the next retry
+// comes soon again rather than a whole cap later.
+void TestResetStartsTheBackoffOver() {
+  mpv::TeardownRetrySchedule schedule;
+  schedule.SetPolicy(mpv::TeardownRetryPolicy::kBackoff);
+  for (int i = 0; i < 8; ++i) schedule.NextDelayMs();
+  schedule.Reset();
+  EXPECT(schedule.NextDelayMs() == mpv::TeardownRetrySchedule::kFirstBackoffMs);
+}
+
+void TestPolicyNames() {
+  mpv::TeardownRetryPolicy policy = mpv::TeardownRetryPolicy::kFixed;
+  EXPECT(mpv::ParseTeardownRetryPolicy("backoff", &policy));
+  EXPECT(policy == mpv::TeardownRetryPolicy::kBackoff);
+  EXPECT(mpv::ParseTeardownRetryPolicy("fixed", &policy));
+  EXPECT(policy == mpv::TeardownRetryPolicy::kFixed);
+  EXPECT(!mpv::ParseTeardownRetryPolicy("eager", &policy));
+  EXPECT(!mpv::ParseTeardownRetryPolicy(nullptr, &policy));
+  EXPECT(policy == mpv::TeardownRetryPolicy::kFixed);
+  EXPECT(std::string(mpv::TeardownRetryPolicyName(mpv::TeardownRetryPolicy::kBackoff)) == "backoff");
+}
+
+}  // namespace
+
+int main() {
+  TestFixedPolicyRetriesAtTheSameRate();
+  TestBackoffDoublesUpToTheCap();
+  TestResetStartsTheBackoffOver();
+  TestPolicyNames();
+  return failures == 0 ? 0 : 1;
+}
@@ -30,6 +30,9 @@ struct SourceHdrMetadata {
   double max_fall = 0.0;       ///< nits, maximum frame-average light level
   double max_luminance = 0.0;  ///< nits, mastering display maximum
   double min_luminance = 0.0;  ///< nits, mastering display minimum
+  /// The FFmpeg pixel format name, e.g. "yuv420p10". Under hardware decoding
+  /// it is the frames' underlying format ("p010"), not the hwdec's ("vaapi").
+  std::string pixel_format;
 };
 
 // Reads the fields the HDR decision needs out of a `video-params` node.
@@ -74,6 +77,10 @@ inline SourceHdrMetadata ParseSourceHdrMetadata(const mpv_node* params) {
     *out = parsed;
   };
 
+  // mpv reports a hardware-decoded frame's pixelformat as the hwdec's own name
+  // and the software format behind it as hw-pixelformat; only the latter says
+  // how deep the source is.
+  std::string hw_pixel_format;
   for (int i = 0; i < entries.num; ++i) {
     const char* key = entries.keys[i];
     if (key == nullptr) continue;
@@ -91,6 +98,10 @@ inline SourceHdrMetadata ParseSourceHdrMetadata(const mpv_node* params) {
       positive(value, &metadata.max_fall);
     } else if (std::strcmp(key, "max-luma") == 0) {
       positive(value, &metadata.max_luminance);
+    } else if (std::strcmp(key, "pixelformat") == 0) {
+      name(value, &metadata.pixel_format);
+    } else if (std::strcmp(key, "hw-pixelformat") == 0) {
+      name(value, &hw_pixel_format);
     } else if (std::strcmp(key, "min-luma") == 0) {
       // The mastering floor is the one luminance a source may legitimately
       // state as zero — a display whose black is unmeasurably low — so it is
@@ -99,6 +110,7 @@ inline SourceHdrMetadata ParseSourceHdrMetadata(const mpv_node* params) {
       if (number(value, &parsed) && parsed >= 0.0) metadata.min_luminance = parsed;
     }
   }
+  if (!hw_pixel_format.empty()) metadata.pixel_format = hw_pixel_format;
   return metadata;
 }
 
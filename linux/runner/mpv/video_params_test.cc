@@ -86,6 +86,21 @@ void TestEveryFieldPresentIsRead() {
   EXPECT(metadata.max_fall == 400.0);
   EXPECT(metadata.max_luminance == 1000.0);
   EXPECT(metadata.min_luminance == 0.0001);
+  EXPECT(metadata.pixel_format == "yuv420p10");
+}
+
+// Under hwdec the pixelformat names the hardware surface, which says nothing
+// about depth; the format behind it does, whichever order mpv sends them in.
+void TestHardwareFramesReportTheirUnderlyingFormat() {
+  Params params;
+  params.Add("hw-pixelformat", Text("p010")).Add("pixelformat", Text("vaapi"));
+  const mpv_node node = params.Node();
+  EXPECT(mpv::ParseSourceHdrMetadata(&node).pixel_format == "p010");
+
+  Params software;
+  software.Add("pixelformat", Text("yuv420p"));
+  const mpv_node software_node = software.Node();
+  EXPECT(mpv::ParseSourceHdrMetadata(&software_node).pixel_format == "yuv420p");
 }
 
 // The common HDR10 case: a PQ / BT.2020 stream that states no static metadata at
@@ -269,6 +284,7 @@ void TestMistypedValuesAreSkippedButIntegersAreNot() {
 
 int main() {
   TestEveryFieldPresentIsRead();
+  TestHardwareFramesReportTheirUnderlyingFormat();
   TestNamesSurviveWithNoLuminances();
   TestEachLuminanceIsAbsentOnItsOwn();
   TestMinLumaAcceptsAZeroTheOthersRefuse();
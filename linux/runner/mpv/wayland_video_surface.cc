@@ -2,15 +2,20 @@
 
 #include <EGL/eglext.h>
 #include <gdk/gdkwayland.h>
+#include <time.h>
 #include <unistd.h>
 #include <wayland-client.h>
 #include <wayland-egl.h>
 
 #include <cstring>
 #include <limits>
+#include <vector>
 
 #include "color-management-v1-client-protocol.h"
 #include "plane_geometry.h"
+#ifdef PLEZY_HAVE_WP_PRESENTATION
+#include "presentation-time-client-protocol.h"
+#endif
 
 namespace mpv {
 namespace {
@@ -30,6 +35,9 @@ bool Fail(std::string* error, const char* message) {
 struct RegistryTarget {
   wl_subcompositor* subcompositor = nullptr;
   wp_color_manager_v1* color_manager = nullptr;
+  // Bound by BindGlobals itself, not here: its clock_id event follows the bind
+  // at once and must find the surface's listener already attached.
+  uint32_t presentation_name = 0;
 };
 
 void RegistryGlobal(void* data, wl_registry* registry, uint32_t name, const char* interface, uint32_t version) {
@@ -41,6 +49,8 @@ void RegistryGlobal(void* data, wl_registry* registry, uint32_t name, const char
     const uint32_t bind_version = version < kColorManagerMaxVersion ? version : kColorManagerMaxVersion;
     target->color_manager = static_cast<wp_color_manager_v1*>(
         wl_registry_bind(registry, name, &wp_color_manager_v1_interface, bind_version));
+  } else if (g_strcmp0(interface, "wp_presentation") == 0 && target->presentation_name == 0) {
+    target->presentation_name = name;
   }
 }
 
@@ -165,6 +175,21 @@ bool WaylandVideoSurface::BindGlobals(GdkDisplay* display, std::string* error) {
     }
   }
 
+#ifdef PLEZY_HAVE_WP_PRESENTATION
+  wp_presentation* presentation = nullptr;
+  if (round_tripped && target.presentation_name != 0) {
+    presentation = static_cast<wp_presentation*>(
+        wl_registry_bind(registry, target.presentation_name, &wp_presentation_interface, 1));
+    if (presentation != nullptr) {
+      static const wp_presentation_listener kPresentationListener = {HandlePresentationClockId};
+      wp_presentation_add_listener(presentation, &kPresentationListener, this);
+      // clock_id is sent on bind; one roundtrip delivers it.
+      round_tripped = wl_display_roundtrip_queue(wl_display_, queue) >= 0;
+      wl_proxy_set_queue(reinterpret_cast<wl_proxy*>(presentation), nullptr);
+    }
+  }
+#endif
+
   wl_registry_destroy(registry);
 
   // Both globals were bound from a registry on `queue`, so they inherited it.
@@ -185,6 +210,10 @@ bool WaylandVideoSurface::BindGlobals(GdkDisplay* display, std::string* error) {
   // message into a VIDEO_PLANE_UNSUPPORTED init failure - a compositor without
   // wl_subcompositor takes this route on every launch.
   auto abandon = [&](const char* message) {
+#ifdef PLEZY_HAVE_WP_PRESENTATION
+    if (presentation != nullptr) wp_presentation_destroy(presentation);
+    presentation_monotonic_ = false;
+#endif
     if (target.color_manager != nullptr) wp_color_manager_v1_destroy(target.color_manager);
     if (target.subcompositor != nullptr) wl_subcompositor_destroy(target.subcompositor);
     manager_caps_ = ManagerCaps{};
@@ -194,6 +223,12 @@ bool WaylandVideoSurface::BindGlobals(GdkDisplay* display, std::string* error) {
   if (target.subcompositor == nullptr) return abandon("Compositor does not expose wl_subcompositor");
 
   subcompositor_ = target.subcompositor;
+#ifdef PLEZY_HAVE_WP_PRESENTATION
+  presentation_ = presentation;
+  if (presentation_ != nullptr && !presentation_monotonic_) {
+    g_message("MPV video plane: presentation clock is not CLOCK_MONOTONIC; no vblank timing");
+  }
+#endif
 
   if (target.color_manager != nullptr) {
     color_manager_ = target.color_manager;
@@ -288,6 +323,50 @@ bool WaylandVideoSurface::InitEgl(std::string* error) {
       };
       if (choose(attributes)) {
         depth_bits_ = tier.bits;
+        created_depth_bits_ = tier.bits;
+        // The 8-bit config a per-source plane drops to for 8-bit SDR; see
+        // plane_format.h. Only worth having where one context can render to
+        // both, and with the same renderable type as the deep one.
+        const bool has_no_config_context =
+            extensions != nullptr && strstr(extensions, "EGL_KHR_no_config_context") != nullptr;
+        if (tier.bits > 8 && has_no_config_context) {
+          const EGLint shallow_attributes[] = {
+              EGL_SURFACE_TYPE,
+              EGL_WINDOW_BIT,
+              EGL_RENDERABLE_TYPE,
+              renderable,
+              EGL_RED_SIZE,
+              8,
+              EGL_GREEN_SIZE,
+              8,
+              EGL_BLUE_SIZE,
+              8,
+              EGL_ALPHA_SIZE,
+              0,
+              EGL_NONE,
+          };
+          // EGL sorts deeper colour first, so on Mesa the best "at least 8"
+          // match is ARGB2101010: only a config that is 8 bits exactly will
+          // do. Without one the plane stays at the depth it was created at.
+          EGLint count = 0;
+          if (eglChooseConfig(egl_display_, shallow_attributes, nullptr, 0, &count) && count > 0) {
+            std::vector<EGLConfig> configs(static_cast<size_t>(count));
+            if (!eglChooseConfig(egl_display_, shallow_attributes, configs.data(), count, &count)) count = 0;
+            configs.resize(static_cast<size_t>(count));
+            auto channel_bits = [this](EGLConfig config, EGLint attribute) {
+              EGLint bits = 0;
+              return eglGetConfigAttrib(egl_display_, config, attribute, &bits) ? bits : 0;
+            };
+            for (const EGLConfig config : configs) {
+              if (channel_bits(config, EGL_RED_SIZE) == 8 && channel_bits(config, EGL_GREEN_SIZE) == 8 &&
+                  channel_bits(config, EGL_BLUE_SIZE) == 8) {
+                deep_config_ = egl_config_;
+                shallow_config_ = config;
+                break;
+              }
+            }
+          }
+        }
         return true;
       }
     }
@@ -295,6 +374,37 @@ bool WaylandVideoSurface::InitEgl(std::string* error) {
   return Fail(error, "No matching EGL config for the video plane");
 }
 
+bool WaylandVideoSurface::SetDepthBits(int bits, std::string* error) {
+  if (bits == depth_bits_) return true;
+  if (shallow_config_ == nullptr || egl_window_ == nullptr) {
+    return Fail(error, "The video plane cannot change depth");
+  }
+  if (bits != 8 && bits != created_depth_bits_) return Fail(error, "The video plane has no config at that depth");
+  const EGLConfig config = bits == 8 ? shallow_config_ : deep_config_;
+
+  // A native window carries one EGL surface at a time, so the old one goes
+  // first. A frame being swapped elsewhere would still be using it.
+  SettleRender();
+  if (eglGetCurrentSurface(EGL_DRAW) == egl_surface_ || eglGetCurrentSurface(EGL_READ) == egl_surface_) {
+    eglMakeCurrent(egl_display_, EGL_NO_SURFACE, EGL_NO_SURFACE, EGL_NO_CONTEXT);
+  }
+  eglDestroySurface(egl_display_, egl_surface_);
+  egl_surface_ =
+      eglCreateWindowSurface(egl_display_, config, reinterpret_cast<EGLNativeWindowType>(egl_window_), nullptr);
+  if (egl_surface_ != EGL_NO_SURFACE) {
+    egl_config_ = config;
+    depth_bits_ = bits;
+    return true;
+  }
+  g_warning("MPV video plane: failed to create a %d-bit EGL surface: 0x%x", bits, eglGetError());
+  egl_surface_ =
+      eglCreateWindowSurface(egl_display_, egl_config_, reinterpret_cast<EGLNativeWindowType>(egl_window_), nullptr);
+  if (egl_surface_ == EGL_NO_SURFACE) {
+    return Fail(error, "Failed to recreate the video EGL surface after a depth change failed");
+  }
+  return Fail(error, "Failed to create a video EGL surface at the requested depth");
+}
+
 bool WaylandVideoSurface::Create(GtkWidget* view, std::string* error) {
   if (view == nullptr) return Fail(error, "Video plane requires a realized view");
   GdkDisplay* display = gtk_widget_get_display(view);
@@ -728,6 +838,11 @@ void WaylandVideoSurface::BeginHdrTransition(
     return;
   }
 
+  // Nothing may be on its way to the screen once the plane is staged: Present()
+  // is held from here, and a frame already rendering could be rendered in the
+  // colour space mpv is about to leave and committed after the description
+  // moves.
+  SettleRender();
   transition_staged_ = true;
   transition_token_ += 1;
   staged_describe_ = describe;
@@ -821,6 +936,7 @@ bool WaylandVideoSurface::CommitHdrTransition(uint64_t token) {
   CancelTransitionWatchdog();
 
   const bool describe = staged_describe_;
+  SettleRender();
 
   if (describe) {
     if (staged_description_ == nullptr) {
@@ -890,6 +1006,7 @@ bool WaylandVideoSurface::ForceUndescribed() {
   if (color_surface_ == nullptr || !hdr_active_) {
     return false;
   }
+  SettleRender();
   wp_color_management_surface_v1_unset_image_description(color_surface_);
   hdr_active_ = false;
   // Cleared everywhere hdr_active_ goes false, not just on the commit path. A
@@ -1001,6 +1118,7 @@ void WaylandVideoSurface::ArmFrameAckWatchdog() {
         // either a new mpv frame or a forced render, so calling on_frame_
         // directly is what makes the next present happen at all.
         self->ClearFrameCallback();
+        self->frame_pacing_.FrameAckMissed();
         if (++self->consecutive_frame_acks_missed_ > kMaxConsecutiveFrameAckMisses) {
           g_warning(
               "MPV video plane: compositor is not acknowledging frames (%d misses); "
@@ -1032,10 +1150,16 @@ void WaylandVideoSurface::ClearFrameCallback() {
 }
 
 void WaylandVideoSurface::HandleFrameDone(void* data, wl_callback* callback, uint32_t time) {
-  (void)time;
   auto* self = static_cast<WaylandVideoSurface*>(data);
-  // Always the callback we hold: Present() is the only place one is created and
-  // it early-returns while frame_pending_, so a second is never armed over a
+  if (self->present_in_flight_) {
+    // Ahead of the render thread's result; FinishPresent records it.
+    self->early_frame_done_us_ = g_get_monotonic_time();
+    self->early_frame_done_ms_ = time;
+  } else {
+    self->frame_pacing_.FrameDone(g_get_monotonic_time(), time);
+  }
+  // Always the callback we hold: BeginPresent() is the only place one is
+  // created and it early-returns while frame_pending_, so a second is never armed over a
   // live one, and libwayland delivers nothing for a proxy we already destroyed.
   if (self->frame_callback_ == callback) {
     wl_callback_destroy(self->frame_callback_);
@@ -1046,12 +1170,80 @@ void WaylandVideoSurface::HandleFrameDone(void* data, wl_callback* callback, uin
   // A real acknowledgement is the watchdog's success case; it has no more
   // work to do (this is a static handler, so the call goes through `self`).
   self->CancelFrameAckWatchdog();
+  if (!self->presentation_timed() && self->on_presented_) self->on_presented_();
   // Rendering resumes from here, not from mpv: its redraw latch is still set
   // from the update we declined to serve, so it will not notify again.
   if (self->on_frame_) self->on_frame_();
 }
 
+void WaylandVideoSurface::HandlePresentationClockId(void* data, wp_presentation* presentation, uint32_t clock_id) {
+  (void)presentation;
+  static_cast<WaylandVideoSurface*>(data)->presentation_monotonic_ = clock_id == CLOCK_MONOTONIC;
+}
+
+// The feedback type is spelled `struct wp_presentation_feedback` throughout:
+// the generated header also declares a request function by that exact name.
+void WaylandVideoSurface::HandleFeedbackSyncOutput(
+    void* data, struct wp_presentation_feedback* feedback, wl_output* output) {
+  (void)data;
+  (void)feedback;
+  (void)output;
+}
+
+void WaylandVideoSurface::HandleFeedbackPresented(
+    void* data, struct wp_presentation_feedback* feedback, uint32_t tv_sec_hi, uint32_t tv_sec_lo, uint32_t tv_nsec,
+    uint32_t refresh, uint32_t seq_hi, uint32_t seq_lo, uint32_t flags) {
+  (void)seq_hi;
+  (void)seq_lo;
+  auto* self = static_cast<WaylandVideoSurface*>(data);
+  self->ReleasePresentationFeedback(feedback);
+#ifdef PLEZY_HAVE_WP_PRESENTATION
+  const int64_t seconds = static_cast<int64_t>((static_cast<uint64_t>(tv_sec_hi) << 32) | tv_sec_lo);
+  self->display_sync_.OnPresented(
+      seconds * 1000000 + tv_nsec / 1000, refresh / 1000, (flags & WP_PRESENTATION_FEEDBACK_KIND_VSYNC) != 0);
+#else
+  (void)tv_sec_hi;
+  (void)tv_sec_lo;
+  (void)tv_nsec;
+  (void)refresh;
+  (void)flags;
+#endif
+  if (self->on_presented_) self->on_presented_();
+}
+
+void WaylandVideoSurface::HandleFeedbackDiscarded(void* data, struct wp_presentation_feedback* feedback) {
+  static_cast<WaylandVideoSurface*>(data)->ReleasePresentationFeedback(feedback);
+}
+
+void WaylandVideoSurface::ReleasePresentationFeedback(struct wp_presentation_feedback* feedback) {
+#ifdef PLEZY_HAVE_WP_PRESENTATION
+  for (auto it = presentation_feedback_.begin(); it != presentation_feedback_.end(); ++it) {
+    if (*it == feedback) {
+      presentation_feedback_.erase(it);
+      wp_presentation_feedback_destroy(feedback);
+      return;
+    }
+  }
+#else
+  (void)feedback;
+#endif
+}
+
+void WaylandVideoSurface::ClearPresentationFeedback() {
+#ifdef PLEZY_HAVE_WP_PRESENTATION
+  for (struct wp_presentation_feedback* feedback : presentation_feedback_) {
+    wp_presentation_feedback_destroy(feedback);
+  }
+#endif
+  presentation_feedback_.clear();
+}
+
 void WaylandVideoSurface::Destroy() {
+  // A frame still being swapped elsewhere would be using the EGL surface and
+  // the wl_surface below.
+  SettleRender();
+  render_fence_ = nullptr;
+  AbandonPresent();
   // Unconditionally, ahead of everything: both timeout closures capture
   // `this`, and the transition watchdog is only cancelled below when a
   // transition is actually staged.
@@ -1070,6 +1262,18 @@ void WaylandVideoSurface::Destroy() {
   }
   ClearFrameCallback();
   on_frame_ = nullptr;
+  // Feedback objects are children of the wl_surface and their listeners
+  // capture `this`, so both go before it does.
+  ClearPresentationFeedback();
+  on_presented_ = nullptr;
+#ifdef PLEZY_HAVE_WP_PRESENTATION
+  if (presentation_ != nullptr) {
+    wp_presentation_destroy(presentation_);
+    presentation_ = nullptr;
+  }
+#endif
+  presentation_monotonic_ = false;
+  display_sync_.Reset();
   // Same rule as on_frame_: the forced-render callback captures the plugin,
   // and nothing may invoke it once teardown has begun.
   on_forced_render_ = nullptr;
@@ -1123,6 +1327,9 @@ void WaylandVideoSurface::Destroy() {
   compositor_ = nullptr;
   wl_display_ = nullptr;
   egl_config_ = nullptr;
+  deep_config_ = nullptr;
+  shallow_config_ = nullptr;
+  created_depth_bits_ = 8;
   egl_display_ = EGL_NO_DISPLAY;
   view_ = nullptr;
   // All of it, not just the size: SetRect() early-returns when nothing changed,
@@ -1219,6 +1426,10 @@ void WaylandVideoSurface::SetRect(int32_t x, int32_t y, int32_t width, int32_t h
   // gate is the first-frame latch rather than buffer attachment: the committed
   // scale survives a detach, so once a frame has been presented the scale must
   // be updatable with no buffer attached.
+  //
+  // Both of these reach the next commit, and mesa reads the window size while it
+  // swaps, so neither may happen under a frame in flight.
+  if (size_changed || scale_changed) SettleRender();
   if (scale_changed && first_frame_presented_ && scale_ != scale_sent_) {
     wl_surface_set_buffer_scale(surface_, scale_);
     scale_sent_ = scale_;
@@ -1238,6 +1449,7 @@ void WaylandVideoSurface::DetachBuffer() {
   // compositor is told to drop it. The pending frame callback goes too - it
   // would otherwise fire against a surface with nothing to present.
   if (surface_ == nullptr) return;
+  SettleRender();
   ClearFrameCallback();
   wl_surface_attach(surface_, nullptr, 0, 0);
   wl_surface_commit(surface_);
@@ -1253,7 +1465,15 @@ void WaylandVideoSurface::SetVisible(bool visible) {
 }
 
 bool WaylandVideoSurface::Present() {
-  if (!visible_ || egl_surface_ == EGL_NO_SURFACE || frame_pending_) return false;
+  if (!BeginPresent()) return false;
+  const bool swapped = SwapBuffers();
+  return FinishPresent(swapped, g_get_monotonic_time());
+}
+
+bool WaylandVideoSurface::BeginPresent() {
+  // A render recorded ahead of either early return is counted as discarded
+  // when the next one starts.
+  if (!visible_ || egl_surface_ == EGL_NO_SURFACE || frame_pending_ || present_in_flight_) return false;
   // Held while a colour transition is staged. eglSwapBuffers is the child
   // surface's commit, so presenting now would publish a buffer paired with a
   // colour state it was not rendered for - the flash this whole two-phase dance
@@ -1269,12 +1489,59 @@ bool WaylandVideoSurface::Present() {
     wl_callback_add_listener(frame_callback_, &kFrameListener, this);
     frame_pending_ = true;
   }
+  // Likewise for the presentation time, which belongs to the same commit.
+  present_feedback_ = nullptr;
+#ifdef PLEZY_HAVE_WP_PRESENTATION
+  if (presentation_timed()) {
+    static const wp_presentation_feedback_listener kFeedbackListener = {
+        HandleFeedbackSyncOutput, HandleFeedbackPresented, HandleFeedbackDiscarded};
+    struct wp_presentation_feedback* feedback = wp_presentation_feedback(presentation_, surface_);
+    if (feedback != nullptr) {
+      wp_presentation_feedback_add_listener(feedback, &kFeedbackListener, this);
+      presentation_feedback_.push_back(feedback);
+      present_feedback_ = feedback;
+    }
+  }
+#endif
+  present_in_flight_ = true;
+  early_frame_done_us_ = 0;
+  return true;
+}
+
+bool WaylandVideoSurface::SwapBuffers() {
+  // Reads only what cannot change while a frame is in flight: Destroy() settles
+  // the render thread before it touches either.
+  if (eglSwapBuffers(egl_display_, egl_surface_) == EGL_TRUE) return true;
+  // Logged here because the error is per-thread.
+  g_warning("MPV video plane: eglSwapBuffers failed: 0x%x", eglGetError());
+  return false;
+}
+
+void WaylandVideoSurface::AbandonPresent() {
+  if (!present_in_flight_) return;
+  present_in_flight_ = false;
+  early_frame_done_us_ = 0;
+  // Nothing was committed, so the feedback would answer for whatever commit
+  // comes next.
+  if (present_feedback_ != nullptr) ReleasePresentationFeedback(present_feedback_);
+  present_feedback_ = nullptr;
+  ClearFrameCallback();
+}
 
-  if (eglSwapBuffers(egl_display_, egl_surface_) != EGL_TRUE) {
-    ClearFrameCallback();
-    g_warning("MPV video plane: eglSwapBuffers failed: 0x%x", eglGetError());
+bool WaylandVideoSurface::FinishPresent(bool swapped, int64_t swap_us) {
+  if (!present_in_flight_) return false;
+  if (!swapped) {
+    AbandonPresent();
+    frame_pacing_.PresentFailed(true);
     return false;
   }
+  present_in_flight_ = false;
+  present_feedback_ = nullptr;
+  frame_pacing_.Presented(swap_us);
+  if (early_frame_done_us_ != 0) {
+    frame_pacing_.FrameDone(early_frame_done_us_, early_frame_done_ms_);
+    early_frame_done_us_ = 0;
+  }
   if (!first_frame_presented_) {
     // First frame published at scale 1; the real scale may now go out. It
     // applies to the next commit, whose buffer mesa allocates at the resized
@@ -1293,7 +1560,7 @@ bool WaylandVideoSurface::Present() {
   }
   // The acknowledgement for this commit is now owed; bound the wait so a
   // compositor that never pays it cannot freeze the plane (see
-  // ArmFrameAckWatchdog).
+  // ArmFrameAckWatchdog). A no-op when the acknowledgement already came.
   ArmFrameAckWatchdog();
   return true;
 }
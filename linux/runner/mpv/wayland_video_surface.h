@@ -2,18 +2,23 @@
 #define PLEZY_LINUX_MPV_WAYLAND_VIDEO_SURFACE_H_
 
 #include <EGL/egl.h>
+#include <EGL/eglext.h>
 #include <gtk/gtk.h>
 
 #include <cstdint>
 #include <functional>
 #include <string>
+#include <vector>
 
+#include "display_sync.h"
+#include "frame_pacing.h"
 #include "hdr_metadata.h"
 
 struct wl_callback;
 struct wl_compositor;
 struct wl_display;
 struct wl_egl_window;
+struct wl_output;
 struct wl_subcompositor;
 struct wl_subsurface;
 struct wl_surface;
@@ -22,6 +27,8 @@ struct wp_color_management_surface_feedback_v1;
 struct wp_color_manager_v1;
 struct wp_image_description_v1;
 struct wp_image_description_info_v1;
+struct wp_presentation;
+struct wp_presentation_feedback;
 
 namespace mpv {
 
@@ -57,7 +64,8 @@ struct PreferredColorDescription {
 // whole window surface per presented frame (see gdk_cairo_draw_from_gl's
 // alpha path), previously paid once per *video* frame.
 //
-// Everything here runs on the GTK main thread. The subsurface is desynchronized
+// Everything here runs on the GTK main thread, SwapBuffers() alone excepted
+// (see BeginPresent). The subsurface is desynchronized
 // so its commits are independent of the parent's frame loop; position and
 // stacking, however, are *parent* state and only take effect on a parent
 // commit, which is why SetRect() asks the view to redraw.
@@ -95,6 +103,24 @@ class WaylandVideoSurface {
   EGLConfig egl_config() const { return egl_config_; }
   EGLSurface egl_surface() const { return egl_surface_; }
 
+  // Whether SetDepthBits can move the plane between the depth it was created
+  // at and 8 bits: it got a deep config, the driver also offers an 8-bit one,
+  // and a context can be created without a config (EGL_KHR_no_config_context).
+  bool can_change_depth() const { return shallow_config_ != nullptr; }
+  // The config a render context that is to follow SetDepthBits must be created
+  // with: EGL_NO_CONFIG_KHR, since a context made for one config cannot be
+  // made current with a surface of another depth.
+  EGLConfig switchable_context_config() const { return EGL_NO_CONFIG_KHR; }
+  // The depth the plane was created at. depth_bits() is the one it runs at.
+  int created_depth_bits() const { return created_depth_bits_; }
+  // Replaces the EGL window surface with one of |bits| per channel, either
+  // created_depth_bits() or 8, for the frames to come. The wl_surface, its
+  // geometry and its colour state are untouched, and the buffer on screen
+  // stays until the next swap. The render context must be current on no other
+  // thread and have been created with switchable_context_config(). False, with
+  // the plane left as it was where that can still be done, on failure.
+  bool SetDepthBits(int bits, std::string* error);
+
   // Current buffer size in physical pixels. Zero until the first SetRect().
   int32_t width() const { return width_; }
   int32_t height() const { return height_; }
@@ -147,6 +173,48 @@ class WaylandVideoSurface {
   // state, so see hdr_transition_staged().
   bool Present();
 
+  // Present() in three parts, for a caller that renders on a thread of its
+  // own. BeginPresent runs the same checks and arms the frame callback and
+  // presentation feedback for the commit to come; SwapBuffers is the one part
+  // that may run on the render thread, and touches nothing but EGL; then
+  // exactly one of FinishPresent or AbandonPresent, back on the main thread.
+  // `swap_us` is when SwapBuffers returned.
+  //
+  // Between Begin and its end the frame is in flight: frame_pending() holds,
+  // and anything here that would change state the swap's commit carries
+  // settles the render thread first (SetRenderFence).
+  bool BeginPresent();
+  bool SwapBuffers();
+  bool FinishPresent(bool swapped, int64_t swap_us);
+  // For a frame that was begun but never swapped - its render failed or was
+  // withdrawn. Nothing was committed, so nothing is counted as presented.
+  void AbandonPresent();
+  bool present_in_flight() const { return present_in_flight_; }
+
+  // Called before any change to the surface's pending state - its size and
+  // scale, its buffer, its colour description - so that a frame being swapped
+  // on another thread cannot commit it half-made. The render thread's owner
+  // installs one that returns only once no frame is in flight; without one,
+  // frames are never in flight across a call into this class.
+  void SetRenderFence(std::function<void()> fence) { render_fence_ = std::move(fence); }
+
+  // Per-frame timing for this plane. The caller records the render into it;
+  // Present() and the frame callback record the swap and the acknowledgement.
+  FramePacingLog& frame_pacing() { return frame_pacing_; }
+  const FramePacingLog& frame_pacing() const { return frame_pacing_; }
+
+  // Where this output's vblanks fall, from wp_presentation feedback on this
+  // surface's own frames. Has no timing on a compositor without the protocol,
+  // with a presentation clock other than CLOCK_MONOTONIC, or on VRR; the
+  // caller records its render cost into it.
+  DisplaySyncScheduler& display_sync() { return display_sync_; }
+  const DisplaySyncScheduler& display_sync() const { return display_sync_; }
+
+  // Invoked on the GTK main thread when a presented frame is known to have
+  // reached the screen: on wp_presentation's presented event, or on the frame
+  // callback where there is no presentation timing to wait for.
+  void SetPresentedCallback(std::function<void()> callback) { on_presented_ = std::move(callback); }
+
   // True when this plane can be described as HDR at all: the compositor offers
   // a parametric image-description creator, accepts the perceptual render
   // intent, and advertises BT.2020 primaries plus at least one HDR curve (PQ or
@@ -250,6 +318,9 @@ class WaylandVideoSurface {
 
  private:
   bool BindGlobals(GdkDisplay* display, std::string* error);
+  void SettleRender() {
+    if (render_fence_) render_fence_();
+  }
   void BuildImageDescription();
   bool InitEgl(std::string* error);
   void RequestParentCommit();
@@ -270,6 +341,17 @@ class WaylandVideoSurface {
   void SettleTransition(bool ok);
 
   static void HandleFrameDone(void* data, wl_callback* callback, uint32_t time);
+  // True when presentation feedback is being requested, and so when it, not
+  // the frame callback, is what reports a frame on screen.
+  bool presentation_timed() const { return presentation_ != nullptr && presentation_monotonic_; }
+  void ReleasePresentationFeedback(wp_presentation_feedback* feedback);
+  void ClearPresentationFeedback();
+  static void HandlePresentationClockId(void* data, wp_presentation* presentation, uint32_t clock_id);
+  static void HandleFeedbackSyncOutput(void* data, wp_presentation_feedback* feedback, wl_output* output);
+  static void HandleFeedbackPresented(
+      void* data, wp_presentation_feedback* feedback, uint32_t tv_sec_hi, uint32_t tv_sec_lo, uint32_t tv_nsec,
+      uint32_t refresh, uint32_t seq_hi, uint32_t seq_lo, uint32_t flags);
+  static void HandleFeedbackDiscarded(void* data, wp_presentation_feedback* feedback);
   // Interface version 1 only; version 2 and later send ready2 in its place.
   static void HandleImageDescriptionReady(void* data, wp_image_description_v1* desc, uint32_t identity);
   // Interface version 2+. Must be present rather than null, for the reason
@@ -358,6 +440,12 @@ class WaylandVideoSurface {
   EGLDisplay egl_display_ = EGL_NO_DISPLAY;
   EGLConfig egl_config_ = nullptr;
   EGLSurface egl_surface_ = EGL_NO_SURFACE;
+  // The config Create() chose, which egl_config_ is again whenever the plane
+  // runs at created_depth_bits_, and the 8-bit one SetDepthBits can move to.
+  // Null when the plane cannot change depth.
+  EGLConfig deep_config_ = nullptr;
+  EGLConfig shallow_config_ = nullptr;
+  int created_depth_bits_ = 8;
 
   int32_t x_ = 0;
   int32_t y_ = 0;
@@ -388,7 +476,26 @@ class WaylandVideoSurface {
   bool first_frame_presented_ = false;
   bool frame_pending_ = false;
   wl_callback* frame_callback_ = nullptr;
+  // Between BeginPresent and its end. A frame callback can beat the render
+  // thread's result back to the main thread, and its time is then held here
+  // until the frame it belongs to has been recorded as presented.
+  bool present_in_flight_ = false;
+  wp_presentation_feedback* present_feedback_ = nullptr;
+  int64_t early_frame_done_us_ = 0;
+  uint32_t early_frame_done_ms_ = 0;
+  std::function<void()> render_fence_;
+  FramePacingLog frame_pacing_;
   std::function<void()> on_frame_;
+  // Bound when the compositor offers it and the build generated the protocol;
+  // its timestamps are only used on CLOCK_MONOTONIC, the clock everything else
+  // here is measured on. One feedback object per presented frame, each
+  // released by its own presented or discarded event, so there can be a few
+  // outstanding while the compositor catches up.
+  wp_presentation* presentation_ = nullptr;
+  bool presentation_monotonic_ = false;
+  std::vector<wp_presentation_feedback*> presentation_feedback_;
+  DisplaySyncScheduler display_sync_;
+  std::function<void()> on_presented_;
   std::function<void()> on_forced_render_;
 
   wp_color_manager_v1* color_manager_ = nullptr;
@@ -1,5 +1,7 @@
 #include "my_application.h"
 
+#include <chrono>
+
 #include <flutter_linux/flutter_linux.h>
 #include <gdk/gdk.h>
 #ifdef GDK_WINDOWING_WAYLAND
@@ -125,8 +127,16 @@ static void my_application_startup(GApplication* application) {
   G_APPLICATION_CLASS(my_application_parent_class)->startup(application);
 }
 
+// How long exit waits for disposed mpv cores to finish tearing down. Bounded
+// because a driver or a demuxer stuck on the network can block it forever,
+// and a quit that hangs is worse than one that leaves that to the OS.
+static constexpr std::chrono::milliseconds kNativeTeardownExitTimeout{2000};
+
 // Implements GApplication::shutdown.
 static void my_application_shutdown(GApplication* application) {
+  if (!mpv::MpvPlayer::WaitForNativeTeardown(kNativeTeardownExitTimeout)) {
+    g_warning("MPV: native teardown still running at exit; leaving it to the OS");
+  }
   G_APPLICATION_CLASS(my_application_parent_class)->shutdown(application);
 }
 
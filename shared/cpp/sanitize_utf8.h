@@ -48,4 +48,12 @@ static inline std::string SanitizeUtf8(const char* input) {
   return input ? SanitizeUtf8(input, strlen(input)) : std::string();
 }
 
+// The streaming node builders' view of the sanitizer (StandardCodecNodeBuilder
+// in mpv_player_common.h): valid strings - nearly all of them - are written
+// straight from mpv's storage without a copy.
+struct SimdutfUtf8 {
+  static bool Valid(const char* value, size_t length) { return simdutf::validate_utf8(value, length); }
+  static std::string Sanitize(const char* value, size_t length) { return SanitizeUtf8(value, length); }
+};
+
 #endif  // SANITIZE_UTF8_H_
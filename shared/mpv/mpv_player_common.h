@@ -12,6 +12,7 @@
 #include <map>
 #include <mutex>
 #include <string>
+#include <thread>
 #include <utility>
 #include <vector>
 
@@ -49,67 +50,456 @@ struct CancelledRequests {
   std::vector<GetPropertyCallback> properties;
 };
 
+// Pending async requests live in a fixed table of slots, so registering one
+// and completing it - which seek-bar scrubbing does hundreds of times a second
+// - neither allocates a node nor takes a lock. A request id names its slot,
+// whether it waits on a status or a property reply, and the slot's generation
+// when it was registered: an id that has already been completed or cancelled
+// never matches the slot's next occupant. When every slot is busy the request
+// goes to a mutex-guarded overflow map instead; those ids carry kOverflowBit so
+// the two halves can never hand out the same id, and 0 is never handed out at
+// all because the submit helpers use it to mean "no callback".
+//
+// Each callback is delivered exactly once, by Take* or by CancelAll, whichever
+// claims it first. A slot is claimed by moving its state from Ready to Taking,
+// so a completion racing CancelAll loses or wins the same CAS and never both
+// runs the callback and reports it cancelled. A registration still writing its
+// slot when CancelAll passes is treated as one that arrived after it, the same
+// outcome the old single mutex gave when Register won the lock second.
+//
+// Every request is stamped when it registers, and Take* can report how long it
+// waited: that is the reply round trip the event-loop stats record.
 class AsyncRequestRegistry {
  public:
+  using Clock = std::chrono::steady_clock;
+
+  static constexpr size_t kSlotCount = 128;
+  static constexpr uint64_t kOverflowBit = uint64_t{1} << 63;
+
+  AsyncRequestRegistry() = default;
+  AsyncRequestRegistry(const AsyncRequestRegistry&) = delete;
+  AsyncRequestRegistry& operator=(const AsyncRequestRegistry&) = delete;
+
   uint64_t RegisterStatus(StatusCallback callback) {
-    std::lock_guard<std::mutex> lock(mutex_);
-    const uint64_t request_id = next_id_++;
-    status_[request_id] = std::move(callback);
-    return request_id;
+    return Register(&Slot::status, kStatusKind, std::move(callback), overflow_status_);
   }
 
-  StatusCallback TakeStatus(uint64_t request_id) {
-    std::lock_guard<std::mutex> lock(mutex_);
-    auto it = status_.find(request_id);
-    if (it == status_.end()) return nullptr;
-    auto callback = std::move(it->second);
-    status_.erase(it);
-    return callback;
+  StatusCallback TakeStatus(uint64_t request_id, Clock::duration* waited = nullptr) {
+    return Take(&Slot::status, kStatusKind, request_id, overflow_status_, waited);
   }
 
   uint64_t RegisterProperty(GetPropertyCallback callback) {
-    std::lock_guard<std::mutex> lock(mutex_);
-    const uint64_t request_id = next_id_++;
-    properties_[request_id] = std::move(callback);
-    return request_id;
+    return Register(&Slot::property, kPropertyKind, std::move(callback), overflow_properties_);
   }
 
-  GetPropertyCallback TakeProperty(uint64_t request_id) {
-    std::lock_guard<std::mutex> lock(mutex_);
-    auto it = properties_.find(request_id);
-    if (it == properties_.end()) return nullptr;
-    auto callback = std::move(it->second);
-    properties_.erase(it);
-    return callback;
+  GetPropertyCallback TakeProperty(uint64_t request_id, Clock::duration* waited = nullptr) {
+    return Take(&Slot::property, kPropertyKind, request_id, overflow_properties_, waited);
   }
 
   CancelledRequests CancelAll() {
     CancelledRequests cancelled;
-    std::lock_guard<std::mutex> lock(mutex_);
-    cancelled.status.reserve(status_.size());
-    for (auto& request : status_) {
-      if (request.second) {
-        cancelled.status.push_back(std::move(request.second));
+    for (auto& slot : slots_) {
+      uint64_t state = slot.state.load(std::memory_order_acquire);
+      if ((state & kPhaseMask) != kReady) continue;
+      const uint64_t generation = state >> kPhaseBits;
+      if (!slot.state.compare_exchange_strong(
+              state, (generation << kPhaseBits) | kTaking, std::memory_order_acq_rel, std::memory_order_relaxed)) {
+        continue;
       }
+      if (slot.status) cancelled.status.push_back(std::move(slot.status));
+      if (slot.property) cancelled.properties.push_back(std::move(slot.property));
+      slot.status = nullptr;
+      slot.property = nullptr;
+      slot.state.store((generation << kPhaseBits) | kFree, std::memory_order_release);
     }
-    cancelled.properties.reserve(properties_.size());
-    for (auto& request : properties_) {
-      if (request.second) {
-        cancelled.properties.push_back(std::move(request.second));
+
+    std::lock_guard<std::mutex> lock(overflow_mutex_);
+    for (auto& request : overflow_status_) {
+      if (request.second.callback) {
+        cancelled.status.push_back(std::move(request.second.callback));
+      }
+    }
+    for (auto& request : overflow_properties_) {
+      if (request.second.callback) {
+        cancelled.properties.push_back(std::move(request.second.callback));
       }
     }
-    status_.clear();
-    properties_.clear();
+    overflow_status_.clear();
+    overflow_properties_.clear();
     return cancelled;
   }
 
  private:
-  uint64_t next_id_ = 1;
-  std::map<uint64_t, StatusCallback> status_;
-  std::map<uint64_t, GetPropertyCallback> properties_;
-  std::mutex mutex_;
+  // Slot state word: generation << kPhaseBits | phase. The generation advances
+  // each time the slot is claimed for a new request.
+  static constexpr uint64_t kFree = 0;
+  static constexpr uint64_t kWriting = 1;
+  static constexpr uint64_t kReady = 2;
+  static constexpr uint64_t kTaking = 3;
+  static constexpr unsigned kPhaseBits = 2;
+  static constexpr uint64_t kPhaseMask = (uint64_t{1} << kPhaseBits) - 1;
+
+  // Request id: generation << kGenerationShift | kind << kSlotBits | index.
+  static constexpr unsigned kSlotBits = 7;
+  static constexpr unsigned kGenerationShift = kSlotBits + 1;
+  static constexpr uint64_t kGenerationMask = (uint64_t{1} << (63 - kGenerationShift)) - 1;
+  static constexpr uint64_t kStatusKind = 0;
+  static constexpr uint64_t kPropertyKind = 1;
+  static_assert(kSlotCount == (size_t{1} << kSlotBits), "slot index must fill kSlotBits exactly");
+
+  struct Slot {
+    std::atomic<uint64_t> state{kFree};
+    StatusCallback status;
+    GetPropertyCallback property;
+    // Written in Writing and read in Taking, so the state CAS orders it.
+    Clock::time_point registered;
+  };
+
+  template <typename Callback>
+  struct OverflowRequest {
+    Callback callback;
+    Clock::time_point registered;
+  };
+  template <typename Callback>
+  using OverflowMap = std::map<uint64_t, OverflowRequest<Callback>>;
+
+  static uint64_t NextGeneration(uint64_t generation) {
+    // Generation 0 is skipped so that no slot id can ever be 0.
+    generation = (generation + 1) & kGenerationMask;
+    return generation == 0 ? 1 : generation;
+  }
+
+  template <typename Callback>
+  uint64_t Register(Callback Slot::*member, uint64_t kind, Callback callback, OverflowMap<Callback>& overflow) {
+    const Clock::time_point registered = Clock::now();
+    const size_t start = next_slot_.fetch_add(1, std::memory_order_relaxed);
+    for (size_t probe = 0; probe < kSlotCount; ++probe) {
+      const size_t index = (start + probe) & (kSlotCount - 1);
+      Slot& slot = slots_[index];
+      uint64_t state = slot.state.load(std::memory_order_relaxed);
+      if ((state & kPhaseMask) != kFree) continue;
+      const uint64_t generation = NextGeneration(state >> kPhaseBits);
+      if (!slot.state.compare_exchange_strong(
+              state, (generation << kPhaseBits) | kWriting, std::memory_order_acquire, std::memory_order_relaxed)) {
+        continue;
+      }
+      slot.*member = std::move(callback);
+      slot.registered = registered;
+      slot.state.store((generation << kPhaseBits) | kReady, std::memory_order_release);
+      return (generation << kGenerationShift) | (kind << kSlotBits) | index;
+    }
+
+    std::lock_guard<std::mutex> lock(overflow_mutex_);
+    const uint64_t request_id = kOverflowBit | next_overflow_id_++;
+    overflow[request_id] = {std::move(callback), registered};
+    return request_id;
+  }
+
+  template <typename Callback>
+  Callback Take(
+      Callback Slot::*member, uint64_t kind, uint64_t request_id, OverflowMap<Callback>& overflow,
+      Clock::duration* waited) {
+    if (request_id & kOverflowBit) {
+      std::lock_guard<std::mutex> lock(overflow_mutex_);
+      auto it = overflow.find(request_id);
+      if (it == overflow.end()) return nullptr;
+      auto callback = std::move(it->second.callback);
+      if (waited) *waited = Clock::now() - it->second.registered;
+      overflow.erase(it);
+      return callback;
+    }
+
+    const uint64_t generation = request_id >> kGenerationShift;
+    if (generation == 0 || ((request_id >> kSlotBits) & 1) != kind) return nullptr;
+    Slot& slot = slots_[request_id & (kSlotCount - 1)];
+    uint64_t expected = (generation << kPhaseBits) | kReady;
+    if (!slot.state.compare_exchange_strong(
+            expected, (generation << kPhaseBits) | kTaking, std::memory_order_acq_rel, std::memory_order_relaxed)) {
+      return nullptr;
+    }
+    Callback callback = std::move(slot.*member);
+    slot.*member = nullptr;
+    if (waited) *waited = Clock::now() - slot.registered;
+    slot.state.store((generation << kPhaseBits) | kFree, std::memory_order_release);
+    return callback;
+  }
+
+  Slot slots_[kSlotCount];
+  std::atomic<size_t> next_slot_{0};
+  std::mutex overflow_mutex_;
+  uint64_t next_overflow_id_ = 1;
+  OverflowMap<StatusCallback> overflow_status_;
+  OverflowMap<GetPropertyCallback> overflow_properties_;
+};
+
+// Event-loop instrumentation, recorded on the hot path by whichever thread
+// drains mpv's queue and read from the platform thread whenever Dart asks.
+//
+// LatencyHistogram buckets by power of two: bucket 0 counts zeros and bucket
+// i > 0 counts values in [2^(i-1), 2^i), so a microsecond histogram spans
+// sub-microsecond to days in a fixed array. Recording is a handful of relaxed
+// atomic adds and never blocks; a reader may see a recording half-applied, which
+// is off by one event at most and of no consequence for the purpose.
+class LatencyHistogram {
+ public:
+  static constexpr size_t kBucketCount = 40;
+
+  struct Snapshot {
+    uint64_t count = 0;
+    uint64_t sum = 0;
+    uint64_t max = 0;
+    uint64_t buckets[kBucketCount] = {};
+
+    // The top of the bucket that holds quantile `q` (0-1), capped at `max`:
+    // an upper bound within a factor of two.
+    uint64_t Percentile(double q) const {
+      if (count == 0) return 0;
+      const double clamped = std::min(std::max(q, 0.0), 1.0);
+      const uint64_t rank = std::max<uint64_t>(1, static_cast<uint64_t>(clamped * static_cast<double>(count) + 0.5));
+      uint64_t seen = 0;
+      for (size_t i = 0; i < kBucketCount; ++i) {
+        seen += buckets[i];
+        if (seen >= rank) return std::min(BucketTop(i), max);
+      }
+      return max;
+    }
+
+    // What was recorded after `earlier`, read from the same histogram. The
+    // maximum is not recorded per interval, so it is bounded from the buckets.
+    Snapshot Since(const Snapshot& earlier) const {
+      Snapshot delta;
+      delta.count = count - std::min(count, earlier.count);
+      delta.sum = sum - std::min(sum, earlier.sum);
+      for (size_t i = 0; i < kBucketCount; ++i) {
+        delta.buckets[i] = buckets[i] - std::min(buckets[i], earlier.buckets[i]);
+        if (delta.buckets[i] != 0) delta.max = std::min(BucketTop(i), max);
+      }
+      return delta;
+    }
+  };
+
+  LatencyHistogram() = default;
+  LatencyHistogram(const LatencyHistogram&) = delete;
+  LatencyHistogram& operator=(const LatencyHistogram&) = delete;
+
+  void Record(uint64_t value) {
+    buckets_[BucketFor(value)].fetch_add(1, std::memory_order_relaxed);
+    count_.fetch_add(1, std::memory_order_relaxed);
+    sum_.fetch_add(value, std::memory_order_relaxed);
+    uint64_t max = max_.load(std::memory_order_relaxed);
+    while (value > max && !max_.compare_exchange_weak(max, value, std::memory_order_relaxed)) {
+    }
+  }
+
+  Snapshot Read() const {
+    Snapshot snapshot;
+    snapshot.count = count_.load(std::memory_order_relaxed);
+    snapshot.sum = sum_.load(std::memory_order_relaxed);
+    snapshot.max = max_.load(std::memory_order_relaxed);
+    for (size_t i = 0; i < kBucketCount; ++i) {
+      snapshot.buckets[i] = buckets_[i].load(std::memory_order_relaxed);
+    }
+    return snapshot;
+  }
+
+  void Reset() {
+    for (auto& bucket : buckets_) bucket.store(0, std::memory_order_relaxed);
+    count_.store(0, std::memory_order_relaxed);
+    sum_.store(0, std::memory_order_relaxed);
+    max_.store(0, std::memory_order_relaxed);
+  }
+
+  static size_t BucketFor(uint64_t value) {
+    size_t bucket = 0;
+    while (value != 0 && bucket + 1 < kBucketCount) {
+      value >>= 1;
+      ++bucket;
+    }
+    return bucket;
+  }
+
+  // The largest value bucket `index` counts; the last bucket is open-ended.
+  static uint64_t BucketTop(size_t index) {
+    if (index == 0) return 0;
+    if (index + 1 >= kBucketCount) return UINT64_MAX;
+    return (uint64_t{1} << index) - 1;
+  }
+
+ private:
+  std::atomic<uint64_t> buckets_[kBucketCount] = {};
+  std::atomic<uint64_t> count_{0};
+  std::atomic<uint64_t> sum_{0};
+  std::atomic<uint64_t> max_{0};
 };
 
+enum class AsyncReplyKind : uint8_t { kCommand, kSetProperty, kGetProperty };
+static constexpr size_t kAsyncReplyKindCount = 3;
+
+inline const char* AsyncReplyKindName(AsyncReplyKind kind) {
+  switch (kind) {
+    case AsyncReplyKind::kCommand:
+      return "command";
+    case AsyncReplyKind::kSetProperty:
+      return "set-property";
+    case AsyncReplyKind::kGetProperty:
+      return "get-property";
+  }
+  return "unknown";
+}
+
+// Where a player's events spend their time: how long a wakeup waits before the
+// queue is drained, how many events each drain finds, how long each event type
+// takes to handle, and how long each kind of async request takes to come back.
+// Durations are in microseconds. Only requests registered with a callback are
+// timed; fire-and-forget ones never come back through the registry.
+class EventLoopStats {
+ public:
+  using Clock = std::chrono::steady_clock;
+
+  // Every mpv_event_id libmpv defines fits, with room for new ones.
+  static constexpr size_t kEventIdCount = 32;
+
+  struct Snapshot {
+    LatencyHistogram::Snapshot wakeup_to_dispatch_us;
+    LatencyHistogram::Snapshot events_per_drain;
+    LatencyHistogram::Snapshot handler_us[kEventIdCount];
+    LatencyHistogram::Snapshot reply_round_trip_us[kAsyncReplyKindCount];
+
+    Snapshot Since(const Snapshot& earlier) const {
+      Snapshot delta;
+      delta.wakeup_to_dispatch_us = wakeup_to_dispatch_us.Since(earlier.wakeup_to_dispatch_us);
+      delta.events_per_drain = events_per_drain.Since(earlier.events_per_drain);
+      for (size_t i = 0; i < kEventIdCount; ++i) delta.handler_us[i] = handler_us[i].Since(earlier.handler_us[i]);
+      for (size_t i = 0; i < kAsyncReplyKindCount; ++i) {
+        delta.reply_round_trip_us[i] = reply_round_trip_us[i].Since(earlier.reply_round_trip_us[i]);
+      }
+      return delta;
+    }
+  };
+
+  void RecordWakeupToDispatch(Clock::duration waited) { wakeup_to_dispatch_us_.Record(Microseconds(waited)); }
+  void RecordDrain(size_t events) { events_per_drain_.Record(events); }
+  void RecordHandler(mpv_event_id id, Clock::duration took) {
+    const size_t index = static_cast<size_t>(id);
+    if (index < kEventIdCount) handler_us_[index].Record(Microseconds(took));
+  }
+  void RecordReply(AsyncReplyKind kind, Clock::duration waited) {
+    reply_round_trip_us_[static_cast<size_t>(kind)].Record(Microseconds(waited));
+  }
+
+  Snapshot Read() const {
+    Snapshot snapshot;
+    snapshot.wakeup_to_dispatch_us = wakeup_to_dispatch_us_.Read();
+    snapshot.events_per_drain = events_per_drain_.Read();
+    for (size_t i = 0; i < kEventIdCount; ++i) snapshot.handler_us[i] = handler_us_[i].Read();
+    for (size_t i = 0; i < kAsyncReplyKindCount; ++i) snapshot.reply_round_trip_us[i] = reply_round_trip_us_[i].Read();
+    return snapshot;
+  }
+
+  void Reset() {
+    wakeup_to_dispatch_us_.Reset();
+    events_per_drain_.Reset();
+    for (auto& histogram : handler_us_) histogram.Reset();
+    for (auto& histogram : reply_round_trip_us_) histogram.Reset();
+  }
+
+ private:
+  static uint64_t Microseconds(Clock::duration duration) {
+    const auto us = std::chrono::duration_cast<std::chrono::microseconds>(duration).count();
+    return us > 0 ? static_cast<uint64_t>(us) : 0;
+  }
+
+  LatencyHistogram wakeup_to_dispatch_us_;
+  LatencyHistogram events_per_drain_;
+  LatencyHistogram handler_us_[kEventIdCount];
+  LatencyHistogram reply_round_trip_us_[kAsyncReplyKindCount];
+};
+
+// The shape Dart reads: {count, sum, max, p50, p90, p99, buckets}, where
+// `buckets` drops the trailing empty ones.
+template <typename Builder>
+typename Builder::Value EmitHistogram(const LatencyHistogram::Snapshot& histogram, Builder& builder) {
+  size_t used = LatencyHistogram::kBucketCount;
+  while (used > 0 && histogram.buckets[used - 1] == 0) --used;
+  auto map = builder.NewMap(7);
+  auto insert = [&](const char* key, uint64_t value) {
+    auto map_key = builder.MapKey(key, std::strlen(key));
+    builder.Insert(map, std::move(map_key), builder.Int(static_cast<int64_t>(std::min<uint64_t>(value, INT64_MAX))));
+  };
+  insert("count", histogram.count);
+  insert("sum", histogram.sum);
+  insert("max", histogram.max);
+  insert("p50", histogram.Percentile(0.5));
+  insert("p90", histogram.Percentile(0.9));
+  insert("p99", histogram.Percentile(0.99));
+  auto buckets_key = builder.MapKey("buckets", 7);
+  auto buckets = builder.NewList(used);
+  for (size_t i = 0; i < used; ++i) {
+    builder.Append(buckets, builder.Int(static_cast<int64_t>(std::min<uint64_t>(histogram.buckets[i], INT64_MAX))));
+  }
+  builder.Insert(map, std::move(buckets_key), builder.FinishList(std::move(buckets)));
+  return builder.FinishMap(std::move(map));
+}
+
+// {wakeupToDispatchUs, eventsPerDrain, handlerUs: {event name: ...},
+// replyRoundTripUs: {kind: ...}}. Event types nothing was recorded for are
+// left out. Built in document order, so it streams as well as it builds trees.
+template <typename Builder>
+typename Builder::Value EmitEventLoopStats(const EventLoopStats::Snapshot& stats, Builder& builder) {
+  size_t handled_types = 0;
+  for (const auto& histogram : stats.handler_us) {
+    if (histogram.count != 0) ++handled_types;
+  }
+
+  auto map = builder.NewMap(4);
+  auto wakeup_key = builder.MapKey("wakeupToDispatchUs", 18);
+  builder.Insert(map, std::move(wakeup_key), EmitHistogram(stats.wakeup_to_dispatch_us, builder));
+  auto drain_key = builder.MapKey("eventsPerDrain", 14);
+  builder.Insert(map, std::move(drain_key), EmitHistogram(stats.events_per_drain, builder));
+
+  auto handlers_key = builder.MapKey("handlerUs", 9);
+  auto handlers = builder.NewMap(handled_types);
+  for (size_t i = 0; i < EventLoopStats::kEventIdCount; ++i) {
+    if (stats.handler_us[i].count == 0) continue;
+    const char* name = mpv_event_name(static_cast<mpv_event_id>(i));
+    const std::string key = name ? name : "event-" + std::to_string(i);
+    auto handler_key = builder.MapKey(key.data(), key.size());
+    builder.Insert(handlers, std::move(handler_key), EmitHistogram(stats.handler_us[i], builder));
+  }
+  builder.Insert(map, std::move(handlers_key), builder.FinishMap(std::move(handlers)));
+
+  auto replies_key = builder.MapKey("replyRoundTripUs", 16);
+  auto replies = builder.NewMap(kAsyncReplyKindCount);
+  for (size_t i = 0; i < kAsyncReplyKindCount; ++i) {
+    const char* name = AsyncReplyKindName(static_cast<AsyncReplyKind>(i));
+    auto reply_key = builder.MapKey(name, std::strlen(name));
+    builder.Insert(replies, std::move(reply_key), EmitHistogram(stats.reply_round_trip_us[i], builder));
+  }
+  builder.Insert(map, std::move(replies_key), builder.FinishMap(std::move(replies)));
+  return builder.FinishMap(std::move(map));
+}
+
+// One log line: the percentiles of everything that saw traffic.
+inline std::string FormatEventLoopStats(const EventLoopStats::Snapshot& stats) {
+  auto describe = [](const LatencyHistogram::Snapshot& histogram) {
+    return "n=" + std::to_string(histogram.count) + " p50=" + std::to_string(histogram.Percentile(0.5)) +
+           " p99=" + std::to_string(histogram.Percentile(0.99)) + " max=" + std::to_string(histogram.max);
+  };
+  std::string text = "wakeup-to-dispatch us " + describe(stats.wakeup_to_dispatch_us) + "; events/drain " +
+                     describe(stats.events_per_drain);
+  for (size_t i = 0; i < EventLoopStats::kEventIdCount; ++i) {
+    if (stats.handler_us[i].count == 0) continue;
+    const char* name = mpv_event_name(static_cast<mpv_event_id>(i));
+    text += "; " + std::string(name ? name : "event-" + std::to_string(i)) + " us " + describe(stats.handler_us[i]);
+  }
+  for (size_t i = 0; i < kAsyncReplyKindCount; ++i) {
+    if (stats.reply_round_trip_us[i].count == 0) continue;
+    text += "; " + std::string(AsyncReplyKindName(static_cast<AsyncReplyKind>(i))) + " reply us " +
+            describe(stats.reply_round_trip_us[i]);
+  }
+  return text;
+}
+
 // Every libmpv async submission follows the same shape: register the callback,
 // hand the request to mpv, and roll back when the submission fails. A negative
 // result means the request never reached mpv, so nothing will ever complete it
@@ -160,20 +550,30 @@ inline void SubmitGetPropertyAsync(
 // the pending-request registry. `sanitize` converts mpv's payload (not
 // guaranteed to be valid UTF-8) into the string handed to the callback.
 // Returns true when the event was a reply event and has been fully handled.
+// `stats`, when given, records how long the request took to come back.
 template <typename Sanitizer>
-inline bool DispatchReplyEvent(AsyncRequestRegistry& requests, const mpv_event* event, const Sanitizer& sanitize) {
+inline bool DispatchReplyEvent(
+    AsyncRequestRegistry& requests, const mpv_event* event, const Sanitizer& sanitize,
+    EventLoopStats* stats = nullptr) {
+  AsyncRequestRegistry::Clock::duration waited{};
   switch (event->event_id) {
     case MPV_EVENT_COMMAND_REPLY:
     case MPV_EVENT_SET_PROPERTY_REPLY: {
-      StatusCallback callback = requests.TakeStatus(event->reply_userdata);
+      StatusCallback callback = requests.TakeStatus(event->reply_userdata, &waited);
       if (callback) {
+        if (stats) {
+          stats->RecordReply(
+              event->event_id == MPV_EVENT_COMMAND_REPLY ? AsyncReplyKind::kCommand : AsyncReplyKind::kSetProperty,
+              waited);
+        }
         callback(event->error);
       }
       return true;
     }
     case MPV_EVENT_GET_PROPERTY_REPLY: {
-      GetPropertyCallback callback = requests.TakeProperty(event->reply_userdata);
+      GetPropertyCallback callback = requests.TakeProperty(event->reply_userdata, &waited);
       if (callback) {
+        if (stats) stats->RecordReply(AsyncReplyKind::kGetProperty, waited);
         std::string value;
         if (event->error >= 0) {
           auto* prop = static_cast<mpv_event_property*>(event->data);
@@ -252,70 +652,716 @@ inline bool ClaimNodeString(const char* input, NodeConversionBudget* budget, siz
 
 // `Builder` adapts the walk to a platform value type and keeps that platform's
 // UTF-8 sanitizer out of this header. It supplies the types `Value`,
-// `ListBuilder` and `MapBuilder`, the leaves `Null`, `Boolean`, `Int`,
-// `Double` and `String(data, length)`, and the containers `NewList`/`Append`/
-// `FinishList` plus `NewMap`/`Insert`/`FinishMap`. A value passed to
-// `Append`/`Insert` belongs to the builder from then on, and `AbandonMap`
-// releases a partially built map whose key was rejected. The boolean leaf is
-// deliberately not named `Bool`: X11's `Xlib.h`, reached through `epoxy/egl.h`
-// on Linux, defines `Bool` as a macro and would rewrite the declaration.
+// `ListBuilder`, `MapBuilder` and `Key`, the leaves `Null`, `Boolean`, `Int`,
+// `Double` and `String(data, length)`, and the containers `NewList(size)`/
+// `Append`/`FinishList` plus `NewMap(size)`/`MapKey`/`Insert`/`FinishMap`.
+// Calls arrive in document order - a container's size before its elements, a
+// map entry's key before its value - so a builder may stream straight into a
+// wire format instead of building a tree. A value passed to `Append`/`Insert`
+// belongs to the builder from then on, and `AbandonMap` releases a partially
+// built map whose key was rejected; the walk then yields `Null` in its place.
+// The boolean leaf is deliberately not named `Bool`: X11's `Xlib.h`, reached
+// through `epoxy/egl.h` on Linux, defines `Bool` as a macro and would rewrite
+// the declaration.
 template <typename Builder>
-typename Builder::Value ConvertNode(const mpv_node* node, size_t depth, NodeConversionBudget* budget) {
+typename Builder::Value ConvertNode(
+    const mpv_node* node, size_t depth, NodeConversionBudget* budget, Builder& builder) {
   if (!node || !budget || depth >= kMaxNodeDepth || budget->remaining_entries == 0) {
-    return Builder::Null();
+    return builder.Null();
   }
   --budget->remaining_entries;
 
   switch (node->format) {
     case MPV_FORMAT_STRING: {
       size_t length = 0;
-      if (!ClaimNodeString(node->u.string, budget, &length)) return Builder::Null();
-      return Builder::String(node->u.string, length);
+      if (!ClaimNodeString(node->u.string, budget, &length)) return builder.Null();
+      return builder.String(node->u.string, length);
     }
     case MPV_FORMAT_FLAG:
-      return Builder::Boolean(node->u.flag != 0);
+      return builder.Boolean(node->u.flag != 0);
     case MPV_FORMAT_INT64:
-      return Builder::Int(node->u.int64);
+      return builder.Int(node->u.int64);
     case MPV_FORMAT_DOUBLE:
-      return Builder::Double(node->u.double_);
+      return builder.Double(node->u.double_);
     case MPV_FORMAT_NODE_ARRAY: {
       const mpv_node_list* list = node->u.list;
       if (!list || list->num < 0 || list->num > kMaxNodeEntries || (list->num > 0 && !list->values)) {
-        return Builder::Null();
+        return builder.Null();
       }
-      typename Builder::ListBuilder result = Builder::NewList();
+      typename Builder::ListBuilder result = builder.NewList(static_cast<size_t>(list->num));
       for (int i = 0; i < list->num; i++) {
-        Builder::Append(result, ConvertNode<Builder>(&list->values[i], depth + 1, budget));
+        builder.Append(result, ConvertNode(&list->values[i], depth + 1, budget, builder));
       }
-      return Builder::FinishList(std::move(result));
+      return builder.FinishList(std::move(result));
     }
     case MPV_FORMAT_NODE_MAP: {
       const mpv_node_list* map = node->u.list;
       if (!map || map->num < 0 || map->num > kMaxNodeEntries || (map->num > 0 && (!map->keys || !map->values))) {
-        return Builder::Null();
+        return builder.Null();
       }
-      typename Builder::MapBuilder result = Builder::NewMap();
+      typename Builder::MapBuilder result = builder.NewMap(static_cast<size_t>(map->num));
       for (int i = 0; i < map->num; i++) {
         size_t key_length = 0;
         if (!ClaimNodeString(map->keys[i], budget, &key_length)) {
-          Builder::AbandonMap(result);
-          return Builder::Null();
+          builder.AbandonMap(result);
+          return builder.Null();
         }
-        Builder::Insert(result, map->keys[i], key_length, ConvertNode<Builder>(&map->values[i], depth + 1, budget));
+        typename Builder::Key key = builder.MapKey(map->keys[i], key_length);
+        builder.Insert(result, std::move(key), ConvertNode(&map->values[i], depth + 1, budget, builder));
       }
-      return Builder::FinishMap(std::move(result));
+      return builder.FinishMap(std::move(result));
     }
     default:
-      return Builder::Null();
+      return builder.Null();
   }
 }
 
+// Stateless builders - every platform tree builder - need no instance of their
+// own.
+template <typename Builder>
+typename Builder::Value ConvertNode(const mpv_node* node, size_t depth, NodeConversionBudget* budget) {
+  Builder builder;
+  return ConvertNode(node, depth, budget, builder);
+}
+
 template <typename Builder>
 typename Builder::Value ConvertNode(const mpv_node* node) {
   NodeConversionBudget budget;
   return ConvertNode<Builder>(node, 0, &budget);
 }
 
+// Flutter's StandardMessageCodec wire format, written directly. A node
+// property that changes - track-list, chapter-list, demuxer-cache-state - can
+// carry thousands of entries; building a platform value tree for it only for
+// the channel codec to walk that tree again costs a second full walk and an
+// allocation per entry. StandardCodecNodeBuilder streams the mpv_node walk
+// into these bytes instead, and the runner sends them as they are.
+//
+// Only the types a node can produce are written. Integers take the int32 form
+// whenever they fit, as Flutter's own encoders do, and multi-byte fields are
+// in host byte order, which is what the codec specifies. A float64 is padded
+// to an 8-byte boundary of the whole message, so bytes written here are only
+// valid at the offset they were written for: the writer starts where the
+// message starts, and a value staged on its own is re-laid out by
+// AppendEncoded when it is spliced in elsewhere.
+class StandardMessageWriter {
+ public:
+  static constexpr uint8_t kNull = 0;
+  static constexpr uint8_t kTrue = 1;
+  static constexpr uint8_t kFalse = 2;
+  static constexpr uint8_t kInt32 = 3;
+  static constexpr uint8_t kInt64 = 4;
+  static constexpr uint8_t kFloat64 = 6;
+  static constexpr uint8_t kString = 7;
+  static constexpr uint8_t kList = 12;
+  static constexpr uint8_t kMap = 13;
+
+  // A value encoded on its own, from offset 0 of its own writer.
+  struct Encoded {
+    std::vector<uint8_t> bytes;
+    // Only a float64 makes the bytes depend on where they land.
+    bool has_double = false;
+  };
+
+  // Drops the content but keeps the allocation, so one writer reused per
+  // event stops allocating once it has seen the largest payload.
+  void Clear() {
+    bytes_.clear();
+    first_double_ = kNoDouble;
+  }
+  const uint8_t* data() const { return bytes_.data(); }
+  size_t size() const { return bytes_.size(); }
+  // A float64 cut off with the tail no longer counts: only one left below
+  // `size` makes the bytes depend on where they land.
+  void Truncate(size_t size) {
+    if (size < bytes_.size()) bytes_.resize(size);
+    if (size <= first_double_) first_double_ = kNoDouble;
+  }
+  // Hands the content over as a standalone value and leaves the writer empty.
+  Encoded TakeEncoded() {
+    Encoded encoded{std::move(bytes_), first_double_ != kNoDouble};
+    Clear();
+    return encoded;
+  }
+
+  void WriteByte(uint8_t value) { bytes_.push_back(value); }
+  void WriteNull() { WriteByte(kNull); }
+  void WriteBool(bool value) { WriteByte(value ? kTrue : kFalse); }
+  void WriteInt(int64_t value) {
+    if (value >= INT32_MIN && value <= INT32_MAX) {
+      WriteByte(kInt32);
+      WriteRaw(static_cast<int32_t>(value));
+    } else {
+      WriteByte(kInt64);
+      WriteRaw(value);
+    }
+  }
+  void WriteDouble(double value) {
+    if (first_double_ == kNoDouble) first_double_ = bytes_.size();
+    WriteByte(kFloat64);
+    while (bytes_.size() % 8 != 0) bytes_.push_back(0);
+    WriteRaw(value);
+  }
+  // `data` must already be valid UTF-8; sanitizing is the builder's business.
+  void WriteString(const char* data, size_t length) {
+    WriteByte(kString);
+    WriteSize(length);
+    bytes_.insert(bytes_.end(), data, data + length);
+  }
+  void BeginList(size_t size) {
+    WriteByte(kList);
+    WriteSize(size);
+  }
+  void BeginMap(size_t size) {
+    WriteByte(kMap);
+    WriteSize(size);
+  }
+
+  // Splices a staged value in at the current offset. Without a float64, or
+  // when the offset keeps the original 8-byte phase, that is a copy; otherwise
+  // the value is walked and every float64 re-padded for its new position.
+  void AppendEncoded(const Encoded& value) {
+    if (!value.has_double || bytes_.size() % 8 == 0) {
+      // Its float64s lie somewhere inside; its start is a safe stand-in.
+      if (value.has_double && first_double_ == kNoDouble) first_double_ = bytes_.size();
+      bytes_.insert(bytes_.end(), value.bytes.begin(), value.bytes.end());
+      return;
+    }
+    const size_t start = bytes_.size();
+    size_t offset = 0;
+    if (!CopyValue(value.bytes.data(), value.bytes.size(), &offset) || offset != value.bytes.size()) {
+      // Only a bug in this writer could produce bytes it cannot read back.
+      Truncate(start);
+      WriteNull();
+    }
+  }
+
+ private:
+  template <typename T>
+  void WriteRaw(T value) {
+    uint8_t raw[sizeof(T)];
+    std::memcpy(raw, &value, sizeof(T));
+    bytes_.insert(bytes_.end(), raw, raw + sizeof(T));
+  }
+
+  void WriteSize(size_t size) {
+    if (size < 254) {
+      WriteByte(static_cast<uint8_t>(size));
+    } else if (size <= 0xffff) {
+      WriteByte(254);
+      WriteRaw(static_cast<uint16_t>(size));
+    } else {
+      WriteByte(255);
+      WriteRaw(static_cast<uint32_t>(size));
+    }
+  }
+
+  static bool ReadSize(const uint8_t* source, size_t size, size_t* offset, size_t* value) {
+    if (*offset >= size) return false;
+    const uint8_t first = source[(*offset)++];
+    if (first < 254) {
+      *value = first;
+      return true;
+    }
+    if (first == 254) {
+      uint16_t wide = 0;
+      if (size - *offset < sizeof(wide)) return false;
+      std::memcpy(&wide, source + *offset, sizeof(wide));
+      *offset += sizeof(wide);
+      *value = wide;
+      return true;
+    }
+    uint32_t wide = 0;
+    if (size - *offset < sizeof(wide)) return false;
+    std::memcpy(&wide, source + *offset, sizeof(wide));
+    *offset += sizeof(wide);
+    *value = wide;
+    return true;
+  }
+
+  // Re-emits one value read from `source`, which was encoded from offset 0.
+  bool CopyValue(const uint8_t* source, size_t size, size_t* offset) {
+    if (*offset >= size) return false;
+    const uint8_t type = source[(*offset)++];
+    switch (type) {
+      case kNull:
+      case kTrue:
+      case kFalse:
+        WriteByte(type);
+        return true;
+      case kInt32:
+      case kInt64: {
+        const size_t width = type == kInt32 ? sizeof(int32_t) : sizeof(int64_t);
+        if (size - *offset < width) return false;
+        WriteByte(type);
+        bytes_.insert(bytes_.end(), source + *offset, source + *offset + width);
+        *offset += width;
+        return true;
+      }
+      case kFloat64: {
+        *offset = (*offset + 7) & ~static_cast<size_t>(7);
+        double value = 0;
+        if (*offset > size || size - *offset < sizeof(value)) return false;
+        std::memcpy(&value, source + *offset, sizeof(value));
+        *offset += sizeof(value);
+        WriteDouble(value);
+        return true;
+      }
+      case kString: {
+        size_t length = 0;
+        if (!ReadSize(source, size, offset, &length) || size - *offset < length) return false;
+        WriteString(reinterpret_cast<const char*>(source + *offset), length);
+        *offset += length;
+        return true;
+      }
+      case kList:
+      case kMap: {
+        size_t count = 0;
+        if (!ReadSize(source, size, offset, &count)) return false;
+        WriteByte(type);
+        WriteSize(count);
+        const size_t values = type == kMap ? count * 2 : count;
+        for (size_t i = 0; i < values; ++i) {
+          if (!CopyValue(source, size, offset)) return false;
+        }
+        return true;
+      }
+      default:
+        return false;
+    }
+  }
+
+  static constexpr size_t kNoDouble = SIZE_MAX;
+
+  std::vector<uint8_t> bytes_;
+  // Offset of the first float64 written, or kNoDouble.
+  size_t first_double_ = kNoDouble;
+};
+
+// Streams the mpv_node walk into a StandardMessageWriter: one pass, no tree.
+// Nothing is held per value - the bytes are already in the writer by the time
+// a leaf returns - except where a map starts, so that a map the walk rejects
+// part-way can be cut back out before its null goes in. `Utf8` supplies
+// `Valid(data, length)` and `Sanitize(data, length)`, keeping the platform's
+// validator out of this header as the tree builders do; valid strings, nearly
+// all of them, are copied straight from mpv's storage.
+template <typename Utf8>
+struct StandardCodecNodeBuilder {
+  struct Value {};
+  using ListBuilder = Value;
+  using MapBuilder = size_t;
+  using Key = Value;
+
+  explicit StandardCodecNodeBuilder(StandardMessageWriter* writer) : writer(writer) {}
+
+  Value Null() {
+    writer->WriteNull();
+    return {};
+  }
+  Value Boolean(bool value) {
+    writer->WriteBool(value);
+    return {};
+  }
+  Value Int(int64_t value) {
+    writer->WriteInt(value);
+    return {};
+  }
+  Value Double(double value) {
+    writer->WriteDouble(value);
+    return {};
+  }
+  Value String(const char* value, size_t length) {
+    if (Utf8::Valid(value, length)) {
+      writer->WriteString(value, length);
+    } else {
+      const std::string sanitized = Utf8::Sanitize(value, length);
+      writer->WriteString(sanitized.data(), sanitized.size());
+    }
+    return {};
+  }
+
+  ListBuilder NewList(size_t size) {
+    writer->BeginList(size);
+    return {};
+  }
+  void Append(ListBuilder&, Value) {}
+  Value FinishList(ListBuilder) { return {}; }
+
+  MapBuilder NewMap(size_t size) {
+    const size_t start = writer->size();
+    writer->BeginMap(size);
+    return start;
+  }
+  Key MapKey(const char* key, size_t length) { return String(key, length); }
+  void Insert(MapBuilder&, Key, Value) {}
+  Value FinishMap(MapBuilder) { return {}; }
+  void AbandonMap(MapBuilder& start) { writer->Truncate(start); }
+
+  StandardMessageWriter* writer;
+};
+
+// Patch delivery. A property Dart observes in patch mode is sent whole the
+// first time, and after that as the edits that turn the value Dart holds into
+// the new one - a track-list with forty subtitle tracks is forty maps, and a
+// track switch changes two flags in it. The runner keeps the last value it
+// delivered as a NodeSnapshot to diff against. A patch travels under the
+// property's patch id rather than its own, so it can share every channel path
+// a plain value takes, batching included.
+inline int PatchPropertyId(int id) { return -1 - id; }
+
+// More edits than this and the whole value is the smaller message.
+static constexpr size_t kMaxNodePatchOps = 64;
+
+// An owned copy of a converted node. Strings are kept as mpv sent them: they
+// are sanitized on the way out, by whichever platform builder emits them.
+struct NodeSnapshot {
+  enum class Kind : uint8_t { kNull, kBoolean, kInt, kDouble, kString, kList, kMap };
+
+  Kind kind = Kind::kNull;
+  bool boolean = false;
+  int64_t integer = 0;
+  double real = 0;
+  std::string string;
+  // kList: the elements. kMap: `keys[i]` maps to `values[i]`, in mpv's order.
+  std::vector<NodeSnapshot> items;
+  std::vector<std::string> keys;
+  std::vector<NodeSnapshot> values;
+};
+
+// Builds a NodeSnapshot through the shared walk, so the copy has the same
+// bounds as anything else made from the node.
+struct NodeSnapshotBuilder {
+  using Value = NodeSnapshot;
+  using ListBuilder = NodeSnapshot;
+  using MapBuilder = NodeSnapshot;
+  using Key = std::string;
+
+  static Value Null() { return NodeSnapshot(); }
+  static Value Boolean(bool value) {
+    NodeSnapshot node;
+    node.kind = NodeSnapshot::Kind::kBoolean;
+    node.boolean = value;
+    return node;
+  }
+  static Value Int(int64_t value) {
+    NodeSnapshot node;
+    node.kind = NodeSnapshot::Kind::kInt;
+    node.integer = value;
+    return node;
+  }
+  static Value Double(double value) {
+    NodeSnapshot node;
+    node.kind = NodeSnapshot::Kind::kDouble;
+    node.real = value;
+    return node;
+  }
+  static Value String(const char* value, size_t length) {
+    NodeSnapshot node;
+    node.kind = NodeSnapshot::Kind::kString;
+    node.string.assign(value, length);
+    return node;
+  }
+
+  static ListBuilder NewList(size_t size) {
+    NodeSnapshot node;
+    node.kind = NodeSnapshot::Kind::kList;
+    node.items.reserve(size);
+    return node;
+  }
+  static void Append(ListBuilder& list, Value value) { list.items.push_back(std::move(value)); }
+  static Value FinishList(ListBuilder list) { return list; }
+
+  static MapBuilder NewMap(size_t size) {
+    NodeSnapshot node;
+    node.kind = NodeSnapshot::Kind::kMap;
+    node.keys.reserve(size);
+    node.values.reserve(size);
+    return node;
+  }
+  static Key MapKey(const char* key, size_t length) { return std::string(key, length); }
+  static void Insert(MapBuilder& map, Key key, Value value) {
+    map.keys.push_back(std::move(key));
+    map.values.push_back(std::move(value));
+  }
+  static Value FinishMap(MapBuilder map) { return map; }
+  static void AbandonMap(MapBuilder&) {}
+};
+
+// Rewrites an existing NodeSnapshot through the same walk, in place. Strings
+// and vectors keep their storage, so a property that keeps its shape - a
+// track-list between switches, demuxer-cache-state every few hundred ms -
+// is copied without allocating once it has been seen. The walk's document
+// order says where each value lands: the next element of the innermost open
+// container, or the root. A slot that changes kind keeps its old storage,
+// which nothing reads for the new kind.
+class NodeSnapshotFiller {
+ public:
+  using Value = NodeSnapshot*;
+  using ListBuilder = NodeSnapshot*;
+  using MapBuilder = NodeSnapshot*;
+  struct Key {};
+
+  explicit NodeSnapshotFiller(NodeSnapshot* root) : root_(root) {}
+
+  Value Null() {
+    NodeSnapshot* slot = NextSlot();
+    slot->kind = NodeSnapshot::Kind::kNull;
+    return slot;
+  }
+  Value Boolean(bool value) {
+    NodeSnapshot* slot = NextSlot();
+    slot->kind = NodeSnapshot::Kind::kBoolean;
+    slot->boolean = value;
+    return slot;
+  }
+  Value Int(int64_t value) {
+    NodeSnapshot* slot = NextSlot();
+    slot->kind = NodeSnapshot::Kind::kInt;
+    slot->integer = value;
+    return slot;
+  }
+  Value Double(double value) {
+    NodeSnapshot* slot = NextSlot();
+    slot->kind = NodeSnapshot::Kind::kDouble;
+    slot->real = value;
+    return slot;
+  }
+  Value String(const char* value, size_t length) {
+    NodeSnapshot* slot = NextSlot();
+    slot->kind = NodeSnapshot::Kind::kString;
+    slot->string.assign(value, length);
+    return slot;
+  }
+
+  ListBuilder NewList(size_t size) {
+    NodeSnapshot* slot = NextSlot();
+    slot->kind = NodeSnapshot::Kind::kList;
+    slot->items.resize(size);
+    open_.push_back({slot, 0});
+    return slot;
+  }
+  void Append(ListBuilder&, Value) {}
+  Value FinishList(ListBuilder list) {
+    open_.pop_back();
+    return list;
+  }
+
+  MapBuilder NewMap(size_t size) {
+    NodeSnapshot* slot = NextSlot();
+    slot->kind = NodeSnapshot::Kind::kMap;
+    slot->keys.resize(size);
+    slot->values.resize(size);
+    open_.push_back({slot, 0});
+    return slot;
+  }
+  Key MapKey(const char* key, size_t length) {
+    Open& map = open_.back();
+    map.node->keys[map.next].assign(key, length);
+    return {};
+  }
+  void Insert(MapBuilder&, Key, Value) {}
+  Value FinishMap(MapBuilder map) {
+    open_.pop_back();
+    return map;
+  }
+  // The walk's Null for a rejected map goes where the map was.
+  void AbandonMap(MapBuilder& map) {
+    open_.pop_back();
+    abandoned_ = map;
+  }
+
+ private:
+  struct Open {
+    NodeSnapshot* node;
+    size_t next;
+  };
+
+  NodeSnapshot* NextSlot() {
+    if (abandoned_) {
+      NodeSnapshot* slot = abandoned_;
+      abandoned_ = nullptr;
+      return slot;
+    }
+    if (open_.empty()) return root_;
+    Open& parent = open_.back();
+    const size_t index = parent.next++;
+    return parent.node->kind == NodeSnapshot::Kind::kList ? &parent.node->items[index] : &parent.node->values[index];
+  }
+
+  NodeSnapshot* root_;
+  NodeSnapshot* abandoned_ = nullptr;
+  std::vector<Open> open_;
+};
+
+// ConvertNode into `snapshot`, reusing what it already holds.
+inline void RefillNodeSnapshot(const mpv_node* node, NodeSnapshot* snapshot) {
+  NodeSnapshotFiller filler(snapshot);
+  NodeConversionBudget budget;
+  ConvertNode(node, 0, &budget, filler);
+}
+
+// Replays a snapshot into any node builder, in the same document order as the
+// walk that made it.
+template <typename Builder>
+typename Builder::Value EmitNodeSnapshot(const NodeSnapshot& node, Builder& builder) {
+  switch (node.kind) {
+    case NodeSnapshot::Kind::kBoolean:
+      return builder.Boolean(node.boolean);
+    case NodeSnapshot::Kind::kInt:
+      return builder.Int(node.integer);
+    case NodeSnapshot::Kind::kDouble:
+      return builder.Double(node.real);
+    case NodeSnapshot::Kind::kString:
+      return builder.String(node.string.data(), node.string.size());
+    case NodeSnapshot::Kind::kList: {
+      typename Builder::ListBuilder list = builder.NewList(node.items.size());
+      for (const auto& item : node.items) {
+        builder.Append(list, EmitNodeSnapshot(item, builder));
+      }
+      return builder.FinishList(std::move(list));
+    }
+    case NodeSnapshot::Kind::kMap: {
+      typename Builder::MapBuilder map = builder.NewMap(node.keys.size());
+      for (size_t i = 0; i < node.keys.size(); ++i) {
+        typename Builder::Key key = builder.MapKey(node.keys[i].data(), node.keys[i].size());
+        builder.Insert(map, std::move(key), EmitNodeSnapshot(node.values[i], builder));
+      }
+      return builder.FinishMap(std::move(map));
+    }
+    case NodeSnapshot::Kind::kNull:
+    default:
+      return builder.Null();
+  }
+}
+
+// One edit. `path` walks from the root, a map key or a list index per step;
+// kSet replaces or adds the value there (an index one past the end appends),
+// kRemove drops a map key, kTruncate shortens the list at `path` to `length`.
+// Keys and values point into the two snapshots that were diffed, which must
+// outlive the ops.
+struct NodePatchOp {
+  enum class Kind : int { kSet = 0, kRemove = 1, kTruncate = 2 };
+  struct Step {
+    const std::string* key;
+    size_t index;
+  };
+
+  Kind kind;
+  std::vector<Step> path;
+  const NodeSnapshot* value;
+  size_t length;
+};
+
+inline bool SameNodeLeaf(const NodeSnapshot& a, const NodeSnapshot& b) {
+  if (a.kind != b.kind) return false;
+  switch (a.kind) {
+    case NodeSnapshot::Kind::kNull:
+      return true;
+    case NodeSnapshot::Kind::kBoolean:
+      return a.boolean == b.boolean;
+    case NodeSnapshot::Kind::kInt:
+      return a.integer == b.integer;
+    case NodeSnapshot::Kind::kDouble:
+      // NaN is unchanged, not changed on every event.
+      return a.real == b.real || (a.real != a.real && b.real != b.real);
+    case NodeSnapshot::Kind::kString:
+      return a.string == b.string;
+    default:
+      return false;
+  }
+}
+
+// mpv rebuilds a map in the same key order each time, so the key is looked
+// for where it was first.
+inline size_t FindSnapshotKey(const NodeSnapshot& map, const std::string& key, size_t hint) {
+  if (hint < map.keys.size() && map.keys[hint] == key) return hint;
+  for (size_t i = 0; i < map.keys.size(); ++i) {
+    if (map.keys[i] == key) return i;
+  }
+  return map.keys.size();
+}
+
+inline bool DiffNodeSnapshotsAt(
+    const NodeSnapshot& before, const NodeSnapshot& after, size_t max_ops, std::vector<NodePatchOp::Step>* path,
+    std::vector<NodePatchOp>* ops) {
+  auto emit = [&](NodePatchOp::Kind kind, const NodeSnapshot* value, size_t length) {
+    if (ops->size() >= max_ops) return false;
+    ops->push_back({kind, *path, value, length});
+    return true;
+  };
+  auto descend = [&](NodePatchOp::Step step, const NodeSnapshot* from, const NodeSnapshot& to) {
+    path->push_back(step);
+    const bool ok = from ? DiffNodeSnapshotsAt(*from, to, max_ops, path, ops) : emit(NodePatchOp::Kind::kSet, &to, 0);
+    path->pop_back();
+    return ok;
+  };
+
+  const bool container = after.kind == NodeSnapshot::Kind::kList || after.kind == NodeSnapshot::Kind::kMap;
+  if (before.kind != after.kind || !container) {
+    return SameNodeLeaf(before, after) || emit(NodePatchOp::Kind::kSet, &after, 0);
+  }
+
+  if (after.kind == NodeSnapshot::Kind::kList) {
+    const size_t common = std::min(before.items.size(), after.items.size());
+    for (size_t i = 0; i < after.items.size(); ++i) {
+      if (!descend({nullptr, i}, i < common ? &before.items[i] : nullptr, after.items[i])) return false;
+    }
+    if (after.items.size() < before.items.size()) {
+      return emit(NodePatchOp::Kind::kTruncate, nullptr, after.items.size());
+    }
+    return true;
+  }
+
+  for (size_t i = 0; i < after.keys.size(); ++i) {
+    const size_t j = FindSnapshotKey(before, after.keys[i], i);
+    if (!descend({&after.keys[i], 0}, j < before.keys.size() ? &before.values[j] : nullptr, after.values[i])) {
+      return false;
+    }
+  }
+  for (size_t j = 0; j < before.keys.size(); ++j) {
+    if (FindSnapshotKey(after, before.keys[j], j) < after.keys.size()) continue;
+    path->push_back({&before.keys[j], 0});
+    const bool ok = emit(NodePatchOp::Kind::kRemove, nullptr, 0);
+    path->pop_back();
+    if (!ok) return false;
+  }
+  return true;
+}
+
+// Appends to `ops` the edits that turn `before` into `after`. Returns false,
+// with `ops` incomplete, once more than `max_ops` would be needed.
+inline bool DiffNodeSnapshots(
+    const NodeSnapshot& before, const NodeSnapshot& after, size_t max_ops, std::vector<NodePatchOp>* ops) {
+  std::vector<NodePatchOp::Step> path;
+  return DiffNodeSnapshotsAt(before, after, max_ops, &path, ops);
+}
+
+// Emits a patch as the value Dart applies: a list of [kind, path, value] for
+// kSet, [kind, path] for kRemove and [kind, path, length] for kTruncate, where
+// path is a list of map keys and list indices.
+template <typename Builder>
+typename Builder::Value EmitNodePatch(const std::vector<NodePatchOp>& ops, Builder& builder) {
+  typename Builder::ListBuilder list = builder.NewList(ops.size());
+  for (const auto& op : ops) {
+    typename Builder::ListBuilder entry = builder.NewList(op.kind == NodePatchOp::Kind::kRemove ? 2 : 3);
+    builder.Append(entry, builder.Int(static_cast<int64_t>(op.kind)));
+    typename Builder::ListBuilder path = builder.NewList(op.path.size());
+    for (const auto& step : op.path) {
+      builder.Append(
+          path, step.key ? builder.String(step.key->data(), step.key->size())
+                         : builder.Int(static_cast<int64_t>(step.index)));
+    }
+    builder.Append(entry, builder.FinishList(std::move(path)));
+    if (op.kind == NodePatchOp::Kind::kSet) {
+      builder.Append(entry, EmitNodeSnapshot(*op.value, builder));
+    } else if (op.kind == NodePatchOp::Kind::kTruncate) {
+      builder.Append(entry, builder.Int(static_cast<int64_t>(op.length)));
+    }
+    builder.Append(list, builder.FinishList(std::move(entry)));
+  }
+  return builder.FinishList(std::move(list));
+}
+
 inline mpv_format ParsePropertyFormat(const std::string& format) {
   if (format == "string") return MPV_FORMAT_STRING;
   if (format == "flag" || format == "bool") return MPV_FORMAT_FLAG;
@@ -331,6 +1377,13 @@ struct ObservationRequest {
   mpv_format format;
 };
 
+// Dart-facing property observations. The event path resolves a PROPERTY_CHANGE
+// by the userdata mpv echoes back in reply_userdata, and userdata values are
+// dense - each Register that adds a property takes the next one - so that is
+// one index into a flat vector: no name compare and no std::string built per
+// event, for properties that fire at display rate. Names are only consulted
+// when registering. The counter never resets, not even on Clear, so a userdata
+// handed out before a Clear can never alias a later observation.
 class PropertyObservationRegistry {
  public:
   ObservationRequest Register(const std::string& name, const std::string& format, int id) {
@@ -339,33 +1392,180 @@ class PropertyObservationRegistry {
     if (userdata_by_name_.find(name) != userdata_by_name_.end()) {
       return {false, 0, MPV_FORMAT_NONE};
     }
-    const uint64_t userdata = next_userdata_++;
+    const uint64_t userdata = first_userdata_ + ids_.size();
     userdata_by_name_[name] = userdata;
-    id_by_name_[name] = id;
+    ids_.push_back(id);
     return {true, userdata, parsed_format};
   }
 
   bool LookupId(const std::string& name, int* id) const {
     std::lock_guard<std::mutex> lock(mutex_);
-    const auto it = id_by_name_.find(name);
-    if (it == id_by_name_.end()) return false;
-    *id = it->second;
+    const auto it = userdata_by_name_.find(name);
+    if (it == userdata_by_name_.end()) return false;
+    *id = ids_[it->second - first_userdata_];
+    return true;
+  }
+
+  // The per-event lookup. False for userdata this registry never handed out -
+  // 0 and the runners' own reserved values - and for anything from before the
+  // last Clear.
+  bool LookupIdForUserdata(uint64_t userdata, int* id) const {
+    std::lock_guard<std::mutex> lock(mutex_);
+    if (userdata < first_userdata_ || userdata - first_userdata_ >= ids_.size()) return false;
+    *id = ids_[userdata - first_userdata_];
     return true;
   }
 
   void Clear() {
     std::lock_guard<std::mutex> lock(mutex_);
+    first_userdata_ += ids_.size();
     userdata_by_name_.clear();
-    id_by_name_.clear();
+    ids_.clear();
   }
 
  private:
-  uint64_t next_userdata_ = 1;
+  // Userdata of ids_[0]; ids_[i] belongs to first_userdata_ + i.
+  uint64_t first_userdata_ = 1;
   std::map<std::string, uint64_t> userdata_by_name_;
-  std::map<std::string, int> id_by_name_;
+  std::vector<int> ids_;
   mutable std::mutex mutex_;
 };
 
+// Disposes of nothing: for platform value types that own their storage.
+struct RetainStagedValue {
+  template <typename Value>
+  void operator()(Value&) const {}
+};
+
+// Last-value-wins staging for observed property changes. One drain of mpv's
+// event queue can report the same property many times over, and only the final
+// value is worth a platform-channel hop, so changes are staged here under the
+// Dart-side property id and handed back together once the drain ends.
+//
+// A property given a minimum interval is held back until that long has passed
+// since it was last delivered. It is held, never dropped: its latest value goes
+// out when the interval expires, so a property that stops changing still lands
+// on its final value.
+//
+// Not synchronised. It belongs to whichever thread drains the event queue.
+// `Release` disposes of a staged value that was superseded or discarded, for
+// platforms whose value type is reference-counted by hand.
+template <typename Value, typename Release = RetainStagedValue>
+class PropertyChangeCoalescer {
+ public:
+  using Clock = std::chrono::steady_clock;
+
+  struct Change {
+    int id;
+    Value value;
+  };
+
+  PropertyChangeCoalescer() = default;
+  PropertyChangeCoalescer(const PropertyChangeCoalescer&) = delete;
+  PropertyChangeCoalescer& operator=(const PropertyChangeCoalescer&) = delete;
+  ~PropertyChangeCoalescer() { Reset(); }
+
+  void SetMinInterval(int id, std::chrono::milliseconds interval) {
+    EntryFor(id).min_interval = std::max(interval, std::chrono::milliseconds(0));
+  }
+
+  // Takes ownership of `value`, releasing whatever was staged for `id` before.
+  void Stage(int id, Value value) {
+    Entry& entry = EntryFor(id);
+    if (entry.staged) {
+      Release()(entry.value);
+    } else {
+      entry.staged = true;
+      entry.sequence = next_sequence_++;
+    }
+    entry.value = std::move(value);
+  }
+
+  bool HasStaged() const {
+    for (const auto& entry : entries_) {
+      if (entry.staged) return true;
+    }
+    return false;
+  }
+
+  // Moves every staged change that may go out at `now` into `out`, in the order
+  // the properties were first staged, and hands ownership to the caller.
+  // `force` ignores the minimum intervals, for callers that must not let a
+  // property trail an event mpv reported after it. Returns true with
+  // `next_due` set when held changes remain.
+  bool TakeDue(Clock::time_point now, bool force, std::vector<Change>* out, Clock::time_point* next_due) {
+    due_.clear();
+    bool held = false;
+    Clock::time_point earliest{};
+    for (size_t i = 0; i < entries_.size(); ++i) {
+      const Entry& entry = entries_[i];
+      if (!entry.staged) continue;
+      const Clock::time_point due = entry.delivered ? entry.last_delivered + entry.min_interval : now;
+      if (force || due <= now) {
+        due_.push_back({entry.sequence, i});
+        continue;
+      }
+      if (!held || due < earliest) earliest = due;
+      held = true;
+    }
+    std::sort(due_.begin(), due_.end());
+    for (const auto& slot : due_) {
+      Entry& entry = entries_[slot.second];
+      out->push_back({entry.id, std::move(entry.value)});
+      entry.value = Value{};
+      entry.staged = false;
+      entry.delivered = true;
+      entry.last_delivered = now;
+    }
+    if (held && next_due) *next_due = earliest;
+    return held;
+  }
+
+  // Releases every staged value and forgets delivery history, keeping the
+  // configured intervals.
+  void Clear() {
+    for (auto& entry : entries_) {
+      if (entry.staged) Release()(entry.value);
+      entry.value = Value{};
+      entry.staged = false;
+      entry.delivered = false;
+    }
+  }
+
+  // Clear, and forget the intervals too: the ids belong to a session that has
+  // ended.
+  void Reset() {
+    Clear();
+    entries_.clear();
+  }
+
+ private:
+  struct Entry {
+    int id = 0;
+    bool staged = false;
+    bool delivered = false;
+    uint64_t sequence = 0;
+    Value value{};
+    std::chrono::milliseconds min_interval{0};
+    Clock::time_point last_delivered{};
+  };
+
+  // A session observes a handful of properties, so a linear scan over a flat
+  // vector beats a tree and allocates nothing once every id has been seen.
+  Entry& EntryFor(int id) {
+    for (auto& entry : entries_) {
+      if (entry.id == id) return entry;
+    }
+    entries_.emplace_back();
+    entries_.back().id = id;
+    return entries_.back();
+  }
+
+  uint64_t next_sequence_ = 0;
+  std::vector<Entry> entries_;
+  std::vector<std::pair<uint64_t, size_t>> due_;
+};
+
 inline bool ParseEnabledFlag(const std::string& value) { return value == "yes" || value == "true" || value == "1"; }
 
 inline const char* TargetColorspaceHint(bool hdr_enabled) { return hdr_enabled ? "auto" : "no"; }
@@ -492,6 +1692,31 @@ class AudioRecoveryState {
            (resume_requested_ || resume_attempts_left_ > 0 || null_attempts_left_ > 0 || reload_pending_);
   }
 
+  // When NextReload next has something to do, for a caller that sleeps until
+  // then instead of polling. A resume request is due at once (NextReload turns
+  // it into a schedule); nothing is due while a reload is outstanding, because
+  // its completion arrives as an mpv reply that wakes the caller anyway.
+  // False when no reload is scheduled at all.
+  bool NextDeadline(Clock::time_point* deadline) const {
+    std::lock_guard<std::mutex> lock(mutex_);
+    if (!file_loaded_) return false;
+    if (resume_requested_) {
+      *deadline = Clock::time_point{};
+      return true;
+    }
+    if (reload_pending_) return false;
+    bool scheduled = false;
+    if (resume_attempts_left_ > 0) {
+      *deadline = resume_next_attempt_;
+      scheduled = true;
+    }
+    if (null_attempts_left_ > 0 && (!scheduled || null_next_attempt_ < *deadline)) {
+      *deadline = null_next_attempt_;
+      scheduled = true;
+    }
+    return scheduled;
+  }
+
  private:
   static constexpr int kResumeReloadAttempts = 2;
   static constexpr int kNullRetryBudget = 5;
@@ -528,7 +1753,11 @@ struct AudioRecoveryNotice {
 // recovery state machine, leaving the caller only the platform reporting.
 inline AudioRecoveryNotice ObserveAudioRecoveryProperty(
     AudioRecoveryState& state, const mpv_event* event, const mpv_event_property* prop) {
-  if (!event || !prop || !prop->name) return {};
+  // Both are the runner's own observations, made with userdata 0; a Dart-facing
+  // observation of the same property gets its own event, and skipping it here
+  // keeps the name compares off the per-event path for everything Dart
+  // observes.
+  if (!event || !prop || !prop->name || event->reply_userdata != 0) return {};
 
   if (std::strcmp(prop->name, "current-ao") == 0) {
     const char* current_ao = nullptr;
@@ -545,13 +1774,290 @@ inline AudioRecoveryNotice ObserveAudioRecoveryProperty(
     }
     return {};
   }
-  if (std::strcmp(prop->name, "audio-device-list") == 0 && event->reply_userdata == 0 &&
+  if (std::strcmp(prop->name, "audio-device-list") == 0 &&
       state.OnAudioDeviceListChanged(AudioRecoveryState::Clock::now())) {
     return {"audio-device-list changed while ao=null; rescheduling ao-reload", true};
   }
   return {};
 }
 
+// Keeps one mpv core created and initialised ahead of the player that will
+// use it, so opening a title claims a ready core instead of paying for
+// mpv_create, the option writes and a blocking mpv_initialize on the spot.
+//
+// `Core` is whatever the platform hands a player: the handle, plus anything
+// that must exist before mpv_initialize (the Windows host window). The owner
+// seeds it on its own thread, `warm` finishes it on a thread of the pool's,
+// and a core nobody claimed goes to `discard` on the owner's thread, so a
+// platform resource the seed created is released where it was made. A warm
+// that fails leaves the core for the claimant to notice and finish itself.
+//
+// One core, because a second player rarely starts before the first is
+// disposed, and each idle core holds its threads and audio state for nothing.
+// Owner's thread only; nothing here is locked, since the warming thread's
+// writes are published by joining it.
+template <typename Core>
+class StandbyCorePool {
+ public:
+  using Warm = std::function<void(Core* core)>;
+  using Discard = std::function<void(Core core)>;
+
+  StandbyCorePool(Warm warm, Discard discard) : warm_(std::move(warm)), discard_(std::move(discard)) {}
+  ~StandbyCorePool() { Drain(); }
+
+  StandbyCorePool(const StandbyCorePool&) = delete;
+  StandbyCorePool& operator=(const StandbyCorePool&) = delete;
+
+  // Starts warming `seed`. False, leaving `seed` to the caller, when a core is
+  // already warming or waiting.
+  bool Refill(Core seed) {
+    if (filled_) return false;
+    core_ = std::move(seed);
+    filled_ = true;
+    warming_ = std::thread([this]() { warm_(&core_); });
+    return true;
+  }
+
+  // Hands over the standby core, first waiting for it to finish warming if it
+  // has not: it started before the caller wanted one, so it is never further
+  // from ready than a core created now. False with none.
+  bool Claim(Core* out) {
+    if (!filled_) {
+      ++misses_;
+      return false;
+    }
+    if (warming_.joinable()) warming_.join();
+    *out = std::move(core_);
+    core_ = Core{};
+    filled_ = false;
+    ++hits_;
+    return true;
+  }
+
+  // Discards the standby core, if there is one.
+  void Drain() {
+    if (!filled_) return;
+    if (warming_.joinable()) warming_.join();
+    Core core = std::move(core_);
+    core_ = Core{};
+    filled_ = false;
+    if (discard_) discard_(std::move(core));
+  }
+
+  bool has_standby() const { return filled_; }
+  // Claims served by a standby core, and claims that found none.
+  uint64_t hits() const { return hits_; }
+  uint64_t misses() const { return misses_; }
+
+ private:
+  const Warm warm_;
+  const Discard discard_;
+  std::thread warming_;
+  bool filled_ = false;
+  Core core_{};
+  uint64_t hits_ = 0;
+  uint64_t misses_ = 0;
+};
+
+// The title `preload` queued behind the playing one, for the platform players
+// to report on. The queue is mpv's own playlist: the title is appended as the
+// entry after the playing one with prefetch-playlist on, so mpv opens its
+// stream and demuxer while the current file is still playing, and `promote`
+// (playlist-next) or a natural end of file switches to it without a cold open.
+//
+// mpv names the entry by playlist entry id, which only its start-file and
+// end-file events carry, so those are what decide whether the queued title
+// started, failed, or was replaced by a `loadfile replace` that cleared the
+// playlist under it. A `preload` made while another is still being appended
+// supersedes it by generation. Locked, because on Windows the request comes
+// from the platform thread while the events arrive on the event thread.
+class NextItemPreload {
+ public:
+  enum class Outcome { kNone, kPromoted, kFailed };
+
+  // Starts tracking |url| in place of whatever was queued. Returns the
+  // generation its append reports back under.
+  uint64_t Begin(const std::string& url) {
+    std::lock_guard<std::mutex> lock(mutex_);
+    url_ = url;
+    entry_id_ = 0;
+    return ++generation_;
+  }
+
+  // The append for |generation| landed as entry |entry_id|. False when a
+  // later Begin superseded it.
+  bool Queued(uint64_t generation, int64_t entry_id) {
+    std::lock_guard<std::mutex> lock(mutex_);
+    if (generation != generation_ || url_.empty()) return false;
+    entry_id_ = entry_id;
+    return true;
+  }
+
+  // The append for |generation| failed. Hands back its url when it was still
+  // the current one.
+  bool Abandon(uint64_t generation, std::string* url) {
+    std::lock_guard<std::mutex> lock(mutex_);
+    if (generation != generation_ || url_.empty()) return false;
+    if (url) *url = std::move(url_);
+    Reset();
+    return true;
+  }
+
+  // Whether an appended entry is waiting for `promote`.
+  bool HasQueued() const {
+    std::lock_guard<std::mutex> lock(mutex_);
+    return entry_id_ > 0;
+  }
+
+  // A file started. kPromoted, with its url, when it is the queued entry. Any
+  // other entry starting means the queued one was dropped with the playlist.
+  Outcome OnStartFile(int64_t entry_id, std::string* url) {
+    std::lock_guard<std::mutex> lock(mutex_);
+    if (entry_id_ <= 0) return Outcome::kNone;
+    if (entry_id != entry_id_) {
+      Reset();
+      return Outcome::kNone;
+    }
+    if (url) *url = std::move(url_);
+    Reset();
+    return Outcome::kPromoted;
+  }
+
+  // A file ended. kFailed, with its url, when the queued entry could not be
+  // opened; mpv skips past it on its own.
+  Outcome OnEndFile(int64_t entry_id, bool error, std::string* url) {
+    std::lock_guard<std::mutex> lock(mutex_);
+    if (!error || entry_id_ <= 0 || entry_id != entry_id_) return Outcome::kNone;
+    if (url) *url = std::move(url_);
+    Reset();
+    return Outcome::kFailed;
+  }
+
+  // Forgets the queued title, e.g. when the player goes away.
+  void Clear() {
+    std::lock_guard<std::mutex> lock(mutex_);
+    Reset();
+  }
+
+ private:
+  void Reset() {
+    url_.clear();
+    entry_id_ = 0;
+  }
+
+  mutable std::mutex mutex_;
+  uint64_t generation_ = 0;
+  std::string url_;
+  int64_t entry_id_ = 0;
+};
+
+// The `loadfile` command that queues a preloaded title after the playing one,
+// with |options| (mpv's `opt=val,...` list) applied to that entry alone.
+inline std::vector<std::string> PreloadLoadfileArgs(const std::string& url, const std::string& options) {
+  std::vector<std::string> args{"loadfile", url, "append"};
+  if (!options.empty()) {
+    // The index slot comes before the options since mpv 0.38; -1 is "append".
+    args.push_back("-1");
+    args.push_back(options);
+  }
+  return args;
+}
+
+// One-shot timers for an event thread that sleeps until its next deadline.
+// Any thread may schedule or cancel; RunDue belongs to the thread that sleeps,
+// and runs each due task outside the lock, earliest first, so a task may
+// schedule its own successor. A task scheduled during a pass waits for the
+// next one even when already due, so a zero-delay reschedule cannot spin.
+//
+// An event thread carries a handful of timers (recovery, periodic logging), so
+// an ordered map keyed by deadline is enough; a timer wheel would only pay off
+// for thousands of them.
+class DeadlineScheduler {
+ public:
+  using Clock = std::chrono::steady_clock;
+  using Task = std::function<void(Clock::time_point now)>;
+
+  // Returns a nonzero id for Cancel. `earliest`, when given, says whether the
+  // task is now the first deadline: a sleeping thread must be woken to see it.
+  uint64_t Schedule(Clock::time_point at, Task task, bool* earliest = nullptr) {
+    std::lock_guard<std::mutex> lock(mutex_);
+    const uint64_t id = ++next_id_;
+    const auto it = tasks_.emplace(Key{at, id}, std::move(task)).first;
+    if (earliest) *earliest = it == tasks_.begin();
+    return id;
+  }
+
+  // False when the task already ran or was cancelled. A task that is running
+  // right now is not waited for.
+  bool Cancel(uint64_t id) {
+    std::lock_guard<std::mutex> lock(mutex_);
+    for (auto it = tasks_.begin(); it != tasks_.end(); ++it) {
+      if (it->first.second != id) continue;
+      tasks_.erase(it);
+      return true;
+    }
+    return false;
+  }
+
+  // Runs every task due at `now` that was scheduled before the call. Returns
+  // how many ran.
+  size_t RunDue(Clock::time_point now) {
+    size_t ran = 0;
+    uint64_t last_id;
+    {
+      std::lock_guard<std::mutex> lock(mutex_);
+      last_id = next_id_;
+    }
+    for (;;) {
+      Task task;
+      {
+        std::lock_guard<std::mutex> lock(mutex_);
+        auto it = tasks_.begin();
+        while (it != tasks_.end() && it->first.first <= now && it->first.second > last_id) ++it;
+        if (it == tasks_.end() || it->first.first > now) break;
+        task = std::move(it->second);
+        tasks_.erase(it);
+      }
+      if (task) task(now);
+      ++ran;
+    }
+    return ran;
+  }
+
+  bool NextDeadline(Clock::time_point* deadline) const {
+    std::lock_guard<std::mutex> lock(mutex_);
+    if (tasks_.empty()) return false;
+    *deadline = tasks_.begin()->first.first;
+    return true;
+  }
+
+  void Clear() {
+    std::lock_guard<std::mutex> lock(mutex_);
+    tasks_.clear();
+  }
+
+ private:
+  // Ties on the deadline run in scheduling order.
+  using Key = std::pair<Clock::time_point, uint64_t>;
+
+  mutable std::mutex mutex_;
+  uint64_t next_id_ = 0;
+  std::map<Key, Task> tasks_;
+};
+
+// The mpv_wait_event timeout that sleeps until `deadline`: negative (forever)
+// without one, zero once it has passed. Rounded up to whole milliseconds so a
+// wait never returns just short of the deadline and spins on what remains.
+inline double WaitTimeoutSeconds(
+    bool has_deadline, std::chrono::steady_clock::time_point deadline, std::chrono::steady_clock::time_point now) {
+  if (!has_deadline) return -1.0;
+  if (deadline <= now) return 0.0;
+  const auto remaining = deadline - now;
+  auto ms = std::chrono::duration_cast<std::chrono::milliseconds>(remaining);
+  if (ms < remaining) ++ms;
+  return static_cast<double>(ms.count()) / 1000.0;
+}
+
 }  // namespace mpv_common
 }  // namespace plezy
 
@@ -0,0 +1,299 @@
+// Cost of the shared event-path helpers, for comparing one build against
+// another. Needs neither a GPU nor a running mpv: the trees are synthetic and
+// the registries are driven directly. Run with
+//
+//   mpv_player_common_benchmark --benchmark_out=mpv_common.json --benchmark_out_format=json
+//
+// (the mpv_player_common_benchmark_json target does exactly that) and compare
+// two of those files with Google Benchmark's tools/compare.py.
+
+#include <benchmark/benchmark.h>
+
+#include <cstdint>
+#include <deque>
+#include <string>
+#include <vector>
+
+#include "mpv_player_common.h"
+#include "sanitize_utf8.h"
+
+namespace {
+
+using plezy::mpv_common::AsyncRequestRegistry;
+using plezy::mpv_common::ConvertNode;
+using plezy::mpv_common::NodeConversionBudget;
+using plezy::mpv_common::NodeSnapshot;
+using plezy::mpv_common::NodeSnapshotBuilder;
+using plezy::mpv_common::PropertyObservationRegistry;
+using plezy::mpv_common::RefillNodeSnapshot;
+using plezy::mpv_common::StandardCodecNodeBuilder;
+using plezy::mpv_common::StandardMessageWriter;
+
+// Owns every node, key and string of a synthetic property value. Containers
+// that hand out pointers into themselves are deques, so growth never moves
+// what an earlier node points at.
+class NodeTree {
+ public:
+  NodeTree(const NodeTree&) = delete;
+  NodeTree& operator=(const NodeTree&) = delete;
+  NodeTree(NodeTree&&) = default;
+  const mpv_node* root() const { return &root_; }
+
+  // mpv's track-list: one map per track, with the fields a typical remux
+  // carries - a video track, then alternating audio and subtitle tracks.
+  static NodeTree TrackList(int tracks) {
+    NodeTree tree;
+    std::vector<mpv_node> items;
+    for (int i = 0; i < tracks; ++i) {
+      const char* type = i == 0 ? "video" : (i % 2 ? "audio" : "sub");
+      std::vector<std::pair<const char*, mpv_node>> fields = {
+          {"id", tree.Int(i + 1)},
+          {"type", tree.String(type)},
+          {"src-id", tree.Int(i)},
+          {"title", tree.String("Track " + std::to_string(i + 1) + " \xc2\xb7 Commentary")},
+          {"lang", tree.String(i % 3 ? "eng" : "jpn")},
+          {"default", tree.Flag(i < 2)},
+          {"forced", tree.Flag(false)},
+          {"external", tree.Flag(false)},
+          {"selected", tree.Flag(i < 3)},
+          {"codec", tree.String(i == 0 ? "hevc" : (i % 2 ? "eac3" : "subrip"))},
+          {"ff-index", tree.Int(i)},
+          {"demux-channel-count", tree.Int(6)},
+          {"demux-samplerate", tree.Int(48000)},
+          {"demux-fps", tree.Double(23.976)},
+      };
+      items.push_back(tree.Map(fields));
+    }
+    tree.root_ = tree.List(items);
+    return tree;
+  }
+
+  // mpv's chapter-list: a title and a start time per chapter.
+  static NodeTree ChapterList(int chapters) {
+    NodeTree tree;
+    std::vector<mpv_node> items;
+    for (int i = 0; i < chapters; ++i) {
+      std::vector<std::pair<const char*, mpv_node>> fields = {
+          {"title", tree.String("Chapter " + std::to_string(i + 1))},
+          {"time", tree.Double(i * 312.5)},
+      };
+      items.push_back(tree.Map(fields));
+    }
+    tree.root_ = tree.List(items);
+    return tree;
+  }
+
+ private:
+  NodeTree() = default;
+
+  mpv_node Int(int64_t value) {
+    mpv_node node{};
+    node.format = MPV_FORMAT_INT64;
+    node.u.int64 = value;
+    return node;
+  }
+  mpv_node Flag(bool value) {
+    mpv_node node{};
+    node.format = MPV_FORMAT_FLAG;
+    node.u.flag = value ? 1 : 0;
+    return node;
+  }
+  mpv_node Double(double value) {
+    mpv_node node{};
+    node.format = MPV_FORMAT_DOUBLE;
+    node.u.double_ = value;
+    return node;
+  }
+  mpv_node String(std::string value) {
+    strings_.push_back(std::move(value));
+    mpv_node node{};
+    node.format = MPV_FORMAT_STRING;
+    node.u.string = &strings_.back()[0];
+    return node;
+  }
+  mpv_node List(const std::vector<mpv_node>& items) {
+    values_.emplace_back(items);
+    lists_.push_back(mpv_node_list{static_cast<int>(items.size()), values_.back().data(), nullptr});
+    mpv_node node{};
+    node.format = MPV_FORMAT_NODE_ARRAY;
+    node.u.list = &lists_.back();
+    return node;
+  }
+  mpv_node Map(const std::vector<std::pair<const char*, mpv_node>>& fields) {
+    std::vector<mpv_node> values;
+    std::vector<char*> keys;
+    for (const auto& field : fields) {
+      keys.push_back(const_cast<char*>(field.first));
+      values.push_back(field.second);
+    }
+    values_.push_back(std::move(values));
+    keys_.push_back(std::move(keys));
+    lists_.push_back(mpv_node_list{static_cast<int>(fields.size()), values_.back().data(), keys_.back().data()});
+    mpv_node node{};
+    node.format = MPV_FORMAT_NODE_MAP;
+    node.u.list = &lists_.back();
+    return node;
+  }
+
+  mpv_node root_{};
+  std::deque<std::string> strings_;
+  std::deque<std::vector<mpv_node>> values_;
+  std::deque<std::vector<char*>> keys_;
+  std::deque<mpv_node_list> lists_;
+};
+
+// The Linux encoded-event path: straight into StandardMessageCodec bytes,
+// into a writer that has already grown to fit.
+void BM_EncodeTrackList(benchmark::State& state) {
+  const NodeTree tree = NodeTree::TrackList(static_cast<int>(state.range(0)));
+  StandardMessageWriter writer;
+  for (auto _ : state) {
+    writer.Clear();
+    StandardCodecNodeBuilder<SimdutfUtf8> builder(&writer);
+    NodeConversionBudget budget;
+    ConvertNode(tree.root(), 0, &budget, builder);
+    benchmark::DoNotOptimize(writer.data());
+  }
+  state.SetBytesProcessed(static_cast<int64_t>(state.iterations() * writer.size()));
+}
+BENCHMARK(BM_EncodeTrackList)->Arg(4)->Arg(16)->Arg(64)->Arg(256);
+
+void BM_EncodeChapterList(benchmark::State& state) {
+  const NodeTree tree = NodeTree::ChapterList(static_cast<int>(state.range(0)));
+  StandardMessageWriter writer;
+  for (auto _ : state) {
+    writer.Clear();
+    StandardCodecNodeBuilder<SimdutfUtf8> builder(&writer);
+    NodeConversionBudget budget;
+    ConvertNode(tree.root(), 0, &budget, builder);
+    benchmark::DoNotOptimize(writer.data());
+  }
+  state.SetBytesProcessed(static_cast<int64_t>(state.iterations() * writer.size()));
+}
+BENCHMARK(BM_EncodeChapterList)->Arg(8)->Arg(64)->Arg(512);
+
+// An owned copy made from nothing, as patch mode does the first time it sees a
+// property: the cost of a conversion that allocates per node.
+void BM_SnapshotTrackList(benchmark::State& state) {
+  const NodeTree tree = NodeTree::TrackList(static_cast<int>(state.range(0)));
+  for (auto _ : state) {
+    NodeSnapshot snapshot = ConvertNode<NodeSnapshotBuilder>(tree.root());
+    benchmark::DoNotOptimize(snapshot);
+  }
+}
+BENCHMARK(BM_SnapshotTrackList)->Arg(4)->Arg(16)->Arg(64)->Arg(256);
+
+// The same copy refilled into the snapshot the last change left, as patch
+// mode does once a property has been seen.
+void BM_RefillTrackList(benchmark::State& state) {
+  const NodeTree tree = NodeTree::TrackList(static_cast<int>(state.range(0)));
+  NodeSnapshot snapshot;
+  for (auto _ : state) {
+    RefillNodeSnapshot(tree.root(), &snapshot);
+    benchmark::DoNotOptimize(snapshot);
+  }
+}
+BENCHMARK(BM_RefillTrackList)->Arg(4)->Arg(16)->Arg(64)->Arg(256);
+
+// A track switch: two flags differ. Both snapshots are made once.
+void BM_DiffTrackListSwitch(benchmark::State& state) {
+  const NodeTree tree = NodeTree::TrackList(static_cast<int>(state.range(0)));
+  const NodeSnapshot before = ConvertNode<NodeSnapshotBuilder>(tree.root());
+  NodeSnapshot after = before;
+  after.items[1].values[8] = NodeSnapshotBuilder::Boolean(false);
+  after.items.back().values[8] = NodeSnapshotBuilder::Boolean(true);
+  std::vector<plezy::mpv_common::NodePatchOp> ops;
+  for (auto _ : state) {
+    plezy::mpv_common::DiffNodeSnapshots(before, after, plezy::mpv_common::kMaxNodePatchOps, &ops);
+    benchmark::DoNotOptimize(ops.data());
+  }
+}
+BENCHMARK(BM_DiffTrackListSwitch)->Arg(4)->Arg(16)->Arg(64)->Arg(256);
+
+// Every thread keeps range(0) requests in flight against one registry, taking
+// each back in the order mpv would usually complete it. Past kSlotCount in
+// flight across all threads the surplus goes to the overflow maps.
+void BM_RequestRegistryChurn(benchmark::State& state) {
+  static AsyncRequestRegistry registry;
+  const size_t in_flight = static_cast<size_t>(state.range(0));
+  std::vector<uint64_t> ids;
+  ids.reserve(in_flight);
+  for (auto _ : state) {
+    for (size_t i = 0; i < in_flight; ++i) {
+      ids.push_back(registry.RegisterStatus([](int) {}));
+    }
+    for (const uint64_t id : ids) {
+      auto callback = registry.TakeStatus(id);
+      benchmark::DoNotOptimize(callback);
+    }
+    ids.clear();
+  }
+  state.SetItemsProcessed(static_cast<int64_t>(state.iterations() * in_flight));
+}
+BENCHMARK(BM_RequestRegistryChurn)->Arg(1)->Arg(16)->Arg(64)->ThreadRange(1, 8)->UseRealTime();
+
+// The per-event lookup, across the property set the players observe.
+void BM_ObservationLookupByUserdata(benchmark::State& state) {
+  PropertyObservationRegistry registry;
+  std::vector<uint64_t> userdata;
+  for (int i = 0; i < 24; ++i) {
+    userdata.push_back(registry.Register("property-" + std::to_string(i), "node", i).userdata);
+  }
+  size_t next = 0;
+  for (auto _ : state) {
+    int id = 0;
+    benchmark::DoNotOptimize(registry.LookupIdForUserdata(userdata[next], &id));
+    benchmark::DoNotOptimize(id);
+    next = next + 1 == userdata.size() ? 0 : next + 1;
+  }
+}
+BENCHMARK(BM_ObservationLookupByUserdata);
+
+// What the event path paid per change before it resolved by userdata.
+void BM_ObservationLookupByName(benchmark::State& state) {
+  PropertyObservationRegistry registry;
+  std::vector<std::string> names;
+  for (int i = 0; i < 24; ++i) {
+    names.push_back("property-" + std::to_string(i));
+    registry.Register(names.back(), "node", i);
+  }
+  size_t next = 0;
+  for (auto _ : state) {
+    int id = 0;
+    benchmark::DoNotOptimize(registry.LookupId(names[next], &id));
+    benchmark::DoNotOptimize(id);
+    next = next + 1 == names.size() ? 0 : next + 1;
+  }
+}
+BENCHMARK(BM_ObservationLookupByName);
+
+std::string Utf8Input(int64_t kind, int64_t length) {
+  // A title with a multi-byte character every few letters.
+  static const char kValid[] = "Chapitre \xc3\xa9t\xc3\xa9 \xe2\x80\x94 ";
+  std::string input;
+  while (input.size() < static_cast<size_t>(length)) input += kValid;
+  input.resize(static_cast<size_t>(length));
+  // Trim back to a character boundary so the valid case stays valid.
+  while (!input.empty() && (static_cast<unsigned char>(input.back()) & 0xc0) == 0x80) input.pop_back();
+  if (!input.empty() && (static_cast<unsigned char>(input.back()) & 0x80)) input.pop_back();
+  if (kind == 1) {
+    // A Latin-1 path: every 16th byte is a lone high byte.
+    for (size_t i = 0; i < input.size(); i += 16) input[i] = static_cast<char>(0xe9);
+  }
+  return input;
+}
+
+// range(0): 0 for valid UTF-8, 1 for input with invalid bytes throughout.
+void BM_SanitizeUtf8(benchmark::State& state) {
+  const std::string input = Utf8Input(state.range(0), state.range(1));
+  for (auto _ : state) {
+    std::string sanitized = SanitizeUtf8(input.data(), input.size());
+    benchmark::DoNotOptimize(sanitized.data());
+  }
+  state.SetBytesProcessed(static_cast<int64_t>(state.iterations() * input.size()));
+}
+BENCHMARK(BM_SanitizeUtf8)->ArgsProduct({{0, 1}, {16, 256, 64 << 10}})->ArgNames({"invalid", "bytes"});
+
+}  // namespace
+
+BENCHMARK_MAIN();
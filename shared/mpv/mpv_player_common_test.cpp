@@ -4,9 +4,13 @@
 #undef NDEBUG
 #endif
 
+#include <algorithm>
 #include <atomic>
 #include <cassert>
 #include <chrono>
+#include <cstring>
+#include <functional>
+#include <limits>
 #include <string>
 #include <thread>
 #include <vector>
@@ -73,6 +77,79 @@ void TestConcurrentRequestCompletion() {
   }
 }
 
+void TestRequestRegistrySlotIds() {
+  using plezy::mpv_common::AsyncRequestRegistry;
+  AsyncRequestRegistry registry;
+
+  // A status id is not a property id, and a taken id stays dead even after
+  // its slot has been handed to a later request.
+  const auto status_id = registry.RegisterStatus([](int) {});
+  assert(status_id != 0);
+  assert(!registry.TakeProperty(status_id));
+  assert(registry.TakeStatus(status_id));
+  assert(!registry.TakeStatus(0));
+  for (size_t i = 0; i < AsyncRequestRegistry::kSlotCount; ++i) {
+    const auto id = registry.RegisterStatus([](int) {});
+    assert(id != status_id);
+    assert(registry.TakeStatus(id));
+  }
+  assert(!registry.TakeStatus(status_id));
+
+  // Filling every slot spills into the overflow map without reusing an id,
+  // and CancelAll drains both halves.
+  std::vector<uint64_t> ids;
+  int cancelled_status = 0;
+  for (size_t i = 0; i < AsyncRequestRegistry::kSlotCount + 8; ++i) {
+    ids.push_back(registry.RegisterStatus([&](int) { ++cancelled_status; }));
+  }
+  ids.push_back(registry.RegisterProperty([](int, const std::string&) {}));
+  std::vector<uint64_t> sorted = ids;
+  std::sort(sorted.begin(), sorted.end());
+  assert(std::adjacent_find(sorted.begin(), sorted.end()) == sorted.end());
+  assert((ids.back() & AsyncRequestRegistry::kOverflowBit) != 0);
+  assert(registry.TakeStatus(ids.front()));
+  assert(registry.TakeStatus(ids[AsyncRequestRegistry::kSlotCount + 1]));
+
+  auto cancelled = registry.CancelAll();
+  assert(cancelled.status.size() == AsyncRequestRegistry::kSlotCount + 6);
+  assert(cancelled.properties.size() == 1);
+  for (auto& callback : cancelled.status) callback(MPV_ERROR_UNINITIALIZED);
+  assert(cancelled_status == static_cast<int>(AsyncRequestRegistry::kSlotCount + 6));
+  for (auto id : ids) assert(!registry.TakeStatus(id));
+}
+
+void TestConcurrentRequestChurn() {
+  plezy::mpv_common::AsyncRequestRegistry registry;
+  std::atomic<int> registered{0};
+  std::atomic<int> completions{0};
+  std::atomic<bool> done{false};
+
+  // Submitters register and complete their own requests while another thread
+  // keeps cancelling: every registered callback must run exactly once.
+  std::vector<std::thread> submitters;
+  for (int t = 0; t < 4; ++t) {
+    submitters.emplace_back([&]() {
+      for (int i = 0; i < 2000; ++i) {
+        registered.fetch_add(1);
+        const auto id = registry.RegisterStatus([&](int) { completions.fetch_add(1); });
+        auto callback = registry.TakeStatus(id);
+        if (callback) callback(0);
+      }
+    });
+  }
+  std::thread canceller([&]() {
+    while (!done.load(std::memory_order_acquire)) {
+      for (auto& callback : registry.CancelAll().status) callback(MPV_ERROR_UNINITIALIZED);
+    }
+  });
+
+  for (auto& submitter : submitters) submitter.join();
+  done.store(true, std::memory_order_release);
+  canceller.join();
+  for (auto& callback : registry.CancelAll().status) callback(MPV_ERROR_UNINITIALIZED);
+  assert(completions.load() == registered.load());
+}
+
 void TestSetPropertyResultContract() {
   using namespace plezy::mpv_common;
 
@@ -125,8 +202,28 @@ void TestPropertyObservationRegistry() {
   assert(registry.LookupId("pause", &id));
   assert(id == 17);
   assert(!registry.LookupId("missing", &id));
+
+  // The event path: dense userdata, resolved without the name.
+  assert(node.userdata == first.userdata + 1);
+  assert(registry.LookupIdForUserdata(first.userdata, &id));
+  assert(id == 17);
+  assert(registry.LookupIdForUserdata(node.userdata, &id));
+  assert(id == 18);
+  assert(!registry.LookupIdForUserdata(0, &id));
+  assert(!registry.LookupIdForUserdata(node.userdata + 1, &id));
+  assert(!registry.LookupIdForUserdata(UINT64_MAX, &id));
+
   registry.Clear();
   assert(!registry.LookupId("pause", &id));
+  assert(!registry.LookupIdForUserdata(first.userdata, &id));
+
+  // Userdata from before Clear never aliases a later observation.
+  const auto again = registry.Register("pause", "bool", 19);
+  assert(again.added);
+  assert(again.userdata > node.userdata);
+  assert(!registry.LookupIdForUserdata(node.userdata, &id));
+  assert(registry.LookupIdForUserdata(again.userdata, &id));
+  assert(id == 19);
 }
 
 void TestConcurrentPropertyObservationRegistry() {
@@ -160,6 +257,9 @@ void TestConcurrentPropertyObservationRegistry() {
         if (registry.LookupId(names[i], &id)) {
           assert(id == 1000 + i);
         }
+        if (registry.LookupIdForUserdata(static_cast<uint64_t>(i + 1), &id)) {
+          assert(id >= 1000 && id < 1000 + kPropertyCount);
+        }
       }
     }
   });
@@ -189,6 +289,65 @@ void TestConcurrentPropertyObservationRegistry() {
   }
 }
 
+// Counts releases so a superseded or discarded staged value can be seen to be
+// disposed of exactly once.
+struct CountingRelease {
+  static int released;
+  void operator()(int&) const { ++released; }
+};
+int CountingRelease::released = 0;
+
+void TestPropertyChangeCoalescer() {
+  using Coalescer = plezy::mpv_common::PropertyChangeCoalescer<int, CountingRelease>;
+  const auto start = Coalescer::Clock::time_point{};
+  CountingRelease::released = 0;
+  Coalescer coalescer;
+  std::vector<Coalescer::Change> out;
+  Coalescer::Clock::time_point next_due{};
+
+  // Last value wins, and properties keep the order they were first staged in.
+  coalescer.Stage(4, 10);
+  coalescer.Stage(2, 20);
+  coalescer.Stage(4, 11);
+  assert(CountingRelease::released == 1);
+  assert(!coalescer.TakeDue(start, false, &out, &next_due));
+  assert(out.size() == 2);
+  assert(out[0].id == 4 && out[0].value == 11);
+  assert(out[1].id == 2 && out[1].value == 20);
+  assert(!coalescer.HasStaged());
+
+  // A throttled property is held, not dropped, and goes out once due.
+  coalescer.SetMinInterval(4, std::chrono::milliseconds(250));
+  out.clear();
+  coalescer.Stage(4, 12);
+  coalescer.Stage(2, 21);
+  assert(coalescer.TakeDue(start + std::chrono::milliseconds(100), false, &out, &next_due));
+  assert(out.size() == 1 && out[0].id == 2);
+  assert(next_due == start + std::chrono::milliseconds(250));
+  coalescer.Stage(4, 13);
+  out.clear();
+  assert(!coalescer.TakeDue(start + std::chrono::milliseconds(250), false, &out, &next_due));
+  assert(out.size() == 1 && out[0].id == 4 && out[0].value == 13);
+
+  // Forcing ignores the interval.
+  out.clear();
+  coalescer.Stage(4, 14);
+  assert(!coalescer.TakeDue(start + std::chrono::milliseconds(260), true, &out, &next_due));
+  assert(out.size() == 1 && out[0].value == 14);
+
+  // Clearing releases what is staged and forgets delivery history.
+  out.clear();
+  const int released = CountingRelease::released;
+  coalescer.Stage(2, 22);
+  coalescer.Stage(4, 15);
+  coalescer.Clear();
+  assert(CountingRelease::released == released + 2);
+  assert(!coalescer.HasStaged());
+  coalescer.Stage(4, 16);
+  assert(!coalescer.TakeDue(start + std::chrono::milliseconds(270), false, &out, &next_due));
+  assert(out.size() == 1 && out[0].value == 16);
+}
+
 void TestResumeRecoverySchedule() {
   AudioRecoveryState state;
   const auto start = AudioRecoveryState::Clock::time_point{};
@@ -345,12 +504,220 @@ void TestStaleReloadCompletionCannotClearCurrentRequest() {
   assert(state.CompleteReload(current_request.request_generation));
 }
 
+// The deadline tracks what NextReload would act on, so a caller sleeping until
+// it wakes exactly when the next reload is due.
+void TestAudioRecoveryNextDeadline() {
+  AudioRecoveryState state;
+  const auto start = AudioRecoveryState::Clock::time_point{} + std::chrono::hours(1);
+  AudioRecoveryState::Clock::time_point deadline;
+  assert(!state.NextDeadline(&deadline));
+
+  state.SetFileLoaded(true, start);
+  assert(!state.NextDeadline(&deadline));
+  state.RequestResume();
+  assert(state.NextDeadline(&deadline));
+  assert(deadline <= start);
+
+  assert(state.NextReload(start).reason == AudioReloadReason::kNone);
+  assert(state.NextDeadline(&deadline));
+  assert(deadline == start + std::chrono::milliseconds(1500));
+
+  // A null fallback due sooner takes over the deadline.
+  state.SetCurrentAudioOutputNull(true, start);
+  assert(state.NextDeadline(&deadline));
+  assert(deadline == start + std::chrono::milliseconds(500));
+
+  const auto reload = state.NextReload(deadline);
+  assert(reload.reason == AudioReloadReason::kNullFallback);
+  // Outstanding: the reply wakes the caller, not a deadline.
+  assert(!state.NextDeadline(&deadline));
+  assert(state.CompleteReload(reload.request_generation));
+  assert(state.NextDeadline(&deadline));
+  assert(deadline == start + std::chrono::milliseconds(1000));
+
+  state.SetFileLoaded(false, start);
+  assert(!state.NextDeadline(&deadline));
+}
+
+void TestDeadlineScheduler() {
+  using plezy::mpv_common::DeadlineScheduler;
+  using TimePoint = DeadlineScheduler::Clock::time_point;
+  DeadlineScheduler scheduler;
+  const auto start = TimePoint{} + std::chrono::hours(1);
+  TimePoint deadline;
+  assert(!scheduler.NextDeadline(&deadline));
+
+  std::vector<int> ran;
+  const auto record = [&ran](int value) { return [&ran, value](TimePoint) { ran.push_back(value); }; };
+  bool earliest = false;
+  scheduler.Schedule(start + std::chrono::milliseconds(20), record(2), &earliest);
+  assert(earliest);
+  const uint64_t cancelled = scheduler.Schedule(start + std::chrono::milliseconds(10), record(-1), &earliest);
+  assert(earliest);
+  // Ties run in scheduling order, and only the first of them is "earliest".
+  scheduler.Schedule(start + std::chrono::milliseconds(10), record(1), &earliest);
+  assert(!earliest);
+  assert(scheduler.Cancel(cancelled));
+  assert(!scheduler.Cancel(cancelled));
+
+  assert(scheduler.NextDeadline(&deadline));
+  assert(deadline == start + std::chrono::milliseconds(10));
+  assert(scheduler.RunDue(start + std::chrono::milliseconds(9)) == 0);
+  assert(scheduler.RunDue(start + std::chrono::milliseconds(20)) == 2);
+  assert((ran == std::vector<int>{1, 2}));
+  assert(!scheduler.NextDeadline(&deadline));
+
+  // A task that reschedules itself for "now" runs once per pass, not forever.
+  int ticks = 0;
+  std::function<void(TimePoint)> tick = [&](TimePoint now) {
+    ++ticks;
+    scheduler.Schedule(now, tick);
+  };
+  scheduler.Schedule(start, tick);
+  assert(scheduler.RunDue(start) == 1);
+  assert(scheduler.RunDue(start) == 1);
+  assert(ticks == 2);
+  scheduler.Clear();
+  assert(!scheduler.NextDeadline(&deadline));
+}
+
+void TestConcurrentDeadlineScheduler() {
+  using plezy::mpv_common::DeadlineScheduler;
+  DeadlineScheduler scheduler;
+  const auto start = DeadlineScheduler::Clock::time_point{};
+  std::atomic<int> ran{0};
+  std::atomic<int> kept{0};
+  std::atomic<bool> done{false};
+
+  // Every task either runs exactly once or is cancelled, never both.
+  std::thread producer([&]() {
+    for (int i = 0; i < 1000; ++i) {
+      const uint64_t id = scheduler.Schedule(start, [&](DeadlineScheduler::Clock::time_point) { ++ran; });
+      if (i % 2 != 0 || !scheduler.Cancel(id)) ++kept;
+    }
+    done = true;
+  });
+  while (!done.load()) scheduler.RunDue(start);
+  producer.join();
+  scheduler.RunDue(start);
+  DeadlineScheduler::Clock::time_point deadline;
+  assert(!scheduler.NextDeadline(&deadline));
+  assert(ran.load() == kept.load());
+}
+
+struct FakeCore {
+  int seed = 0;
+  bool warmed = false;
+  std::thread::id warmed_on;
+};
+
+void TestStandbyCorePool() {
+  using plezy::mpv_common::StandbyCorePool;
+  std::vector<int> discarded;
+  {
+    StandbyCorePool<FakeCore> pool(
+        [](FakeCore* core) {
+          std::this_thread::sleep_for(std::chrono::milliseconds(10));
+          core->warmed = true;
+          core->warmed_on = std::this_thread::get_id();
+        },
+        [&](FakeCore core) {
+          assert(core.warmed);
+          discarded.push_back(core.seed);
+        });
+
+    FakeCore claimed;
+    assert(!pool.Claim(&claimed));
+    assert(pool.misses() == 1);
+
+    FakeCore seed;
+    seed.seed = 1;
+    assert(pool.Refill(seed));
+    assert(pool.has_standby());
+    seed.seed = 2;
+    assert(!pool.Refill(seed));
+
+    // Claimed while still warming: the claim waits it out.
+    assert(pool.Claim(&claimed));
+    assert(claimed.seed == 1);
+    assert(claimed.warmed);
+    assert(claimed.warmed_on != std::this_thread::get_id());
+    assert(!pool.has_standby());
+    assert(pool.hits() == 1);
+
+    // Disposal recycles the pool; an unclaimed core is discarded on the
+    // owner's thread when the pool goes.
+    assert(pool.Refill(seed));
+  }
+  assert((discarded == std::vector<int>{2}));
+}
+
+void TestNextItemPreload() {
+  using plezy::mpv_common::NextItemPreload;
+  using Outcome = NextItemPreload::Outcome;
+  NextItemPreload preload;
+  std::string url;
+
+  // A later preload supersedes one whose append has not landed yet.
+  const auto first = preload.Begin("https://a");
+  const auto second = preload.Begin("https://b");
+  assert(!preload.Queued(first, 4));
+  assert(!preload.HasQueued());
+  assert(preload.Queued(second, 5));
+  assert(preload.HasQueued());
+
+  // The playing entry's own end and unrelated errors leave it queued.
+  assert(preload.OnEndFile(3, false, &url) == Outcome::kNone);
+  assert(preload.OnEndFile(3, true, &url) == Outcome::kNone);
+  assert(preload.OnStartFile(5, &url) == Outcome::kPromoted);
+  assert(url == "https://b");
+  assert(!preload.HasQueued());
+
+  // A start of any other entry means the playlist was replaced under it.
+  const auto third = preload.Begin("https://c");
+  assert(preload.Queued(third, 7));
+  assert(preload.OnStartFile(8, &url) == Outcome::kNone);
+  assert(!preload.HasQueued());
+  assert(preload.OnStartFile(7, &url) == Outcome::kNone);
+
+  // The queued entry failing to open is reported once.
+  const auto fourth = preload.Begin("https://d");
+  assert(preload.Queued(fourth, 9));
+  assert(preload.OnEndFile(9, true, &url) == Outcome::kFailed);
+  assert(url == "https://d");
+  assert(preload.OnEndFile(9, true, &url) == Outcome::kNone);
+
+  // A failed append hands its url back only while it is current.
+  const auto fifth = preload.Begin("https://e");
+  const auto sixth = preload.Begin("https://f");
+  assert(!preload.Abandon(fifth, &url));
+  assert(preload.Abandon(sixth, &url));
+  assert(url == "https://f");
+  assert(!preload.Queued(sixth, 10));
+
+  assert((plezy::mpv_common::PreloadLoadfileArgs("u", "") == std::vector<std::string>{"loadfile", "u", "append"}));
+  assert(
+      (plezy::mpv_common::PreloadLoadfileArgs("u", "start=5") ==
+       std::vector<std::string>{"loadfile", "u", "append", "-1", "start=5"}));
+}
+
+void TestWaitTimeoutSeconds() {
+  using plezy::mpv_common::WaitTimeoutSeconds;
+  const auto now = std::chrono::steady_clock::time_point{} + std::chrono::hours(1);
+  assert(WaitTimeoutSeconds(false, now, now) < 0);
+  assert(WaitTimeoutSeconds(true, now - std::chrono::milliseconds(5), now) == 0.0);
+  assert(WaitTimeoutSeconds(true, now, now) == 0.0);
+  assert(WaitTimeoutSeconds(true, now + std::chrono::microseconds(100), now) == 0.001);
+  assert(WaitTimeoutSeconds(true, now + std::chrono::milliseconds(1500), now) == 1.5);
+}
+
 // Renders the shared node walk into text so its bounds can be asserted on
 // every platform, without a platform value type in the way.
 struct TextNodeBuilder {
   using Value = std::string;
   using ListBuilder = std::string;
   using MapBuilder = std::string;
+  using Key = std::string;
 
   static Value Null() { return "null"; }
   static Value Boolean(bool value) { return value ? "true" : "false"; }
@@ -358,14 +725,13 @@ struct TextNodeBuilder {
   static Value Double(double value) { return std::to_string(value); }
   static Value String(const char* value, size_t length) { return "'" + std::string(value, length) + "'"; }
 
-  static ListBuilder NewList() { return std::string("["); }
+  static ListBuilder NewList(size_t) { return std::string("["); }
   static void Append(ListBuilder& list, Value value) { list += value + ","; }
   static Value FinishList(ListBuilder list) { return list + "]"; }
 
-  static MapBuilder NewMap() { return std::string("{"); }
-  static void Insert(MapBuilder& map, const char* key, size_t key_length, Value value) {
-    map += std::string(key, key_length) + ":" + value + ",";
-  }
+  static MapBuilder NewMap(size_t) { return std::string("{"); }
+  static Key MapKey(const char* key, size_t key_length) { return std::string(key, key_length); }
+  static void Insert(MapBuilder& map, Key key, Value value) { map += key + ":" + value + ","; }
   static Value FinishMap(MapBuilder map) { return map + "}"; }
   static void AbandonMap(MapBuilder& map) { map += "<abandoned>"; }
 };
@@ -435,6 +801,425 @@ void TestNodeConversionBounds() {
   assert(bytes.remaining_bytes == 4);
 }
 
+struct PassThroughUtf8 {
+  static bool Valid(const char* value, size_t length) { return std::memchr(value, '\xff', length) == nullptr; }
+  static std::string Sanitize(const char* value, size_t length) {
+    std::string sanitized(value, length);
+    std::replace(sanitized.begin(), sanitized.end(), '\xff', '?');
+    return sanitized;
+  }
+};
+
+// Reads StandardMessageCodec bytes back into TextNodeBuilder's notation, with
+// float64 alignment measured from the start of `bytes` as the Dart decoder
+// measures it from the start of the message.
+std::string DecodeStandardValue(const std::vector<uint8_t>& bytes, size_t* offset) {
+  using Writer = plezy::mpv_common::StandardMessageWriter;
+  assert(*offset < bytes.size());
+  auto read_size = [&]() {
+    size_t size = bytes[(*offset)++];
+    if (size == 254) {
+      uint16_t wide = 0;
+      std::memcpy(&wide, bytes.data() + *offset, sizeof(wide));
+      *offset += sizeof(wide);
+      size = wide;
+    } else if (size == 255) {
+      uint32_t wide = 0;
+      std::memcpy(&wide, bytes.data() + *offset, sizeof(wide));
+      *offset += sizeof(wide);
+      size = wide;
+    }
+    return size;
+  };
+  const uint8_t type = bytes[(*offset)++];
+  switch (type) {
+    case Writer::kNull:
+      return "null";
+    case Writer::kTrue:
+      return "true";
+    case Writer::kFalse:
+      return "false";
+    case Writer::kInt32: {
+      int32_t value = 0;
+      std::memcpy(&value, bytes.data() + *offset, sizeof(value));
+      *offset += sizeof(value);
+      return std::to_string(value);
+    }
+    case Writer::kInt64: {
+      int64_t value = 0;
+      std::memcpy(&value, bytes.data() + *offset, sizeof(value));
+      *offset += sizeof(value);
+      return std::to_string(value);
+    }
+    case Writer::kFloat64: {
+      while (*offset % 8 != 0) assert(bytes[(*offset)++] == 0);
+      double value = 0;
+      std::memcpy(&value, bytes.data() + *offset, sizeof(value));
+      *offset += sizeof(value);
+      return std::to_string(value);
+    }
+    case Writer::kString: {
+      const size_t length = read_size();
+      std::string value(reinterpret_cast<const char*>(bytes.data() + *offset), length);
+      *offset += length;
+      return "'" + value + "'";
+    }
+    case Writer::kList: {
+      const size_t count = read_size();
+      std::string text = "[";
+      for (size_t i = 0; i < count; ++i) text += DecodeStandardValue(bytes, offset) + ",";
+      return text + "]";
+    }
+    case Writer::kMap: {
+      const size_t count = read_size();
+      std::string text = "{";
+      for (size_t i = 0; i < count; ++i) {
+        std::string key = DecodeStandardValue(bytes, offset);
+        text += key.substr(1, key.size() - 2) + ":" + DecodeStandardValue(bytes, offset) + ",";
+      }
+      return text + "}";
+    }
+    default:
+      assert(false && "unknown StandardMessageCodec type");
+      return "";
+  }
+}
+
+std::string DecodeStandardMessage(const uint8_t* data, size_t size, size_t offset) {
+  std::vector<uint8_t> bytes(data, data + size);
+  const std::string text = DecodeStandardValue(bytes, &offset);
+  assert(offset == bytes.size());
+  return text;
+}
+
+void TestStandardCodecNodeBuilder() {
+  using plezy::mpv_common::ConvertNode;
+  using plezy::mpv_common::NodeConversionBudget;
+  using plezy::mpv_common::StandardMessageWriter;
+  using Builder = plezy::mpv_common::StandardCodecNodeBuilder<PassThroughUtf8>;
+
+  // A track-list shaped tree: a map per entry with every leaf type, a long
+  // string that needs the wide size form, a value beyond int32, and an
+  // invalid-UTF-8 title for the sanitizer.
+  std::string long_title(300, 't');
+  char bad_title[] = "bad\xfftitle";
+  char* keys[] = {const_cast<char*>("id"), const_cast<char*>("title"), const_cast<char*>("fps"),
+                  const_cast<char*>("default"), const_cast<char*>("bytes"), const_cast<char*>("lang")};
+  std::vector<mpv_node> values(6);
+  values[0].format = MPV_FORMAT_INT64;
+  values[0].u.int64 = 3;
+  values[1].format = MPV_FORMAT_STRING;
+  values[1].u.string = &long_title[0];
+  values[2].format = MPV_FORMAT_DOUBLE;
+  values[2].u.double_ = 23.976;
+  values[3].format = MPV_FORMAT_FLAG;
+  values[3].u.flag = 1;
+  values[4].format = MPV_FORMAT_INT64;
+  values[4].u.int64 = int64_t{1} << 40;
+  values[5].format = MPV_FORMAT_NONE;
+  mpv_node_list track_map{6, values.data(), keys};
+  std::vector<mpv_node> tracks(3);
+  tracks[0].format = MPV_FORMAT_NODE_MAP;
+  tracks[0].u.list = &track_map;
+  tracks[1].format = MPV_FORMAT_STRING;
+  tracks[1].u.string = bad_title;
+  // A map whose key is rejected streams as a null in its slot.
+  char* missing_key[] = {nullptr};
+  mpv_node_list keyless{1, values.data(), missing_key};
+  tracks[2].format = MPV_FORMAT_NODE_MAP;
+  tracks[2].u.list = &keyless;
+  mpv_node_list track_list{3, tracks.data(), nullptr};
+  mpv_node root{};
+  root.format = MPV_FORMAT_NODE_ARRAY;
+  root.u.list = &track_list;
+
+  std::string expected_streamed = ConvertNode<TextNodeBuilder>(&root);
+  assert(expected_streamed.find(",null,]") != std::string::npos);
+  expected_streamed.replace(expected_streamed.find("bad\xfftitle"), std::string("bad?title").size(), "bad?title");
+
+  // The same bytes at every 8-byte phase: the writer pads relative to where
+  // the message starts, which is where its own buffer starts.
+  for (size_t prefix = 0; prefix < 8; ++prefix) {
+    StandardMessageWriter writer;
+    for (size_t i = 0; i < prefix; ++i) writer.WriteByte(0);
+    Builder builder(&writer);
+    NodeConversionBudget budget;
+    ConvertNode(&root, 0, &budget, builder);
+    assert(DecodeStandardMessage(writer.data(), writer.size(), prefix) == expected_streamed);
+  }
+
+  // The budget bounds the stream exactly as it bounds a tree.
+  {
+    StandardMessageWriter writer;
+    Builder builder(&writer);
+    NodeConversionBudget budget{2, 1024};
+    ConvertNode(&root, 0, &budget, builder);
+    NodeConversionBudget text_budget{2, 1024};
+    assert(
+        DecodeStandardMessage(writer.data(), writer.size(), 0) == ConvertNode<TextNodeBuilder>(&root, 0, &text_budget));
+  }
+
+  // A staged value spliced in at any phase still decodes, float64 and all,
+  // and the reused writer keeps its capacity across Clear.
+  StandardMessageWriter staging;
+  Builder staging_builder(&staging);
+  NodeConversionBudget staging_budget;
+  ConvertNode(&root, 0, &staging_budget, staging_builder);
+  const StandardMessageWriter::Encoded staged = staging.TakeEncoded();
+  assert(staged.has_double);
+  assert(staging.size() == 0);
+  StandardMessageWriter message;
+  for (size_t prefix = 0; prefix < 8; ++prefix) {
+    message.Clear();
+    for (size_t i = 0; i < prefix; ++i) message.WriteByte(0);
+    message.AppendEncoded(staged);
+    assert(DecodeStandardMessage(message.data(), message.size(), prefix) == expected_streamed);
+  }
+
+  // A float64 cut off by Truncate, as a rejected map's are, no longer marks
+  // the bytes as depending on their offset; one written before the cut does.
+  staging.WriteInt(1);
+  const size_t cut = staging.size();
+  staging.WriteDouble(0.5);
+  staging.Truncate(cut);
+  assert(!staging.TakeEncoded().has_double);
+  staging.WriteDouble(0.5);
+  const size_t kept = staging.size();
+  staging.WriteDouble(1.5);
+  staging.Truncate(kept);
+  assert(staging.TakeEncoded().has_double);
+  message.Clear();
+  message.AppendEncoded(staged);
+  message.Truncate(0);
+  assert(!message.TakeEncoded().has_double);
+}
+
+plezy::mpv_common::NodeSnapshot TrackSnapshot(int64_t id, bool selected) {
+  using plezy::mpv_common::NodeSnapshotBuilder;
+  auto track = NodeSnapshotBuilder::NewMap(2);
+  NodeSnapshotBuilder::Insert(track, "id", NodeSnapshotBuilder::Int(id));
+  NodeSnapshotBuilder::Insert(track, "selected", NodeSnapshotBuilder::Boolean(selected));
+  return track;
+}
+
+std::string PatchText(const plezy::mpv_common::NodeSnapshot& before, const plezy::mpv_common::NodeSnapshot& after) {
+  std::vector<plezy::mpv_common::NodePatchOp> ops;
+  if (!plezy::mpv_common::DiffNodeSnapshots(before, after, plezy::mpv_common::kMaxNodePatchOps, &ops)) return "full";
+  TextNodeBuilder builder;
+  return plezy::mpv_common::EmitNodePatch(ops, builder);
+}
+
+void TestNodeSnapshotPatches() {
+  using plezy::mpv_common::ConvertNode;
+  using plezy::mpv_common::EmitNodeSnapshot;
+  using plezy::mpv_common::NodeSnapshot;
+  using plezy::mpv_common::NodeSnapshotBuilder;
+
+  // The snapshot is made by the shared walk and replays as the walk would.
+  char title[] = "English";
+  char* keys[] = {const_cast<char*>("id"), const_cast<char*>("title"), const_cast<char*>("fps")};
+  std::vector<mpv_node> values(3);
+  values[0].format = MPV_FORMAT_INT64;
+  values[0].u.int64 = 1;
+  values[1].format = MPV_FORMAT_STRING;
+  values[1].u.string = title;
+  values[2].format = MPV_FORMAT_DOUBLE;
+  values[2].u.double_ = 23.976;
+  mpv_node_list track{3, values.data(), keys};
+  mpv_node root{};
+  root.format = MPV_FORMAT_NODE_MAP;
+  root.u.list = &track;
+  const NodeSnapshot converted = ConvertNode<NodeSnapshotBuilder>(&root);
+  TextNodeBuilder text;
+  assert(EmitNodeSnapshot(converted, text) == ConvertNode<TextNodeBuilder>(&root));
+
+  auto tracks = [](std::vector<NodeSnapshot> items) {
+    auto list = NodeSnapshotBuilder::NewList(items.size());
+    for (auto& item : items) NodeSnapshotBuilder::Append(list, std::move(item));
+    return list;
+  };
+  const NodeSnapshot before = tracks({TrackSnapshot(1, true), TrackSnapshot(2, false), TrackSnapshot(3, false)});
+
+  // Unchanged: nothing to send.
+  assert(PatchText(before, tracks({TrackSnapshot(1, true), TrackSnapshot(2, false), TrackSnapshot(3, false)})) == "[]");
+  // A track switch is two flags.
+  assert(
+      PatchText(before, tracks({TrackSnapshot(1, false), TrackSnapshot(2, true), TrackSnapshot(3, false)})) ==
+      "[[0,[0,'selected',],false,],[0,[1,'selected',],true,],]");
+  // A shorter list is truncated; a longer one appended to.
+  assert(PatchText(before, tracks({TrackSnapshot(1, true)})) == "[[2,[],1,],]");
+  assert(
+      PatchText(before, tracks({TrackSnapshot(1, true), TrackSnapshot(2, false), TrackSnapshot(3, false),
+                                TrackSnapshot(4, true)})) == "[[0,[3,],{id:4,selected:true,},],]");
+
+  // Keys added and dropped, and a value that changes type.
+  NodeSnapshot edited = before;
+  NodeSnapshotBuilder::Insert(edited.items[0], "lang", NodeSnapshotBuilder::String("en", 2));
+  edited.items[1].keys.erase(edited.items[1].keys.begin() + 1);
+  edited.items[1].values.erase(edited.items[1].values.begin() + 1);
+  edited.items[2].values[0] = NodeSnapshotBuilder::String("3", 1);
+  assert(PatchText(before, edited) == "[[0,[0,'lang',],'en',],[1,[1,'selected',],],[0,[2,'id',],'3',],]");
+
+  // NaN stays NaN rather than changing on every event.
+  const NodeSnapshot nan = NodeSnapshotBuilder::Double(std::numeric_limits<double>::quiet_NaN());
+  assert(PatchText(nan, nan) == "[]");
+
+  // Past the op limit the whole value goes instead.
+  std::vector<NodeSnapshot> many_before;
+  std::vector<NodeSnapshot> many_after;
+  for (size_t i = 0; i <= plezy::mpv_common::kMaxNodePatchOps; ++i) {
+    many_before.push_back(TrackSnapshot(static_cast<int64_t>(i), false));
+    many_after.push_back(TrackSnapshot(static_cast<int64_t>(i), true));
+  }
+  assert(PatchText(tracks(many_before), tracks(many_after)) == "full");
+  assert(plezy::mpv_common::PatchPropertyId(0) == -1);
+  assert(plezy::mpv_common::PatchPropertyId(41) == -42);
+}
+
+void TestNodeSnapshotRefill() {
+  using plezy::mpv_common::ConvertNode;
+  using plezy::mpv_common::EmitNodeSnapshot;
+  using plezy::mpv_common::NodeSnapshot;
+  using plezy::mpv_common::NodeSnapshotBuilder;
+  using plezy::mpv_common::RefillNodeSnapshot;
+
+  // Two tracks, each {id, title}; the second title long enough to live on
+  // the heap.
+  char short_title[] = "English";
+  char long_title[] = "Commentary with the director and the director of photography";
+  char* keys[] = {const_cast<char*>("id"), const_cast<char*>("title")};
+  mpv_node first[2] = {};
+  first[0].format = MPV_FORMAT_INT64;
+  first[0].u.int64 = 1;
+  first[1].format = MPV_FORMAT_STRING;
+  first[1].u.string = short_title;
+  mpv_node second[2] = {};
+  second[0].format = MPV_FORMAT_INT64;
+  second[0].u.int64 = 2;
+  second[1].format = MPV_FORMAT_STRING;
+  second[1].u.string = long_title;
+  mpv_node_list first_map{2, first, keys};
+  mpv_node_list second_map{2, second, keys};
+  mpv_node tracks[2] = {};
+  tracks[0].format = MPV_FORMAT_NODE_MAP;
+  tracks[0].u.list = &first_map;
+  tracks[1].format = MPV_FORMAT_NODE_MAP;
+  tracks[1].u.list = &second_map;
+  mpv_node_list track_list{2, tracks, nullptr};
+  mpv_node root{};
+  root.format = MPV_FORMAT_NODE_ARRAY;
+  root.u.list = &track_list;
+
+  // Whatever it held before, a refill reads back as a fresh conversion.
+  TextNodeBuilder text;
+  const std::string expected = ConvertNode<TextNodeBuilder>(&root);
+  NodeSnapshot snapshot;
+  RefillNodeSnapshot(&root, &snapshot);
+  assert(EmitNodeSnapshot(snapshot, text) == expected);
+  snapshot = NodeSnapshotBuilder::String("stale", 5);
+  RefillNodeSnapshot(&root, &snapshot);
+  assert(EmitNodeSnapshot(snapshot, text) == expected);
+  auto longer = NodeSnapshotBuilder::NewList(4);
+  for (int i = 0; i < 4; ++i) NodeSnapshotBuilder::Append(longer, TrackSnapshot(i, true));
+  snapshot = longer;
+  RefillNodeSnapshot(&root, &snapshot);
+  assert(EmitNodeSnapshot(snapshot, text) == expected);
+  std::vector<plezy::mpv_common::NodePatchOp> ops;
+  assert(plezy::mpv_common::DiffNodeSnapshots(ConvertNode<NodeSnapshotBuilder>(&root), snapshot, 1, &ops));
+  assert(ops.empty());
+
+  // The same shape again reuses the storage it filled last time.
+  const void* items = snapshot.items.data();
+  const void* title = snapshot.items[1].values[1].string.data();
+  second[0].u.int64 = 3;
+  RefillNodeSnapshot(&root, &snapshot);
+  assert(snapshot.items.data() == items);
+  assert(snapshot.items[1].values[1].string.data() == title);
+  assert(snapshot.items[1].values[0].integer == 3);
+
+  // A map the walk rejects part-way is null where it stood, as in any builder.
+  keys[1] = nullptr;
+  assert(ConvertNode<TextNodeBuilder>(&root) == "[null,null,]");
+  RefillNodeSnapshot(&root, &snapshot);
+  assert(EmitNodeSnapshot(snapshot, text) == "[null,null,]");
+  keys[1] = const_cast<char*>("title");
+  RefillNodeSnapshot(&root, &snapshot);
+  assert(EmitNodeSnapshot(snapshot, text) == ConvertNode<TextNodeBuilder>(&root));
+}
+
+void TestEventLoopStats() {
+  using plezy::mpv_common::EventLoopStats;
+  using plezy::mpv_common::LatencyHistogram;
+
+  LatencyHistogram histogram;
+  for (uint64_t value : {0, 1, 2, 3, 1000}) histogram.Record(value);
+  const auto first = histogram.Read();
+  assert(first.count == 5 && first.sum == 1006 && first.max == 1000);
+  assert(first.buckets[0] == 1 && first.buckets[1] == 1 && first.buckets[2] == 2 && first.buckets[10] == 1);
+  // Percentiles are bucket tops, never above the largest value seen.
+  assert(first.Percentile(0) == 0);
+  assert(first.Percentile(0.5) == 3);
+  assert(first.Percentile(0.99) == 1000);
+  assert(LatencyHistogram::Snapshot().Percentile(0.5) == 0);
+
+  histogram.Record(5000);
+  const auto delta = histogram.Read().Since(first);
+  assert(delta.count == 1 && delta.sum == 5000 && delta.max == 5000 && delta.buckets[13] == 1);
+  histogram.Record(uint64_t{1} << 60);
+  assert(histogram.Read().buckets[LatencyHistogram::kBucketCount - 1] == 1);
+  histogram.Reset();
+  assert(histogram.Read().count == 0 && histogram.Read().max == 0);
+
+  // Recording from several threads loses nothing.
+  std::vector<std::thread> threads;
+  for (int t = 0; t < 4; ++t) {
+    threads.emplace_back([&histogram, t]() {
+      for (uint64_t i = 0; i < 10000; ++i) histogram.Record(i + static_cast<uint64_t>(t));
+    });
+  }
+  for (auto& thread : threads) thread.join();
+  assert(histogram.Read().count == 40000 && histogram.Read().max == 10002);
+
+  // Reply round trips are recorded by kind, and only for requests that had a
+  // callback to take.
+  EventLoopStats stats;
+  plezy::mpv_common::AsyncRequestRegistry registry;
+  bool completed = false;
+  mpv_event reply{};
+  reply.event_id = MPV_EVENT_COMMAND_REPLY;
+  reply.reply_userdata = registry.RegisterStatus([&completed](int) { completed = true; });
+  const auto identity = [](const char* value) { return std::string(value); };
+  assert(plezy::mpv_common::DispatchReplyEvent(registry, &reply, identity, &stats));
+  assert(completed);
+  assert(plezy::mpv_common::DispatchReplyEvent(registry, &reply, identity, &stats));
+  auto snapshot = stats.Read();
+  assert(snapshot.reply_round_trip_us[static_cast<size_t>(plezy::mpv_common::AsyncReplyKind::kCommand)].count == 1);
+  assert(snapshot.reply_round_trip_us[static_cast<size_t>(plezy::mpv_common::AsyncReplyKind::kGetProperty)].count == 0);
+
+  stats.RecordWakeupToDispatch(std::chrono::microseconds(40));
+  stats.RecordDrain(3);
+  stats.RecordHandler(MPV_EVENT_PROPERTY_CHANGE, std::chrono::microseconds(250));
+  stats.RecordHandler(static_cast<mpv_event_id>(EventLoopStats::kEventIdCount), std::chrono::microseconds(1));
+  snapshot = stats.Read();
+  assert(snapshot.handler_us[MPV_EVENT_PROPERTY_CHANGE].count == 1);
+
+  TextNodeBuilder text;
+  const std::string emitted = plezy::mpv_common::EmitEventLoopStats(snapshot, text);
+  const std::string handler =
+      std::string(mpv_event_name(MPV_EVENT_PROPERTY_CHANGE)) +
+      ":{count:1,sum:250,max:250,p50:250,p90:250,p99:250,buckets:[0,0,0,0,0,0,0,0,1,],}";
+  assert(emitted.find("wakeupToDispatchUs:{count:1,sum:40,") == 1);
+  assert(emitted.find("eventsPerDrain:{count:1,sum:3,max:3,") != std::string::npos);
+  assert(emitted.find("handlerUs:{" + handler + ",}") != std::string::npos);
+  assert(emitted.find("command:{count:1,") != std::string::npos);
+  assert(emitted.find("get-property:{count:0,sum:0,max:0,p50:0,p90:0,p99:0,buckets:[],}") != std::string::npos);
+
+  const std::string line = plezy::mpv_common::FormatEventLoopStats(snapshot);
+  assert(line.find("events/drain n=1 p50=3 p99=3 max=3") != std::string::npos);
+  assert(line.find("command reply us n=1") != std::string::npos);
+  assert(line.find("get-property") == std::string::npos);
+}
+
 void TestHdrHelpers() {
   assert(plezy::mpv_common::ParseEnabledFlag("yes"));
   assert(plezy::mpv_common::ParseEnabledFlag("true"));
@@ -449,16 +1234,29 @@ void TestHdrHelpers() {
 int main() {
   TestRequestRegistry();
   TestConcurrentRequestCompletion();
+  TestRequestRegistrySlotIds();
+  TestConcurrentRequestChurn();
   TestSetPropertyResultContract();
   TestPropertyObservationRegistry();
   TestConcurrentPropertyObservationRegistry();
+  TestPropertyChangeCoalescer();
   TestResumeRecoverySchedule();
   TestConcurrentAudioRecoveryState();
   TestNullFallbackRecoverySchedule();
   TestFileBoundaryRestartsNullRecoveryOnlyAfterLoad();
   TestUnloadedResumeIsConsumed();
   TestStaleReloadCompletionCannotClearCurrentRequest();
+  TestAudioRecoveryNextDeadline();
+  TestDeadlineScheduler();
+  TestConcurrentDeadlineScheduler();
+  TestWaitTimeoutSeconds();
+  TestStandbyCorePool();
+  TestNextItemPreload();
   TestNodeConversionBounds();
+  TestStandardCodecNodeBuilder();
+  TestNodeSnapshotPatches();
+  TestNodeSnapshotRefill();
+  TestEventLoopStats();
   TestHdrHelpers();
   return 0;
 }
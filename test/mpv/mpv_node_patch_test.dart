@@ -0,0 +1,159 @@
+import 'package:flutter_test/flutter_test.dart';
+import 'package:plezy/mpv/player/mpv_node_patch.dart';
+
+void main() {
+  final trackList = <Object?>[
+    <Object?, Object?>{'id': 1, 'type': 'audio', 'selected': true},
+    <Object?, Object?>{'id': 2, 'type': 'audio', 'selected': false},
+    <Object?, Object?>{'id': 3, 'type': 'sub', 'selected': false, 'lang': 'en'},
+  ];
+
+  test('sets, appends, removes and truncates along a path', () {
+    final patched = MpvNodePatch.apply(trackList, [
+      [
+        0,
+        [0, 'selected'],
+        false,
+      ],
+      [
+        0,
+        [1, 'selected'],
+        true,
+      ],
+      [
+        1,
+        [2, 'lang'],
+      ],
+      [
+        0,
+        [3],
+        {'id': 4, 'type': 'video'},
+      ],
+    ]);
+    expect(patched, [
+      {'id': 1, 'type': 'audio', 'selected': false},
+      {'id': 2, 'type': 'audio', 'selected': true},
+      {'id': 3, 'type': 'sub', 'selected': false},
+      {'id': 4, 'type': 'video'},
+    ]);
+
+    expect(
+      MpvNodePatch.apply(trackList, [
+        [2, [], 1],
+      ]),
+      [
+        {'id': 1, 'type': 'audio', 'selected': true},
+      ],
+    );
+    expect(
+      MpvNodePatch.apply(trackList, [
+        [0, [], 'replaced'],
+      ]),
+      'replaced',
+    );
+    expect(MpvNodePatch.apply(trackList, const []), same(trackList));
+  });
+
+  test('leaves the base and untouched branches as they were', () {
+    final patched = MpvNodePatch.apply(trackList, [
+      [
+        0,
+        [1, 'selected'],
+        true,
+      ],
+      [
+        0,
+        [1, 'title'],
+        'Commentary',
+      ],
+    ])! as List;
+
+    expect((trackList[1] as Map)['selected'], isFalse);
+    expect((trackList[1] as Map).containsKey('title'), isFalse);
+    expect(trackList, hasLength(3));
+    expect(patched[0], same(trackList[0]));
+    expect(patched[2], same(trackList[2]));
+    expect(patched[1], {'id': 2, 'type': 'audio', 'selected': true, 'title': 'Commentary'});
+  });
+
+  final malformed = <({String name, Object? ops})>[
+    (name: 'not a list', ops: {'op': 0}),
+    (name: 'op not a list', ops: [0]),
+    (
+      name: 'unknown kind',
+      ops: [
+        [9, [], 0],
+      ],
+    ),
+    (
+      name: 'missing value',
+      ops: [
+        [
+          0,
+          [0],
+        ],
+      ],
+    ),
+    (
+      name: 'index past the end',
+      ops: [
+        [
+          0,
+          [5],
+          null,
+        ],
+      ],
+    ),
+    (
+      name: 'missing key on the way',
+      ops: [
+        [
+          0,
+          [0, 'metadata', 'title'],
+          'x',
+        ],
+      ],
+    ),
+    (
+      name: 'key into a list',
+      ops: [
+        [
+          0,
+          ['id'],
+          1,
+        ],
+      ],
+    ),
+    (
+      name: 'remove from a list',
+      ops: [
+        [
+          1,
+          [0],
+        ],
+      ],
+    ),
+    (
+      name: 'truncate past the end',
+      ops: [
+        [2, [], 4],
+      ],
+    ),
+    (
+      name: 'truncate a map',
+      ops: [
+        [
+          2,
+          [0],
+          0,
+        ],
+      ],
+    ),
+  ];
+  for (final entry in malformed) {
+    test('rejects ${entry.name}', () {
+      expect(() => MpvNodePatch.apply(trackList, entry.ops), throwsFormatException);
+      expect(trackList, hasLength(3));
+    });
+  }
+}
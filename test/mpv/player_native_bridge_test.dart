@@ -665,6 +665,171 @@ void main() {
     );
   });
 
+  test('MPV applies batched property changes in order and skips malformed pairs', () async {
+    final observations = <String, int>{};
+    await withMockPlayerChannels(
+      methodChannelName: 'com.plezy/mpv_player',
+      eventChannelName: 'com.plezy/mpv_player/events',
+      methodHandler: (call) async {
+        if (call.method == 'initialize') return true;
+        if (call.method == 'observeProperty') {
+          final arguments = call.arguments as Map;
+          observations[arguments['name'] as String] = arguments['id'] as int;
+        }
+        return null;
+      },
+      testBody: () async {
+        final player = PlayerNative();
+        try {
+          await player.setLogLevel('warn');
+          final messenger = TestDefaultBinaryMessengerBinding.instance.defaultBinaryMessenger;
+          const codec = StandardMethodCodec();
+
+          Future<void> sendEvent(Object? event) async {
+            final done = Completer<void>();
+            await messenger.handlePlatformMessage(
+              'com.plezy/mpv_player/events',
+              codec.encodeSuccessEnvelope(event),
+              (_) => done.complete(),
+            );
+            await done.future;
+            await Future<void>.delayed(Duration.zero);
+          }
+
+          await sendEvent({
+            'type': 'property-batch',
+            'changes': [
+              observations['duration'],
+              120.0,
+              'not-a-property-id',
+              true,
+              observations['pause'],
+              false,
+              observations['demuxer-cache-state'],
+              const {'cache-end': 30.0},
+            ],
+          });
+          expect(player.state.duration, const Duration(minutes: 2));
+          expect(player.state.playing, isTrue);
+          expect(player.state.buffer, const Duration(seconds: 30));
+
+          // A dangling id without a value is ignored, and the channel stays live.
+          await sendEvent({
+            'type': 'property-batch',
+            'changes': [observations['pause']],
+          });
+          await sendEvent({'type': 'property-batch', 'changes': 'not-a-list'});
+          expect(player.state.playing, isTrue);
+          await sendEvent([observations['pause'], true]);
+          expect(player.state.playing, isFalse);
+        } finally {
+          await player.dispose();
+        }
+      },
+    );
+  });
+
+  test('MPV applies node patches and resyncs a property a patch does not fit', () async {
+    PlayerNative.debugPatchNodeProperties = true;
+    addTearDown(() => PlayerNative.debugPatchNodeProperties = null);
+    final observations = <String, int>{};
+    final patched = <String>{};
+    final resyncs = <int>[];
+    await withMockPlayerChannels(
+      methodChannelName: 'com.plezy/mpv_player',
+      eventChannelName: 'com.plezy/mpv_player/events',
+      methodHandler: (call) async {
+        if (call.method == 'initialize') return true;
+        if (call.method == 'observeProperty') {
+          final arguments = call.arguments as Map;
+          observations[arguments['name'] as String] = arguments['id'] as int;
+          if (arguments['patch'] == true) patched.add(arguments['name'] as String);
+        }
+        if (call.method == 'resyncProperty') resyncs.add((call.arguments as Map)['id'] as int);
+        return null;
+      },
+      testBody: () async {
+        final player = PlayerNative();
+        try {
+          await player.setLogLevel('warn');
+          expect(patched, {'track-list', 'demuxer-cache-state', 'audio-device-list'});
+          final messenger = TestDefaultBinaryMessengerBinding.instance.defaultBinaryMessenger;
+          const codec = StandardMethodCodec();
+
+          Future<void> sendEvent(Object? event) async {
+            final done = Completer<void>();
+            await messenger.handlePlatformMessage(
+              'com.plezy/mpv_player/events',
+              codec.encodeSuccessEnvelope(event),
+              (_) => done.complete(),
+            );
+            await done.future;
+            await Future<void>.delayed(Duration.zero);
+          }
+
+          final cacheId = observations['demuxer-cache-state']!;
+          final cachePatchId = -1 - cacheId;
+
+          // A patch with nothing to apply to asks for the whole value, once.
+          await sendEvent([cachePatchId, const []]);
+          await sendEvent([cachePatchId, const []]);
+          expect(resyncs, [cacheId]);
+
+          await sendEvent([cacheId, const {'cache-end': 12.5}]);
+          expect(player.state.buffer, const Duration(milliseconds: 12500));
+
+          // Patches apply to the last whole value, batched ones included.
+          await sendEvent([
+            cachePatchId,
+            const [
+              [
+                0,
+                ['cache-end'],
+                20.0,
+              ],
+            ],
+          ]);
+          expect(player.state.buffer, const Duration(seconds: 20));
+          await sendEvent({
+            'type': 'property-batch',
+            'changes': [
+              cachePatchId,
+              const [
+                [
+                  0,
+                  ['cache-end'],
+                  25.0,
+                ],
+              ],
+            ],
+          });
+          expect(player.state.buffer, const Duration(seconds: 25));
+
+          // One that does not fit is dropped, and the whole value asked for.
+          await sendEvent([
+            cachePatchId,
+            const [
+              [
+                0,
+                ['seekable-ranges', 3, 'end'],
+                1.0,
+              ],
+            ],
+          ]);
+          expect(player.state.buffer, const Duration(seconds: 25));
+          expect(resyncs, [cacheId, cacheId]);
+
+          // A patch id for an observation that is not patched is ignored.
+          final pauseId = observations['pause']!;
+          await sendEvent([-1 - pauseId, const []]);
+          expect(resyncs, hasLength(2));
+        } finally {
+          await player.dispose();
+        }
+      },
+    );
+  });
+
   test('Android command failure reaches seek recovery', () async {
     await withMockPlayerChannels(
       methodChannelName: 'com.plezy/mpv_player',
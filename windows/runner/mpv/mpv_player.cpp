@@ -3,6 +3,7 @@
 #include <commctrl.h>
 #include <windowsx.h>
 
+#include <cstdlib>
 #include <unordered_map>
 
 #include "sanitize_utf8.h"
@@ -31,6 +32,7 @@ struct EncodableNodeBuilder {
   using Value = flutter::EncodableValue;
   using ListBuilder = flutter::EncodableList;
   using MapBuilder = flutter::EncodableMap;
+  using Key = flutter::EncodableValue;
 
   static Value Null() { return flutter::EncodableValue(); }
   static Value Boolean(bool value) { return flutter::EncodableValue(value); }
@@ -38,14 +40,19 @@ struct EncodableNodeBuilder {
   static Value Double(double value) { return flutter::EncodableValue(value); }
   static Value String(const char* value, size_t length) { return flutter::EncodableValue(SanitizeUtf8(value, length)); }
 
-  static ListBuilder NewList() { return flutter::EncodableList(); }
+  static ListBuilder NewList(size_t size) {
+    flutter::EncodableList list;
+    list.reserve(size);
+    return list;
+  }
   static void Append(ListBuilder& list, Value value) { list.push_back(std::move(value)); }
   static Value FinishList(ListBuilder list) { return flutter::EncodableValue(std::move(list)); }
 
-  static MapBuilder NewMap() { return flutter::EncodableMap(); }
-  static void Insert(MapBuilder& map, const char* key, size_t key_length, Value value) {
-    map[flutter::EncodableValue(SanitizeUtf8(key, key_length))] = std::move(value);
+  static MapBuilder NewMap(size_t) { return flutter::EncodableMap(); }
+  static Key MapKey(const char* key, size_t key_length) {
+    return flutter::EncodableValue(SanitizeUtf8(key, key_length));
   }
+  static void Insert(MapBuilder& map, Key key, Value value) { map[std::move(key)] = std::move(value); }
   static Value FinishMap(MapBuilder map) { return flutter::EncodableValue(std::move(map)); }
   static void AbandonMap(MapBuilder&) {}
 };
@@ -510,101 +517,150 @@ void MpvPlayer::DetachMpvInnerSubclass() {
   inner_subclass_.reset();
 }
 
-bool MpvPlayer::Initialize(HWND view) {
-  if (mpv_) {
-    return true;  // Already initialized.
-  }
+HWND MpvPlayer::CreateVideoHost(HWND view) {
+  // Create a child window for mpv to render into, parented to the Flutter
+  // |view|. The video child then sits in the view's own per-window layer
+  // stack, above the view's (never-painted) layer-1 content and below the
+  // engine's topmost DComp visual carrying the UI. WS_CLIPSIBLINGS keeps it
+  // from painting over neighboring view children.
+  //
+  // WS_DISABLED takes the host — and the inner window mpv creates inside it,
+  // which a disabled parent disables implicitly — out of input targeting, so
+  // mouse, touch, and pen over the video are delivered to the parent Flutter
+  // view instead of to mpv's thread. mpv never consumes input here anyway
+  // (input-vo-keyboard=no, and the forwarding subclass swallows the rest).
+  return ::CreateWindowExW(
+      WS_EX_NOPARENTNOTIFY, L"STATIC", L"", kVideoHostWindowStyle, 0, 0, 100, 100, view, nullptr,
+      GetModuleHandle(nullptr), nullptr);
+}
 
+mpv_handle* MpvPlayer::CreateCore(bool audio_only, bool hdr_enabled, HWND host) {
   // Create mpv instance.
-  mpv_ = mpv_create();
-  if (!mpv_) {
-    return false;
+  mpv_handle* mpv = mpv_create();
+  if (!mpv) {
+    return nullptr;
   }
 
-  if (audio_only_) {
+  if (audio_only) {
     // Windowless music core: no HWND, no VO, no video decode. vid=no keeps
     // embedded cover art from ever becoming a video track, and
     // force-window/audio-display make sure mpv never opens a video output
     // for it either.
-    mpv_set_option_string(mpv_, "vid", "no");
-    mpv_set_option_string(mpv_, "force-window", "no");
-    mpv_set_option_string(mpv_, "audio-display", "no");
-    mpv_set_option_string(mpv_, "gapless-audio", "weak");
+    mpv_set_option_string(mpv, "vid", "no");
+    mpv_set_option_string(mpv, "force-window", "no");
+    mpv_set_option_string(mpv, "audio-display", "no");
+    mpv_set_option_string(mpv, "gapless-audio", "weak");
   } else {
-    // Create a child window for mpv to render into, parented to the Flutter
-    // |view|. The video child then sits in the view's own per-window layer
-    // stack, above the view's (never-painted) layer-1 content and below the
-    // engine's topmost DComp visual carrying the UI. WS_CLIPSIBLINGS keeps it
-    // from painting over neighboring view children.
-    //
-    // WS_DISABLED takes the host — and the inner window mpv creates inside it,
-    // which a disabled parent disables implicitly — out of input targeting, so
-    // mouse, touch, and pen over the video are delivered to the parent Flutter
-    // view instead of to mpv's thread. mpv never consumes input here anyway
-    // (input-vo-keyboard=no, and the forwarding subclass swallows the rest).
-    hwnd_ = ::CreateWindowExW(
-        WS_EX_NOPARENTNOTIFY, L"STATIC", L"", kVideoHostWindowStyle, 0, 0, 100, 100, view, nullptr,
-        GetModuleHandle(nullptr), nullptr);
-    if (!hwnd_) {
-      mpv_destroy(mpv_);
-      mpv_ = nullptr;
-      return false;
-    }
-    forward_target_view_ = view;
-
     // Set the wid option to embed mpv in our window.
-    int64_t wid = reinterpret_cast<int64_t>(hwnd_);
-    mpv_set_option(mpv_, "wid", MPV_FORMAT_INT64, &wid);
+    int64_t wid = reinterpret_cast<int64_t>(host);
+    mpv_set_option(mpv, "wid", MPV_FORMAT_INT64, &wid);
 
-    mpv_set_option_string(mpv_, "vo", "gpu-next");
-    mpv_set_option_string(mpv_, "gpu-api", "auto");
+    mpv_set_option_string(mpv, "vo", "gpu-next");
+    mpv_set_option_string(mpv, "gpu-api", "auto");
     // hwdec is set from Flutter via setProperty based on user preference
   }
 
   // Configure mpv for embedded playback.
-  mpv_set_option_string(mpv_, "keep-open", "yes");
-  mpv_set_option_string(mpv_, "idle", "yes");
-  mpv_set_option_string(mpv_, "input-default-bindings", "no");
-  mpv_set_option_string(mpv_, "input-vo-keyboard", "no");
+  mpv_set_option_string(mpv, "keep-open", "yes");
+  mpv_set_option_string(mpv, "idle", "yes");
+  mpv_set_option_string(mpv, "input-default-bindings", "no");
+  mpv_set_option_string(mpv, "input-vo-keyboard", "no");
   // Hardware media keys are owned by the SMTC integration (os_media_controls);
   // mpv's default handling would double-handle Play/Pause.
-  mpv_set_option_string(mpv_, "input-media-keys", "no");
-  mpv_set_option_string(mpv_, "osc", "no");
+  mpv_set_option_string(mpv, "input-media-keys", "no");
+  mpv_set_option_string(mpv, "osc", "no");
   // Never resolve URLs through mpv's bundled ytdl_hook: Plezy only ever opens
   // media-server streams and local files, the hook adds a per-open on_load
   // round trip, and on a failed open it spawns yt-dlp with the access token in
   // its argv. mpv decides whether to load the builtin script during
   // mpv_initialize, so this must be an option, not a Dart setProperty.
-  mpv_set_option_string(mpv_, "ytdl", "no");
+  mpv_set_option_string(mpv, "ytdl", "no");
 
-  if (!audio_only_) {
+  if (!audio_only) {
     // Let mpv use display/context detection instead of forcing HDR signaling.
-    mpv_set_option_string(mpv_, "target-colorspace-hint", plezy::mpv_common::TargetColorspaceHint(hdr_enabled_));
+    mpv_set_option_string(mpv, "target-colorspace-hint", plezy::mpv_common::TargetColorspaceHint(hdr_enabled));
 
     // Fallback tone mapping when display doesn't support HDR
-    mpv_set_option_string(mpv_, "tone-mapping", "auto");
-    mpv_set_option_string(mpv_, "hdr-compute-peak", "auto");
+    mpv_set_option_string(mpv, "tone-mapping", "auto");
+    mpv_set_option_string(mpv, "hdr-compute-peak", "auto");
   }
 
   // When WASAPI becomes unavailable (sleep, device unplug), fall back to null
   // audio output instead of permanently dropping the audio track. Recovery is
   // handled by MaybeRunAudioRecovery in the event loop.
-  mpv_set_option_string(mpv_, "audio-fallback-to-null", "yes");
+  mpv_set_option_string(mpv, "audio-fallback-to-null", "yes");
 
   // Default to warn-level logging; Dart side can raise to "v" if debug logging is enabled.
-  mpv_request_log_messages(mpv_, "warn");
+  mpv_request_log_messages(mpv, "warn");
 
   // Initialize mpv.
-  int err = mpv_initialize(mpv_);
+  int err = mpv_initialize(mpv);
   if (err < 0) {
+    mpv_destroy(mpv);
+    return nullptr;
+  }
+  return mpv;
+}
+
+MpvPlayer::StandbyCore MpvPlayer::PrepareStandbyCore(HWND view, bool audio_only) {
+  StandbyCore core;
+  if (!audio_only) {
+    core.view = view;
+    core.hwnd = CreateVideoHost(view);
+  }
+  return core;
+}
+
+void MpvPlayer::WarmStandbyCore(StandbyCore* core, bool audio_only) {
+  if (!audio_only && !core->hwnd) return;
+  // A new player always starts with HDR enabled.
+  core->mpv = CreateCore(audio_only, true, core->hwnd);
+}
+
+void MpvPlayer::DiscardStandbyCore(StandbyCore core) {
+  if (core.hwnd) ::DestroyWindow(core.hwnd);
+  // Idle, but terminating still joins mpv's threads; keep it off the
+  // platform thread like Dispose does.
+  if (core.mpv) {
+    mpv_handle* handle = core.mpv;
+    std::thread([handle]() { mpv_terminate_destroy(handle); }).detach();
+  }
+}
+
+bool MpvPlayer::Initialize(HWND view, StandbyCore* standby) {
+  if (mpv_) {
+    return true;  // Already initialized.
+  }
+
+  // A core warmed for another view cannot be re-parented under mpv's feet;
+  // it is left untouched for the caller to discard.
+  if (standby && standby->view == view) {
+    hwnd_ = standby->hwnd;
+    mpv_ = standby->mpv;
+    *standby = StandbyCore{};
+  }
+
+  if (!audio_only_) {
+    if (!hwnd_) hwnd_ = CreateVideoHost(view);
+    if (!hwnd_) {
+      if (mpv_) {
+        mpv_destroy(mpv_);
+        mpv_ = nullptr;
+      }
+      return false;
+    }
+    forward_target_view_ = view;
+  }
+
+  // A standby core whose warm failed leaves only its host window behind.
+  if (!mpv_) mpv_ = CreateCore(audio_only_, hdr_enabled_, hwnd_);
+  if (!mpv_) {
     if (hwnd_) {
       DetachMpvInnerSubclass();
       forward_target_view_ = nullptr;
       ::DestroyWindow(hwnd_);
       hwnd_ = nullptr;
     }
-    mpv_destroy(mpv_);
-    mpv_ = nullptr;
     return false;
   }
 
@@ -652,6 +708,17 @@ void MpvPlayer::Dispose() {
   }
 
   observed_properties_.Clear();
+  // Per-id batching state goes with the observations it was keyed by: a
+  // re-initialised player is observed afresh, and an id reused there must not
+  // inherit an old interval or send a value staged for this session. The event
+  // thread has stopped, so its state is safe to touch here.
+  property_batch_.Reset();
+  {
+    std::lock_guard<std::mutex> lock(min_interval_mutex_);
+    pending_min_intervals_.clear();
+    min_intervals_pending_.store(false, std::memory_order_relaxed);
+  }
+  next_item_.Clear();
 }
 
 void MpvPlayer::Command(const std::vector<std::string>& args) { CommandAsync(args, nullptr); }
@@ -665,6 +732,44 @@ void MpvPlayer::CommandAsync(const std::vector<std::string>& args, CommandCallba
   plezy::mpv_common::SubmitCommandAsync(mpv_, pending_requests_, args, std::move(callback));
 }
 
+void MpvPlayer::Preload(const std::string& url, const std::string& options, StatusCallback callback) {
+  if (!mpv_) {
+    if (callback) callback(MPV_ERROR_UNINITIALIZED);
+    return;
+  }
+
+  const uint64_t generation = next_item_.Begin(url);
+  // mpv opens the next entry's stream and demuxer once the playing one has
+  // been read to its end, which is what takes the cold open off the boundary.
+  SetPropertyAsync("prefetch-playlist", "yes", nullptr);
+  // Drops any title queued before, and keeps the playing entry, so the append
+  // below is always the one playlist-next reaches.
+  CommandAsync({"playlist-clear"}, nullptr);
+  CommandAsync(plezy::mpv_common::PreloadLoadfileArgs(url, options), [this, generation, url, callback](int error) {
+    if (error < 0) {
+      if (next_item_.Abandon(generation, nullptr)) SendPreloadEvent("failed", url, error);
+      if (callback) callback(error);
+      return;
+    }
+    if (callback) callback(error);
+    // The entry id is what start-file and end-file name it by.
+    GetPropertyAsync("playlist/1/id", [this, generation, url](int error, const std::string& value) {
+      const int64_t entry_id = error >= 0 ? std::strtoll(value.c_str(), nullptr, 10) : 0;
+      if (entry_id <= 0) {
+        if (next_item_.Abandon(generation, nullptr)) SendPreloadEvent("failed", url, error < 0 ? error : -1);
+        return;
+      }
+      if (next_item_.Queued(generation, entry_id)) SendPreloadEvent("ready", url);
+    });
+  });
+}
+
+bool MpvPlayer::Promote(StatusCallback callback) {
+  if (!mpv_ || !next_item_.HasQueued()) return false;
+  CommandAsync({"playlist-next", "force"}, std::move(callback));
+  return true;
+}
+
 void MpvPlayer::SetProperty(const std::string& name, const std::string& value) {
   SetPropertyAsync(name, value, nullptr);
 }
@@ -693,11 +798,18 @@ void MpvPlayer::GetPropertyAsync(const std::string& name, GetPropertyCallback ca
   plezy::mpv_common::SubmitGetPropertyAsync(mpv_, pending_requests_, name, std::move(callback));
 }
 
-void MpvPlayer::ObserveProperty(const std::string& name, const std::string& format, int id) {
+void MpvPlayer::ObserveProperty(const std::string& name, const std::string& format, int id, int min_interval_ms) {
   if (!mpv_) return;
 
   const auto request = observed_properties_.Register(name, format, id);
   if (!request.added) return;
+  if (min_interval_ms > 0) {
+    // Queued before mpv is asked, so the drain that first stages the property
+    // has already applied it.
+    std::lock_guard<std::mutex> lock(min_interval_mutex_);
+    pending_min_intervals_.emplace_back(id, min_interval_ms);
+    min_intervals_pending_.store(true, std::memory_order_release);
+  }
   mpv_observe_property(mpv_, request.userdata, name.c_str(), request.format);
 }
 
@@ -733,9 +845,18 @@ void MpvPlayer::SetEventCallback(EventCallback callback) {
   event_callback_ = std::move(callback);
 }
 
+void MpvPlayer::SetPropertyBatching(bool enabled) { property_batching_.store(enabled, std::memory_order_relaxed); }
+
 void MpvPlayer::NotifyPowerSuspend() { LogRecovery("system suspending"); }
 
-void MpvPlayer::NotifyPowerResume() { audio_recovery_.RequestResume(); }
+void MpvPlayer::NotifyPowerResume() {
+  audio_recovery_.RequestResume();
+  WakeEventLoop();
+}
+
+void MpvPlayer::WakeEventLoop() {
+  if (mpv_) mpv_wakeup(mpv_);
+}
 
 void MpvPlayer::LogRecovery(const std::string& text) {
   char log_msg[512];
@@ -776,6 +897,8 @@ void MpvPlayer::MaybeRunAudioRecovery() {
 
 void MpvPlayer::StartEventLoop() {
   running_ = true;
+  // Only stamps the time: the event thread is already waiting on the queue.
+  mpv_set_wakeup_callback(mpv_, &MpvPlayer::OnMpvWakeup, this);
   event_thread_ = std::thread(&MpvPlayer::EventLoop, this);
 }
 
@@ -788,26 +911,136 @@ void MpvPlayer::StopEventLoop() {
     }
     event_thread_.join();
   }
+  // Returns only once no callback is running, so `this` is not used after.
+  if (mpv_) mpv_set_wakeup_callback(mpv_, nullptr, nullptr);
+}
+
+void MpvPlayer::OnMpvWakeup(void* ctx) {
+  auto* player = static_cast<MpvPlayer*>(ctx);
+  int64_t expected = 0;
+  player->wakeup_at_.compare_exchange_strong(
+      expected, plezy::mpv_common::EventLoopStats::Clock::now().time_since_epoch().count(),
+      std::memory_order_relaxed);
 }
 
 void MpvPlayer::EventLoop() {
+  using Clock = plezy::mpv_common::EventLoopStats::Clock;
+  event_thread_id_.store(std::this_thread::get_id(), std::memory_order_relaxed);
   while (running_) {
-    mpv_event* event = mpv_wait_event(mpv_, 0.1);
+    // Sleeps until mpv has something, a timer falls due or an audio reload is
+    // scheduled, whichever is first; with none of them, until mpv wakes it.
+    // Anything that changes a deadline from another thread calls
+    // WakeEventLoop so the wait is recomputed.
+    Clock::time_point deadline;
+    bool has_deadline = timers_.NextDeadline(&deadline);
+    Clock::time_point reload_at;
+    if (audio_recovery_.NextDeadline(&reload_at) && (!has_deadline || reload_at < deadline)) {
+      deadline = reload_at;
+      has_deadline = true;
+    }
+    const double timeout = plezy::mpv_common::WaitTimeoutSeconds(has_deadline, deadline, Clock::now());
+    mpv_event* event = mpv_wait_event(mpv_, timeout);
     if (event->event_id == MPV_EVENT_SHUTDOWN) {
       break;
     }
     if (event->event_id != MPV_EVENT_NONE) {
-      HandleMpvEvent(event);
+      const int64_t woken_at = wakeup_at_.exchange(0, std::memory_order_relaxed);
+      if (woken_at != 0) {
+        event_loop_stats_.RecordWakeupToDispatch(Clock::now() - Clock::time_point(Clock::duration(woken_at)));
+      }
+      // Everything already queued is one drain, and one delivery.
+      draining_ = true;
+      batch_properties_ = property_batching_.load(std::memory_order_relaxed);
+      ApplyPendingMinIntervals();
+      // With batching off, a value still held for its interval must go out
+      // before the unbatched change that would otherwise overtake it.
+      if (!batch_properties_) FlushPropertyBatch(true);
+      size_t handled = 0;
+      while (event->event_id != MPV_EVENT_NONE && event->event_id != MPV_EVENT_SHUTDOWN) {
+        const auto started = Clock::now();
+        const mpv_event_id event_id = event->event_id;
+        HandleMpvEvent(event);
+        event_loop_stats_.RecordHandler(event_id, Clock::now() - started);
+        ++handled;
+        event = mpv_wait_event(mpv_, 0);
+      }
+      event_loop_stats_.RecordDrain(handled);
+      FlushPropertyBatch(false);
+      draining_ = false;
+      batch_properties_ = false;
+      DeliverMessages(std::move(drain_messages_));
+      drain_messages_.clear();
+      // Wakeups for events this drain already took say nothing about the next.
+      wakeup_at_.store(0, std::memory_order_relaxed);
+      if (event->event_id == MPV_EVENT_SHUTDOWN) {
+        break;
+      }
     }
-    // Runs on every iteration including wait timeouts: this ~100ms tick is
-    // the clock that drives scheduled audio reload attempts.
+    // Runs after every wake, whatever caused it: the drain may have scheduled
+    // a reload or completed one, and a timeout means a deadline is due.
     MaybeRunAudioRecovery();
+    RunEventLoopTimers();
+  }
+  timers_.Clear();
+  stats_log_timer_ = 0;
+  property_flush_timer_ = 0;
+}
+
+void MpvPlayer::RunEventLoopTimers() {
+  const auto now = plezy::mpv_common::EventLoopStats::Clock::now();
+  if (stats_log_rebase_.exchange(false)) {
+    stats_logged_ = event_loop_stats_.Read();
+    if (stats_log_timer_ != 0) timers_.Cancel(stats_log_timer_);
+    stats_log_timer_ = 0;
+    ScheduleEventLoopStatsLog(now);
+  }
+  timers_.RunDue(now);
+}
+
+void MpvPlayer::ScheduleEventLoopStatsLog(plezy::mpv_common::DeadlineScheduler::Clock::time_point now) {
+  const int interval_ms = stats_log_interval_ms_.load(std::memory_order_relaxed);
+  if (interval_ms <= 0) return;
+  stats_log_timer_ = timers_.Schedule(
+      now + std::chrono::milliseconds(interval_ms),
+      [this](plezy::mpv_common::DeadlineScheduler::Clock::time_point due) { LogEventLoopStats(due); });
+}
+
+void MpvPlayer::LogEventLoopStats(plezy::mpv_common::DeadlineScheduler::Clock::time_point now) {
+  stats_log_timer_ = 0;
+  const auto current = event_loop_stats_.Read();
+  const std::string text = plezy::mpv_common::FormatEventLoopStats(current.Since(stats_logged_));
+  stats_logged_ = current;
+  ScheduleEventLoopStatsLog(now);
+  const std::string line = "MPV [info] event-loop: " + text + "\n";
+  OutputDebugStringA(line.c_str());
+
+  flutter::EncodableMap data;
+  data[flutter::EncodableValue("prefix")] = flutter::EncodableValue("event-loop");
+  data[flutter::EncodableValue("level")] = flutter::EncodableValue("info");
+  data[flutter::EncodableValue("text")] = flutter::EncodableValue(text);
+  SendEvent("log-message", data);
+}
+
+flutter::EncodableValue MpvPlayer::GetEventLoopStats(bool reset) {
+  EncodableNodeBuilder builder;
+  flutter::EncodableValue stats = plezy::mpv_common::EmitEventLoopStats(event_loop_stats_.Read(), builder);
+  if (reset) {
+    event_loop_stats_.Reset();
+    stats_log_rebase_ = true;
+    WakeEventLoop();
   }
+  return stats;
+}
+
+void MpvPlayer::SetEventLoopStatsLogInterval(int interval_ms) {
+  stats_log_interval_ms_ = interval_ms > 0 ? interval_ms : 0;
+  stats_log_rebase_ = true;
+  WakeEventLoop();
 }
 
 void MpvPlayer::HandleMpvEvent(mpv_event* event) {
   if (plezy::mpv_common::DispatchReplyEvent(
-          pending_requests_, event, [](const char* value) { return SanitizeUtf8(value); })) {
+          pending_requests_, event, [](const char* value) { return SanitizeUtf8(value); }, &event_loop_stats_)) {
     return;
   }
 
@@ -829,11 +1062,12 @@ void MpvPlayer::HandleMpvEvent(mpv_event* event) {
       auto* prop = static_cast<mpv_event_property*>(event->data);
       mpv_node node = plezy::mpv_common::ExtractPropertyNode(prop);
 
-      // The 100ms mpv_wait_event tick already polls for scheduled reloads.
+      // The event loop recomputes its wait after this drain, so a reload the
+      // property schedules needs no wakeup of its own.
       const auto notice = plezy::mpv_common::ObserveAudioRecoveryProperty(audio_recovery_, event, prop);
       if (notice.message) LogRecovery(notice.message);
 
-      SendPropertyChange(prop->name, &node);
+      SendPropertyChange(event->reply_userdata, &node);
       break;
     }
     case MPV_EVENT_END_FILE: {
@@ -846,10 +1080,21 @@ void MpvPlayer::HandleMpvEvent(mpv_event* event) {
         data[flutter::EncodableValue("message")] = flutter::EncodableValue(SanitizeUtf8(mpv_error_string(end->error)));
       }
       SendEvent("end-file", data);
+      std::string preloaded;
+      if (next_item_.OnEndFile(end->playlist_entry_id, end->reason == MPV_END_FILE_REASON_ERROR, &preloaded) ==
+          plezy::mpv_common::NextItemPreload::Outcome::kFailed) {
+        SendPreloadEvent("failed", preloaded, end->error);
+      }
       break;
     }
     case MPV_EVENT_START_FILE: {
       SendEvent("start-file");
+      auto* start = static_cast<mpv_event_start_file*>(event->data);
+      std::string preloaded;
+      if (start && next_item_.OnStartFile(start->playlist_entry_id, &preloaded) ==
+                       plezy::mpv_common::NextItemPreload::Outcome::kPromoted) {
+        SendPreloadEvent("promoted", preloaded);
+      }
       break;
     }
     case MPV_EVENT_FILE_LOADED: {
@@ -870,36 +1115,124 @@ void MpvPlayer::HandleMpvEvent(mpv_event* event) {
   }
 }
 
-void MpvPlayer::SendPropertyChange(const char* name, mpv_node* data) {
-  if (!name) return;
-
+void MpvPlayer::SendPropertyChange(uint64_t userdata, mpv_node* data) {
   int id = 0;
-  if (!observed_properties_.LookupId(name, &id)) return;
+  if (!observed_properties_.LookupIdForUserdata(userdata, &id)) return;
 
   // mpv owns event node storage; copy the full tree before the callback can
   // queue it beyond the current mpv_wait_event result's lifetime.
+  flutter::EncodableValue value = NodeToEncodableValue(data);
+  if (batch_properties_) {
+    // A later change to the same property in this drain replaces this one.
+    property_batch_.Stage(id, std::move(value));
+    return;
+  }
+
   flutter::EncodableList list;
   list.push_back(flutter::EncodableValue(id));
-  list.push_back(NodeToEncodableValue(data));
+  list.push_back(std::move(value));
+  QueueMessage(flutter::EncodableValue(std::move(list)));
+}
 
-  std::lock_guard<std::mutex> lock(callback_mutex_);
-  if (event_callback_) {
-    event_callback_(flutter::EncodableValue(list));
+void MpvPlayer::SendPreloadEvent(const char* state, const std::string& url, int error) {
+  flutter::EncodableMap data;
+  data[flutter::EncodableValue("state")] = flutter::EncodableValue(state);
+  data[flutter::EncodableValue("url")] = flutter::EncodableValue(SanitizeUtf8(url.data(), url.size()));
+  if (error < 0) {
+    data[flutter::EncodableValue("error")] = flutter::EncodableValue(error);
+    data[flutter::EncodableValue("message")] = flutter::EncodableValue(SanitizeUtf8(mpv_error_string(error)));
   }
+  SendEvent("preload", data);
 }
 
 void MpvPlayer::SendEvent(const std::string& name, const flutter::EncodableMap& data) {
+  // A property that changed before this event must not reach Dart after it:
+  // file-loaded, end-file and playback-restart are all read against the
+  // property state they follow. Log lines carry no such ordering and arrive
+  // often enough to split every batch, so they do not flush.
+  if (name != "log-message") FlushPropertyBatch(true);
+
   flutter::EncodableMap event;
   event[flutter::EncodableValue("type")] = flutter::EncodableValue("event");
   event[flutter::EncodableValue("name")] = flutter::EncodableValue(name);
   if (!data.empty()) {
     event[flutter::EncodableValue("data")] = flutter::EncodableValue(data);
   }
+  QueueMessage(flutter::EncodableValue(std::move(event)));
+}
 
-  std::lock_guard<std::mutex> lock(callback_mutex_);
-  if (event_callback_) {
-    event_callback_(flutter::EncodableValue(event));
+void MpvPlayer::QueueMessage(flutter::EncodableValue message) {
+  // Recovery and power logging also reach here from the platform thread, which
+  // must not touch the drain's list.
+  if (draining_ && event_thread_id_.load(std::memory_order_relaxed) == std::this_thread::get_id()) {
+    drain_messages_.push_back(std::move(message));
+    return;
+  }
+  flutter::EncodableList messages;
+  messages.push_back(std::move(message));
+  DeliverMessages(std::move(messages));
+}
+
+void MpvPlayer::ApplyPendingMinIntervals() {
+  if (!min_intervals_pending_.exchange(false, std::memory_order_acquire)) return;
+  std::lock_guard<std::mutex> lock(min_interval_mutex_);
+  for (const auto& interval : pending_min_intervals_) {
+    property_batch_.SetMinInterval(interval.first, std::chrono::milliseconds(interval.second));
+  }
+  pending_min_intervals_.clear();
+}
+
+void MpvPlayer::FlushPropertyBatch(bool force) {
+  // Only the event thread stages, so only it has anything to send first.
+  if (event_thread_id_.load(std::memory_order_relaxed) != std::this_thread::get_id()) return;
+  if (!property_batch_.HasStaged()) return;
+
+  using Coalescer = plezy::mpv_common::PropertyChangeCoalescer<flutter::EncodableValue>;
+  const auto now = Coalescer::Clock::now();
+  std::vector<Coalescer::Change> due;
+  Coalescer::Clock::time_point next_due{};
+  if (property_batch_.TakeDue(now, force, &due, &next_due)) SchedulePropertyFlush(next_due);
+  if (due.empty()) return;
+
+  // Flat [id, value, id, value, ...] pairs, in the order the properties first
+  // changed during the drain: Dart applies them exactly as it would the same
+  // changes sent one at a time.
+  flutter::EncodableList changes;
+  changes.reserve(due.size() * 2);
+  for (auto& change : due) {
+    changes.push_back(flutter::EncodableValue(change.id));
+    changes.push_back(std::move(change.value));
+  }
+  flutter::EncodableMap batch;
+  batch[flutter::EncodableValue("type")] = flutter::EncodableValue("property-batch");
+  batch[flutter::EncodableValue("changes")] = flutter::EncodableValue(std::move(changes));
+  QueueMessage(flutter::EncodableValue(std::move(batch)));
+}
+
+// One timer covers everything held, due with the earliest of it. The loop
+// reads its deadline before it next waits, so it needs no wakeup.
+void MpvPlayer::SchedulePropertyFlush(plezy::mpv_common::DeadlineScheduler::Clock::time_point at) {
+  if (property_flush_timer_ != 0) {
+    if (property_flush_at_ <= at) return;
+    timers_.Cancel(property_flush_timer_);
+  }
+  property_flush_at_ = at;
+  property_flush_timer_ = timers_.Schedule(at, [this](plezy::mpv_common::DeadlineScheduler::Clock::time_point) {
+    property_flush_timer_ = 0;
+    FlushPropertyBatch(false);
+  });
+}
+
+void MpvPlayer::DeliverMessages(flutter::EncodableList messages) {
+  if (messages.empty()) return;
+  // The lock covers only the hand-off: the callback copies nothing it was not
+  // given, and a slow platform-thread post must not hold up SetEventCallback.
+  EventCallback callback;
+  {
+    std::lock_guard<std::mutex> lock(callback_mutex_);
+    callback = event_callback_;
   }
+  if (callback) callback(std::move(messages));
 }
 
 void MpvPlayer::SetHDREnabled(bool enabled, StatusCallback callback) {
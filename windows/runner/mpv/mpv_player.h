@@ -12,6 +12,7 @@
 #include <mutex>
 #include <string>
 #include <thread>
+#include <utility>
 #include <vector>
 
 #include "../../../shared/mpv/mpv_player_common.h"
@@ -28,19 +29,41 @@ inline constexpr DWORD kVideoHostWindowStyle = WS_CHILD | WS_CLIPSIBLINGS | WS_D
 // and event dispatching.
 class MpvPlayer {
  public:
-  using EventCallback = std::function<void(const flutter::EncodableValue&)>;
+  // Receives, in order, every channel message one drain of mpv's event queue
+  // produced, so the platform thread is reached once per drain rather than
+  // once per event.
+  using EventCallback = std::function<void(flutter::EncodableList messages)>;
 
   // |audio_only| runs mpv as a windowless music core: no child HWND, no VO,
   // video decode disabled entirely (vid=no).
   explicit MpvPlayer(bool audio_only = false);
   ~MpvPlayer();
 
+  // A core warmed ahead of its player by the plugin's standby pool (see
+  // plezy::mpv_common::StandbyCorePool): the hidden host window, made on the
+  // platform thread for |view|, and the initialised handle rendering into it,
+  // null until warmed or when warming failed. Audio-only cores have neither
+  // window nor view.
+  struct StandbyCore {
+    HWND view = nullptr;
+    HWND hwnd = nullptr;
+    mpv_handle* mpv = nullptr;
+  };
+
+  // Platform thread: seeds a standby core for |view|.
+  static StandbyCore PrepareStandbyCore(HWND view, bool audio_only);
+  // Any thread: creates and initialises the seeded core's handle.
+  static void WarmStandbyCore(StandbyCore* core, bool audio_only);
+  // Platform thread: releases a core no player claimed.
+  static void DiscardStandbyCore(StandbyCore core);
+
   // Initializes mpv and creates the video window as a child of the Flutter
   // |view| window. The flutter-plezy engine presents the UI on a topmost
   // DirectComposition visual, so the video child composites beneath it in the
   // same HWND. In audio-only mode |view| is ignored (pass nullptr) and no
-  // window is created.
-  bool Initialize(HWND view);
+  // window is created. A claimed |standby| core is adopted instead of creating
+  // one; whatever the call takes from it is cleared.
+  bool Initialize(HWND view, StandbyCore* standby = nullptr);
 
   // Disposes mpv and the video window.
   void Dispose();
@@ -59,6 +82,17 @@ class MpvPlayer {
   // Executes an mpv command asynchronously to prevent UI blocking.
   void CommandAsync(const std::vector<std::string>& args, CommandCallback callback);
 
+  // Queues |url| as the next title (see plezy::mpv_common::NextItemPreload):
+  // appended after the playing one with prefetch on, replacing any title
+  // queued before it. |options| are mpv per-entry options for it alone. The
+  // callback reports the append; a `preload` event follows with `ready`, and
+  // later `promoted` or `failed`.
+  void Preload(const std::string& url, const std::string& options, StatusCallback callback);
+
+  // Switches to the preloaded title. False, without calling back, when there
+  // is none queued.
+  bool Promote(StatusCallback callback);
+
   // Queues an mpv property update without waiting for completion.
   void SetProperty(const std::string& name, const std::string& value);
 
@@ -68,8 +102,10 @@ class MpvPlayer {
   // Gets an mpv property asynchronously.
   void GetPropertyAsync(const std::string& name, GetPropertyCallback callback);
 
-  // Observes an mpv property for changes.
-  void ObserveProperty(const std::string& name, const std::string& format, int id);
+  // Observes an mpv property for changes. While batching, a positive
+  // `min_interval_ms` holds its deliveries to one per interval; the last value
+  // still goes out when the interval ends.
+  void ObserveProperty(const std::string& name, const std::string& format, int id, int min_interval_ms = 0);
 
   // Returns the mpv video window handle.
   HWND GetHwnd() const { return hwnd_; }
@@ -86,21 +122,49 @@ class MpvPlayer {
   // Sets the event callback for property changes and events.
   void SetEventCallback(EventCallback callback);
 
+  // Coalesces the property changes of each drain into one `property-batch`
+  // message, last value wins, instead of one [id, value] message each. Taken
+  // up by the event thread from its next drain.
+  void SetPropertyBatching(bool enabled);
+
+  // The event loop's histograms (see plezy::mpv_common::EventLoopStats) as a
+  // map for the method channel. |reset| starts them over once read. Safe from
+  // any thread.
+  flutter::EncodableValue GetEventLoopStats(bool reset);
+
+  // Logs the event loop's percentiles for each interval of |interval_ms| that
+  // saw events, as a `log-message` as well as to the debugger. 0 stops it.
+  void SetEventLoopStatsLogInterval(int interval_ms);
+
   // Power notifications, called from the platform thread (window proc).
-  // NotifyPowerResume only sets an atomic flag consumed by the event thread —
-  // no mpv calls, no timers — so it cannot race Dispose and needs no cleanup.
+  // NotifyPowerResume sets a flag consumed by the event thread and wakes it
+  // with mpv_wakeup; both happen on the thread that runs Dispose, so it cannot
+  // race the handle going away and needs no cleanup.
   void NotifyPowerSuspend();
   void NotifyPowerResume();
 
  private:
   friend class MpvPlayerPropertyContractTestPeer;
 
+  static HWND CreateVideoHost(HWND view);
+  static mpv_handle* CreateCore(bool audio_only, bool hdr_enabled, HWND host);
   void StartEventLoop();
   void StopEventLoop();
   void EventLoop();
+  static void OnMpvWakeup(void* ctx);
+  void WakeEventLoop();
+  void RunEventLoopTimers();
+  void ScheduleEventLoopStatsLog(plezy::mpv_common::DeadlineScheduler::Clock::time_point now);
+  void LogEventLoopStats(plezy::mpv_common::DeadlineScheduler::Clock::time_point now);
   void HandleMpvEvent(mpv_event* event);
-  void SendPropertyChange(const char* name, mpv_node* data);
+  void SendPropertyChange(uint64_t userdata, mpv_node* data);
   void SendEvent(const std::string& name, const flutter::EncodableMap& data = {});
+  void SendPreloadEvent(const char* state, const std::string& url, int error = 0);
+  void QueueMessage(flutter::EncodableValue message);
+  void ApplyPendingMinIntervals();
+  void FlushPropertyBatch(bool force);
+  void SchedulePropertyFlush(plezy::mpv_common::DeadlineScheduler::Clock::time_point at);
+  void DeliverMessages(flutter::EncodableList messages);
   void MaybeRunAudioRecovery();
   void TryAudioReload(const char* reason, int attempt, uint64_t request_generation);
   void LogRecovery(const std::string& text);
@@ -118,10 +182,46 @@ class MpvPlayer {
   std::atomic<bool> running_{false};
   EventCallback event_callback_;
   std::mutex callback_mutex_;
+
+  // Per-drain batching. While the event thread drains, its messages collect
+  // in drain_messages_ and go out together once the queue is empty; property
+  // changes are staged in property_batch_ when batching is on, and flushed
+  // ahead of any event so none trails an event mpv reported after it. A
+  // property with a minimum interval can be held past its drain, and a timer
+  // sends it once it is due. All of it is the event thread's alone; other
+  // threads deliver directly, and hand new intervals over through
+  // pending_min_intervals_.
+  std::atomic<std::thread::id> event_thread_id_{};
+  std::atomic<bool> property_batching_{false};
+  bool draining_ = false;
+  bool batch_properties_ = false;
+  flutter::EncodableList drain_messages_;
+  plezy::mpv_common::PropertyChangeCoalescer<flutter::EncodableValue> property_batch_;
+  uint64_t property_flush_timer_ = 0;
+  plezy::mpv_common::DeadlineScheduler::Clock::time_point property_flush_at_{};
+  std::mutex min_interval_mutex_;
+  std::vector<std::pair<int, int>> pending_min_intervals_;  // (id, ms)
+  std::atomic<bool> min_intervals_pending_{false};
   plezy::mpv_common::AudioRecoveryState audio_recovery_;
+  // Timed work for the event thread, which sleeps until the earliest entry
+  // (or the next audio reload) instead of polling.
+  plezy::mpv_common::DeadlineScheduler timers_;
 
   plezy::mpv_common::AsyncRequestRegistry pending_requests_;
   plezy::mpv_common::PropertyObservationRegistry observed_properties_;
+  plezy::mpv_common::NextItemPreload next_item_;
+
+  // Event-loop instrumentation. The histograms are atomic; the wakeup stamp
+  // is the first wakeup since the last drain, in steady_clock ticks (0: none).
+  // The logged baseline and its timer are the event thread's alone: the
+  // platform thread asks for a fresh one through stats_log_rebase_ instead of
+  // writing them, and wakes the loop to apply it.
+  plezy::mpv_common::EventLoopStats event_loop_stats_;
+  std::atomic<int64_t> wakeup_at_{0};
+  std::atomic<int> stats_log_interval_ms_{0};
+  std::atomic<bool> stats_log_rebase_{false};
+  uint64_t stats_log_timer_ = 0;
+  plezy::mpv_common::EventLoopStats::Snapshot stats_logged_;
 
   // HDR state
   bool hdr_enabled_ = true;
@@ -1,12 +1,14 @@
 #include <windowsx.h>
 
 #include <atomic>
+#include <chrono>
 #include <cstdlib>
 #include <functional>
 #include <future>
 #include <iostream>
 #include <thread>
 #include <utility>
+#include <vector>
 
 #include "mpv_player.h"
 
@@ -36,6 +38,30 @@ class MpvPlayerPropertyContractTestPeer {
     player.hwnd_ = nullptr;
     player.forward_target_view_ = nullptr;
   }
+
+  // Makes the calling thread the player's event thread, batching properties.
+  static void BecomeBatchingEventThread(MpvPlayer& player) {
+    player.event_thread_id_.store(std::this_thread::get_id(), std::memory_order_relaxed);
+    player.batch_properties_ = true;
+  }
+
+  static void SetMinInterval(MpvPlayer& player, int id, int ms) {
+    player.property_batch_.SetMinInterval(id, std::chrono::milliseconds(ms));
+  }
+
+  static void StageChange(MpvPlayer& player, int id, flutter::EncodableValue value) {
+    player.property_batch_.Stage(id, std::move(value));
+  }
+
+  static void FlushPropertyBatch(MpvPlayer& player, bool force) { player.FlushPropertyBatch(force); }
+
+  static bool NextTimer(MpvPlayer& player, plezy::mpv_common::DeadlineScheduler::Clock::time_point* at) {
+    return player.timers_.NextDeadline(at);
+  }
+
+  static void RunTimers(MpvPlayer& player) {
+    player.timers_.RunDue(plezy::mpv_common::DeadlineScheduler::Clock::now());
+  }
 };
 
 namespace {
@@ -263,6 +289,69 @@ void TestPendingRequestTypesRemainDistinctOnDispose() {
   Check(read_value.empty(), "cancelled property reads must not manufacture a value");
 }
 
+// The last [id, value] pair of the property batch delivered `index`-th.
+flutter::EncodableValue LastBatchedValue(const std::vector<flutter::EncodableList>& delivered, size_t index) {
+  const auto& batch = std::get<flutter::EncodableMap>(delivered[index].front());
+  const auto& changes = std::get<flutter::EncodableList>(batch.at(flutter::EncodableValue("changes")));
+  return changes.back();
+}
+
+void TestHeldPropertyGoesOutWhenItsIntervalEnds() {
+  using Peer = MpvPlayerPropertyContractTestPeer;
+  MpvPlayer player;
+  std::vector<flutter::EncodableList> delivered;
+  player.SetEventCallback([&](flutter::EncodableList messages) { delivered.push_back(std::move(messages)); });
+  Peer::BecomeBatchingEventThread(player);
+  Peer::SetMinInterval(player, 7, 250);
+
+  Peer::StageChange(player, 7, flutter::EncodableValue(1));
+  Peer::FlushPropertyBatch(player, false);
+  Check(delivered.size() == 1, "a property's first value must go out with its drain");
+
+  const auto held_at = plezy::mpv_common::DeadlineScheduler::Clock::now();
+  Peer::StageChange(player, 7, flutter::EncodableValue(2));
+  Peer::StageChange(player, 7, flutter::EncodableValue(3));
+  Peer::FlushPropertyBatch(player, false);
+  Check(delivered.size() == 1, "a value inside its minimum interval must be held");
+  plezy::mpv_common::DeadlineScheduler::Clock::time_point due{};
+  Check(Peer::NextTimer(player, &due), "a held value must schedule its own flush");
+  Check(due > held_at && due <= held_at + std::chrono::milliseconds(250), "the flush must fall due with the interval");
+
+  std::this_thread::sleep_until(due);
+  Peer::RunTimers(player);
+  Check(delivered.size() == 2, "the flush timer must send the held value");
+  Check(LastBatchedValue(delivered, 1) == flutter::EncodableValue(3), "the held value must be the latest one");
+
+  // An event must not overtake a held value, interval or not.
+  Peer::StageChange(player, 7, flutter::EncodableValue(4));
+  Peer::FlushPropertyBatch(player, true);
+  Check(delivered.size() == 3, "a forced flush must send a value inside its interval");
+  Check(LastBatchedValue(delivered, 2) == flutter::EncodableValue(4), "a forced flush must send the latest value");
+}
+
+void TestDisposeForgetsPropertyIntervals() {
+  using Peer = MpvPlayerPropertyContractTestPeer;
+  MpvPlayer player;
+  std::vector<flutter::EncodableList> delivered;
+  player.SetEventCallback([&](flutter::EncodableList messages) { delivered.push_back(std::move(messages)); });
+  Peer::BecomeBatchingEventThread(player);
+  Peer::SetMinInterval(player, 7, 60000);
+  Peer::StageChange(player, 7, flutter::EncodableValue(1));
+  Peer::FlushPropertyBatch(player, false);
+  Check(delivered.size() == 1, "a property's first value must go out with its drain");
+  Peer::StageChange(player, 7, flutter::EncodableValue(2));
+
+  player.Dispose();
+  Peer::BecomeBatchingEventThread(player);
+  Peer::StageChange(player, 7, flutter::EncodableValue(3));
+  Peer::FlushPropertyBatch(player, false);
+  Check(delivered.size() == 2, "an id observed after dispose must not inherit the old interval");
+  Check(LastBatchedValue(delivered, 1) == flutter::EncodableValue(3), "a value staged before dispose must not be sent");
+  Peer::StageChange(player, 7, flutter::EncodableValue(4));
+  Peer::FlushPropertyBatch(player, false);
+  Check(delivered.size() == 3, "an id observed after dispose must not be held");
+}
+
 void TestInnerSubclassOwnershipIsSerializedAndDetached() {
   struct TestWindows {
     HWND target;
@@ -806,6 +895,8 @@ int main() {
   mpv::TestUnavailablePropertyWriteFails();
   mpv::TestPendingPropertyWriteFailsOnDispose();
   mpv::TestPendingRequestTypesRemainDistinctOnDispose();
+  mpv::TestHeldPropertyGoesOutWhenItsIntervalEnds();
+  mpv::TestDisposeForgetsPropertyIntervals();
   mpv::TestInnerSubclassOwnershipIsSerializedAndDetached();
   mpv::TestTimedOutSubclassDetachCanBeAdopted();
   mpv::TestTimedOutSubclassInstallCannotOutliveItsState();
@@ -73,6 +73,7 @@ MpvPlayerPlugin::~MpvPlayerPlugin() {
     player_->Dispose();
     player_.reset();
   }
+  standby_pool_.reset();
 
   DrainPlatformTasks();
 
@@ -124,6 +125,12 @@ void MpvPlayerPlugin::DrainPlatformTasks() {
   }
 }
 
+void MpvPlayerPlugin::RefillStandbyCore() {
+  if (!standby_pool_ || standby_pool_->has_standby()) return;
+  HWND view = audio_only_ ? nullptr : GetChildWindow();
+  standby_pool_->Refill(MpvPlayer::PrepareStandbyCore(view, audio_only_));
+}
+
 void MpvPlayerPlugin::HandleMethodCall(
     const flutter::MethodCall<flutter::EncodableValue>& method_call,
     std::unique_ptr<flutter::MethodResult<flutter::EncodableValue>> result) {
@@ -180,12 +187,18 @@ void MpvPlayerPlugin::HandleMethodCall(
 
     const uint64_t generation = player_generation_.fetch_add(1, std::memory_order_acq_rel) + 1;
     player_ = std::make_unique<MpvPlayer>(audio_only_);
-    bool success = player_->Initialize(view);
+    MpvPlayer::StandbyCore standby;
+    const bool claimed = standby_pool_ && standby_pool_->Claim(&standby);
+    bool success = player_->Initialize(view, claimed ? &standby : nullptr);
+    // Whatever the player did not adopt is still ours to release.
+    if (claimed) MpvPlayer::DiscardStandbyCore(standby);
+    // Warm the one after this while the title plays.
+    RefillStandbyCore();
 
     if (success) {
       // Set up event callback.
       player_->SetEventCallback(
-          [this, generation](const flutter::EncodableValue& event) { SendEvent(generation, event); });
+          [this, generation](flutter::EncodableList events) { SendEvents(generation, std::move(events)); });
 
       if (!audio_only_) {
         // Start hidden.
@@ -202,6 +215,31 @@ void MpvPlayerPlugin::HandleMethodCall(
       player_->Dispose();
       player_.reset();
     }
+    RefillStandbyCore();
+    result->Success();
+  } else if (method == "setStandbyCore") {
+    const auto* args = method_call.arguments();
+    if (!args || !std::holds_alternative<flutter::EncodableMap>(*args)) {
+      result->Error("INVALID_ARGS", "Expected map argument");
+      return;
+    }
+
+    const auto& map = std::get<flutter::EncodableMap>(*args);
+    auto enabled_it = map.find(flutter::EncodableValue("enabled"));
+    if (enabled_it == map.end() || !std::holds_alternative<bool>(enabled_it->second)) {
+      result->Error("INVALID_ARGS", "Missing 'enabled'");
+      return;
+    }
+
+    if (!std::get<bool>(enabled_it->second)) {
+      standby_pool_.reset();
+    } else if (!standby_pool_) {
+      const bool audio_only = audio_only_;
+      standby_pool_ = std::make_unique<plezy::mpv_common::StandbyCorePool<MpvPlayer::StandbyCore>>(
+          [audio_only](MpvPlayer::StandbyCore* core) { MpvPlayer::WarmStandbyCore(core, audio_only); },
+          [](MpvPlayer::StandbyCore core) { MpvPlayer::DiscardStandbyCore(core); });
+      RefillStandbyCore();
+    }
     result->Success();
   } else if (method == "command") {
     if (!player_ || !player_->IsInitialized()) {
@@ -246,6 +284,62 @@ void MpvPlayerPlugin::HandleMethodCall(
       });
     });
     return;  // Response will be sent asynchronously
+  } else if (method == "preload") {
+    if (!player_ || !player_->IsInitialized()) {
+      result->Error("NOT_INITIALIZED", "Player not initialized");
+      return;
+    }
+
+    const auto* args = method_call.arguments();
+    if (!args || !std::holds_alternative<flutter::EncodableMap>(*args)) {
+      result->Error("INVALID_ARGS", "Expected map argument");
+      return;
+    }
+
+    const auto& map = std::get<flutter::EncodableMap>(*args);
+    auto url_it = map.find(flutter::EncodableValue("url"));
+    if (url_it == map.end() || !std::holds_alternative<std::string>(url_it->second)) {
+      result->Error("INVALID_ARGS", "Missing 'url'");
+      return;
+    }
+    std::string options;
+    auto options_it = map.find(flutter::EncodableValue("options"));
+    if (options_it != map.end() && std::holds_alternative<std::string>(options_it->second)) {
+      options = std::get<std::string>(options_it->second);
+    }
+
+    auto result_ptr =
+        std::make_shared<std::unique_ptr<flutter::MethodResult<flutter::EncodableValue>>>(std::move(result));
+    player_->Preload(std::get<std::string>(url_it->second), options, [this, result_ptr](int error) {
+      PostToPlatformThread([result_ptr, error]() {
+        if (error < 0) {
+          (*result_ptr)->Error("PRELOAD_FAILED", mpv_error_string(error));
+        } else {
+          (*result_ptr)->Success();
+        }
+      });
+    });
+    return;
+  } else if (method == "promote") {
+    if (!player_ || !player_->IsInitialized()) {
+      result->Error("NOT_INITIALIZED", "Player not initialized");
+      return;
+    }
+
+    auto result_ptr =
+        std::make_shared<std::unique_ptr<flutter::MethodResult<flutter::EncodableValue>>>(std::move(result));
+    const bool queued = player_->Promote([this, result_ptr](int error) {
+      PostToPlatformThread([result_ptr, error]() {
+        if (error < 0) {
+          (*result_ptr)
+              ->Error("COMMAND_FAILED", "MPV command failed: playlist-next (error " + std::to_string(error) + ")");
+        } else {
+          (*result_ptr)->Success();
+        }
+      });
+    });
+    if (!queued) (*result_ptr)->Error("NO_PRELOAD", "No preloaded item to promote");
+    return;
   } else if (method == "setProperty") {
     if (!player_ || !player_->IsInitialized()) {
       result->Error(plezy::mpv_common::kSetPropertyNotInitializedCode, "Player not initialized");
@@ -373,9 +467,76 @@ void MpvPlayerPlugin::HandleMethodCall(
       return;
     }
 
+    // Optional, and only honoured while property batching is on.
+    int min_interval_ms = 0;
+    auto interval_it = map.find(flutter::EncodableValue("minIntervalMs"));
+    if (interval_it != map.end() && std::holds_alternative<int32_t>(interval_it->second)) {
+      min_interval_ms = std::min(std::max(std::get<int32_t>(interval_it->second), 0), 60000);
+    }
+
     player_->ObserveProperty(
         std::get<std::string>(name_it->second), std::get<std::string>(format_it->second),
-        std::get<int32_t>(id_it->second));
+        std::get<int32_t>(id_it->second), min_interval_ms);
+    result->Success();
+  } else if (method == "getEventLoopStats") {
+    if (!player_ || !player_->IsInitialized()) {
+      result->Error("NOT_INITIALIZED", "Player not initialized");
+      return;
+    }
+
+    bool reset = false;
+    const auto* args = method_call.arguments();
+    if (args && std::holds_alternative<flutter::EncodableMap>(*args)) {
+      const auto& map = std::get<flutter::EncodableMap>(*args);
+      auto reset_it = map.find(flutter::EncodableValue("reset"));
+      if (reset_it != map.end() && std::holds_alternative<bool>(reset_it->second)) {
+        reset = std::get<bool>(reset_it->second);
+      }
+    }
+    result->Success(player_->GetEventLoopStats(reset));
+  } else if (method == "setEventLoopStatsLogInterval") {
+    if (!player_ || !player_->IsInitialized()) {
+      result->Error("NOT_INITIALIZED", "Player not initialized");
+      return;
+    }
+
+    const auto* args = method_call.arguments();
+    if (!args || !std::holds_alternative<flutter::EncodableMap>(*args)) {
+      result->Error("INVALID_ARGS", "Expected map argument");
+      return;
+    }
+
+    const auto& map = std::get<flutter::EncodableMap>(*args);
+    auto interval_it = map.find(flutter::EncodableValue("intervalMs"));
+    if (interval_it == map.end() || !std::holds_alternative<int32_t>(interval_it->second)) {
+      result->Error("INVALID_ARGS", "Missing 'intervalMs'");
+      return;
+    }
+
+    // Same bounds as Linux: at most an hour.
+    const int32_t interval_ms = std::get<int32_t>(interval_it->second);
+    player_->SetEventLoopStatsLogInterval(interval_ms > 3600000 ? 3600000 : interval_ms);
+    result->Success();
+  } else if (method == "setPropertyBatching") {
+    if (!player_ || !player_->IsInitialized()) {
+      result->Error("NOT_INITIALIZED", "Player not initialized");
+      return;
+    }
+
+    const auto* args = method_call.arguments();
+    if (!args || !std::holds_alternative<flutter::EncodableMap>(*args)) {
+      result->Error("INVALID_ARGS", "Expected map argument");
+      return;
+    }
+
+    const auto& map = std::get<flutter::EncodableMap>(*args);
+    auto enabled_it = map.find(flutter::EncodableValue("enabled"));
+    if (enabled_it == map.end() || !std::holds_alternative<bool>(enabled_it->second)) {
+      result->Error("INVALID_ARGS", "Missing 'enabled'");
+      return;
+    }
+
+    player_->SetPropertyBatching(std::get<bool>(enabled_it->second));
     result->Success();
   } else if (method == "setVisible") {
     if (audio_only_) {
@@ -527,13 +688,16 @@ void MpvPlayerPlugin::HandleMethodCall(
   }
 }
 
-void MpvPlayerPlugin::SendEvent(uint64_t player_generation, const flutter::EncodableValue& event) {
+void MpvPlayerPlugin::SendEvents(uint64_t player_generation, flutter::EncodableList events) {
   // mpv events arrive on the mpv event thread; Flutter channel APIs are
   // platform-thread-only. Capture the player generation at receipt so queued
   // property/event callbacks from a disposed player cannot publish into its
-  // replacement's stream.
-  PostToPlatformThread([this, player_generation, event]() {
-    if (player_generation_.load(std::memory_order_acquire) == player_generation && event_sink_) {
+  // replacement's stream. A whole drain rides one task, so a seek storm
+  // queues one task per drain rather than one per property change.
+  auto batch = std::make_shared<flutter::EncodableList>(std::move(events));
+  PostToPlatformThread([this, player_generation, batch]() {
+    for (const auto& event : *batch) {
+      if (player_generation_.load(std::memory_order_acquire) != player_generation || !event_sink_) return;
       event_sink_->Success(event);
     }
   });
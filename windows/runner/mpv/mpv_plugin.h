@@ -46,9 +46,10 @@ class MpvPlayerPlugin : public flutter::Plugin {
       const flutter::MethodCall<flutter::EncodableValue>& method_call,
       std::unique_ptr<flutter::MethodResult<flutter::EncodableValue>> result);
 
-  void SendEvent(uint64_t player_generation, const flutter::EncodableValue& event);
+  void SendEvents(uint64_t player_generation, flutter::EncodableList events);
   void PostToPlatformThread(std::function<void()> task);
   void DrainPlatformTasks();
+  void RefillStandbyCore();
 
   HWND GetWindow();
   HWND GetChildWindow();
@@ -66,6 +67,9 @@ class MpvPlayerPlugin : public flutter::Plugin {
   std::unique_ptr<flutter::EventSink<flutter::EncodableValue>> event_sink_;
 
   std::unique_ptr<MpvPlayer> player_;
+  // The next player's core, warmed in the background while Dart has it on
+  // (setStandbyCore). Platform thread only.
+  std::unique_ptr<plezy::mpv_common::StandbyCorePool<MpvPlayer::StandbyCore>> standby_pool_;
   std::atomic<uint64_t> player_generation_{0};
   DisplayModeManager display_mode_manager_;
   std::optional<int32_t> proc_id_;